@@ -0,0 +1,332 @@
+////////////////////////////////////////
+//
+//  File:
+//      \file AlignedBuffer.hpp
+//
+//  Description:
+//      \brief Aligned Buffer: Header & Impl
+//
+//  Author:
+//      \author J. Caleb Wherry
+//
+////////////////////////////////////////
+
+// Include Guards:
+#ifndef ALIGNED_BUFFER_H
+#define ALIGNED_BUFFER_H
+
+// Forward Declared Dependencies:
+//
+
+// Local Include Dependencies:
+#include "MemoryResource.hpp"
+
+// Compiler Include Dependencies:
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <memory>
+#include <utility>
+#include <algorithm>
+
+/// matrix Namespace
+namespace matrix
+{
+
+  /// Byte alignment of every buffer (one cache line, one AVX-512 register)
+  const std::size_t storageAlignment = 64;
+
+  /// Allocate raw, uninitialized memory for count elements aligned to storageAlignment
+  template <typename T>
+  T* allocateAligned(std::size_t count, MemoryResource& resource)
+  {
+    if ( count == 0 )
+    {
+      return nullptr;
+    }
+
+    // Guard against size overflow:
+    if ( count > (SIZE_MAX - storageAlignment) / sizeof(T) )
+    {
+      throw std::bad_alloc();
+    }
+
+    return static_cast<T*>(resource.allocate(count*sizeof(T), storageAlignment));
+  }
+
+  /// Free memory obtained from allocateAligned
+  template <typename T>
+  void deallocateAligned(T* ptr, std::size_t count, MemoryResource& resource)
+  {
+    if ( ptr != nullptr )
+    {
+      resource.deallocate(ptr, count*sizeof(T));
+    }
+  }
+
+  /// Aligned Buffer class
+  ///
+  /// Owns a single contiguous, storageAlignment-aligned block of constructed
+  /// elements. This is the storage engine behind Matrix. Memory comes from
+  /// the calling thread's current MemoryResource and goes back to the same one.
+  template <typename T>
+  class AlignedBuffer
+  {
+
+    private:
+      MemoryResource* resource;   ///< Where the memory came from
+      T* ptr;               ///< First element
+      std::size_t count;    ///< Number of constructed elements
+      std::shared_ptr<void> owner;   ///< Keeps adopted memory alive (null when the buffer allocated it)
+
+      /// Destroy all elements and free the block
+      void release();
+
+    public:
+
+      //
+      // Constructors:
+      //
+
+      /// Default Constructor (empty buffer, no allocation)
+      AlignedBuffer();
+
+      /// Default-initialized Constructor (scalars are left uninitialized)
+      explicit AlignedBuffer(
+        std::size_t _count    ///< Number of elements
+      );
+
+      /// Fill Constructor
+      AlignedBuffer(
+        std::size_t _count,   ///< Number of elements
+        const T& initVal      ///< Value of every element
+      );
+
+      /// Adopting Constructor (views _count elements at _ptr, which owner keeps
+      ///  alive, e.g. a mapped file; nothing is allocated, constructed or freed)
+      AlignedBuffer(
+        T* _ptr,                        ///< First element (storageAlignment-aligned)
+        std::size_t _count,             ///< Number of elements
+        std::shared_ptr<void> _owner    ///< Released when the buffer lets go of the memory
+      );
+
+      /// Copy Constructor (deep copy)
+      AlignedBuffer(
+        const AlignedBuffer<T>& rhs   ///< Buffer to copy from
+      );
+
+      /// Move Constructor
+      AlignedBuffer(
+        AlignedBuffer<T>&& rhs        ///< Buffer to steal from
+      ) noexcept;
+
+      /// Deconstructor
+      ~AlignedBuffer();
+
+
+      //
+      // Operators:
+      //
+
+      /// Copy Assignment
+      AlignedBuffer<T>& operator=(const AlignedBuffer<T>& rhs);
+
+      /// Move Assignment
+      AlignedBuffer<T>& operator=(AlignedBuffer<T>&& rhs) noexcept;
+
+
+      //
+      // Accessors:
+      //
+
+      T* data() { return ptr; };                        ///< First element
+      const T* data() const { return ptr; };            ///< First element (const)
+      std::size_t size() const { return count; };       ///< Number of elements
+      MemoryResource& getResource() const { return *resource; };   ///< Where the memory came from
+      bool isAdopted() const { return owner != nullptr; };   ///< Is the memory someone else's?
+
+      /// Swap contents with another buffer
+      void swap(AlignedBuffer<T>& rhs) noexcept;
+
+  }; // AlignedBuffer class
+
+
+  //
+  // Template Implementation
+  //
+
+
+  // Default constructor
+  template <typename T>
+  AlignedBuffer<T>::AlignedBuffer()
+        : resource(&getMemoryResource()),
+          ptr(nullptr),
+          count(0)
+  {
+  }
+
+  // Default-initialized constructor
+  template <typename T>
+  AlignedBuffer<T>::AlignedBuffer(std::size_t _count)
+        : resource(&getMemoryResource()),
+          ptr(allocateAligned<T>(_count, *resource)),
+          count(_count)
+  {
+    // Placement-new each element. For trivial types this compiles away and the
+    //  memory stays uninitialized, which is what result buffers want.
+    std::size_t i = 0;
+    try
+    {
+      for (; i<count; ++i)
+      {
+        new (ptr + i) T;
+      }
+    }
+    catch (...)
+    {
+      for (std::size_t j=0; j<i; ++j)
+      {
+        ptr[j].~T();
+      }
+      deallocateAligned(ptr, count, *resource);
+      throw;
+    }
+  }
+
+  // Fill constructor
+  template <typename T>
+  AlignedBuffer<T>::AlignedBuffer(std::size_t _count, const T& initVal)
+        : resource(&getMemoryResource()),
+          ptr(allocateAligned<T>(_count, *resource)),
+          count(_count)
+  {
+    try
+    {
+      std::uninitialized_fill_n(ptr, count, initVal);
+    }
+    catch (...)
+    {
+      deallocateAligned(ptr, count, *resource);
+      throw;
+    }
+  }
+
+  // Adopting constructor
+  template <typename T>
+  AlignedBuffer<T>::AlignedBuffer(T* _ptr, std::size_t _count, std::shared_ptr<void> _owner)
+        : resource(&getMemoryResource()),
+          ptr(_ptr),
+          count(_count),
+          owner(std::move(_owner))
+  {
+  }
+
+  // Copy constructor
+  template <typename T>
+  AlignedBuffer<T>::AlignedBuffer(const AlignedBuffer<T>& rhs)
+        : resource(&getMemoryResource()),
+          ptr(allocateAligned<T>(rhs.count, *resource)),
+          count(rhs.count)
+  {
+    try
+    {
+      std::uninitialized_copy(rhs.ptr, rhs.ptr + count, ptr);
+    }
+    catch (...)
+    {
+      deallocateAligned(ptr, count, *resource);
+      throw;
+    }
+  }
+
+  // Move constructor
+  template <typename T>
+  AlignedBuffer<T>::AlignedBuffer(AlignedBuffer<T>&& rhs) noexcept
+        : resource(rhs.resource),
+          ptr(rhs.ptr),
+          count(rhs.count),
+          owner(std::move(rhs.owner))
+  {
+    rhs.ptr = nullptr;
+    rhs.count = 0;
+  }
+
+  // Destructor
+  template <typename T>
+  AlignedBuffer<T>::~AlignedBuffer()
+  {
+    release();
+  }
+
+  // release
+  template <typename T>
+  void AlignedBuffer<T>::release()
+  {
+    // Adopted memory goes back to its owner untouched:
+    if ( owner )
+    {
+      owner.reset();
+      ptr = nullptr;
+      count = 0;
+      return;
+    }
+
+    for (std::size_t i=0; i<count; ++i)
+    {
+      ptr[i].~T();
+    }
+
+    deallocateAligned(ptr, count, *resource);
+    ptr = nullptr;
+    count = 0;
+  }
+
+  // Operator = (copy)
+  template <typename T>
+  AlignedBuffer<T>& AlignedBuffer<T>::operator=(const AlignedBuffer<T>& rhs)
+  {
+    if ( this == &rhs )
+    {
+      return *this;
+    }
+
+    // Same size: copy in place and skip the allocation:
+    if ( count == rhs.count )
+    {
+      std::copy(rhs.ptr, rhs.ptr + count, ptr);
+      return *this;
+    }
+
+    AlignedBuffer<T> temp(rhs);
+    swap(temp);
+
+    return *this;
+  }
+
+  // Operator = (move)
+  template <typename T>
+  AlignedBuffer<T>& AlignedBuffer<T>::operator=(AlignedBuffer<T>&& rhs) noexcept
+  {
+    if ( this != &rhs )
+    {
+      release();
+      swap(rhs);
+    }
+
+    return *this;
+  }
+
+  // swap
+  template <typename T>
+  void AlignedBuffer<T>::swap(AlignedBuffer<T>& rhs) noexcept
+  {
+    std::swap(resource, rhs.resource);
+    std::swap(ptr, rhs.ptr);
+    std::swap(count, rhs.count);
+    owner.swap(rhs.owner);
+  }
+
+} // matrix namespace
+
+#endif // ALIGNED_BUFFER_H
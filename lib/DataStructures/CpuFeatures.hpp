@@ -0,0 +1,75 @@
+////////////////////////////////////////
+//
+//  File:
+//      \file CpuFeatures.hpp
+//
+//  Description:
+//      \brief CPU Features: Header & Impl
+//
+//  Author:
+//      \author J. Caleb Wherry
+//
+////////////////////////////////////////
+
+// Include Guards:
+#ifndef CPU_FEATURES_H
+#define CPU_FEATURES_H
+
+// Forward Declared Dependencies:
+//
+
+// Local Include Dependencies:
+//
+
+// Compiler Include Dependencies:
+//
+
+// SIMD kernels are compiled with per-function target attributes and picked at
+//  runtime, so the library itself can be built without any -m flags.
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+  #define MATRIX_X86_DISPATCH 1
+  #include <immintrin.h>
+#else
+  #define MATRIX_X86_DISPATCH 0
+#endif
+
+/// matrix Namespace
+namespace matrix
+{
+
+  /// Instruction set extensions available on the running CPU
+  struct CpuFeatures
+  {
+    bool sse2;        ///< SSE2
+    bool sse42;       ///< SSE4.2 (CRC32C)
+    bool avx;         ///< AVX
+    bool avx2;        ///< AVX2
+    bool fma;         ///< FMA3
+    bool avx512f;     ///< AVX-512 Foundation
+    bool avx512vnni;  ///< AVX-512 Vector Neural Network Instructions (dpbusd)
+  };
+
+  /// Detect the running CPU's features (CPUID, done once)
+  inline const CpuFeatures& cpuFeatures()
+  {
+    static const CpuFeatures features = []() {
+      CpuFeatures f = { false, false, false, false, false, false, false };
+#if MATRIX_X86_DISPATCH
+      __builtin_cpu_init();
+      f.sse2    = __builtin_cpu_supports("sse2");
+      f.sse42   = __builtin_cpu_supports("sse4.2");
+      f.avx     = __builtin_cpu_supports("avx");
+      f.avx2    = __builtin_cpu_supports("avx2");
+      f.fma     = __builtin_cpu_supports("fma");
+      f.avx512f = __builtin_cpu_supports("avx512f");
+      f.avx512vnni = __builtin_cpu_supports("avx512vnni");
+#endif
+      return f;
+    }();
+
+    return features;
+  }
+
+} // matrix namespace
+
+#endif // CPU_FEATURES_H
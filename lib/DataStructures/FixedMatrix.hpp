@@ -0,0 +1,621 @@
+////////////////////////////////////////
+//
+//  File:
+//      \file FixedMatrix.hpp
+//
+//  Description:
+//      \brief Fixed Matrix: Compile-time sized matrix with inline storage
+//
+//  Author:
+//      \author J. Caleb Wherry
+//
+////////////////////////////////////////
+
+// Include Guards:
+#ifndef FIXED_MATRIX_H
+#define FIXED_MATRIX_H
+
+// Forward Declared Dependencies:
+//
+
+// Local Include Dependencies:
+#include "Matrix.hpp"
+
+// Compiler Include Dependencies:
+#include <cstddef>
+#include <cstdint>
+#include <complex>
+#include <stdexcept>
+#include <iostream>
+#include <type_traits>
+#include <utility>
+
+/// matrix Namespace
+namespace matrix
+{
+
+  /// fixedImpl namespace (compile-time sized kernels)
+  namespace fixedImpl
+  {
+
+    /// Tag selecting FixedMatrix's exactly-one-value-per-element constructor
+    struct ElementList {};
+
+    /// Dot product of a[0..N) and b[0, stride, .., (N-1)*stride), unrolled by recursion
+    template <typename T, std::size_t N>
+    struct Dot
+    {
+      static constexpr T compute(const T* a, const T* b, std::size_t stride)
+      {
+        return Dot<T, N - 1>::compute(a, b, stride) + a[N - 1]*b[(N - 1)*stride];
+      }
+    };
+
+    /// One-term dot product (ends the recursion)
+    template <typename T>
+    struct Dot<T, 1>
+    {
+      static constexpr T compute(const T* a, const T* b, std::size_t) { return a[0]*b[0]; }
+    };
+
+    /// Pivot size of an element (constexpr, unlike std::abs)
+    template <typename T>
+    constexpr T magnitude(const T& x) { return (x < T(0)) ? -x : x; }
+
+    /// Pivot size of an element (complex: squared modulus, enough to compare)
+    template <typename U>
+    constexpr U magnitude(const std::complex<U>& x) { return x.real()*x.real() + x.imag()*x.imag(); }
+
+    /// Determinant of an N x N row-major array of integers (fraction-free
+    ///  Bareiss elimination: every division is exact)
+    template <typename T, std::size_t N>
+    struct ExactDeterminant
+    {
+      static constexpr T compute(const T* in)
+      {
+        T a[N*N] = {};
+        for (std::size_t i=0; i<N*N; ++i)
+        {
+          a[i] = in[i];
+        }
+
+        T sign = T(1), previous = T(1);
+        for (std::size_t k=0; k<N; ++k)
+        {
+          std::size_t p = k;
+          while ( (p < N) && (a[p*N + k] == T(0)) )
+          {
+            ++p;
+          }
+          if ( p == N )
+          {
+            return T(0);
+          }
+          if ( p != k )
+          {
+            for (std::size_t j=k; j<N; ++j)
+            {
+              const T t = a[k*N + j];
+              a[k*N + j] = a[p*N + j];
+              a[p*N + j] = t;
+            }
+            sign = T(0) - sign;
+          }
+
+          const T pivot = a[k*N + k];
+          for (std::size_t i=k+1; i<N; ++i)
+          {
+            for (std::size_t j=k+1; j<N; ++j)
+            {
+              a[i*N + j] = (a[i*N + j]*pivot - a[i*N + k]*a[k*N + j])/previous;
+            }
+          }
+          previous = pivot;
+        }
+
+        return sign*previous;
+      }
+    };
+
+    /// Determinant of an N x N row-major array (elimination with partial pivoting;
+    ///  integers take ExactDeterminant, as the multipliers would truncate)
+    template <typename T, std::size_t N>
+    struct Determinant
+    {
+      static constexpr T compute(const T* in)
+      {
+        if ( std::is_integral<T>::value )
+        {
+          return ExactDeterminant<T, N>::compute(in);
+        }
+
+        T a[N*N] = {};
+        for (std::size_t i=0; i<N*N; ++i)
+        {
+          a[i] = in[i];
+        }
+
+        T det = T(1);
+        for (std::size_t k=0; k<N; ++k)
+        {
+          std::size_t p = k;
+          for (std::size_t i=k+1; i<N; ++i)
+          {
+            if ( magnitude(a[i*N + k]) > magnitude(a[p*N + k]) )
+            {
+              p = i;
+            }
+          }
+          if ( a[p*N + k] == T(0) )
+          {
+            return T(0);
+          }
+          if ( p != k )
+          {
+            for (std::size_t j=k; j<N; ++j)
+            {
+              const T t = a[k*N + j];
+              a[k*N + j] = a[p*N + j];
+              a[p*N + j] = t;
+            }
+            det = -det;
+          }
+
+          det *= a[k*N + k];
+          for (std::size_t i=k+1; i<N; ++i)
+          {
+            const T l = a[i*N + k]/a[k*N + k];
+            for (std::size_t j=k+1; j<N; ++j)
+            {
+              a[i*N + j] -= l*a[k*N + j];
+            }
+          }
+        }
+
+        return det;
+      }
+    };
+
+    /// 1 x 1 determinant
+    template <typename T>
+    struct Determinant<T, 1>
+    {
+      static constexpr T compute(const T* a) { return a[0]; }
+    };
+
+    /// 2 x 2 determinant (closed form)
+    template <typename T>
+    struct Determinant<T, 2>
+    {
+      static constexpr T compute(const T* a) { return a[0]*a[3] - a[1]*a[2]; }
+    };
+
+    /// 3 x 3 determinant (closed form)
+    template <typename T>
+    struct Determinant<T, 3>
+    {
+      static constexpr T compute(const T* a)
+      {
+        return a[0]*(a[4]*a[8] - a[5]*a[7])
+             - a[1]*(a[3]*a[8] - a[5]*a[6])
+             + a[2]*(a[3]*a[7] - a[4]*a[6]);
+      }
+    };
+
+    /// Inverse of an N x N row-major array (Gauss-Jordan with partial pivoting); false if singular
+    template <typename T, std::size_t N>
+    struct Inverse
+    {
+      static constexpr bool compute(const T* in, T* out)
+      {
+        T a[N*N] = {};
+        for (std::size_t i=0; i<N*N; ++i)
+        {
+          a[i] = in[i];
+          out[i] = (i % (N + 1) == 0) ? T(1) : T(0);
+        }
+
+        for (std::size_t k=0; k<N; ++k)
+        {
+          std::size_t p = k;
+          for (std::size_t i=k+1; i<N; ++i)
+          {
+            if ( magnitude(a[i*N + k]) > magnitude(a[p*N + k]) )
+            {
+              p = i;
+            }
+          }
+          if ( a[p*N + k] == T(0) )
+          {
+            return false;
+          }
+          if ( p != k )
+          {
+            for (std::size_t j=0; j<N; ++j)
+            {
+              const T t = a[k*N + j];
+              a[k*N + j] = a[p*N + j];
+              a[p*N + j] = t;
+              const T u = out[k*N + j];
+              out[k*N + j] = out[p*N + j];
+              out[p*N + j] = u;
+            }
+          }
+
+          const T pivot = a[k*N + k];
+          for (std::size_t j=0; j<N; ++j)
+          {
+            a[k*N + j] /= pivot;
+            out[k*N + j] /= pivot;
+          }
+          for (std::size_t i=0; i<N; ++i)
+          {
+            if ( i != k )
+            {
+              const T l = a[i*N + k];
+              for (std::size_t j=0; j<N; ++j)
+              {
+                a[i*N + j] -= l*a[k*N + j];
+                out[i*N + j] -= l*out[k*N + j];
+              }
+            }
+          }
+        }
+
+        return true;
+      }
+    };
+
+    /// 2 x 2 inverse (adjugate over determinant)
+    template <typename T>
+    struct Inverse<T, 2>
+    {
+      static constexpr bool compute(const T* a, T* out)
+      {
+        const T det = Determinant<T, 2>::compute(a);
+        if ( det == T(0) )
+        {
+          return false;
+        }
+        out[0] =  a[3]/det;  out[1] = -a[1]/det;
+        out[2] = -a[2]/det;  out[3] =  a[0]/det;
+        return true;
+      }
+    };
+
+    /// 3 x 3 inverse (adjugate over determinant)
+    template <typename T>
+    struct Inverse<T, 3>
+    {
+      static constexpr bool compute(const T* a, T* out)
+      {
+        const T det = Determinant<T, 3>::compute(a);
+        if ( det == T(0) )
+        {
+          return false;
+        }
+        out[0] = (a[4]*a[8] - a[5]*a[7])/det;
+        out[1] = (a[2]*a[7] - a[1]*a[8])/det;
+        out[2] = (a[1]*a[5] - a[2]*a[4])/det;
+        out[3] = (a[5]*a[6] - a[3]*a[8])/det;
+        out[4] = (a[0]*a[8] - a[2]*a[6])/det;
+        out[5] = (a[2]*a[3] - a[0]*a[5])/det;
+        out[6] = (a[3]*a[7] - a[4]*a[6])/det;
+        out[7] = (a[1]*a[6] - a[0]*a[7])/det;
+        out[8] = (a[0]*a[4] - a[1]*a[3])/det;
+        return true;
+      }
+    };
+
+  } // fixedImpl namespace
+
+
+  /// Fixed Matrix class
+  ///
+  /// A Rows x Cols matrix whose elements live inline (row-major, no heap, no
+  /// pad string), for the small transforms that are built and thrown away by
+  /// the million. Sizes are template arguments, so element-wise operations,
+  /// products and transposes expand to straight-line code over an index pack
+  /// (nothing is zeroed first and there are no loops left to unroll), and a
+  /// dimension mismatch is a compile error rather than a std::logic_error.
+  /// Everything is constexpr; convert to and from Matrix<T> to mix with
+  /// dynamically sized code.
+  template <typename T, std::size_t Rows, std::size_t Cols>
+  class FixedMatrix
+  {
+
+    static_assert((Rows > 0) && (Cols > 0), "FixedMatrix - Dimensions must be nonzero!");
+
+    template <typename U, std::size_t R, std::size_t C>
+    friend class FixedMatrix;
+
+    private:
+      T elements[Rows*Cols];      ///< Row-major elements
+
+      /// One value per element, in order
+      template <typename... Args>
+      constexpr FixedMatrix(fixedImpl::ElementList, const Args&... values) : elements{ T(values)... } {};
+
+      // Straight-line kernels (I runs over the result's elements):
+      template <std::size_t... I>
+      constexpr FixedMatrix plus(const FixedMatrix& rhs, std::index_sequence<I...>) const
+      { return FixedMatrix(fixedImpl::ElementList(), (elements[I] + rhs.elements[I])...); };
+
+      template <std::size_t... I>
+      constexpr FixedMatrix minus(const FixedMatrix& rhs, std::index_sequence<I...>) const
+      { return FixedMatrix(fixedImpl::ElementList(), (elements[I] - rhs.elements[I])...); };
+
+      template <std::size_t... I>
+      constexpr FixedMatrix negate(std::index_sequence<I...>) const
+      { return FixedMatrix(fixedImpl::ElementList(), (-elements[I])...); };
+
+      template <std::size_t... I>
+      constexpr FixedMatrix scale(const T& s, std::index_sequence<I...>) const
+      { return FixedMatrix(fixedImpl::ElementList(), (elements[I]*s)...); };
+
+      template <std::size_t... I>
+      constexpr FixedMatrix divide(const T& s, std::index_sequence<I...>) const
+      { return FixedMatrix(fixedImpl::ElementList(), (elements[I]/s)...); };
+
+      template <std::size_t K, std::size_t... I>
+      constexpr FixedMatrix<T, Rows, K> multiply(const FixedMatrix<T, Cols, K>& rhs, std::index_sequence<I...>) const
+      { return FixedMatrix<T, Rows, K>(fixedImpl::ElementList(), fixedImpl::Dot<T, Cols>::compute(elements + (I/K)*Cols, rhs.elements + I%K, K)...); };
+
+      template <std::size_t... I>
+      constexpr FixedMatrix<T, Cols, Rows> transpose(std::index_sequence<I...>) const
+      { return FixedMatrix<T, Cols, Rows>(fixedImpl::ElementList(), elements[(I%Rows)*Cols + I/Rows]...); };
+
+      template <std::size_t... I>
+      static constexpr FixedMatrix identity(std::index_sequence<I...>)
+      { return FixedMatrix(fixedImpl::ElementList(), ((I%(Cols + 1) == 0) ? T(1) : T(0))...); };
+
+    public:
+
+
+      //
+      // Constructors:
+      //
+
+      /// Default Constructor (all zeros)
+      constexpr FixedMatrix() : elements{} {};
+
+      /// Fill Constructor
+      constexpr explicit FixedMatrix(const T& initVal);
+
+      /// Element Constructor: exactly Rows*Cols values, row by row (checked at compile time)
+      template <typename... Args,
+                typename = typename std::enable_if<(sizeof...(Args) == Rows*Cols) && (sizeof...(Args) > 1)>::type>
+      constexpr FixedMatrix(const Args&... values) : elements{ T(values)... } {};
+
+      /// Matrix Constructor (throws if the sizes differ)
+      explicit FixedMatrix(const Matrix<T>& rhs);
+
+
+      //
+      // Accessors:
+      //
+
+      static constexpr std::size_t getNumRows() { return Rows; };         ///< Row accessor
+      static constexpr std::size_t getNumCols() { return Cols; };         ///< Columns accessor
+      static constexpr std::size_t size() { return Rows*Cols; };          ///< Number of elements
+      constexpr T* data() { return elements; };                           ///< Row-major elements
+      constexpr const T* data() const { return elements; };               ///< Row-major elements (const)
+
+      /// Dynamic copy
+      Matrix<T> toMatrix() const;
+
+
+      //
+      // Operators:
+      //
+
+      constexpr T& operator()(std::size_t row, std::size_t col);                ///< Element Access
+      constexpr const T& operator()(std::size_t row, std::size_t col) const;    ///< Element Access (const)
+
+      constexpr bool operator==(const FixedMatrix& rhs) const;    ///< Comparison
+      constexpr bool operator!=(const FixedMatrix& rhs) const { return !(*this == rhs); };
+
+      constexpr FixedMatrix operator+(const FixedMatrix& rhs) const { return plus(rhs, std::make_index_sequence<Rows*Cols>()); };    ///< Matrix/Matrix Addition
+      constexpr FixedMatrix operator-(const FixedMatrix& rhs) const { return minus(rhs, std::make_index_sequence<Rows*Cols>()); };   ///< Matrix/Matrix Subtraction
+      constexpr FixedMatrix operator-() const { return negate(std::make_index_sequence<Rows*Cols>()); };                             ///< Negation
+      constexpr FixedMatrix operator*(const T& rhs) const { return scale(rhs, std::make_index_sequence<Rows*Cols>()); };             ///< Matrix/Scalar Multiplication
+      constexpr FixedMatrix operator/(const T& rhs) const { return divide(rhs, std::make_index_sequence<Rows*Cols>()); };            ///< Matrix/Scalar Division
+
+      /// Matrix/Matrix Multiplication (inner dimensions must match to compile)
+      template <std::size_t K>
+      constexpr FixedMatrix<T, Rows, K> operator*(const FixedMatrix<T, Cols, K>& rhs) const
+      { return multiply(rhs, std::make_index_sequence<Rows*K>()); };
+
+      constexpr FixedMatrix& operator+=(const FixedMatrix& rhs) { return *this = *this + rhs; };      ///< Matrix/Matrix Addition
+      constexpr FixedMatrix& operator-=(const FixedMatrix& rhs) { return *this = *this - rhs; };      ///< Matrix/Matrix Subtraction
+      constexpr FixedMatrix& operator*=(const FixedMatrix& rhs);                                      ///< Matrix/Matrix Multiplication (square)
+      constexpr FixedMatrix& operator*=(const T& rhs) { return *this = *this*rhs; };                  ///< Matrix/Scalar Multiplication
+      constexpr FixedMatrix& operator/=(const T& rhs) { return *this = *this/rhs; };                  ///< Matrix/Scalar Division
+
+      /// Output operator
+      template <typename U, std::size_t R, std::size_t C>
+      friend std::ostream& operator<< (std::ostream& os, const FixedMatrix<U, R, C>& rhs);
+
+
+      //
+      // Operations:
+      //
+
+      constexpr FixedMatrix<T, Cols, Rows> transpose() const { return transpose(std::make_index_sequence<Rows*Cols>()); };   ///< Matrix Transpose
+      static constexpr FixedMatrix identity();                    ///< Identity (square only)
+      constexpr FixedMatrix inverse() const;                      ///< Matrix Inverse (square, floating-point or complex only; throws if singular)
+      constexpr T determinant() const;                            ///< det(A) (square only)
+      constexpr T trace() const;                                  ///< Sum of diagonal elements
+
+  }; // FixedMatrix class
+
+
+  //
+  // Template Implementation
+  //
+
+
+  // Fill constructor
+  template <typename T, std::size_t Rows, std::size_t Cols>
+  constexpr FixedMatrix<T,Rows,Cols>::FixedMatrix(const T& initVal)
+        : elements{}
+  {
+    for (std::size_t i=0; i<Rows*Cols; ++i)
+    {
+      elements[i] = initVal;
+    }
+  }
+
+  // Matrix constructor
+  template <typename T, std::size_t Rows, std::size_t Cols>
+  FixedMatrix<T,Rows,Cols>::FixedMatrix(const Matrix<T>& rhs)
+        : elements{}
+  {
+    // Sizes of a dynamic matrix are only known at runtime:
+    if ( (rhs.getNumRows() != Rows) || (rhs.getNumCols() != Cols) )
+    {
+      throw std::logic_error("FixedMatrix::FixedMatrix (Matrix) - Dimensions do not match!");
+    }
+
+    for (std::size_t i=0; i<Rows; ++i)
+    {
+      for (std::size_t j=0; j<Cols; ++j)
+      {
+        elements[i*Cols + j] = rhs.data()[i*rhs.getLeadingDim() + j];
+      }
+    }
+  }
+
+  // toMatrix
+  template <typename T, std::size_t Rows, std::size_t Cols>
+  Matrix<T> FixedMatrix<T,Rows,Cols>::toMatrix() const
+  {
+    Matrix<T> result(Rows, Cols);
+    for (std::size_t i=0; i<Rows; ++i)
+    {
+      for (std::size_t j=0; j<Cols; ++j)
+      {
+        result.data()[i*result.getLeadingDim() + j] = elements[i*Cols + j];
+      }
+    }
+
+    return result;
+  }
+
+  // Operator ()
+  template <typename T, std::size_t Rows, std::size_t Cols>
+  constexpr T& FixedMatrix<T,Rows,Cols>::operator()(std::size_t row, std::size_t col)
+  {
+    // Check range:
+    if ( (row >= Rows) || (col >= Cols) )
+    {
+      throw std::out_of_range("FixedMatrix::operator() - Indices out of bounds!");
+    }
+
+    return elements[row*Cols + col];
+  }
+
+  // Operator () const
+  template <typename T, std::size_t Rows, std::size_t Cols>
+  constexpr const T& FixedMatrix<T,Rows,Cols>::operator()(std::size_t row, std::size_t col) const
+  {
+    // Check range:
+    if ( (row >= Rows) || (col >= Cols) )
+    {
+      throw std::out_of_range("FixedMatrix::operator() - Indices out of bounds!");
+    }
+
+    return elements[row*Cols + col];
+  }
+
+  // Operator ==
+  template <typename T, std::size_t Rows, std::size_t Cols>
+  constexpr bool FixedMatrix<T,Rows,Cols>::operator==(const FixedMatrix& rhs) const
+  {
+    for (std::size_t i=0; i<Rows*Cols; ++i)
+    {
+      if ( elements[i] != rhs.elements[i] )
+      {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  // Operator *= (Matrix)
+  template <typename T, std::size_t Rows, std::size_t Cols>
+  constexpr FixedMatrix<T,Rows,Cols>& FixedMatrix<T,Rows,Cols>::operator*=(const FixedMatrix& rhs)
+  {
+    static_assert(Rows == Cols, "FixedMatrix::operator*= - Matrix must be square!");
+    return *this = (*this)*rhs;
+  }
+
+  // Operator <<
+  template <typename T, std::size_t Rows, std::size_t Cols>
+  std::ostream& operator<<(std::ostream& os, const FixedMatrix<T,Rows,Cols>& rhs)
+  {
+    for (std::size_t i=0; i<Rows; ++i)
+    {
+      for (std::size_t j=0; j<Cols; ++j)
+      {
+        os << rhs.elements[i*Cols + j] << " ";
+      }
+      os << std::endl;
+    }
+
+    return os;
+  }
+
+  // Scalar * Matrix
+  template <typename T, std::size_t Rows, std::size_t Cols>
+  constexpr FixedMatrix<T,Rows,Cols> operator*(const T& lhs, const FixedMatrix<T,Rows,Cols>& rhs)
+  {
+    return rhs*lhs;
+  }
+
+  // identity
+  template <typename T, std::size_t Rows, std::size_t Cols>
+  constexpr FixedMatrix<T,Rows,Cols> FixedMatrix<T,Rows,Cols>::identity()
+  {
+    static_assert(Rows == Cols, "FixedMatrix::identity - Matrix must be square!");
+    return identity(std::make_index_sequence<Rows*Cols>());
+  }
+
+  // inverse
+  template <typename T, std::size_t Rows, std::size_t Cols>
+  constexpr FixedMatrix<T,Rows,Cols> FixedMatrix<T,Rows,Cols>::inverse() const
+  {
+    static_assert(Rows == Cols, "FixedMatrix::inverse - Matrix must be square!");
+    static_assert(!std::is_integral<T>::value, "FixedMatrix::inverse - Integer matrices have no integer inverse in general!");
+    FixedMatrix result;
+    if ( !fixedImpl::Inverse<T,Rows>::compute(elements, result.elements) )
+    {
+      throw std::logic_error("FixedMatrix::inverse - Matrix is singular!");
+    }
+    return result;
+  }
+
+  // determinant
+  template <typename T, std::size_t Rows, std::size_t Cols>
+  constexpr T FixedMatrix<T,Rows,Cols>::determinant() const
+  {
+    static_assert(Rows == Cols, "FixedMatrix::determinant - Matrix must be square!");
+    return fixedImpl::Determinant<T,Rows>::compute(elements);
+  }
+
+  // trace
+  template <typename T, std::size_t Rows, std::size_t Cols>
+  constexpr T FixedMatrix<T,Rows,Cols>::trace() const
+  {
+    T diagSum = T(0);
+    for (std::size_t i=0; (i<Rows) && (i<Cols); ++i)
+    {
+      diagSum += elements[i*Cols + i];
+    }
+    return diagSum;
+  }
+
+} // matrix namespace
+
+#endif // FIXED_MATRIX_H
@@ -16,18 +16,40 @@
 #define MATRIX_H
 
 // Forward Declared Dependencies:
-//
+namespace matrix
+{
+  template <typename T> class LUDecomposition;
+  template <typename T> class CholeskyDecomposition;
+  template <typename T> class QRDecomposition;
+}
 
 // Local Include Dependencies:
-//
+#include "AlignedBuffer.hpp"
+#include "MatrixGemm.hpp"
+#include "MatrixGemv.hpp"
+#include "MatrixStrassen.hpp"
+#include "MatrixSimd.hpp"
+#include "ThreadPool.hpp"
+#include "MatrixExpr.hpp"
+#include "MatrixEigen.hpp"
+#include "MatrixTranspose.hpp"
+#include "MatrixPredicates.hpp"
+#include "MatrixReduce.hpp"
+#include "MatrixRows.hpp"
 
 // Compiler Include Dependencies:
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <limits>
 #include <stdexcept>
 #include <iostream>
 #include <string>
 #include <vector>
 #include <complex>
 #include <initializer_list>
+#include <type_traits>
+#include <utility>
 
 /// matrix Namespace
 namespace matrix
@@ -36,19 +58,107 @@ namespace matrix
   /// Empty string used for default pad in matrix printing
   const std::string emptyStr = std::string();
 
+  /// Block columns of the lower triangle computed per GEMM in Hermitian products
+  const uint32_t hermitianBlock = 256;
+
+  /// Cap on the Lanczos steps p2Norm() takes (it stops sooner once the estimate settles)
+  const uint32_t p2NormSteps = 200;
+
+  /// Lanczos vectors p2Norm() keeps (and reorthogonalizes against) per side
+  const uint32_t p2NormBasis = 32;
+
+  /// How Matrix::power computes A^p
+  enum PowerMethod
+  {
+    powerSquaring,    ///< Exact: repeated squaring, about 2*log2(p) GEMMs
+    powerEigen        ///< Real symmetric only: one eigendecomposition, error at rounding level
+  };
+
+  /// Exact determinant of integer elements (see MatrixLU.hpp)
+  namespace factorImpl
+  {
+    template <typename T> T bareissDeterminant(std::size_t n, T* a, std::size_t ld);
+  }
+
+  /// Magnitude type of an element type: T itself for arithmetic T, U for std::complex<U>
+  ///  (std::abs can't tell, as it is ambiguous for unsigned T)
+  template <typename T>
+  struct RealType { typedef T type; };
+
+  template <typename U>
+  struct RealType<std::complex<U>> { typedef U type; };
+
+  /// Lazy conjugate (transpose) of a Matrix (see MatrixConjugate.hpp)
+  template <typename T> class ConjugateView;
+
+  /// Non-owning strided windows onto matrix elements (see MatrixView.hpp)
+  template <typename T> class ConstMatrixView;
+  template <typename T> class MatrixView;
+
   /// Matrix class
+  ///
+  /// Elements live in one contiguous, 64-byte aligned, row-major buffer. Element
+  /// (i,j) is at offset i*leadingDim + j; owned matrices are packed so that
+  /// leadingDim == numCols and every kernel can stream through memory linearly.
   template <typename T>
-  class Matrix 
+  class Matrix : public MatrixExpr<Matrix<T>, T>
   {
 
     private:
-      std::vector<std::vector<T>> matrix;   ///< Matrix
+      AlignedBuffer<T> storage;             ///< Row-major element buffer
       uint32_t numRows;                     ///< Number of rows
       uint32_t numCols;                     ///< Number of columns
+      uint32_t leadingDim;                  ///< Distance (in elements) between rows
       std::string pad;                      ///< Pad used when printing matrix
 
+      /// Tag selecting the uninitialized constructor
+      struct Uninitialized {};
+
+      friend class ConjugateView<T>;
+      friend class ConstMatrixView<T>;
+
+      /// op(A)*op(B), each op transposing and/or conjugating on the fly;
+      ///  A^H*A and A*A^H compute one triangle and mirror it
+      static Matrix product(
+        const Matrix& a, bool transA, bool conjA,
+        const Matrix& b, bool transB, bool conjB
+      );
+
+      /// Uninitialized Constructor (used for results that are fully overwritten)
+      Matrix (
+        uint32_t _numRows,                    ///< Number of rows new matrix will have.
+        uint32_t _numCols,                    ///< Number of columns new matrix will have.
+        Uninitialized                         ///< Tag
+      );
+
+      /// Buffer of count copies of initVal, written by the worker threads that
+      ///  will later process each part (first-touch page placement)
+      static AlignedBuffer<T> filledStorage(std::size_t count, const T& initVal);
+
+      // Unchecked element access:
+      T& element(uint32_t row, uint32_t col) { return storage.data()[std::size_t(row)*leadingDim + col]; };
+      const T& element(uint32_t row, uint32_t col) const { return storage.data()[std::size_t(row)*leadingDim + col]; };
+
+      /// Number of elements in the buffer
+      std::size_t size() const { return std::size_t(numRows)*numCols; };
+
+      // det(A) and invertibility: exact fraction-free elimination for integer
+      //  elements (LU's divisions would truncate), Cholesky or LU otherwise
+      T determinantOf(std::true_type) const;
+      T determinantOf(std::false_type) const;
+      bool invertibleOf(std::true_type) const { return this->determinantOf(std::true_type()) != T(0); };
+      bool invertibleOf(std::false_type) const;
+
+      // Largest singular value: in double for integer elements (the iteration
+      //  needs fractions), Lanczos bidiagonalization otherwise
+      typename RealType<T>::type p2NormOf(std::true_type) const;
+      typename RealType<T>::type p2NormOf(std::false_type) const;
+
     public:
 
+      /// Magnitude type of the elements (T itself, or U for complex<U>)
+      typedef typename RealType<T>::type Real;
+
 
       //
       // Constructors:
@@ -62,6 +172,11 @@ namespace matrix
         const Matrix<T>& rhs    ///< Matrix to copy from.
       );
 
+      /// Move Constructor (takes rhs's storage, leaves rhs empty)
+      Matrix (
+        Matrix<T>&& rhs         ///< Matrix to move from.
+      ) noexcept;
+
       /// Custom Constructor
       Matrix (
         uint32_t _numRows,                    ///< Number of rows new matrix will have.
@@ -75,6 +190,20 @@ namespace matrix
         std::initializer_list<std::initializer_list<T>> _matrix   ///< Initial values list.
       );
 
+      /// Expression Constructor (evaluates the whole expression in one pass)
+      template <typename E>
+      Matrix (
+        const MatrixExpr<E,T>& expr   ///< Expression to evaluate.
+      );
+
+      /// Adopting Constructor (takes over a filled buffer of rows*cols elements,
+      ///  e.g. a mapped file, without copying it)
+      Matrix (
+        uint32_t _numRows,                    ///< Number of rows.
+        uint32_t _numCols,                    ///< Number of columns.
+        AlignedBuffer<T>&& buffer             ///< Row-major elements, packed.
+      );
+
       /// Deconstructor
       ~Matrix();
 
@@ -83,12 +212,37 @@ namespace matrix
       // Accessors/Modifiers:
       //
 
-      /// Matrix Accessor
-      std::vector<std::vector<T>> getMatrix() const { return matrix; };
+      /// Matrix Accessor (copy as nested vectors)
+      std::vector<std::vector<T>> getMatrix() const;
+
+      // Storage Accessors (no copy): element (i,j) is at data()[i*getLeadingDim() + j]
+      T* data() { return storage.data(); };                   ///< Row-major elements
+      const T* data() const { return storage.data(); };       ///< Row-major elements (const)
+
+      // Row Accessors (unchecked): rowPtr(i)[j] is element (i,j)
+      T* rowPtr(uint32_t row) { return storage.data() + std::size_t(row)*leadingDim; };                         ///< First element of a row
+      const T* rowPtr(uint32_t row) const { return storage.data() + std::size_t(row)*leadingDim; };             ///< First element of a row (const)
+      RowSpan<T> rowSpan(uint32_t row) { return RowSpan<T>(this->rowPtr(row), numCols); };                      ///< A row as a span
+      RowSpan<const T> rowSpan(uint32_t row) const { return RowSpan<const T>(this->rowPtr(row), numCols); };    ///< A row as a span (const)
+
+      // Element Iterators (unchecked, row-major; plain pointers since the storage is packed)
+      typedef T* iterator;                                            ///< Element iterator
+      typedef const T* const_iterator;                                ///< Element iterator (const)
+      iterator begin() { return storage.data(); };                    ///< First element
+      iterator end() { return storage.data() + this->size(); };       ///< One past the last element
+      const_iterator begin() const { return storage.data(); };        ///< First element (const)
+      const_iterator end() const { return storage.data() + this->size(); };     ///< One past the last element (const)
+      const_iterator cbegin() const { return storage.data(); };       ///< First element (const)
+      const_iterator cend() const { return storage.data() + this->size(); };    ///< One past the last element (const)
+
+      // Row Iterators (random-access, yielding RowSpans): for (auto row : A.rows())
+      RowRange<T> rows() { return RowRange<T>(RowIterator<T>(storage.data(), leadingDim, numCols), numRows); };                       ///< All rows
+      RowRange<const T> rows() const { return RowRange<const T>(RowIterator<const T>(storage.data(), leadingDim, numCols), numRows); }; ///< All rows (const)
   
       // Size Accessors
-      uint32_t getNumRows() const { return numRows; };    ///< Row accessor
-      uint32_t getNumCols() const { return numCols; };    ///< Columns accessor
+      uint32_t getNumRows() const { return numRows; };        ///< Row accessor
+      uint32_t getNumCols() const { return numCols; };        ///< Columns accessor
+      uint32_t getLeadingDim() const { return leadingDim; };  ///< Row stride accessor
 
       // Pad Accessor/Modifier
       std::string getPad() const { return pad; };             ///< Pad accessor
@@ -99,7 +253,7 @@ namespace matrix
       // Operators:
       //
 
-      /// Display
+      /// Display (defined in MatrixText.hpp)
       template <typename U>
       friend std::ostream& operator<< (
         std::ostream& os,                 ///< Output stream
@@ -111,32 +265,86 @@ namespace matrix
         const Matrix<T>& rhs    ///< Matrix to assign
       );
 
+      /// Move Assignment (takes rhs's storage, leaves rhs empty)
+      Matrix<T>& operator= (
+        Matrix<T>&& rhs         ///< Matrix to move from
+      ) noexcept;
+
+      /// Expression Assignment (evaluated in place, reusing this matrix's storage)
+      template <typename E>
+      Matrix<T>& operator= (
+        const MatrixExpr<E,T>& expr   ///< Expression to assign
+      );
+
+      // Compound Assignment (in place, no allocation except *= Matrix):
+      template <typename E>
+      Matrix<T>& operator+=(const MatrixExpr<E,T>& rhs);    ///< Matrix/Matrix Addition
+      template <typename E>
+      Matrix<T>& operator-=(const MatrixExpr<E,T>& rhs);    ///< Matrix/Matrix Subtraction
+      Matrix<T>& operator*=(const Matrix<T>& rhs);          ///< Matrix/Matrix Multiplication
+      Matrix<T>& operator*=(const T& rhs);                  ///< Matrix/Scalar Multiplication
+      Matrix<T>& operator/=(const T& rhs);                  ///< Matrix/Scalar Division
+      Matrix<T>& operator+=(const T& rhs);                  ///< Matrix/Scalar Addition
+      Matrix<T>& operator-=(const T& rhs);                  ///< Matrix/Scalar Subtraction
+
       // Matrix/Matrix
       Matrix<T> operator*(const Matrix<T>& rhs) const;      ///< Matrix/Matrix Multiplication
-      Matrix<T> operator+(const Matrix<T>& rhs) const;      ///< Matrix/Matrix Addition
-      Matrix<T> operator-(const Matrix<T>& rhs) const;      ///< Matrix/Matrix Subtraction
+      Matrix<T> operator*(const ConjugateView<T>& rhs) const;   ///< Matrix/Conjugated Matrix Multiplication (fused)
 
-      // Matrix/Vector
-      //std::vector<T> operator*(const std::vector<T>& rhs) const;  // Matrix/Vector Multiplication
+      // Element-wise +, - (Matrix/Matrix), *, /, +, - (Matrix/Scalar) and unary -
+      //  are lazy expressions; on a temporary Matrix they work in its buffer
+      //  instead. See MatrixExpr.hpp.
 
-      // Matrix/Scalar
-      Matrix<T> operator*(const T& rhs) const;              ///< Matrix/Scalar Multiplication
-      Matrix<T> operator/(const T& rhs) const;              ///< Matrix/Scalar Division
-      Matrix<T> operator+(const T& rhs) const;              ///< Matrix/Scalar Addition
-      Matrix<T> operator-(const T& rhs) const;              ///< Matrix/Scalar Subtraction
+      // Matrix/Vector
+      std::vector<T> operator*(const std::vector<T>& rhs) const;  ///< Matrix/Vector Multiplication (GEMV)
 
       // Matrix (unitary)
-      Matrix<T> operator-() const;                          ///< Matrix Negative
-      Matrix<T> operator^(const uint32_t& power) const;     ///< Matrix Power function
+      Matrix<T> operator^(const uint32_t& power) const;     ///< Matrix Power function (same as power(p))
 
-      // Element Access
+      // Element Access (checked; loops should use rowPtr(), rowSpan() or the iterators)
       T& operator()(const uint32_t& row, const uint32_t& col);                ///< Matrix Element Access
       const T& operator()(const uint32_t& row, const uint32_t& col) const;    ///< Matrix Element Access (const)
+      T& at(uint32_t row, uint32_t col);                                      ///< Checked Element Access
+      const T& at(uint32_t row, uint32_t col) const;                          ///< Checked Element Access (const)
 
       // Comparison
       bool operator==(const Matrix<T>& rhs) const;          ///< Matrix Comparison
 
 
+      //
+      // Expression interface (see MatrixExpr.hpp):
+      //
+
+      /// Elements [lo, lo+n) of the row-major buffer
+      const T* evalBlock(std::size_t lo, std::size_t, T*) const { return storage.data() + lo; };
+
+      /// Is p inside this matrix's buffer?
+      bool references(const T* p) const { return (p >= storage.data()) && (p < storage.data() + this->size()); };
+
+      /// Views only: a matrix reads each element where it is written
+      bool overlaps(const T*, const T*) const { return false; };
+
+
+      //
+      // Views (no copy; a view must not outlive the matrix, see MatrixView.hpp):
+      //
+
+      MatrixView<T> view();                                   ///< The whole matrix
+      ConstMatrixView<T> view() const;                        ///< The whole matrix (const)
+      MatrixView<T> block(uint32_t row, uint32_t col, uint32_t rows, uint32_t cols);               ///< rows x cols block at (row, col)
+      ConstMatrixView<T> block(uint32_t row, uint32_t col, uint32_t rows, uint32_t cols) const;    ///< rows x cols block at (row, col) (const)
+      MatrixView<T> row(uint32_t row);                        ///< One row (1 x cols)
+      ConstMatrixView<T> row(uint32_t row) const;             ///< One row (1 x cols) (const)
+      MatrixView<T> column(uint32_t col);                     ///< One column (rows x 1)
+      ConstMatrixView<T> column(uint32_t col) const;          ///< One column (rows x 1) (const)
+      MatrixView<T> diagonal();                               ///< Main diagonal as a column
+      ConstMatrixView<T> diagonal() const;                    ///< Main diagonal as a column (const)
+
+      /// Every rowStep-th row and colStep-th column of the rows x cols grid starting at (row, col)
+      MatrixView<T> slice(uint32_t row, uint32_t col, uint32_t rows, uint32_t cols, uint32_t rowStep, uint32_t colStep);
+      ConstMatrixView<T> slice(uint32_t row, uint32_t col, uint32_t rows, uint32_t cols, uint32_t rowStep, uint32_t colStep) const;
+
+
       //
       // Operations:
       //
@@ -144,9 +352,40 @@ namespace matrix
       Matrix<T> transpose() const;            ///< Matrix Transpose
       Matrix<T> complexConjugate() const;     ///< Matrix Complex Conjugate
       Matrix<T> conjugateTranspose() const;   ///< Matrix Complex Conjugate Transpose
-      //Matrix<T> inverse() const;              // Matrix Inverse
+      ConjugateView<T> conjugated() const;    ///< Lazy complex conjugate (no copy until used)
+      ConjugateView<T> adjoint() const;       ///< Lazy conjugate transpose (no copy until used)
+      Matrix<T>& transposeInPlace();          ///< Transpose without a second buffer (any shape)
+      Matrix<T>& conjugateTransposeInPlace(); ///< Conjugate transpose without a second buffer (any shape)
+      Matrix<T> inverse() const;              ///< Matrix Inverse (A*A^-1 = I; floating-point and complex elements)
       Matrix<T> identity() const;             ///< Identity matrix of same size and type
 
+      /// y = A*x into caller storage (x: getNumCols() elements, y: getNumRows())
+      void multiply(const T* x, T* y) const;
+
+      /// y = A*x, resizing y only if its length is wrong
+      void multiply(const std::vector<T>& x, std::vector<T>& y) const;
+
+      /// y = A^T*x into caller storage (x: getNumRows() elements, y: getNumCols())
+      void multiplyTransposed(const T* x, T* y) const;
+
+      /// y = A^T*x, resizing y only if its length is wrong
+      void multiplyTransposed(const std::vector<T>& x, std::vector<T>& y) const;
+
+      /// X with A*X = B, for any number of right-hand side columns (one Cholesky
+      ///  factorization for Hermitian positive definite A, else one LU; floating-point
+      ///  and complex elements)
+      Matrix<T> solve(const Matrix<T>& B) const;
+
+      /// X minimizing ||A*X - B|| for A with at least as many rows as columns
+      ///  (Householder QR; never forms the normal equations)
+      Matrix<T> leastSquares(const Matrix<T>& B) const;
+
+      /// Matrix Power (A^0 = I)
+      Matrix<T> power(
+        uint32_t exponent,                      ///< Exponent
+        PowerMethod method = powerSquaring      ///< Algorithm
+      ) const;
+
 
       //
       // Boolean Properties:
@@ -155,23 +394,27 @@ namespace matrix
       bool isSquare() const;            ///< Is matrix square?
       bool isReal() const;              ///< Are all elements real?
       bool isComplex() const;           ///< Do any elements have imaginary parts?
-      bool isSymmetric() const;         ///<  A = A^T ?
-      bool isSkewSymmetric() const;     ///< -A = A^T ?
-      bool isHermitian() const;         ///<  A = A^dagger (Complex extension of isSymmetric()) ?
-      bool isSelfAdjoint() const;       ///<  Same as isHermitian() 
-      bool isSkewHermitian() const;     ///< -A = A^dagger (Complex extension of isSkewSymmetric())
-      bool isNormal() const;            ///< Real: A*A^T = A^T*A; Complex: A*A^dagger = A^dagger*A
-      bool isOrthogonal() const;        ///< A*A^T = A^T*A = I
-      bool isUnitary() const;           ///< A*A^dagger = A^dagger*A = I (Complex extension of isOrthogonal())
-      //bool isInvertible() const;        // A*A^-1 = I
-      //bool isSingular() const;          // A has no inverse (det A = 0)
-      //bool isDegenerate() const;        // Same as isSingular()
-      bool isProjection() const;        ///< A = A^2
+      //  The structural checks below compare in place and stop at the first
+      //   mismatch. Two elements agree when |x - y| <= absTol + relTol*max(|x|,|y|);
+      //   the default zero tolerances mean exact equality.
+      bool isSymmetric(double absTol = 0, double relTol = 0) const;       ///<  A = A^T ?
+      bool isSkewSymmetric(double absTol = 0, double relTol = 0) const;   ///< -A = A^T ?
+      bool isHermitian(double absTol = 0, double relTol = 0) const;       ///<  A = A^dagger (Complex extension of isSymmetric()) ?
+      bool isSelfAdjoint(double absTol = 0, double relTol = 0) const;     ///<  Same as isHermitian()
+      bool isSkewHermitian(double absTol = 0, double relTol = 0) const;   ///< -A = A^dagger (Complex extension of isSkewSymmetric())
+      bool isNormal(double absTol = 0, double relTol = 0) const;          ///< A*A^dagger = A^dagger*A (A*A^T = A^T*A when real)
+      bool isOrthogonal(double absTol = 0, double relTol = 0) const;      ///< A*A^T = A^T*A = I
+      bool isUnitary(double absTol = 0, double relTol = 0) const;         ///< A*A^dagger = A^dagger*A = I (Complex extension of isOrthogonal())
+      bool isInvertible() const;        ///< A*A^-1 = I
+      bool isSingular() const;          ///< A has no inverse: exactly for integers, else some pivot <= n*eps*max|pivot| (determinant() is then 0)
+      bool isDegenerate() const;        ///< Same as isSingular()
+      bool isPositiveDefinite() const;  ///< Hermitian with x^H*A*x > 0 for all x != 0 ?
+      bool isProjection(double absTol = 0, double relTol = 0) const;      ///< A = A^2
       //bool isIdempotent() const;        // Same as isProjection()
       //bool isInvolutory() const;        // A = A^-1 (A^2 = I)
       //bool isDiagonal() const;          // Are all elements zero except those on diagonal?
       //bool isTriDiagonal() const;
-      bool isIdentity() const;          ///< A = I
+      bool isIdentity(double absTol = 0, double relTol = 0) const;        ///< A = I
       //bool isTriangular() const;
       //bool isUniTri() const;
       //bool isStrictlyTri() const;
@@ -185,24 +428,44 @@ namespace matrix
       //bool isNilpotent() const;       // A^k = 0 for some positive integer k.
       //bool isDiagonalizable() const;
       //bool isDefective() const;       // A not diagonalizable?
-      bool commutesWith(const Matrix<T>& rhs) const;
+      bool commutesWith(const Matrix<T>& rhs, double absTol = 0, double relTol = 0) const;   ///< A*B = B*A ?
 
       //
       // Numerical Properties:
       //
 
       T trace() const;                  ///< Sum of diagonal elements
-      T sum() const;                    ///< Sum of all elements
-      //T mean() const;
-      //T determinant() const;
-      //T p1Norm() const;               // P=1 Norm: Maximum absolute column sum
-      //T p2Norm() const;               // P=2 Norm: Euclidean Norm
-      //T pInfNorm() const;             // P=inf Norm: Maximum absolute row sum
-      //T frobeniusNorm() const;
-      //T maxNorm() const
+      T sum(Summation method = summationLanes) const;     ///< Sum of all elements
+      T mean(Summation method = summationLanes) const;    ///< Average of all elements
+      T determinant() const;            ///< det(A), from an LU factorization (exact Bareiss elimination for integers; 0 when isSingular())
+      Real p1Norm() const;              ///< P=1 Norm: Maximum absolute column sum
+      Real p2Norm() const;              ///< P=2 Norm: Largest singular value (Euclidean norm of a single row or column; rounded to nearest for integers)
+      Real pInfNorm() const;            ///< P=inf Norm: Maximum absolute row sum
+      Real frobeniusNorm() const;       ///< Square root of the sum of squared magnitudes
+      Real maxNorm() const;             ///< Largest element magnitude
+
+
+      //
+      // Row and Column Reductions:
+      //
+
+      std::vector<T> rowSums(Summation method = summationLanes) const;       ///< Sum of each row
+      std::vector<T> columnSums(Summation method = summationLanes) const;    ///< Sum of each column
+      std::vector<T> rowMeans(Summation method = summationLanes) const;      ///< Average of each row
+      std::vector<T> columnMeans(Summation method = summationLanes) const;   ///< Average of each column
+      std::vector<Real> rowNorms(VectorNorm norm = vectorNorm2) const;       ///< Norm of each row
+      std::vector<Real> columnNorms(VectorNorm norm = vectorNorm2) const;    ///< Norm of each column
 
   }; // Matrix class
 
+  /// Vector/Matrix Multiplication: x^T*A (transposed GEMV)
+  template <typename T>
+  std::vector<T> operator*(const std::vector<T>& lhs, const Matrix<T>& rhs);
+
+  /// Display: buffered rows, shortest round-trip floats (see MatrixText.hpp)
+  template <typename T>
+  std::ostream& operator<<(std::ostream& os, const Matrix<T>& rhs);
+
 
   //
   // Template Implementation
@@ -214,112 +477,166 @@ namespace matrix
   Matrix<T>::Matrix()
         : numRows(0),
           numCols(0),
+          leadingDim(0),
           pad("")
   {
-    // Resize matrix to 0:
-    //  Note: Probably not needed but... oh well.
-    matrix.resize(0);
+    // Empty storage, no allocation.
   }
 
   // Copy constructor
   template <typename T>
   Matrix<T>::Matrix(const Matrix<T>& rhs)
+        : storage(rhs.storage),
+          numRows(rhs.numRows),
+          numCols(rhs.numCols),
+          leadingDim(rhs.leadingDim),
+          pad(rhs.pad)
+  {
+    // Single allocation + linear copy done by the buffer.
+  }
+
+  // Move constructor
+  template <typename T>
+  Matrix<T>::Matrix(Matrix<T>&& rhs) noexcept
+        : storage(std::move(rhs.storage)),
+          numRows(rhs.numRows),
+          numCols(rhs.numCols),
+          leadingDim(rhs.leadingDim),
+          pad(std::move(rhs.pad))
   {
-    // Copy everything:
-    matrix = rhs.getMatrix();
-    numRows = rhs.getNumRows();
-    numCols = rhs.getNumCols();
-    pad = rhs.getPad();
+    // Leave rhs a valid, empty matrix:
+    rhs.numRows = 0;
+    rhs.numCols = 0;
+    rhs.leadingDim = 0;
   }
 
   // Custom constructor
   template <typename T>
   Matrix<T>::Matrix(uint32_t _numRows, uint32_t _numCols, const T& initVal, const std::string& _pad)
-        : numRows(_numRows),
+        : storage(filledStorage(std::size_t(_numRows)*_numCols, initVal)),
+          numRows(_numRows),
           numCols(_numCols),
+          leadingDim(_numCols),
           pad(_pad)
   {
+    // One allocation for the whole matrix, filled in parallel.
+  }
 
-    // Resize matrix rows:
-    matrix.resize(numRows);
-
-    // Resize all matrix columns:
-    //  Note: The iterator takes care of the case when numRows is zero so we don't
-    //        have to explicitly check for it.
-    for (auto& row : matrix)
+  // filledStorage
+  template <typename T>
+  AlignedBuffer<T> Matrix<T>::filledStorage(std::size_t count, const T& initVal)
+  {
+    if ( !std::is_trivially_copyable<T>::value || (count < 2*getParallelThreshold()) )
     {
-      row.resize(numCols, initVal);
+      return AlignedBuffer<T>(count, initVal);
     }
 
+    // Fresh pages are placed on the NUMA node of the thread that first writes
+    //  them, so fill with the same split the element-wise kernels use:
+    AlignedBuffer<T> buffer(count);
+    T* p = buffer.data();
+    parallelFor(0, count, [=](std::size_t lo, std::size_t hi) {
+      std::fill(p + lo, p + hi, initVal);
+    });
+    return buffer;
+  }
+
+  // Uninitialized constructor
+  template <typename T>
+  Matrix<T>::Matrix(uint32_t _numRows, uint32_t _numCols, Uninitialized)
+        : storage(std::size_t(_numRows)*_numCols),
+          numRows(_numRows),
+          numCols(_numCols),
+          leadingDim(_numCols),
+          pad("")
+  {
+    // Caller is responsible for writing every element.
+  }
+
+  // Adopting constructor
+  template <typename T>
+  Matrix<T>::Matrix(uint32_t _numRows, uint32_t _numCols, AlignedBuffer<T>&& buffer)
+        : storage(std::move(buffer)),
+          numRows(_numRows),
+          numCols(_numCols),
+          leadingDim(_numCols),
+          pad("")
+  {
+    // The buffer must hold exactly the packed elements:
+    if ( storage.size() != std::size_t(_numRows)*_numCols )
+    {
+      throw std::logic_error("Matrix::Matrix - Buffer size does not match the dimensions!");
+    }
   }
 
   // Initalizer_list constructor
   template <typename T>
   Matrix<T>::Matrix(std::initializer_list<std::initializer_list<T>> _matrix)
-        : pad("")
+        : numRows(0),
+          numCols(0),
+          leadingDim(0),
+          pad("")
   {
 
     // Set new row and col sizes:
     numRows = _matrix.size();
-    numCols = _matrix.begin()->size();
+    numCols = (numRows == 0) ? 0 : _matrix.begin()->size();
+    leadingDim = numCols;
 
-    // Resize matrix rows:
-    matrix.resize(numRows);
-
-    // Resize all matrix columns:
-    //  Note: The iterator takes care of the case when numRows is zero so we don't
-    //        have to explicitly check for it.
-    for (auto& row : matrix)
+    // Every row must be the same length since they share one buffer:
+    for (const auto& rows : _matrix)
     {
-      row.resize(numCols, 0);
+      if ( rows.size() != numCols )
+      {
+        throw std::logic_error("Matrix::Matrix (initializer_list) - All rows must have the same number of columns!");
+      }
     }
 
     // Copy values from initializer list to matrix:
-    uint32_t i = 0, j = 0;
+    AlignedBuffer<T> temp(this->size());
+    T* dst = temp.data();
     for (const auto& rows : _matrix)
     {
-      for (const auto& cols : rows)
-      {
-        auto a_ij = cols;
-        matrix[i][j] = a_ij;
-        j++;
-      }
-      i++;
-      j = 0;
+      dst = std::copy(rows.begin(), rows.end(), dst);
     }
+    storage.swap(temp);
   
   }
 
+  // Expression constructor
+  template <typename T>
+  template <typename E>
+  Matrix<T>::Matrix(const MatrixExpr<E,T>& expr)
+        : storage(std::size_t(expr.derived().getNumRows())*expr.derived().getNumCols()),
+          numRows(expr.derived().getNumRows()),
+          numCols(expr.derived().getNumCols()),
+          leadingDim(numCols),
+          pad("")
+  {
+    // Fresh buffer, so the expression can be evaluated straight into it:
+    evaluateInto(expr, storage.data(), this->size());
+  }
+
   // Destructor
   template <typename T>
   Matrix<T>::~Matrix()
   {
-    // No dynamic allocation so nothing to do. 
+    // Storage is released by the buffer.
   }
 
-  // Operator <<
+  // getMatrix
   template <typename T>
-  std::ostream& operator<<(std::ostream& os, const Matrix<T>& rhs)
+  std::vector<std::vector<T>> Matrix<T>::getMatrix() const
   {
+    std::vector<std::vector<T>> result(numRows);
 
-    // Iterate through and print out each element:
-    for (const auto& rows : rhs.getMatrix())
+    for (uint32_t i=0; i<numRows; ++i)
     {
-      // Output pad in front of each row:
-      os << rhs.getPad();
-
-      for (const auto& cols : rows)
-      {
-        // Output matrix element:
-        auto a_ij = cols;
-        os << a_ij << " ";
-      }
-      
-      // Newline between rows:
-      os << std::endl;
+      const T* row = &this->element(i,0);
+      result[i].assign(row, row + numCols);
     }
 
-    return os;
+    return result;
   }
 
   // Operator = (Matrix)
@@ -333,232 +650,317 @@ namespace matrix
       return *this;
     }
 
+    // Copy the buffer (reuses the current allocation when sizes match):
+    storage = rhs.storage;
+
     // Get rhs sizes and set them to class vars:
-    numRows = rhs.getNumRows();
-    numCols = rhs.getNumCols();
+    numRows = rhs.numRows;
+    numCols = rhs.numCols;
+    leadingDim = rhs.leadingDim;
 
     // Get pad and set to class var:
-    pad = rhs.getPad();
-
-    // Resize matrix to new size:
-    matrix.resize(numRows);
-    for (auto& cols : matrix)
-    {
-      cols.resize(numCols);
-    }
-
-    // Copy data from rhs to this matrix:
-    for (uint32_t i=0; i<numRows; ++i)
-    {
-      for (uint32_t j=0; j<numCols; ++j)
-      {
-        matrix[i][j] = rhs(i,j);
-      }
-    }
+    pad = rhs.pad;
 
     // Return new, resized matrix:
     return *this;
   }
 
-  // Operator * (Matrix/Matrix)
+  // Operator = (Matrix, move)
   template <typename T>
-  Matrix<T> Matrix<T>::operator*(const Matrix<T>& rhs) const
+  Matrix<T>& Matrix<T>::operator=(Matrix<T>&& rhs) noexcept
   {
 
-    // If lhs col count doesn match rhs's row count, can't multiply:
-    if ( this->numCols != rhs.getNumRows() )
+    // If rhs is already this matrix, no reason to continue:
+    if( this == &rhs )
     {
-      throw std::logic_error("Matrix::operator* (Matrix/Matrix) - Matrices' inner dimensions do not match, can not multiply them!");
+      return *this;
     }
 
-    // New dimensions and matrix:
-    uint32_t rows = this->numRows,
-             cols = rhs.getNumCols();
-    Matrix result(rows, cols);
+    // Take rhs's buffer (our old one is freed):
+    storage = std::move(rhs.storage);
+    numRows = rhs.numRows;
+    numCols = rhs.numCols;
+    leadingDim = rhs.leadingDim;
+    pad = std::move(rhs.pad);
 
-    // Multiply matrices together:
-    for (uint32_t i=0; i<rows; ++i)
-    {
-      for (uint32_t j=0; j<cols; ++j)
-      {
-        for (uint32_t k=0; k<rows; ++k)
-        {
-          result(i,j) += this->matrix[i][k] * rhs(k,j);
-        }
-      }
-    }
+    // Leave rhs a valid, empty matrix:
+    rhs.numRows = 0;
+    rhs.numCols = 0;
+    rhs.leadingDim = 0;
 
-    // Return new matrix multiplied matrix:
-    return result;
+    return *this;
   }
 
-  // Operator + (Matrix/Matrix)
+  // Operator = (Expression)
   template <typename T>
-  Matrix<T> Matrix<T>::operator+(const Matrix<T>& rhs) const
+  template <typename E>
+  Matrix<T>& Matrix<T>::operator=(const MatrixExpr<E,T>& expr)
   {
+    const E& e = expr.derived();
 
-    // If matrices aren't same size, can't add them:
-    if ( (this->numRows != rhs.getNumRows()) ||
-         (this->numCols != rhs.getNumCols())
-       )
+    // Same shape: evaluate in place (evaluateInto handles expressions that read this matrix):
+    if ( (numRows == e.getNumRows()) && (numCols == e.getNumCols()) )
     {
-      throw std::logic_error("Matrix::operator+ (Matrix/Matrix) - Matrices must be the same size!");
+      evaluateInto(expr, storage.data(), this->size());
+      return *this;
     }
 
-    Matrix result(this->numRows, this->numCols);
-
-    // Loop through and add all elements:
-    for (uint32_t i=0; i<this->numRows; ++i)
-    {
-      for (uint32_t j=0; j<this->numCols; ++j)
-      {
-        result(i,j) = matrix[i][j] + rhs(i,j);
-      }
-    }
+    // Different shape: this matrix can't be an operand, build new storage:
+    AlignedBuffer<T> temp(std::size_t(e.getNumRows())*e.getNumCols());
+    evaluateInto(expr, temp.data(), temp.size());
+    storage.swap(temp);
+    numRows = e.getNumRows();
+    numCols = e.getNumCols();
+    leadingDim = numCols;
 
-    // Return 2 matrices added:
-    return result;
+    return *this;
   }
 
-  // Operator - (Matrix/Matrix)
+  // Operator += (Matrix/Matrix)
   template <typename T>
-  Matrix<T> Matrix<T>::operator-(const Matrix<T>& rhs) const
+  template <typename E>
+  Matrix<T>& Matrix<T>::operator+=(const MatrixExpr<E,T>& rhs)
   {
+    exprImpl::checkSameSize(*this, rhs, "Matrix::operator+= (Matrix/Matrix) - Matrices must be the same size!");
+    updateInto<simd::opAdd>(rhs, storage.data(), this->size());
+    return *this;
+  }
 
-    // If matrices aren't same size, can't subtract them:
-    if ( (this->numRows != rhs.getNumRows()) ||
-         (this->numCols != rhs.getNumCols())
-       )
-    {
-      throw std::logic_error("Matrix::operator- (Matrix/Matrix) - Matrices must be the same size!");
-    }
+  // Operator -= (Matrix/Matrix)
+  template <typename T>
+  template <typename E>
+  Matrix<T>& Matrix<T>::operator-=(const MatrixExpr<E,T>& rhs)
+  {
+    exprImpl::checkSameSize(*this, rhs, "Matrix::operator-= (Matrix/Matrix) - Matrices must be the same size!");
+    updateInto<simd::opSub>(rhs, storage.data(), this->size());
+    return *this;
+  }
 
-    return (*this + rhs*(-1));
+  // Operator *= (Matrix/Matrix)
+  template <typename T>
+  Matrix<T>& Matrix<T>::operator*=(const Matrix<T>& rhs)
+  {
+    // GEMM can't write over its own input, so the product gets a new buffer
+    //  that replaces ours:
+    *this = (*this) * rhs;
+    return *this;
   }
 
-  // Operator * (Matrix/Scalar)
+  // Operator *= (Matrix/Scalar)
   template <typename T>
-  Matrix<T> Matrix<T>::operator*(const T& rhs) const
+  Matrix<T>& Matrix<T>::operator*=(const T& rhs)
   {
-    Matrix result(this->numRows, this->numCols);
+    updateInto<simd::opMul>(rhs, storage.data(), this->size());
+    return *this;
+  }
 
-    // Loop through matrix and multiply each element by scalar:
-    for (uint32_t i=0; i< this->numRows; ++i)
+  // Operator /= (Matrix/Scalar)
+  template <typename T>
+  Matrix<T>& Matrix<T>::operator/=(const T& rhs)
+  {
+    // Check for division by zero:
+    if ( rhs == T(0) )
     {
-      for (uint32_t j=0; j< this->numCols; ++j)
-      {
-        result(i,j) = matrix[i][j] * rhs;
-      }
+      throw std::logic_error("Matrix::operator/= (Matrix/Scalar) - Can't divide by zero!");
     }
 
-    return result;
+    updateInto<simd::opDiv>(rhs, storage.data(), this->size());
+    return *this;
   }
 
-  // Operator / (Matrix/Scalar)
+  // Operator += (Matrix/Scalar)
   template <typename T>
-  Matrix<T> Matrix<T>::operator/(const T& rhs) const
+  Matrix<T>& Matrix<T>::operator+=(const T& rhs)
   {
-    // Check for division by zero:
-    if ( rhs == 0 )
-    {
-      throw std::logic_error("Matrix::operator/ (Matrix/Scalar) - Can't divide by zero!");
-    }
+    updateInto<simd::opAdd>(rhs, storage.data(), this->size());
+    return *this;
+  }
+
+  // Operator -= (Matrix/Scalar)
+  template <typename T>
+  Matrix<T>& Matrix<T>::operator-=(const T& rhs)
+  {
+    updateInto<simd::opSub>(rhs, storage.data(), this->size());
+    return *this;
+  }
 
-    Matrix result(this->numRows, this->numCols);
+  // Operator * (Matrix/Matrix)
+  template <typename T>
+  Matrix<T> Matrix<T>::operator*(const Matrix<T>& rhs) const
+  {
 
-    // Loop through matrix and divide each element by scalar:
-    for (uint32_t i=0; i< this->numRows; ++i)
+    // If lhs col count doesn match rhs's row count, can't multiply:
+    if ( this->numCols != rhs.getNumRows() )
     {
-      for (uint32_t j=0; j< this->numCols; ++j)
-      {
-        result(i,j) = matrix[i][j] / rhs;
-      }
+      throw std::logic_error("Matrix::operator* (Matrix/Matrix) - Matrices' inner dimensions do not match, can not multiply them!");
     }
 
+    // New dimensions and matrix:
+    uint32_t rows = this->numRows,
+             cols = rhs.getNumCols(),
+             inner = this->numCols;
+    Matrix result(rows, cols, Uninitialized());
+
+    // Multiply matrices together through the blocked GEMM engine (with
+    //  Strassen-Winograd levels on top when enabled and large enough):
+    strassen<T>(rows, cols, inner,
+                this->storage.data(), this->leadingDim,
+                rhs.storage.data(), rhs.leadingDim,
+                result.storage.data(), result.leadingDim);
+
+    // Return new matrix multiplied matrix:
     return result;
   }
 
-  // Operator + (Matrix/Scalar)
+  // Operator * (Matrix/Conjugated Matrix)
+  template <typename T>
+  Matrix<T> Matrix<T>::operator*(const ConjugateView<T>& rhs) const
+  {
+    return product(*this, false, false, rhs.getMatrix(), rhs.isTransposed(), true);
+  }
+
+  // product
   template <typename T>
-  Matrix<T> Matrix<T>::operator+(const T& rhs) const
+  Matrix<T> Matrix<T>::product(const Matrix& a, bool transA, bool conjA,
+                               const Matrix& b, bool transB, bool conjB)
   {
-    Matrix result(this->numRows, this->numCols);
+    const uint32_t rows = transA ? a.numCols : a.numRows;
+    const uint32_t inner = transA ? a.numRows : a.numCols;
+    const uint32_t cols = transB ? b.numRows : b.numCols;
+    if ( inner != (transB ? b.numCols : b.numRows) )
+    {
+      throw std::logic_error("Matrix::operator* (Matrix/Matrix) - Matrices' inner dimensions do not match, can not multiply them!");
+    }
 
-    // Loop through matrix and add each element by scalar:
-    for (uint32_t i=0; i< this->numRows; ++i)
+    // Complex types the engine can't conjugate while packing are conjugated up front:
+    if ( (conjA || conjB) && !gemmImpl::IsPlanar<T>::value && !std::is_same<T, Real>::value )
     {
-      for (uint32_t j=0; j< this->numCols; ++j)
+      return product(conjA ? a.complexConjugate() : a, transA, false,
+                     conjB ? b.complexConjugate() : b, transB, false);
+    }
+
+    // Transposition is a swap of strides, conjugation a flag to the engine:
+    const std::ptrdiff_t rsA = transA ? 1 : a.leadingDim, csA = transA ? a.leadingDim : 1;
+    const std::ptrdiff_t rsB = transB ? 1 : b.leadingDim, csB = transB ? b.leadingDim : 1;
+    const int conj = (conjA ? conjugateA : conjugateNone) | (conjB ? conjugateB : conjugateNone);
+    const T* pa = a.storage.data();
+    const T* pb = b.storage.data();
+
+    Matrix result(rows, cols, Uninitialized());
+    T* c = result.storage.data();
+    const std::size_t ld = result.leadingDim;
+
+    // A^H*A or A*A^H: the result is Hermitian, so compute the lower triangle a
+    //  block column at a time and mirror it, for about half the flops:
+    const bool hermitian = (&a == &b) && (transA != transB) && (conjA == transA) && (conjB == transB);
+    if ( hermitian && (rows > hermitianBlock) )
+    {
+      for (std::size_t j0=0; j0<rows; j0+=hermitianBlock)
       {
-        result(i,j) = matrix[i][j] + rhs;
+        const std::size_t jb = std::min<std::size_t>(hermitianBlock, rows - j0);
+        gemm<T>(rows - j0, jb, inner,
+                T(1), pa + std::ptrdiff_t(j0)*rsA, rsA, csA,
+                      pb + std::ptrdiff_t(j0)*csB, rsB, csB,
+                T(0), c + j0*ld + j0, std::ptrdiff_t(ld), 1, conj);
+
+        // Below the diagonal block goes to the right of it:
+        transposeCopy<T>(rows - j0 - jb, jb, c + (j0 + jb)*ld + j0, ld, c + j0*ld + j0 + jb, ld, true);
+
+        // Inside it, upper from lower, with an exactly real diagonal:
+        for (std::size_t i=j0; i<j0+jb; ++i)
+        {
+          c[i*ld + i] = T(std::real(c[i*ld + i]));
+          for (std::size_t j=j0; j<i; ++j)
+          {
+            c[j*ld + i] = conjugate(c[i*ld + j]);
+          }
+        }
       }
+      return result;
     }
 
+    gemm<T>(rows, cols, inner,
+            T(1), pa, rsA, csA,
+                  pb, rsB, csB,
+            T(0), c, std::ptrdiff_t(ld), 1, conj);
+
     return result;
   }
 
-  // Operator - (Matrix/Scalar)
+  // Operator * (Matrix/Vector)
   template <typename T>
-  Matrix<T> Matrix<T>::operator-(const T& rhs) const
+  std::vector<T> Matrix<T>::operator*(const std::vector<T>& rhs) const
   {
-    return ( (*this) + (-rhs) );
+    std::vector<T> result;
+    this->multiply(rhs, result);
+    return result;
   }
 
-  // Operator - (Matrix [unitary])
+  // Operator ^ (Matrix [unitary])
   template <typename T>
-  Matrix<T> Matrix<T>::operator-() const
+  Matrix<T> Matrix<T>::operator^(const uint32_t& rhs) const
   {
-    return ( (*this)*(-1) );
+    return this->power(rhs);
   }
 
-  // Operator ^ (Matrix [unitary])
+  // Operator ()
   template <typename T>
-  Matrix<T> Matrix<T>::operator^(const uint32_t& rhs) const
+  T& Matrix<T>::operator()(const uint32_t& row, const uint32_t& col)
   {
-    // The power function can only be applied to square matrices:
-    if ( !this->isSquare() )
+    // Check range:
+    if ( (row >= this->numRows) ||
+         (col >= this->numCols)
+       )
     {
-      throw std::logic_error("Matrix::operator^ - Matrix must be square!");
+      throw std::out_of_range("Matrix::operator() - Indices out of bounds!");
     }
 
-    Matrix result(this->numRows, this->numCols, 0);
-    result = *this;
+    return this->element(row,col);
+  }
 
-    for (uint32_t i=0; i<rhs; ++i)
+  // Operator () const
+  template <typename T>
+  const T& Matrix<T>::operator()(const uint32_t& row, const uint32_t& col) const
+  {
+    // Check range:
+    if ( (row >= this->numRows) ||
+         (col >= this->numCols)
+       )
     {
-      result = (*this) * (*this);
+      throw std::out_of_range("Matrix::operator() - Indices out of bounds!");
     }
 
-    return result;
+    return this->element(row,col);
   }
 
-  // Operator ()
+  // at
   template <typename T>
-  T& Matrix<T>::operator()(const uint32_t& row, const uint32_t& col)
+  T& Matrix<T>::at(uint32_t row, uint32_t col)
   {
     // Check range:
     if ( (row >= this->numRows) ||
          (col >= this->numCols)
        )
     {
-      throw std::out_of_range("Matrix::operator() - Indices out of bounds!");
+      throw std::out_of_range("Matrix::at - Indices out of bounds!");
     }
 
-    return this->matrix[row][col];
+    return this->element(row,col);
   }
 
-  // Operator () const
+  // at const
   template <typename T>
-  const T& Matrix<T>::operator()(const uint32_t& row, const uint32_t& col) const
+  const T& Matrix<T>::at(uint32_t row, uint32_t col) const
   {
     // Check range:
     if ( (row >= this->numRows) ||
          (col >= this->numCols)
        )
     {
-      throw std::out_of_range("Matrix::operator() - Indices out of bounds!");
+      throw std::out_of_range("Matrix::at - Indices out of bounds!");
     }
 
-    return this->matrix[row][col];
+    return this->element(row,col);
   }
 
   // Operator ==
@@ -574,109 +976,324 @@ namespace matrix
       return false;
     }
 
-    // Loop through and if any elements don't match, the matrices are not equal:
-    for (uint32_t i=0; i < this->numRows; ++i)
-    {
-      for (uint32_t j=0; j < this->numCols; ++j)
-      {
-        if ( this->matrix[i][j] != rhs(i,j) )
-          return false;
-      }
-    }
-
-    // If all elements are equal, then the matrices are equal:
-    return true;
+    // If any elements don't match, the matrices are not equal:
+    const T* a = this->storage.data();
+    const T* b = rhs.storage.data();
+    return parallelAll(0, this->size(), [=](std::size_t lo, std::size_t hi) {
+      return simdEqual(a + lo, b + lo, hi - lo);
+    });
   }
 
   // transpose
   template <typename T>
   Matrix<T> Matrix<T>::transpose() const
   {
-    Matrix matrixTranspose;
+    // Every element of the result is written, so skip initializing it:
+    Matrix matrixTranspose(numCols, numRows, Uninitialized());
 
-    // If matrix is square, create transpose of same size. Otherwise, swap
-    //  number of rows and cols.
-    if ( this->isSquare() )
-    {
-      matrixTranspose = Matrix(numRows, numCols);
-    }
-    else
-    {
-      matrixTranspose = Matrix(numCols, numRows);
+    // Cache-oblivious, tiled copy:
+    transposeCopy<T>(numRows, numCols, this->data(), leadingDim, matrixTranspose.data(), matrixTranspose.getLeadingDim());
+
+    // Return tranposed matrix:
+    return matrixTranspose;
+  }
+
+  // transposeInPlace
+  template <typename T>
+  Matrix<T>& Matrix<T>::transposeInPlace()
+  {
+    // Packed storage, so only the shape changes besides the elements:
+    matrix::transposeInPlace<T>(numRows, numCols, this->data());
+    std::swap(numRows, numCols);
+    leadingDim = numCols;
+
+    return *this;
+  }
+
+  // complexConjugate
+  template <typename T>
+  Matrix<T> Matrix<T>::complexConjugate() const
+  {
+    // One pass, straight into the new matrix (a plain copy for real element types):
+    Matrix matrixCC(numRows, numCols, Uninitialized());
+    matrixCC.pad = this->pad;
+
+    const T* a = this->storage.data();
+    T* c = matrixCC.storage.data();
+    parallelFor(0, this->size(), [=](std::size_t lo, std::size_t hi) {
+      simdConjugate(a + lo, c + lo, hi - lo);
+    });
+
+    // Return the complex conjugate
+    return matrixCC;
+
+  }
+
+  // conjugateTranspose
+  template <typename T>
+  Matrix<T> Matrix<T>::conjugateTranspose() const
+  {
+    // Conjugated while transposing, in one pass:
+    Matrix matrixCT(numCols, numRows, Uninitialized());
+    transposeCopy<T>(numRows, numCols, this->data(), leadingDim, matrixCT.data(), matrixCT.getLeadingDim(), true);
+
+    return matrixCT;
+  }
+
+  // conjugated
+  template <typename T>
+  ConjugateView<T> Matrix<T>::conjugated() const
+  {
+    return ConjugateView<T>(*this, false);
+  }
+
+  // adjoint
+  template <typename T>
+  ConjugateView<T> Matrix<T>::adjoint() const
+  {
+    return ConjugateView<T>(*this, true);
+  }
+
+  // conjugateTransposeInPlace
+  template <typename T>
+  Matrix<T>& Matrix<T>::conjugateTransposeInPlace()
+  {
+    matrix::transposeInPlace<T>(numRows, numCols, this->data(), true);
+    std::swap(numRows, numCols);
+    leadingDim = numCols;
+
+    return *this;
+  }
+
+  // identity
+  template <typename T>
+  Matrix<T> Matrix<T>::identity() const
+  {
+    // Identity has to be square:
+    //  Note: We use the columns here so that right multiplying by the result matrix
+    //    still yields a matrix when applied to 'this'.
+    Matrix result(this->numCols, this->numCols, 0 , "\t");
+
+    for (uint32_t i=0; i < this->numCols; ++i)
+    {
+      result.element(i,i) = 1;
     }
 
-    // Loop through and swap elements:
-    for (uint32_t i=0; i < this->numRows; ++i)
+    return result;
+  }
+
+  // inverse
+  template <typename T>
+  Matrix<T> Matrix<T>::inverse() const
+  {
+    static_assert(!std::is_integral<T>::value, "Matrix::inverse - Integer matrices have no integer inverse in general!");
+
+    // Only square matrices have inverses:
+    if ( !this->isSquare() )
     {
-      for (uint32_t j=0; j < this->numCols; ++j)
+      throw std::logic_error("Matrix::inverse - Matrix must be square!");
+    }
+
+    // Hermitian positive definite matrices take the cheaper Cholesky factors:
+    if ( this->isHermitian() )
+    {
+      CholeskyDecomposition<T> cholesky(*this);
+      if ( cholesky.isComplete() )
       {
-        matrixTranspose(j,i) = this->matrix[i][j];
+        return cholesky.inverse();
       }
     }
 
-    // Return tranposed matrix:
-    return matrixTranspose;
+    // Factor once, then solve for every column of I:
+    LUDecomposition<T> lu(*this);
+    if ( lu.isSingular() )
+    {
+      throw std::logic_error("Matrix::inverse - Matrix is singular!");
+    }
+
+    return lu.inverse();
   }
 
-  // complexConjugate
+  // solve
   template <typename T>
-  Matrix<T> Matrix<T>::complexConjugate() const
+  Matrix<T> Matrix<T>::solve(const Matrix<T>& B) const
   {
+    static_assert(!std::is_integral<T>::value, "Matrix::solve - Integer systems have no integer solution in general!");
 
-    // Check if real or not. If real, return it since complex conjugate leaves it unchanged::
-    if ( this->isReal() )
+    // Only square systems have a unique solution:
+    if ( !this->isSquare() )
     {
-      return *this;
+      throw std::logic_error("Matrix::solve - Matrix must be square!");
     }
 
-    // New complex conjugate matrix:
-    Matrix matrixCC = *this;
+    // Dimensions must match:
+    if ( B.getNumRows() != this->getNumRows() )
+    {
+      throw std::logic_error("Matrix::solve - Right-hand side must have as many rows as the matrix!");
+    }
 
-    // Iterate through and complex conjugate each element:
-    for (uint32_t i=0; i < this->numRows; ++i)
+    // Hermitian positive definite matrices take the cheaper Cholesky factors:
+    if ( this->isHermitian() )
     {
-      for (uint32_t j=0; j < this->numCols; ++j)
+      CholeskyDecomposition<T> cholesky(*this);
+      if ( cholesky.isComplete() )
       {
-        matrixCC(i,j) = std::conj(this->matrix[i][j]);
+        return cholesky.solve(B);
       }
     }
 
-    // Return the complex conjugate
-    return matrixCC;
-    
+    LUDecomposition<T> lu(*this);
+    if ( lu.isSingular() )
+    {
+      throw std::logic_error("Matrix::solve - Matrix is singular!");
+    }
+
+    return lu.solve(B);
   }
 
-  // conjugateTranspose
+  // leastSquares
   template <typename T>
-  Matrix<T> Matrix<T>::conjugateTranspose() const
+  Matrix<T> Matrix<T>::leastSquares(const Matrix<T>& B) const
   {
-    Matrix matrixCT = *this;
+    // Need at least as many equations as unknowns:
+    if ( this->getNumRows() < this->getNumCols() )
+    {
+      throw std::logic_error("Matrix::leastSquares - Matrix must have at least as many rows as columns!");
+    }
 
-    if ( matrixCT.isReal() )
+    // Dimensions must match:
+    if ( B.getNumRows() != this->getNumRows() )
     {
-      return matrixCT.transpose();
+      throw std::logic_error("Matrix::leastSquares - Right-hand side must have as many rows as the matrix!");
     }
 
-    return matrixCT.complexConjugate().transpose();
+    return QRDecomposition<T>(*this).solve(B);
   }
 
-  // identity
+  // power
   template <typename T>
-  Matrix<T> Matrix<T>::identity() const
+  Matrix<T> Matrix<T>::power(uint32_t exponent, PowerMethod method) const
   {
-    // Identity has to be square:
-    //  Note: We use the columns here so that right multiplying by the result matrix
-    //    still yields a matrix when applied to 'this'.
-    Matrix result(this->numCols, this->numCols, 0 , "\t");
+    // The power function can only be applied to square matrices:
+    if ( !this->isSquare() )
+    {
+      throw std::logic_error("Matrix::operator^ - Matrix must be square!");
+    }
 
-    for (uint32_t i=0; i < this->numCols; ++i)
+    const uint32_t n = this->numRows;
+
+    if ( exponent == 0 )
+    {
+      Matrix result = this->identity();
+      result.pad = this->pad;
+      return result;
+    }
+
+    if ( method == powerEigen )
     {
-      result(i,i) = 1;
+      Matrix result(n, n, Uninitialized());
+      result.pad = this->pad;
+      if ( !this->isSymmetric() ||
+           !symmetricPower<T>(n, this->storage.data(), this->leadingDim, exponent, result.storage.data(), result.leadingDim)
+         )
+      {
+        throw std::logic_error("Matrix::power - Eigendecomposition needs a real, symmetric matrix!");
+      }
+      return result;
+    }
+
+    // Exponentiation by squaring over three buffers allocated up front; each
+    //  product goes into the spare one, which then swaps places with its
+    //  destination, so the loop itself never allocates:
+    Matrix base = *this;
+    Matrix spare(n, n, Uninitialized());
+
+    auto multiplyInto = [n](const Matrix& a, const Matrix& b, Matrix& c) {
+      strassen<T>(n, n, n,
+                  a.storage.data(), a.leadingDim,
+                  b.storage.data(), b.leadingDim,
+                  c.storage.data(), c.leadingDim);
+    };
+
+    // Square away the trailing zero bits, then the lowest set bit seeds the result:
+    while ( (exponent & 1) == 0 )
+    {
+      multiplyInto(base, base, spare);
+      base.storage.swap(spare.storage);
+      exponent >>= 1;
+    }
+
+    Matrix result = base;
+    exponent >>= 1;
+
+    while ( exponent != 0 )
+    {
+      multiplyInto(base, base, spare);
+      base.storage.swap(spare.storage);
+
+      if ( exponent & 1 )
+      {
+        multiplyInto(result, base, spare);
+        result.storage.swap(spare.storage);
+      }
+
+      exponent >>= 1;
     }
 
     return result;
   }
 
+  // multiply
+  template <typename T>
+  void Matrix<T>::multiply(const T* x, T* y) const
+  {
+    gemv<T>(numRows, numCols, T(1), storage.data(), leadingDim, x, T(0), y);
+  }
+
+  // multiply (vector)
+  template <typename T>
+  void Matrix<T>::multiply(const std::vector<T>& x, std::vector<T>& y) const
+  {
+    // Vector length must match the column count:
+    if ( x.size() != numCols )
+    {
+      throw std::logic_error("Matrix::operator* (Matrix/Vector) - Vector length does not match the number of columns!");
+    }
+
+    y.resize(numRows);
+    this->multiply(x.data(), y.data());
+  }
+
+  // multiplyTransposed
+  template <typename T>
+  void Matrix<T>::multiplyTransposed(const T* x, T* y) const
+  {
+    gemvTransposed<T>(numRows, numCols, T(1), storage.data(), leadingDim, x, T(0), y);
+  }
+
+  // multiplyTransposed (vector)
+  template <typename T>
+  void Matrix<T>::multiplyTransposed(const std::vector<T>& x, std::vector<T>& y) const
+  {
+    // Vector length must match the row count:
+    if ( x.size() != numRows )
+    {
+      throw std::logic_error("Matrix::operator* (Vector/Matrix) - Vector length does not match the number of rows!");
+    }
+
+    y.resize(numCols);
+    this->multiplyTransposed(x.data(), y.data());
+  }
+
+  // Operator * (Vector/Matrix)
+  template <typename T>
+  std::vector<T> operator*(const std::vector<T>& lhs, const Matrix<T>& rhs)
+  {
+    std::vector<T> result;
+    rhs.multiplyTransposed(lhs, result);
+    return result;
+  }
+
   // isSquare
   template <typename T>
   bool Matrix<T>::isSquare() const
@@ -688,22 +1305,16 @@ namespace matrix
   template <typename T>
   bool Matrix<T>::isReal() const
   {
-    // Iterate over all elements to see if they all have non-zero complex parts:
-    for (const auto& row : this->matrix)
+    // Real element types need no look; complex ones check only the imaginary parts:
+    if ( !std::is_same<T, std::complex<Real>>::value )
     {
-      for (const auto& col : row)
-      {
-        // If a complex part if found, the matrix is not real:
-        auto a_ij = col;
-        if ( std::imag((std::complex<double>)a_ij) != 0 )
-        {
-          return false;
-        }
-      }
+      return true;
     }
 
-    // If none of the elements have complex parts, its real:
-    return true;
+    const T* a = this->storage.data();
+    return parallelAll(0, this->size(), [=](std::size_t lo, std::size_t hi) {
+      return simdAllReal(a + lo, hi - lo);
+    });
   }
 
   // isComplex
@@ -717,143 +1328,114 @@ namespace matrix
 
   // isSymmetric
   template <typename T>
-  bool Matrix<T>::isSymmetric() const
+  bool Matrix<T>::isSymmetric(double absTol, double relTol) const
   {
-    // If the matrix is equal to its transpose, its symmetric:
-    if ( *this == this->transpose() )
+    // Only a square matrix can equal its transpose:
+    if ( !this->isSquare() )
     {
-      return true;
+      return false;
     }
 
-    // If transpose doesn't match, not symmetric:
-    return false;
+    // Compare each element below the diagonal with its mirror image:
+    return predicateImpl::mirrored<T>(numRows, this->storage.data(), leadingDim, false, false, absTol, relTol);
   }
 
   // isSkewSymmetric
   template <typename T>
-  bool Matrix<T>::isSkewSymmetric() const
+  bool Matrix<T>::isSkewSymmetric(double absTol, double relTol) const
   {
-    // If the negative of the matrix equals its transpose, its skew-symmetric:
-    if ( (*this)*(-1) == this->transpose() )
+    // Only a square matrix can equal its negated transpose:
+    if ( !this->isSquare() )
     {
-      return true;
+      return false;
     }
 
-    // If transpose doesn't match, not skew-symmetric:
-    return false;
+    // Compare each element below the diagonal with its mirror image:
+    return predicateImpl::mirrored<T>(numRows, this->storage.data(), leadingDim, true, false, absTol, relTol);
   }
 
   // isHermitian
   template <typename T>
-  bool Matrix<T>::isHermitian() const
+  bool Matrix<T>::isHermitian(double absTol, double relTol) const
   {
-    // If the matrix is equal to its conjugate transpose, its Hermitian:
-    if ( *this == this->conjugateTranspose() )
+    // Only a square matrix can equal its conjugate transpose:
+    if ( !this->isSquare() )
     {
-      return true;
+      return false;
     }
 
-    // If the conjugate tranpose does not match, it is no Hermitian:
-    return false;
+    // Compare each element below the diagonal with its mirror image:
+    return predicateImpl::mirrored<T>(numRows, this->storage.data(), leadingDim, false, true, absTol, relTol);
   }
 
   // isSelfAdjoint
   template <typename T>
-  bool Matrix<T>::isSelfAdjoint() const
+  bool Matrix<T>::isSelfAdjoint(double absTol, double relTol) const
   {
-    return this->isHermitian();
+    return this->isHermitian(absTol, relTol);
   }
 
   // isSkewHermitian
   template <typename T>
-  bool Matrix<T>::isSkewHermitian() const
+  bool Matrix<T>::isSkewHermitian(double absTol, double relTol) const
   {
-
-    // If the negative of the matrix equals its conjugate transpose, its skew-hermitian:
-    if ( (*this)*(-1) == this->conjugateTranspose() )
+    // Only a square matrix can equal its negated conjugate transpose:
+    if ( !this->isSquare() )
     {
-      return true;
+      return false;
     }
 
-    // If conjugate transpose doesn't match, not skew-hermitian:
-    return false;
-  
+    // Compare each element below the diagonal with its mirror image:
+    return predicateImpl::mirrored<T>(numRows, this->storage.data(), leadingDim, true, true, absTol, relTol);
   }
 
   // isNormal
   template <typename T>
-  bool Matrix<T>::isNormal() const
+  bool Matrix<T>::isNormal(double absTol, double relTol) const
   {
-
     // Can't be normal if not square:
     if ( !this->isSquare() )
     {
       return false;
     }
 
-    // Seperate real from complex case:
-    if (this->isReal())
-    {
-      return this->commutesWith(this->transpose());
-    }
-    else  // Complex case
-    {
-      return this->commutesWith(this->conjugateTranspose());
-    }
-
+    // A*A^dagger against A^dagger*A, a band of rows at a time (for real
+    //  matrices the conjugations drop out and this is A*A^T = A^T*A):
+    return predicateImpl::normal<T>(numRows, this->storage.data(), leadingDim, absTol, relTol);
   }
 
   // isOrthogonal
   template <typename T>
-  bool Matrix<T>::isOrthogonal() const
+  bool Matrix<T>::isOrthogonal(double absTol, double relTol) const
   {
-
     // Can't be orthgonal if not square:
     if ( !this->isSquare() )
     {
       return false;
     }
-  
-    // Check properties:
-    if ( (this->isNormal()) &&
-         (((*this)*this->transpose()) == this->identity())
-       )
-    {
-      return true;
-    }
 
-    // Not orthogonal if none of the above are true:
-    return false;
+    // For square A, A*A^T = I already makes A^T the inverse, so A^T*A = I too:
+    return predicateImpl::orthonormal<T>(numRows, this->storage.data(), leadingDim, false, absTol, relTol);
   }
 
   // isUnitary
   template <typename T>
-  bool Matrix<T>::isUnitary() const
+  bool Matrix<T>::isUnitary(double absTol, double relTol) const
   {
-
     // Can't be unitary if not square:
     if ( !this->isSquare() )
     {
       return false;
     }
 
-    // Check properties:
-    if ( (this->isNormal()) &&
-         (((*this)*this->conjugateTranspose()) == this->identity())
-       )
-    {
-      return true;
-    }
-
-    // Not unitary if none of the above are true:
-    return false;
+    // For square A, A*A^dagger = I already makes A^dagger the inverse:
+    return predicateImpl::orthonormal<T>(numRows, this->storage.data(), leadingDim, true, absTol, relTol);
   }
 
   // isProjection
   template <typename T>
-  bool Matrix<T>::isProjection() const
+  bool Matrix<T>::isProjection(double absTol, double relTol) const
   {
-
     // Can't be a projection if not square:
     if ( !this->isSquare() )
     {
@@ -861,94 +1443,421 @@ namespace matrix
     }
 
     // If the matrix equals its square, it is a projection:
-    if ( (*this) == ((*this)^2) )
+    return predicateImpl::projection<T>(numRows, this->storage.data(), leadingDim, absTol, relTol);
+  }
+
+  // isInvertible
+  template <typename T>
+  bool Matrix<T>::isInvertible() const
+  {
+    // Can't be invertible if not square:
+    if ( !this->isSquare() )
+    {
+      return false;
+    }
+
+    return this->invertibleOf(std::is_integral<T>());
+  }
+
+  // invertibleOf (floating-point and complex)
+  template <typename T>
+  bool Matrix<T>::invertibleOf(std::false_type) const
+  {
+    // The factorization determinant() uses: a complete Cholesky, else LU with
+    //  no negligible pivot (so isSingular() holds exactly when determinant() is 0):
+    if ( this->isHermitian() && CholeskyDecomposition<T>(*this).isComplete() )
     {
       return true;
     }
 
-    // If it doesn't equal its square, its not a projection:
-    return false;
+    return !LUDecomposition<T>(*this).isSingular();
   }
 
-  // isIdentity
+  // isSingular
   template <typename T>
-  bool Matrix<T>::isIdentity() const
+  bool Matrix<T>::isSingular() const
   {
+    return !this->isInvertible();
+  }
 
-    // Can't be the identity if not square:
-    if ( !this->isSquare() )
+  // isDegenerate
+  template <typename T>
+  bool Matrix<T>::isDegenerate() const
+  {
+    return this->isSingular();
+  }
+
+  // isPositiveDefinite
+  template <typename T>
+  bool Matrix<T>::isPositiveDefinite() const
+  {
+    // Must be square and Hermitian:
+    if ( !this->isSquare() || !this->isHermitian() )
     {
       return false;
     }
 
-    // Check if matrix is equal to its identity:
-    if ( (*this) == this->identity() )
+    // Positive definite exactly when LL^H finds every pivot positive:
+    return CholeskyDecomposition<T>(*this).isComplete();
+  }
+
+  // isIdentity
+  template <typename T>
+  bool Matrix<T>::isIdentity(double absTol, double relTol) const
+  {
+    // Can't be the identity if not square:
+    if ( !this->isSquare() )
     {
-      return true;
+      return false;
     }
 
-    // If not equal, not the identity:
-    return false;
+    // Ones on the diagonal, zeros everywhere else:
+    return predicateImpl::identity<T>(numRows, this->storage.data(), leadingDim, absTol, relTol);
   }
 
   // commutesWith
   template <typename T>
-  bool Matrix<T>::commutesWith(const Matrix<T>& rhs) const
+  bool Matrix<T>::commutesWith(const Matrix<T>& rhs, double absTol, double relTol) const
   {
-    // If inner dimensions don't match either way, can't multiply:
-    if ( (this->getNumCols() != rhs.getNumRows()) ||
-         (this->getNumRows() != rhs.getNumCols())
+    // AB and BA only have the same shape when both are square and the same size:
+    if ( !this->isSquare() || !rhs.isSquare() ||
+         (this->getNumRows() != rhs.getNumRows())
        )
     {
       return false;
     }
 
     // 2 matricies commute if AB = BA:
-    if ( ((*this)*(rhs)) == ((rhs)*(*this)) )
+    return predicateImpl::commute<T>(numRows, this->storage.data(), leadingDim,
+                                     rhs.storage.data(), rhs.leadingDim, absTol, relTol);
+  }
+
+  // Trace
+  template <typename T>
+  T Matrix<T>::trace() const
+  {
+    // Loop through the rows and sum the main diagonal (each diagonal element
+    //  sits on its own cache line, so chunks of it are summed in parallel):
+    uint32_t diagLen = (numRows < numCols) ? numRows : numCols;
+    const T* a = this->storage.data();
+    const std::size_t stride = std::size_t(this->leadingDim) + 1;
+    return parallelReduce(0, diagLen, T(0),
+      [=](std::size_t lo, std::size_t hi) {
+        // Sum of diagonal values:
+        T diagSum = 0;
+        for (std::size_t i=lo; i<hi; ++i)
+        {
+          diagSum += a[i*stride];
+        }
+        return diagSum;
+      },
+      [](const T& x, const T& y) { return x + y; },
+      getParallelThreshold()/8 + 1);
+  }
+
+  // Sum
+  template <typename T>
+  T Matrix<T>::sum(Summation method) const
+  {
+    // Stream through and sum all elements (several independent accumulators
+    //  per chunk, chunks combined in order):
+    const T* a = this->storage.data();
+    return parallelReduce(0, this->size(), T(0),
+      [=](std::size_t lo, std::size_t hi) { return reduceImpl::sum(a + lo, hi - lo, method); },
+      [](const T& x, const T& y) { return x + y; });
+  }
+
+  // mean
+  template <typename T>
+  T Matrix<T>::mean(Summation method) const
+  {
+    // No elements, no average:
+    if ( this->size() == 0 )
     {
-      return true;
+      throw std::logic_error("Matrix::mean - Matrix is empty!");
     }
 
-    // If they aren't equal, they don't commute:
-    return false;
+    return this->sum(method)/T(this->size());
   }
 
-  // Trace
+  // p1Norm
   template <typename T>
-  T Matrix<T>::trace() const
+  typename Matrix<T>::Real Matrix<T>::p1Norm() const
   {
-    // Sum of diagonal values:
-    T diagSum = 0;
+    // Largest column sum of magnitudes:
+    const std::vector<Real> norms = this->columnNorms(vectorNorm1);
+    return norms.empty() ? Real(0) : *std::max_element(norms.begin(), norms.end());
+  }
 
-    // Loop through the rows and sum the main diagonal
-    for (uint32_t i=0; i<numRows; ++i)
+  // p2Norm
+  template <typename T>
+  typename Matrix<T>::Real Matrix<T>::p2Norm() const
+  {
+    return this->p2NormOf(std::is_integral<T>());
+  }
+
+  // p2NormOf (integers)
+  template <typename T>
+  typename Matrix<T>::Real Matrix<T>::p2NormOf(std::true_type) const
+  {
+    // Computed in double and rounded to nearest, whatever the shape:
+    Matrix<double> real(numRows, numCols);
+    std::copy(this->begin(), this->end(), real.begin());
+    return Real(std::llround(real.p2Norm()));
+  }
+
+  // p2NormOf (floating-point and complex)
+  template <typename T>
+  typename Matrix<T>::Real Matrix<T>::p2NormOf(std::false_type) const
+  {
+    // For a single row or column the spectral norm is its Euclidean length:
+    if ( (numRows <= 1) || (numCols <= 1) )
+    {
+      return this->frobeniusNorm();
+    }
+
+    // Work with A/scale so no intermediate vector can overflow:
+    const Real scale = this->maxNorm();
+    if ( (scale == Real(0)) || !(scale <= std::numeric_limits<Real>::max()) )
     {
-      diagSum += this->matrix[i][i];
+      return scale;
     }
-    
-    return diagSum;
+
+    // Golub-Kahan-Lanczos bidiagonalization, fully reorthogonalized: after k
+    //  steps the largest singular value of the k x k bidiagonal B (alphas on
+    //  the diagonal, betas above it) approximates A's, and it converges far
+    //  faster than power iteration on A^H*A. u and v keep the latest
+    //  p2NormBasis left and right Lanczos vectors, vector k in slot k % basis;
+    //  losing orthogonality to older ones only repeats converged singular
+    //  values in B, never raises its largest one:
+    const std::size_t m = numRows, n = numCols;
+    const std::size_t steps = std::min<std::size_t>(std::min(m, n), p2NormSteps);
+    const std::size_t basis = std::min<std::size_t>(steps, p2NormBasis);
+    std::vector<T> u(basis*m), v(basis*n), scaled(std::max(m, n));
+    std::vector<Real> alpha, beta;
+
+    // Orthogonalize vector k against the kept vectors before it (every slot but its own):
+    auto orthogonalizeKept = [basis](T* x, std::size_t len, const T* kept, std::size_t k) {
+      const std::size_t slot = k % basis, filled = std::min(k, basis);
+      reduceImpl::orthogonalize(x, len, kept, std::min(slot, filled));
+      if ( filled > slot + 1 )
+      {
+        reduceImpl::orthogonalize(x, len, kept + (slot + 1)*len, filled - slot - 1);
+      }
+    };
+
+    // (A/scale)*x and (A/scale)^H*y:
+    auto applyA = [&](const T* x, T* y) {
+      simdMultiplyScalar(x, T(Real(1)/scale), scaled.data(), n);
+      this->multiply(scaled.data(), y);
+    };
+    auto applyAdjoint = [&](const T* y, T* x) {
+      for (std::size_t i=0; i<m; ++i)
+      {
+        scaled[i] = conjugate(y[i])/T(scale);
+      }
+      this->multiplyTransposed(scaled.data(), x);
+      for (std::size_t j=0; j<n; ++j)
+      {
+        x[j] = conjugate(x[j]);
+      }
+    };
+
+    // Start from the column lengths (they lean toward the dominant right singular vector):
+    const std::vector<Real> lengths = this->columnNorms(vectorNorm2);
+    std::copy(lengths.begin(), lengths.end(), v.begin());
+    simdMultiplyScalar(v.data(), T(Real(1)/reduceImpl::euclidean<Real>(v.data(), n)), v.data(), n);
+
+    Real sigma = 0;
+    for (std::size_t k=0; k<steps; ++k)
+    {
+      // u_k = A*v_k - beta_(k-1)*u_(k-1), orthogonalized against the earlier u's:
+      T* uk = u.data() + (k % basis)*m;
+      applyA(v.data() + (k % basis)*n, uk);
+      orthogonalizeKept(uk, m, u.data(), k);
+      alpha.push_back(reduceImpl::euclidean<Real>(uk, m));
+
+      const Real next = reduceImpl::largestSingularValue(alpha, beta);
+      const bool converged = ( next - sigma <= 4*std::numeric_limits<Real>::epsilon()*next );
+      sigma = std::max(sigma, next);
+      if ( converged || (alpha.back() <= std::numeric_limits<Real>::epsilon()*sigma) || (k + 1 == steps) )
+      {
+        break;
+      }
+      simdMultiplyScalar(uk, T(Real(1)/alpha.back()), uk, m);
+
+      // v_(k+1) = A^H*u_k - alpha_k*v_k, orthogonalized against the earlier v's:
+      T* vk = v.data() + ((k + 1) % basis)*n;
+      applyAdjoint(uk, vk);
+      orthogonalizeKept(vk, n, v.data(), k + 1);
+      beta.push_back(reduceImpl::euclidean<Real>(vk, n));
+      if ( beta.back() <= std::numeric_limits<Real>::epsilon()*sigma )
+      {
+        // An invariant subspace: B's singular values are exact:
+        break;
+      }
+      simdMultiplyScalar(vk, T(Real(1)/beta.back()), vk, n);
+    }
+
+    return sigma*scale;
   }
 
-  // Sum
+  // pInfNorm
+  template <typename T>
+  typename Matrix<T>::Real Matrix<T>::pInfNorm() const
+  {
+    // Largest row sum of magnitudes:
+    const std::vector<Real> norms = this->rowNorms(vectorNorm1);
+    return norms.empty() ? Real(0) : *std::max_element(norms.begin(), norms.end());
+  }
+
+  // frobeniusNorm
   template <typename T>
-  T Matrix<T>::sum() const
+  typename Matrix<T>::Real Matrix<T>::frobeniusNorm() const
   {
-    // Sum of all elements in matrix:
-    T sum = 0;
+    // One fast pass of squares; rescaled only if that over- or underflowed:
+    const T* a = this->storage.data();
+    const Real squares = parallelReduce(0, this->size(), Real(0),
+      [=](std::size_t lo, std::size_t hi) { return reduceImpl::accumulate<simd::accSquare, Real>(a + lo, hi - lo); },
+      [](const Real& x, const Real& y) { return x + y; });
 
-    // Loop through and sum all ements:
-    for (const auto& rows : this->matrix)
+    return reduceImpl::euclidean<Real>(a, this->size(), 1, squares);
+  }
+
+  // maxNorm
+  template <typename T>
+  typename Matrix<T>::Real Matrix<T>::maxNorm() const
+  {
+    const T* a = this->storage.data();
+    return parallelReduce(0, this->size(), Real(0),
+      [=](std::size_t lo, std::size_t hi) { return reduceImpl::accumulate<simd::accMaxAbs, Real>(a + lo, hi - lo); },
+      [](const Real& x, const Real& y) { return std::max(x, y); });
+  }
+
+  // rowSums
+  template <typename T>
+  std::vector<T> Matrix<T>::rowSums(Summation method) const
+  {
+    std::vector<T> result(numRows);
+    const T* a = this->storage.data();
+    const std::size_t cols = numCols, ld = leadingDim;
+    T* out = result.data();
+    parallelFor(0, numRows, [=](std::size_t lo, std::size_t hi) {
+      for (std::size_t i=lo; i<hi; ++i)
+      {
+        out[i] = reduceImpl::sum(a + i*ld, cols, method);
+      }
+    }, getParallelThreshold()/(cols + 1) + 1);
+
+    return result;
+  }
+
+  // columnSums
+  template <typename T>
+  std::vector<T> Matrix<T>::columnSums(Summation method) const
+  {
+    std::vector<T> result(numCols);
+    reduceImpl::columnSums(numRows, numCols, this->storage.data(), leadingDim, result.data(), method);
+    return result;
+  }
+
+  // rowMeans
+  template <typename T>
+  std::vector<T> Matrix<T>::rowMeans(Summation method) const
+  {
+    // No columns, no averages:
+    if ( numCols == 0 )
+    {
+      throw std::logic_error("Matrix::rowMeans - Matrix is empty!");
+    }
+
+    std::vector<T> result = this->rowSums(method);
+    simdDivideScalar(result.data(), T(numCols), result.data(), result.size());
+    return result;
+  }
+
+  // columnMeans
+  template <typename T>
+  std::vector<T> Matrix<T>::columnMeans(Summation method) const
+  {
+    // No rows, no averages:
+    if ( numRows == 0 )
+    {
+      throw std::logic_error("Matrix::columnMeans - Matrix is empty!");
+    }
+
+    std::vector<T> result = this->columnSums(method);
+    simdDivideScalar(result.data(), T(numRows), result.data(), result.size());
+    return result;
+  }
+
+  // rowNorms
+  template <typename T>
+  std::vector<typename Matrix<T>::Real> Matrix<T>::rowNorms(VectorNorm norm) const
+  {
+    std::vector<Real> result(numRows);
+    reduceImpl::rowNorms(numRows, numCols, this->storage.data(), leadingDim, result.data(), norm);
+    return result;
+  }
+
+  // columnNorms
+  template <typename T>
+  std::vector<typename Matrix<T>::Real> Matrix<T>::columnNorms(VectorNorm norm) const
+  {
+    std::vector<Real> result(numCols);
+    reduceImpl::columnNorms(numRows, numCols, this->storage.data(), leadingDim, result.data(), norm);
+    return result;
+  }
+
+  // determinant
+  template <typename T>
+  T Matrix<T>::determinant() const
+  {
+    // Only square matrices have determinants:
+    if ( !this->isSquare() )
+    {
+      throw std::logic_error("Matrix::determinant - Matrix must be square!");
+    }
+
+    return this->determinantOf(std::is_integral<T>());
+  }
+
+  // determinantOf (integers)
+  template <typename T>
+  T Matrix<T>::determinantOf(std::true_type) const
+  {
+    Matrix<T> work(*this);
+    return factorImpl::bareissDeterminant<T>(numRows, work.storage.data(), work.leadingDim);
+  }
+
+  // determinantOf (floating-point and complex)
+  template <typename T>
+  T Matrix<T>::determinantOf(std::false_type) const
+  {
+    // Hermitian positive definite matrices take the cheaper Cholesky factors:
+    if ( this->isHermitian() )
     {
-      for (const auto& cols : rows)
+      CholeskyDecomposition<T> cholesky(*this);
+      if ( cholesky.isComplete() )
       {
-        auto a_ij = cols;
-        sum += a_ij;
+        return cholesky.determinant();
       }
     }
 
-    return sum;
+    return LUDecomposition<T>(*this).determinant();
   }
 
 } // matrix namespace
 
+// Factorizations and file I/O (need the complete Matrix class):
+#include "MatrixLU.hpp"
+#include "MatrixCholesky.hpp"
+#include "MatrixQR.hpp"
+#include "MatrixFile.hpp"
+#include "MatrixOutOfCore.hpp"
+#include "MatrixConjugate.hpp"
+#include "MatrixView.hpp"
+#include "MatrixQuantized.hpp"
+#include "MatrixText.hpp"
+
 #endif // MATRIX_H
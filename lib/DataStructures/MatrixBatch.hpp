@@ -0,0 +1,941 @@
+////////////////////////////////////////
+//
+//  File:
+//      \file MatrixBatch.hpp
+//
+//  Description:
+//      \brief Matrix Batch: Many small same-shaped matrices in one buffer
+//
+//  Author:
+//      \author J. Caleb Wherry
+//
+////////////////////////////////////////
+
+// Include Guards:
+#ifndef MATRIX_BATCH_H
+#define MATRIX_BATCH_H
+
+// Forward Declared Dependencies:
+//
+
+// Local Include Dependencies:
+#include "Matrix.hpp"
+#include "MatrixGemm.hpp"
+#include "MatrixSimd.hpp"
+#include "AlignedBuffer.hpp"
+#include "ThreadPool.hpp"
+
+// Compiler Include Dependencies:
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <complex>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <utility>
+#include <type_traits>
+
+/// matrix Namespace
+namespace matrix
+{
+
+  /// How a MatrixBatch arranges its matrices in memory
+  enum BatchLayout
+  {
+    batchStrided,       ///< One matrix after another, each row-major
+    batchInterleaved    ///< Chunks of lanes() matrices, element by element: (i,j) of a chunk's matrices is contiguous
+  };
+
+  /// batchImpl namespace (kernels over chunks of interleaved matrices)
+  namespace batchImpl
+  {
+
+    /// Matrices per chunk: one cache line (two AVX2 registers) of each element
+    template <typename T>
+    constexpr std::size_t lanes()
+    {
+      return (storageAlignment > sizeof(T)) ? storageAlignment/sizeof(T) : 1;
+    }
+
+    /// c = a*b for one chunk of matrices (m x k by k x n)
+    template <typename T>
+    void multiplyLanes(std::size_t m, std::size_t n, std::size_t k, const T* a, const T* b, T* c)
+    {
+      const std::size_t L = lanes<T>();
+      for (std::size_t i=0; i<m; ++i)
+      {
+        for (std::size_t j=0; j<n; ++j)
+        {
+          T acc[lanes<T>()];
+          std::fill(acc, acc + L, T(0));
+          for (std::size_t l=0; l<k; ++l)
+          {
+            const T* pa = a + (i*k + l)*L;
+            const T* pb = b + (l*n + j)*L;
+            for (std::size_t v=0; v<L; ++v)
+            {
+              acc[v] += pa[v]*pb[v];
+            }
+          }
+          std::copy(acc, acc + L, c + (i*n + j)*L);
+        }
+      }
+    }
+
+#if MATRIX_X86_DISPATCH
+
+    // Two columns of C at a time, so each A load feeds four FMAs:
+    __attribute__((target("avx2,fma")))
+    inline void multiplyLanesAvx2(std::size_t m, std::size_t n, std::size_t k, const double* a, const double* b, double* c)
+    {
+      for (std::size_t i=0; i<m; ++i)
+      {
+        const double* ai = a + i*k*8;
+        std::size_t j = 0;
+        for (; j+2<=n; j+=2)
+        {
+          __m256d c00 = _mm256_setzero_pd(), c01 = c00, c10 = c00, c11 = c00;
+          for (std::size_t l=0; l<k; ++l)
+          {
+            const __m256d a0 = _mm256_load_pd(ai + l*8), a1 = _mm256_load_pd(ai + l*8 + 4);
+            const double* pb = b + (l*n + j)*8;
+            c00 = _mm256_fmadd_pd(a0, _mm256_load_pd(pb),      c00);
+            c01 = _mm256_fmadd_pd(a1, _mm256_load_pd(pb + 4),  c01);
+            c10 = _mm256_fmadd_pd(a0, _mm256_load_pd(pb + 8),  c10);
+            c11 = _mm256_fmadd_pd(a1, _mm256_load_pd(pb + 12), c11);
+          }
+          double* pc = c + (i*n + j)*8;
+          _mm256_store_pd(pc,      c00);
+          _mm256_store_pd(pc + 4,  c01);
+          _mm256_store_pd(pc + 8,  c10);
+          _mm256_store_pd(pc + 12, c11);
+        }
+        if ( j < n )
+        {
+          __m256d c00 = _mm256_setzero_pd(), c01 = c00;
+          for (std::size_t l=0; l<k; ++l)
+          {
+            const double* pb = b + (l*n + j)*8;
+            c00 = _mm256_fmadd_pd(_mm256_load_pd(ai + l*8),     _mm256_load_pd(pb),     c00);
+            c01 = _mm256_fmadd_pd(_mm256_load_pd(ai + l*8 + 4), _mm256_load_pd(pb + 4), c01);
+          }
+          _mm256_store_pd(c + (i*n + j)*8,     c00);
+          _mm256_store_pd(c + (i*n + j)*8 + 4, c01);
+        }
+      }
+    }
+
+    __attribute__((target("avx2,fma")))
+    inline void multiplyLanesAvx2(std::size_t m, std::size_t n, std::size_t k, const float* a, const float* b, float* c)
+    {
+      for (std::size_t i=0; i<m; ++i)
+      {
+        const float* ai = a + i*k*16;
+        std::size_t j = 0;
+        for (; j+2<=n; j+=2)
+        {
+          __m256 c00 = _mm256_setzero_ps(), c01 = c00, c10 = c00, c11 = c00;
+          for (std::size_t l=0; l<k; ++l)
+          {
+            const __m256 a0 = _mm256_load_ps(ai + l*16), a1 = _mm256_load_ps(ai + l*16 + 8);
+            const float* pb = b + (l*n + j)*16;
+            c00 = _mm256_fmadd_ps(a0, _mm256_load_ps(pb),      c00);
+            c01 = _mm256_fmadd_ps(a1, _mm256_load_ps(pb + 8),  c01);
+            c10 = _mm256_fmadd_ps(a0, _mm256_load_ps(pb + 16), c10);
+            c11 = _mm256_fmadd_ps(a1, _mm256_load_ps(pb + 24), c11);
+          }
+          float* pc = c + (i*n + j)*16;
+          _mm256_store_ps(pc,      c00);
+          _mm256_store_ps(pc + 8,  c01);
+          _mm256_store_ps(pc + 16, c10);
+          _mm256_store_ps(pc + 24, c11);
+        }
+        if ( j < n )
+        {
+          __m256 c00 = _mm256_setzero_ps(), c01 = c00;
+          for (std::size_t l=0; l<k; ++l)
+          {
+            const float* pb = b + (l*n + j)*16;
+            c00 = _mm256_fmadd_ps(_mm256_load_ps(ai + l*16),     _mm256_load_ps(pb),     c00);
+            c01 = _mm256_fmadd_ps(_mm256_load_ps(ai + l*16 + 8), _mm256_load_ps(pb + 8), c01);
+          }
+          _mm256_store_ps(c + (i*n + j)*16,     c00);
+          _mm256_store_ps(c + (i*n + j)*16 + 8, c01);
+        }
+      }
+    }
+
+    // The solver's lane loops are written once and compiled twice, for the
+    //  baseline and for AVX2 + FMA, by forcing one body into both; restrict
+    //  lets the lane loops vectorize without runtime overlap checks:
+    #define MATRIX_BATCH_BODY inline __attribute__((always_inline))
+    #define MATRIX_BATCH_RESTRICT __restrict__
+#else
+    #define MATRIX_BATCH_BODY inline
+    #define MATRIX_BATCH_RESTRICT
+#endif // MATRIX_X86_DISPATCH
+
+    /// y[v] -= f[v]*x[v] over one element vector
+    template <typename T>
+    MATRIX_BATCH_BODY void subtractProduct(T* MATRIX_BATCH_RESTRICT y, const T* MATRIX_BATCH_RESTRICT f,
+                                           const T* MATRIX_BATCH_RESTRICT x)
+    {
+      for (std::size_t v=0; v<lanes<T>(); ++v)
+      {
+        y[v] -= f[v]*x[v];
+      }
+    }
+
+    /// y[v] *= d[v] over one element vector
+    template <typename T>
+    MATRIX_BATCH_BODY void scaleLanes(T* MATRIX_BATCH_RESTRICT y, const T* MATRIX_BATCH_RESTRICT d)
+    {
+      for (std::size_t v=0; v<lanes<T>(); ++v)
+      {
+        y[v] *= d[v];
+      }
+    }
+
+    /// y[v] /= d[v] over one element vector
+    template <typename T>
+    MATRIX_BATCH_BODY void divideLanes(T* MATRIX_BATCH_RESTRICT y, const T* MATRIX_BATCH_RESTRICT d)
+    {
+      for (std::size_t v=0; v<lanes<T>(); ++v)
+      {
+        y[v] /= d[v];
+      }
+    }
+
+    /// Solve a*x = b in place for one chunk (a: n x n, overwritten by its
+    ///  factors; x: n x r, holds b on entry)
+    ///
+    /// Gaussian elimination with partial pivoting. Pivots are chosen and rows
+    /// swapped lane by lane; the elimination itself runs across all lanes at
+    /// once. A lane with a zero pivot carries on with a unit pivot so the
+    /// other lanes are unaffected. As in LUDecomposition, a lane is flagged
+    /// in singular when its smallest pivot is no larger than n*eps*max|u|.
+    /// Floating point pivots are inverted once and the divisions become
+    /// multiplications.
+    template <typename T>
+    MATRIX_BATCH_BODY void solveLanesBody(std::size_t n, std::size_t r, T* a, T* x, bool* singular)
+    {
+      typedef decltype(std::abs(T(0))) Real;
+
+      const std::size_t L = lanes<T>();
+      const bool reciprocal = std::is_floating_point<Real>::value;
+
+      // Per lane: U's largest element and smallest pivot (NaN sticks):
+      Real largest[lanes<T>()], smallest[lanes<T>()];
+      std::fill(largest, largest + L, Real(0));
+      std::fill(smallest, smallest + L, std::numeric_limits<Real>::max());
+
+      for (std::size_t p=0; p<n; ++p)
+      {
+        T* ap = a + p*n*L;
+        T* xp = x + p*r*L;
+
+        for (std::size_t v=0; v<L; ++v)
+        {
+          std::size_t best = p;
+          auto bestSize = std::abs(ap[p*L + v]);
+          for (std::size_t q=p+1; q<n; ++q)
+          {
+            const auto size = std::abs(a[(q*n + p)*L + v]);
+            if ( size > bestSize )
+            {
+              best = q;
+              bestSize = size;
+            }
+          }
+          if ( best != p )
+          {
+            for (std::size_t c=p; c<n; ++c)
+            {
+              std::swap(ap[c*L + v], a[(best*n + c)*L + v]);
+            }
+            for (std::size_t c=0; c<r; ++c)
+            {
+              std::swap(xp[c*L + v], x[(best*r + c)*L + v]);
+            }
+          }
+
+          // Row p of U is final now:
+          for (std::size_t c=p; c<n; ++c)
+          {
+            largest[v] = std::max(largest[v], Real(std::abs(ap[c*L + v])));
+          }
+          const Real pivot = std::abs(ap[p*L + v]);
+          smallest[v] = ( (pivot < smallest[v]) || (pivot != pivot) ) ? pivot : smallest[v];
+
+          if ( ap[p*L + v] == T(0) )
+          {
+            ap[p*L + v] = T(1);
+          }
+          if ( reciprocal )
+          {
+            ap[p*L + v] = T(1)/ap[p*L + v];
+          }
+        }
+
+        for (std::size_t q=p+1; q<n; ++q)
+        {
+          T* aq = a + q*n*L;
+          T* xq = x + q*r*L;
+          T f[lanes<T>()];
+          std::copy(aq + p*L, aq + (p + 1)*L, f);
+          reciprocal ? scaleLanes(f, ap + p*L) : divideLanes(f, ap + p*L);
+          for (std::size_t c=p+1; c<n; ++c)
+          {
+            subtractProduct(aq + c*L, f, ap + c*L);
+          }
+          for (std::size_t c=0; c<r; ++c)
+          {
+            subtractProduct(xq + c*L, f, xp + c*L);
+          }
+        }
+      }
+
+      for (std::size_t v=0; v<L; ++v)
+      {
+        if ( !(smallest[v] > largest[v]*Real(n)*std::numeric_limits<Real>::epsilon()) )
+        {
+          singular[v] = true;
+        }
+      }
+
+      // Back substitution:
+      for (std::size_t p=n; p-- > 0;)
+      {
+        const T* ap = a + p*n*L;
+        T* xp = x + p*r*L;
+        for (std::size_t q=p+1; q<n; ++q)
+        {
+          const T* xq = x + q*r*L;
+          for (std::size_t c=0; c<r; ++c)
+          {
+            subtractProduct(xp + c*L, ap + q*L, xq + c*L);
+          }
+        }
+        for (std::size_t c=0; c<r; ++c)
+        {
+          reciprocal ? scaleLanes(xp + c*L, ap + p*L) : divideLanes(xp + c*L, ap + p*L);
+        }
+      }
+    }
+
+    #undef MATRIX_BATCH_BODY
+    #undef MATRIX_BATCH_RESTRICT
+
+    /// c = a*b for one chunk, on the widest kernel available
+    template <typename T>
+    void multiplyChunk(std::size_t m, std::size_t n, std::size_t k, const T* a, const T* b, T* c)
+    {
+      multiplyLanes(m, n, k, a, b, c);
+    }
+
+    /// Solve a*x = b in place for one chunk, on the widest kernel available
+    template <typename T>
+    void solveChunk(std::size_t n, std::size_t r, T* a, T* x, bool* singular)
+    {
+      solveLanesBody(n, r, a, x, singular);
+    }
+
+#if MATRIX_X86_DISPATCH
+    __attribute__((target("avx2,fma")))
+    inline void solveLanesAvx2(std::size_t n, std::size_t r, double* a, double* x, bool* singular)
+    {
+      solveLanesBody(n, r, a, x, singular);
+    }
+
+    __attribute__((target("avx2,fma")))
+    inline void solveLanesAvx2(std::size_t n, std::size_t r, float* a, float* x, bool* singular)
+    {
+      solveLanesBody(n, r, a, x, singular);
+    }
+
+    inline void multiplyChunk(std::size_t m, std::size_t n, std::size_t k, const double* a, const double* b, double* c)
+    {
+      simd::useAvx2Fma() ? multiplyLanesAvx2(m, n, k, a, b, c) : multiplyLanes(m, n, k, a, b, c);
+    }
+
+    inline void multiplyChunk(std::size_t m, std::size_t n, std::size_t k, const float* a, const float* b, float* c)
+    {
+      simd::useAvx2Fma() ? multiplyLanesAvx2(m, n, k, a, b, c) : multiplyLanes(m, n, k, a, b, c);
+    }
+
+    inline void solveChunk(std::size_t n, std::size_t r, double* a, double* x, bool* singular)
+    {
+      simd::useAvx2Fma() ? solveLanesAvx2(n, r, a, x, singular) : solveLanesBody(n, r, a, x, singular);
+    }
+
+    inline void solveChunk(std::size_t n, std::size_t r, float* a, float* x, bool* singular)
+    {
+      simd::useAvx2Fma() ? solveLanesAvx2(n, r, a, x, singular) : solveLanesBody(n, r, a, x, singular);
+    }
+#endif
+
+  } // batchImpl namespace
+
+
+  /// Matrix Batch class
+  ///
+  /// Many independent matrices of one shape in a single aligned buffer, for
+  /// workloads that multiply or solve hundreds of thousands of 4x4 to 64x64
+  /// systems at a time. There is no per-matrix object, heap block, pad or
+  /// bounds check; shapes are checked once per batch operation.
+  ///
+  /// The interleaved layout groups the matrices in chunks of lanes() (one
+  /// cache line of elements) and stores each chunk element by element, so
+  /// element (i,j) of the chunk's matrices is one aligned vector and the
+  /// batch kernels vectorize across matrices: one AVX2 FMA updates the same
+  /// element of 4 (double) or 8 (float) matrices, whatever the matrix size.
+  /// A chunk is contiguous, so its kernel stays inside a few pages; the last
+  /// chunk is padded with zero matrices. The strided layout
+  /// keeps each matrix contiguous and row-major, which suits sizes where one
+  /// matrix fills the vectors by itself (about 32 and up) and interop with
+  /// Matrix. Either way the batch is spread over the thread pool.
+  template <typename T>
+  class MatrixBatch
+  {
+
+    private:
+      AlignedBuffer<T> storage;   ///< All elements
+      std::size_t count;          ///< Number of matrices
+      uint32_t numRows;           ///< Rows of each matrix
+      uint32_t numCols;           ///< Columns of each matrix
+      BatchLayout layout;         ///< Arrangement of the elements
+      std::size_t stride;         ///< Distance between matrices (strided) or chunks (interleaved)
+
+    public:
+
+      //
+      // Constructors:
+      //
+
+      /// Default Constructor (empty batch)
+      MatrixBatch();
+
+      /// Fill Constructor
+      MatrixBatch(
+        std::size_t _count,                       ///< Number of matrices
+        uint32_t _numRows,                        ///< Rows of each matrix
+        uint32_t _numCols,                        ///< Columns of each matrix
+        BatchLayout _layout = batchInterleaved,   ///< Arrangement of the elements
+        const T& initVal = T(0)                   ///< Value of every element
+      );
+
+      /// Matrices Constructor (all must have the same shape)
+      explicit MatrixBatch(
+        const std::vector<Matrix<T>>& matrices,   ///< Matrices to copy in
+        BatchLayout _layout = batchInterleaved    ///< Arrangement of the elements
+      );
+
+
+      //
+      // Accessors:
+      //
+
+      std::size_t getCount() const { return count; };       ///< Number of matrices
+      uint32_t getNumRows() const { return numRows; };      ///< Rows of each matrix
+      uint32_t getNumCols() const { return numCols; };      ///< Columns of each matrix
+      BatchLayout getLayout() const { return layout; };     ///< Arrangement of the elements
+      std::size_t getStride() const { return stride; };     ///< Matrix (strided) or chunk (interleaved) stride
+
+      /// Matrices per interleaved chunk
+      static constexpr std::size_t lanes() { return batchImpl::lanes<T>(); };
+
+      // Storage Accessors (no copy): element (i,j) of matrix b is at data()[offset(b,i,j)]
+      T* data() { return storage.data(); };                 ///< All elements
+      const T* data() const { return storage.data(); };     ///< All elements (const)
+
+      /// Position of element (row,col) of matrix index in data()
+      std::size_t offset(std::size_t index, uint32_t row, uint32_t col) const
+      {
+        return (layout == batchStrided) ? index*stride + std::size_t(row)*numCols + col
+                                        : (index/lanes())*stride + (std::size_t(row)*numCols + col)*lanes() + index%lanes();
+      }
+
+      /// Element (row,col) of matrix index (unchecked)
+      T& operator()(std::size_t index, uint32_t row, uint32_t col) { return storage.data()[offset(index, row, col)]; };
+
+      /// Element (row,col) of matrix index (unchecked, const)
+      const T& operator()(std::size_t index, uint32_t row, uint32_t col) const { return storage.data()[offset(index, row, col)]; };
+
+      /// Element (row,col) of matrix index (checked)
+      T& at(std::size_t index, uint32_t row, uint32_t col);
+
+      /// Element (row,col) of matrix index (checked, const)
+      const T& at(std::size_t index, uint32_t row, uint32_t col) const;
+
+      /// Copy of matrix index
+      Matrix<T> getMatrix(std::size_t index) const;
+
+      /// Overwrite matrix index (same shape)
+      void setMatrix(std::size_t index, const Matrix<T>& rhs);
+
+
+      //
+      // Operations:
+      //
+
+      /// Same matrices in the other layout
+      MatrixBatch<T> toLayout(BatchLayout _layout) const;
+
+      /// Set every element of every matrix
+      void fill(const T& value) { std::fill(storage.data(), storage.data() + storage.size(), value); };
+
+  }; // MatrixBatch class
+
+
+  //
+  // Template Implementation
+  //
+
+
+  // Default constructor
+  template <typename T>
+  MatrixBatch<T>::MatrixBatch()
+        : count(0),
+          numRows(0),
+          numCols(0),
+          layout(batchInterleaved),
+          stride(0)
+  {
+  }
+
+  // Fill constructor
+  template <typename T>
+  MatrixBatch<T>::MatrixBatch(std::size_t _count, uint32_t _numRows, uint32_t _numCols, BatchLayout _layout, const T& initVal)
+        : count(_count),
+          numRows(_numRows),
+          numCols(_numCols),
+          layout(_layout)
+  {
+    // Interleaved batches hold whole chunks so the kernels never need a remainder:
+    const std::size_t L = lanes();
+    const std::size_t elements = std::size_t(numRows)*numCols;
+    stride = (layout == batchStrided) ? elements : elements*L;
+    storage = AlignedBuffer<T>((layout == batchStrided) ? count*stride : (count + L - 1)/L*stride, initVal);
+  }
+
+  // Matrices constructor
+  template <typename T>
+  MatrixBatch<T>::MatrixBatch(const std::vector<Matrix<T>>& matrices, BatchLayout _layout)
+        : MatrixBatch(matrices.size(),
+                      matrices.empty() ? 0 : matrices[0].getNumRows(),
+                      matrices.empty() ? 0 : matrices[0].getNumCols(),
+                      _layout)
+  {
+    for (std::size_t b=0; b<count; ++b)
+    {
+      setMatrix(b, matrices[b]);
+    }
+  }
+
+  // at
+  template <typename T>
+  T& MatrixBatch<T>::at(std::size_t index, uint32_t row, uint32_t col)
+  {
+    if ( (index >= count) || (row >= numRows) || (col >= numCols) )
+    {
+      throw std::out_of_range("MatrixBatch::at - Indices out of bounds!");
+    }
+    return (*this)(index, row, col);
+  }
+
+  // at (const)
+  template <typename T>
+  const T& MatrixBatch<T>::at(std::size_t index, uint32_t row, uint32_t col) const
+  {
+    if ( (index >= count) || (row >= numRows) || (col >= numCols) )
+    {
+      throw std::out_of_range("MatrixBatch::at - Indices out of bounds!");
+    }
+    return (*this)(index, row, col);
+  }
+
+  // getMatrix
+  template <typename T>
+  Matrix<T> MatrixBatch<T>::getMatrix(std::size_t index) const
+  {
+    if ( index >= count )
+    {
+      throw std::out_of_range("MatrixBatch::getMatrix - Index out of bounds!");
+    }
+
+    Matrix<T> result(numRows, numCols);
+    for (uint32_t i=0; i<numRows; ++i)
+    {
+      for (uint32_t j=0; j<numCols; ++j)
+      {
+        result.data()[std::size_t(i)*result.getLeadingDim() + j] = (*this)(index, i, j);
+      }
+    }
+    return result;
+  }
+
+  // setMatrix
+  template <typename T>
+  void MatrixBatch<T>::setMatrix(std::size_t index, const Matrix<T>& rhs)
+  {
+    if ( index >= count )
+    {
+      throw std::out_of_range("MatrixBatch::setMatrix - Index out of bounds!");
+    }
+    if ( (rhs.getNumRows() != numRows) || (rhs.getNumCols() != numCols) )
+    {
+      throw std::logic_error("MatrixBatch::setMatrix - Matrix does not have the batch's dimensions!");
+    }
+
+    for (uint32_t i=0; i<numRows; ++i)
+    {
+      for (uint32_t j=0; j<numCols; ++j)
+      {
+        (*this)(index, i, j) = rhs.data()[std::size_t(i)*rhs.getLeadingDim() + j];
+      }
+    }
+  }
+
+  // toLayout
+  template <typename T>
+  MatrixBatch<T> MatrixBatch<T>::toLayout(BatchLayout _layout) const
+  {
+    MatrixBatch<T> result(count, numRows, numCols, _layout);
+    const std::size_t elements = std::size_t(numRows)*numCols;
+    const T* src = storage.data();
+    T* dst = result.storage.data();
+
+    if ( _layout == layout )
+    {
+      std::copy(src, src + storage.size(), dst);
+      return result;
+    }
+
+    // A matrix's elements are 1 (strided) or lanes() (interleaved) apart:
+    const std::size_t se = (layout == batchStrided) ? 1 : lanes(), de = (_layout == batchStrided) ? 1 : lanes();
+    parallelFor(0, count, [&](std::size_t lo, std::size_t hi) {
+      for (std::size_t b=lo; b<hi; ++b)
+      {
+        const T* s0 = src + offset(b, 0, 0);
+        T* d0 = dst + result.offset(b, 0, 0);
+        for (std::size_t e=0; e<elements; ++e)
+        {
+          d0[e*de] = s0[e*se];
+        }
+      }
+    }, getParallelThreshold()/(elements + 1) + 1);
+
+    return result;
+  }
+
+
+  /// batchImpl namespace (result handling)
+  namespace batchImpl
+  {
+
+    /// Make c hold count rows x cols matrices in layout, reallocating only if its shape differs
+    template <typename T>
+    void reshape(MatrixBatch<T>& c, std::size_t count, std::size_t rows, std::size_t cols, BatchLayout layout)
+    {
+      if ( (c.getCount() != count) || (c.getNumRows() != rows) || (c.getNumCols() != cols) || (c.getLayout() != layout) )
+      {
+        c = MatrixBatch<T>(count, uint32_t(rows), uint32_t(cols), layout);
+      }
+    }
+
+  } // batchImpl namespace
+
+
+  //
+  // Batch Operations:
+  //
+  // Each operation has a form that writes into a result batch, which only
+  // reallocates when its shape is wrong: in a steady loop the same buffers
+  // are reused and no memory is allocated or faulted in.
+  //
+
+  /// C[b] = A[b]*B[b] for every matrix in the batch (C is reshaped as needed)
+  template <typename T>
+  void batchMultiply(const MatrixBatch<T>& A, const MatrixBatch<T>& B, MatrixBatch<T>& C)
+  {
+    if ( (A.getCount() != B.getCount()) || (A.getLayout() != B.getLayout()) )
+    {
+      throw std::logic_error("batchMultiply - Batches must have the same count and layout!");
+    }
+    if ( A.getNumCols() != B.getNumRows() )
+    {
+      throw std::logic_error("batchMultiply - Matrices' inner dimensions do not match, can not multiply them!");
+    }
+
+    // The result can't overwrite an operand while it is being read:
+    if ( (&C == &A) || (&C == &B) )
+    {
+      MatrixBatch<T> result;
+      batchMultiply(A, B, result);
+      C = std::move(result);
+      return;
+    }
+
+    const std::size_t count = A.getCount(), m = A.getNumRows(), n = B.getNumCols(), k = A.getNumCols();
+    batchImpl::reshape(C, count, m, n, A.getLayout());
+
+    const T* a = A.data();
+    const T* b = B.data();
+    T* c = C.data();
+    const std::size_t sa = A.getStride(), sb = B.getStride(), sc = C.getStride();
+    if ( A.getLayout() == batchInterleaved )
+    {
+      const std::size_t L = MatrixBatch<T>::lanes();
+      parallelFor(0, (count + L - 1)/L, [=](std::size_t lo, std::size_t hi) {
+        for (std::size_t chunk=lo; chunk<hi; ++chunk)
+        {
+          batchImpl::multiplyChunk(m, n, k, a + chunk*sa, b + chunk*sb, c + chunk*sc);
+        }
+      }, getGemmParallelThreshold()/(m*n*k*L + 1) + 1);
+      return;
+    }
+
+    // Strided: each matrix is a row-major block for the GEMM engine:
+    parallelFor(0, count, [=](std::size_t lo, std::size_t hi) {
+      for (std::size_t i=lo; i<hi; ++i)
+      {
+        gemm<T>(m, n, k,
+                T(1), a + i*sa, std::ptrdiff_t(k), 1,
+                      b + i*sb, std::ptrdiff_t(n), 1,
+                T(0), c + i*sc, std::ptrdiff_t(n), 1);
+      }
+    }, getGemmParallelThreshold()/(m*n*k + 1) + 1);
+  }
+
+  /// A[b]*B[b] for every matrix in the batch
+  template <typename T>
+  MatrixBatch<T> batchMultiply(const MatrixBatch<T>& A, const MatrixBatch<T>& B)
+  {
+    MatrixBatch<T> C;
+    batchMultiply(A, B, C);
+    return C;
+  }
+
+  /// X[b] with A[b]*X[b] = B[b] for every matrix in the batch (X may be B)
+  ///
+  /// Gaussian elimination with partial pivoting, vectorized across matrices.
+  /// Strided batches are packed into interleaved chunks on the fly. Throws
+  /// std::logic_error if any matrix in the batch is singular (X is then
+  /// unspecified). Elements must be floating-point or complex.
+  template <typename T>
+  void batchSolve(const MatrixBatch<T>& A, const MatrixBatch<T>& B, MatrixBatch<T>& X)
+  {
+    static_assert(!std::is_integral<T>::value, "batchSolve - Integer elements would be truncated by the elimination!");
+
+    if ( (A.getCount() != B.getCount()) || (A.getLayout() != B.getLayout()) )
+    {
+      throw std::logic_error("batchSolve - Batches must have the same count and layout!");
+    }
+    if ( A.getNumRows() != A.getNumCols() )
+    {
+      throw std::logic_error("batchSolve - Matrices must be square!");
+    }
+    if ( B.getNumRows() != A.getNumRows() )
+    {
+      throw std::logic_error("batchSolve - Right-hand sides must have as many rows as the matrices!");
+    }
+
+    const std::size_t count = A.getCount(), n = A.getNumRows(), r = B.getNumCols();
+    const std::size_t L = MatrixBatch<T>::lanes();
+    const std::size_t grain = getGemmParallelThreshold()/(n*n*(n + r)*L + 1) + 1;
+    std::atomic<bool> singular(false);
+
+    // A is read throughout, so it can't also be the result:
+    if ( &X == &A )
+    {
+      MatrixBatch<T> result;
+      batchSolve(A, B, result);
+      X = std::move(result);
+      return;
+    }
+
+    // B is copied into X a chunk at a time, right before it is solved:
+    batchImpl::reshape(X, count, n, r, A.getLayout());
+    const T* a = A.data();
+    const T* b = B.data();
+    T* x = X.data();
+    const std::size_t sa = A.getStride(), sb = B.getStride(), sx = X.getStride();
+    if ( A.getLayout() == batchInterleaved )
+    {
+      // Factor a copy of each chunk in scratch, solve in place in X:
+      parallelFor(0, (count + L - 1)/L, [&, a, b, x](std::size_t lo, std::size_t hi) {
+        AlignedBuffer<T> pa(n*n*L);
+        for (std::size_t chunk=lo; chunk<hi; ++chunk)
+        {
+          std::copy(a + chunk*sa, a + chunk*sa + n*n*L, pa.data());
+          if ( x != b )
+          {
+            std::copy(b + chunk*sb, b + chunk*sb + n*r*L, x + chunk*sx);
+          }
+          bool flags[MatrixBatch<T>::lanes()] = {};
+          batchImpl::solveChunk(n, r, pa.data(), x + chunk*sx, flags);
+          for (std::size_t v=0; (v<L) && (chunk*L + v<count); ++v)
+          {
+            if ( flags[v] )
+            {
+              singular = true;
+            }
+          }
+        }
+      }, grain);
+    }
+    else
+    {
+      // Pack L matrices at a time into an interleaved chunk and back
+      //  (identities pad the last one):
+      parallelFor(0, (count + L - 1)/L, [&, a, b, x](std::size_t lo, std::size_t hi) {
+        AlignedBuffer<T> pa(n*n*L), px(n*r*L);
+        for (std::size_t chunk=lo; chunk<hi; ++chunk)
+        {
+          for (std::size_t v=0; v<L; ++v)
+          {
+            const std::size_t i = chunk*L + v;
+            for (std::size_t e=0; e<n*n; ++e)
+            {
+              pa.data()[e*L + v] = (i < count) ? a[i*sa + e] : T((e/n == e%n) ? 1 : 0);
+            }
+            for (std::size_t e=0; e<n*r; ++e)
+            {
+              px.data()[e*L + v] = (i < count) ? b[i*sb + e] : T(0);
+            }
+          }
+
+          bool flags[MatrixBatch<T>::lanes()] = {};
+          batchImpl::solveChunk(n, r, pa.data(), px.data(), flags);
+
+          for (std::size_t v=0; (v<L) && (chunk*L + v<count); ++v)
+          {
+            const std::size_t i = chunk*L + v;
+            for (std::size_t e=0; e<n*r; ++e)
+            {
+              x[i*sx + e] = px.data()[e*L + v];
+            }
+            if ( flags[v] )
+            {
+              singular = true;
+            }
+          }
+        }
+      }, grain);
+    }
+
+    if ( singular )
+    {
+      throw std::logic_error("batchSolve - A matrix in the batch is singular!");
+    }
+  }
+
+  /// X[b] with A[b]*X[b] = B[b] for every matrix in the batch
+  template <typename T>
+  MatrixBatch<T> batchSolve(const MatrixBatch<T>& A, const MatrixBatch<T>& B)
+  {
+    MatrixBatch<T> X;
+    batchSolve(A, B, X);
+    return X;
+  }
+
+  /// X[b] = A[b]^-1 for every matrix in the batch (batchSolve against identities)
+  template <typename T>
+  void batchInverse(const MatrixBatch<T>& A, MatrixBatch<T>& X)
+  {
+    if ( &X == &A )
+    {
+      MatrixBatch<T> result;
+      batchInverse(A, result);
+      X = std::move(result);
+      return;
+    }
+
+    batchImpl::reshape(X, A.getCount(), A.getNumRows(), A.getNumRows(), A.getLayout());
+    X.fill(T(0));
+    for (std::size_t b=0; b<X.getCount(); ++b)
+    {
+      for (uint32_t i=0; i<X.getNumRows(); ++i)
+      {
+        X(b, i, i) = T(1);
+      }
+    }
+    batchSolve(A, X, X);
+  }
+
+  /// A[b]^-1 for every matrix in the batch
+  template <typename T>
+  MatrixBatch<T> batchInverse(const MatrixBatch<T>& A)
+  {
+    MatrixBatch<T> X;
+    batchInverse(A, X);
+    return X;
+  }
+
+  /// C[b] = A[b]^T for every matrix in the batch (C is reshaped as needed)
+  template <typename T>
+  void batchTranspose(const MatrixBatch<T>& A, MatrixBatch<T>& C)
+  {
+    if ( &C == &A )
+    {
+      MatrixBatch<T> result;
+      batchTranspose(A, result);
+      C = std::move(result);
+      return;
+    }
+
+    const std::size_t count = A.getCount(), m = A.getNumRows(), n = A.getNumCols();
+    batchImpl::reshape(C, count, n, m, A.getLayout());
+    const T* a = A.data();
+    T* c = C.data();
+
+    const std::size_t sa = A.getStride(), sc = C.getStride();
+    if ( A.getLayout() == batchInterleaved )
+    {
+      // Whole element vectors move, so this is a series of aligned copies:
+      const std::size_t L = MatrixBatch<T>::lanes();
+      parallelFor(0, (count + L - 1)/L, [=](std::size_t lo, std::size_t hi) {
+        for (std::size_t chunk=lo; chunk<hi; ++chunk)
+        {
+          for (std::size_t i=0; i<m; ++i)
+          {
+            for (std::size_t j=0; j<n; ++j)
+            {
+              const T* src = a + chunk*sa + (i*n + j)*L;
+              std::copy(src, src + L, c + chunk*sc + (j*m + i)*L);
+            }
+          }
+        }
+      }, getParallelThreshold()/(m*n*L + 1) + 1);
+      return;
+    }
+
+    parallelFor(0, count, [=](std::size_t lo, std::size_t hi) {
+      for (std::size_t b=lo; b<hi; ++b)
+      {
+        for (std::size_t i=0; i<m; ++i)
+        {
+          for (std::size_t j=0; j<n; ++j)
+          {
+            c[b*sc + j*m + i] = a[b*sa + i*n + j];
+          }
+        }
+      }
+    }, getParallelThreshold()/(m*n + 1) + 1);
+  }
+
+  /// A[b]^T for every matrix in the batch
+  template <typename T>
+  MatrixBatch<T> batchTranspose(const MatrixBatch<T>& A)
+  {
+    MatrixBatch<T> C;
+    batchTranspose(A, C);
+    return C;
+  }
+
+} // matrix namespace
+
+#endif // MATRIX_BATCH_H
@@ -0,0 +1,454 @@
+////////////////////////////////////////
+//
+//  File:
+//      \file MatrixCholesky.hpp
+//
+//  Description:
+//      \brief Matrix Cholesky: Blocked LL^H and LDL^H factorizations of Hermitian matrices
+//
+//  Author:
+//      \author J. Caleb Wherry
+//
+////////////////////////////////////////
+
+// Include Guards:
+#ifndef MATRIX_CHOLESKY_H
+#define MATRIX_CHOLESKY_H
+
+// Forward Declared Dependencies:
+//
+
+// Local Include Dependencies:
+#include "Matrix.hpp"
+#include "MatrixLU.hpp"
+#include "MatrixGemm.hpp"
+#include "MatrixSimd.hpp"
+#include "ThreadPool.hpp"
+
+// Compiler Include Dependencies:
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <complex>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include <algorithm>
+
+/// matrix Namespace
+namespace matrix
+{
+
+  /// Which Cholesky factorization to compute
+  enum CholeskyForm
+  {
+    choleskyLLT,      ///< A = L*L^H (L lower): positive definite matrices only
+    choleskyLDLT      ///< A = L*D*L^H (L unit lower, D real diagonal): no square roots, any nonzero pivots
+  };
+
+
+  /// Cholesky Decomposition class
+  ///
+  /// Factors a Hermitian (real: symmetric) A using only its lower triangle, at
+  /// about half the cost of LU. The factorization is blocked: each panel of
+  /// columns is factored, the rows below it are solved in parallel, and the
+  /// lower half of the trailing matrix is updated with GEMMs. The symmetry of
+  /// A is assumed, not checked. As in LUDecomposition, a pivot no larger than
+  /// n*eps*max|a_ii| counts as zero, so a numerically singular A leaves the
+  /// factorization incomplete.
+  template <typename T>
+  class CholeskyDecomposition
+  {
+
+    private:
+      Matrix<T> factors;        ///< L below the diagonal, L^H mirrored above; the diagonal holds L's (LL^H) or D (LDL^H)
+      CholeskyForm form;        ///< Which factorization
+      bool complete;            ///< Did every pivot qualify?
+      decltype(std::abs(T(0))) tolerance;   ///< Pivots no larger than this count as zero
+
+      /// Factor the columns [k0, k0+kb) of the rows [k0, n); false on a bad pivot
+      bool factorPanel(std::size_t k0, std::size_t kb);
+
+      /// Lower half of A22 -= L21*D1*L21^H for the panel [k0, k0+kb)
+      void updateTrailing(std::size_t k0, std::size_t kb);
+
+      /// Pivot j's weight in the updates (1 for LL^H, d_j for LDL^H)
+      T weight(std::size_t j) const { return (form == choleskyLLT) ? T(1) : factors.data()[j*factors.getLeadingDim() + j]; };
+
+      /// Throw unless the factors are usable
+      void checkComplete(const char* message) const;
+
+    public:
+
+
+      //
+      // Constructors:
+      //
+
+      /// Factoring Constructor
+      explicit CholeskyDecomposition (
+        const Matrix<T>& A,               ///< Square Hermitian matrix to factor (lower triangle read).
+        CholeskyForm form = choleskyLLT   ///< Factorization
+      );
+
+
+      //
+      // Accessors:
+      //
+
+      const Matrix<T>& getFactors() const { return factors; };    ///< Packed factors
+      CholeskyForm getForm() const { return form; };              ///< Factorization computed
+      Matrix<T> getL() const;                                     ///< Lower factor (unit diagonal for LDL^H)
+      std::vector<T> getD() const;                                ///< D's diagonal (all ones for LL^H)
+
+
+      //
+      // Operations:
+      //
+
+      bool isComplete() const { return complete; };   ///< Every pivot above the tolerance (LL^H) or above it in magnitude (LDL^H)?
+      bool isPositiveDefinite() const;                ///< Was A positive definite?
+      T determinant() const;                          ///< det(A)
+      Matrix<T> solve(const Matrix<T>& B) const;      ///< X with A*X = B (any number of columns)
+      std::vector<T> solve(const std::vector<T>& b) const;   ///< x with A*x = b
+      Matrix<T> inverse() const;                      ///< A^-1
+
+  }; // CholeskyDecomposition class
+
+
+  //
+  // Template Implementation
+  //
+
+
+  // Factoring constructor
+  template <typename T>
+  CholeskyDecomposition<T>::CholeskyDecomposition(const Matrix<T>& A, CholeskyForm form)
+        : factors(A),
+          form(form),
+          complete(false),
+          tolerance(0)
+  {
+    typedef decltype(std::abs(T(0))) Real;
+
+    // Only square matrices can be Hermitian:
+    if ( !A.isSquare() )
+    {
+      throw std::logic_error("CholeskyDecomposition::CholeskyDecomposition - Matrix must be square!");
+    }
+
+    // Negligible next to A's largest diagonal element (at working precision):
+    const std::size_t n = A.getNumRows();
+    Real largest = 0;
+    for (uint32_t i=0; i<n; ++i)
+    {
+      largest = std::max(largest, Real(std::abs(A.rowPtr(i)[i])));
+    }
+    tolerance = largest*Real(n)*std::numeric_limits<Real>::epsilon();
+
+    for (std::size_t k0=0; k0<n; k0+=factorBlockSize)
+    {
+      const std::size_t kb = std::min(factorBlockSize, n - k0);
+      if ( !this->factorPanel(k0, kb) )
+      {
+        return;
+      }
+      this->updateTrailing(k0, kb);
+    }
+
+    // Mirror L^H into the upper triangle so both solves run row-major (in
+    //  tiles, so the column reads stay in cache):
+    const std::size_t ld = factors.getLeadingDim();
+    const std::size_t tile = 32;
+    T* a = factors.data();
+    for (std::size_t i0=0; i0<n; i0+=tile)
+    {
+      for (std::size_t j0=i0; j0<n; j0+=tile)
+      {
+        for (std::size_t i=i0; i<std::min(i0 + tile, n); ++i)
+        {
+          for (std::size_t j=std::max(j0, i + 1); j<std::min(j0 + tile, n); ++j)
+          {
+            a[i*ld + j] = conjugate(a[j*ld + i]);
+          }
+        }
+      }
+    }
+
+    complete = true;
+  }
+
+  // factorPanel
+  template <typename T>
+  bool CholeskyDecomposition<T>::factorPanel(std::size_t k0, std::size_t kb)
+  {
+    const std::size_t n = factors.getNumRows();
+    const std::size_t ld = factors.getLeadingDim();
+    const std::size_t end = k0 + kb;
+    T* a = factors.data();
+
+    // Diagonal block, a column at a time. wd row j holds conj(l_jk)*w_k, so
+    //  every update below is a contiguous dot product:
+    std::vector<T> wd(kb*kb);
+    for (std::size_t j=k0; j<end; ++j)
+    {
+      T* wj = wd.data() + (j - k0)*kb;
+
+      // Pivot:
+      T s = a[j*ld + j];
+      for (std::size_t k=k0; k<j; ++k)
+      {
+        s -= a[j*ld + k]*conjugate(a[j*ld + k])*this->weight(k);
+      }
+      const auto d = factorImpl::realPart(s);
+      if ( (form == choleskyLLT) ? !(d > tolerance) : !(std::abs(d) > tolerance) )
+      {
+        return false;
+      }
+      a[j*ld + j] = (form == choleskyLLT) ? T(std::sqrt(d)) : T(d);
+
+      for (std::size_t k=k0; k<j; ++k)
+      {
+        wj[k - k0] = conjugate(a[j*ld + k])*this->weight(k);
+      }
+
+      // Rest of the column inside the block:
+      for (std::size_t i=j+1; i<end; ++i)
+      {
+        T t = a[i*ld + j];
+        for (std::size_t k=k0; k<j; ++k)
+        {
+          t -= a[i*ld + k]*wj[k - k0];
+        }
+        a[i*ld + j] = t/a[j*ld + j];
+      }
+    }
+
+    // Rows below the block solve against it: a GEMM brings each strip of
+    //  columns up to date, then the strip's small triangle is solved per row:
+    const std::size_t strip = 16;
+    for (std::size_t s0=k0; (s0<end) && (end<n); s0+=strip)
+    {
+      const std::size_t sb = std::min(strip, end - s0);
+      if ( s0 > k0 )
+      {
+        gemm<T>(n - end, sb, s0 - k0,
+                T(-1), a + end*ld + k0, ld, 1,
+                       wd.data() + (s0 - k0)*kb, 1, kb,
+                T(1),  a + end*ld + s0, ld, 1);
+      }
+
+      parallelFor(end, n,
+        [=, &wd](std::size_t lo, std::size_t hi) {
+          for (std::size_t i=lo; i<hi; ++i)
+          {
+            T* ai = a + i*ld;
+            for (std::size_t j=s0; j<s0+sb; ++j)
+            {
+              const T* wj = wd.data() + (j - k0)*kb;
+              T t = ai[j];
+              for (std::size_t k=s0; k<j; ++k)
+              {
+                t -= ai[k]*wj[k - k0];
+              }
+              ai[j] = t/a[j*ld + j];
+            }
+          }
+        },
+        getParallelThreshold()/(sb*sb/2 + 1) + 1);
+    }
+
+    return true;
+  }
+
+  // updateTrailing
+  template <typename T>
+  void CholeskyDecomposition<T>::updateTrailing(std::size_t k0, std::size_t kb)
+  {
+    const std::size_t n = factors.getNumRows();
+    const std::size_t ld = factors.getLeadingDim();
+    const std::size_t end = k0 + kb;
+    const std::size_t rest = n - end;
+    T* a = factors.data();
+
+    if ( rest == 0 )
+    {
+      return;
+    }
+
+    // (L21*D1)^H, stored row-major so GEMM reads it with transposed strides:
+    AlignedBuffer<T> w(rest*kb);
+    for (std::size_t i=0; i<rest; ++i)
+    {
+      for (std::size_t k=0; k<kb; ++k)
+      {
+        w.data()[i*kb + k] = conjugate(a[(end + i)*ld + k0 + k])*this->weight(k0 + k);
+      }
+    }
+
+    // Row bands of A22, each only up to the end of its diagonal block (the
+    //  upper half is rebuilt by mirroring, so its overlap is harmless):
+    const std::size_t band = 2*factorBlockSize;
+    for (std::size_t r0=0; r0<rest; r0+=band)
+    {
+      const std::size_t rb = std::min(band, rest - r0);
+      gemm<T>(rb, r0 + rb, kb,
+              T(-1), a + (end + r0)*ld + k0, ld, 1,
+                     w.data(), 1, kb,
+              T(1),  a + (end + r0)*ld + end, ld, 1);
+    }
+  }
+
+  // checkComplete
+  template <typename T>
+  void CholeskyDecomposition<T>::checkComplete(const char* message) const
+  {
+    if ( !complete )
+    {
+      throw std::logic_error(message);
+    }
+  }
+
+  // getL
+  template <typename T>
+  Matrix<T> CholeskyDecomposition<T>::getL() const
+  {
+    this->checkComplete("CholeskyDecomposition::getL - Factorization is incomplete!");
+
+    const uint32_t n = factors.getNumRows();
+    Matrix<T> result(n, n, T(0));
+    for (uint32_t i=0; i<n; ++i)
+    {
+      const T* src = factors.rowPtr(i);
+      T* dst = result.rowPtr(i);
+      std::copy(src, src + i, dst);
+      dst[i] = (form == choleskyLLT) ? src[i] : T(1);
+    }
+
+    return result;
+  }
+
+  // getD
+  template <typename T>
+  std::vector<T> CholeskyDecomposition<T>::getD() const
+  {
+    this->checkComplete("CholeskyDecomposition::getD - Factorization is incomplete!");
+
+    std::vector<T> d(factors.getNumRows(), T(1));
+    if ( form == choleskyLDLT )
+    {
+      for (uint32_t i=0; i<factors.getNumRows(); ++i)
+      {
+        d[i] = factors.rowPtr(i)[i];
+      }
+    }
+
+    return d;
+  }
+
+  // isPositiveDefinite
+  template <typename T>
+  bool CholeskyDecomposition<T>::isPositiveDefinite() const
+  {
+    if ( !complete )
+    {
+      return false;
+    }
+
+    // LL^H only completes for positive definite A; LDL^H needs a positive D:
+    if ( form == choleskyLDLT )
+    {
+      for (uint32_t i=0; i<factors.getNumRows(); ++i)
+      {
+        if ( !(factorImpl::realPart(factors.rowPtr(i)[i]) > 0) )
+        {
+          return false;
+        }
+      }
+    }
+
+    return true;
+  }
+
+  // determinant
+  template <typename T>
+  T CholeskyDecomposition<T>::determinant() const
+  {
+    this->checkComplete("CholeskyDecomposition::determinant - Factorization is incomplete!");
+
+    // det(L*L^H) = prod(l_ii)^2, det(L*D*L^H) = prod(d_i):
+    T det = T(1);
+    for (uint32_t i=0; i<factors.getNumRows(); ++i)
+    {
+      det *= (form == choleskyLLT) ? factors.rowPtr(i)[i]*factors.rowPtr(i)[i] : factors.rowPtr(i)[i];
+    }
+
+    return det;
+  }
+
+  // solve (Matrix)
+  template <typename T>
+  Matrix<T> CholeskyDecomposition<T>::solve(const Matrix<T>& B) const
+  {
+    // Right-hand sides need one row per unknown:
+    if ( B.getNumRows() != factors.getNumRows() )
+    {
+      throw std::logic_error("CholeskyDecomposition::solve - Right-hand side must have as many rows as the matrix!");
+    }
+    this->checkComplete("CholeskyDecomposition::solve - Factorization is incomplete!");
+
+    // L*(D*(L^H*X)) = B:
+    Matrix<T> X = B;
+    const std::size_t n = factors.getNumRows(), nrhs = X.getNumCols();
+    const std::size_t ld = factors.getLeadingDim(), ldx = X.getLeadingDim();
+    const bool unit = (form == choleskyLDLT);
+    factorImpl::solveLower<T>(n, nrhs, factors.data(), ld, X.data(), ldx, unit);
+    if ( unit )
+    {
+      for (std::size_t i=0; i<n; ++i)
+      {
+        simdDivideScalar(X.data() + i*ldx, factors.data()[i*ld + i], X.data() + i*ldx, nrhs);
+      }
+    }
+    factorImpl::solveUpper<T>(n, nrhs, factors.data(), ld, X.data(), ldx, unit);
+
+    return X;
+  }
+
+  // solve (vector)
+  template <typename T>
+  std::vector<T> CholeskyDecomposition<T>::solve(const std::vector<T>& b) const
+  {
+    // Right-hand side needs one element per unknown:
+    if ( b.size() != factors.getNumRows() )
+    {
+      throw std::logic_error("CholeskyDecomposition::solve - Right-hand side must have as many rows as the matrix!");
+    }
+    this->checkComplete("CholeskyDecomposition::solve - Factorization is incomplete!");
+
+    std::vector<T> x = b;
+    const std::size_t n = factors.getNumRows(), ld = factors.getLeadingDim();
+    const bool unit = (form == choleskyLDLT);
+    factorImpl::solveLower<T>(n, 1, factors.data(), ld, x.data(), 1, unit);
+    if ( unit )
+    {
+      for (std::size_t i=0; i<n; ++i)
+      {
+        x[i] /= factors.data()[i*ld + i];
+      }
+    }
+    factorImpl::solveUpper<T>(n, 1, factors.data(), ld, x.data(), 1, unit);
+
+    return x;
+  }
+
+  // inverse
+  template <typename T>
+  Matrix<T> CholeskyDecomposition<T>::inverse() const
+  {
+    return this->solve(factors.identity());
+  }
+
+} // matrix namespace
+
+#endif // MATRIX_CHOLESKY_H
@@ -0,0 +1,160 @@
+////////////////////////////////////////
+//
+//  File:
+//      \file MatrixConjugate.hpp
+//
+//  Description:
+//      \brief Matrix Conjugate: Lazy conjugate and conjugate transpose views
+//
+//  Author:
+//      \author J. Caleb Wherry
+//
+////////////////////////////////////////
+
+// Include Guards:
+#ifndef MATRIX_CONJUGATE_H
+#define MATRIX_CONJUGATE_H
+
+// Forward Declared Dependencies:
+//
+
+// Local Include Dependencies:
+#include "Matrix.hpp"
+
+// Compiler Include Dependencies:
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+
+/// matrix Namespace
+namespace matrix
+{
+
+  /// Conjugate View class
+  ///
+  /// What Matrix::conjugated() and Matrix::adjoint() return: a reference to
+  /// the matrix plus whether it is also transposed. Nothing is copied. In a
+  /// product the conjugation and transposition are folded into the GEMM
+  /// packing (strides and a conjugate flag), so A.adjoint()*B never builds
+  /// A^H; A.adjoint()*A and A*A.adjoint() compute only one triangle of their
+  /// Hermitian result. Elsewhere the view is an expression operand (see
+  /// MatrixExpr.hpp): A.adjoint() + B, A.adjoint() == B and os << A.adjoint()
+  /// read it in place, transpose() flips it without a copy, and other Matrix
+  /// members go through eval(). A view must not outlive the matrix it refers to.
+  template <typename T>
+  class ConjugateView : public MatrixExpr<ConjugateView<T>, T>
+  {
+
+    private:
+      const Matrix<T>& matrix;    ///< Matrix being viewed
+      bool transposed;            ///< Conjugate transpose (true) or plain conjugate (false)
+
+    public:
+
+      /// Constructor
+      ConjugateView(
+        const Matrix<T>& _matrix,   ///< Matrix to view
+        bool _transposed            ///< Also transpose it?
+      ) : matrix(_matrix), transposed(_transposed) {};
+
+      //
+      // Accessors:
+      //
+
+      const Matrix<T>& getMatrix() const { return matrix; };    ///< Matrix being viewed
+      bool isTransposed() const { return transposed; };         ///< Conjugate transpose?
+
+      /// Number of rows of the conjugate (transpose)
+      uint32_t getNumRows() const { return transposed ? matrix.getNumCols() : matrix.getNumRows(); };
+
+      /// Number of columns of the conjugate (transpose)
+      uint32_t getNumCols() const { return transposed ? matrix.getNumRows() : matrix.getNumCols(); };
+
+      /// Transpose of the view (conjugate <-> conjugate transpose, no copy)
+      ConjugateView transpose() const { return ConjugateView(matrix, !transposed); };
+
+      /// Materialize the conjugate (transpose)
+      Matrix<T> eval() const { return transposed ? matrix.conjugateTranspose() : matrix.complexConjugate(); };
+
+
+      //
+      // Expression interface (see MatrixExpr.hpp):
+      //
+
+      /// Elements [lo, lo+n) in row-major order, conjugated into out
+      const T* evalBlock(std::size_t lo, std::size_t n, T* out) const;
+
+      /// Does the view read p?
+      bool references(const T* p) const { return matrix.references(p); };
+
+      /// Does a conjugate transpose read any of [lo, hi)? (it reads elements away from where they land)
+      bool overlaps(const T* lo, const T* hi) const
+      {
+        return transposed && (lo < matrix.data() + std::size_t(matrix.getNumRows())*matrix.getLeadingDim()) && (matrix.data() < hi);
+      }
+
+
+      //
+      // Operators:
+      //
+
+      /// Materialize the conjugate (transpose)
+      operator Matrix<T>() const { return this->eval(); };
+
+      /// Conjugated Matrix/Matrix Multiplication (fused)
+      Matrix<T> operator*(const Matrix<T>& rhs) const
+      {
+        return Matrix<T>::product(matrix, transposed, true, rhs, false, false);
+      }
+
+      /// Conjugated Matrix/Conjugated Matrix Multiplication (fused)
+      Matrix<T> operator*(const ConjugateView<T>& rhs) const
+      {
+        return Matrix<T>::product(matrix, transposed, true, rhs.matrix, rhs.transposed, true);
+      }
+
+  }; // ConjugateView class
+
+
+
+  //
+  // Template Implementation
+  //
+
+  // evalBlock
+  template <typename T>
+  const T* ConjugateView<T>::evalBlock(std::size_t lo, std::size_t n, T* out) const
+  {
+    const std::size_t cols = this->getNumCols();
+    const std::size_t ld = matrix.getLeadingDim();
+    const T* a = matrix.data();
+
+    std::size_t i = (cols == 0) ? 0 : lo/cols, j = (cols == 0) ? 0 : lo%cols;
+    for (std::size_t done=0; done<n; )
+    {
+      const std::size_t len = std::min(n - done, cols - j);
+      if ( transposed )
+      {
+        // Row i of A^H is column i of A:
+        for (std::size_t l=0; l<len; ++l)
+        {
+          out[done + l] = conjugate(a[(j + l)*ld + i]);
+        }
+      }
+      else
+      {
+        for (std::size_t l=0; l<len; ++l)
+        {
+          out[done + l] = conjugate(a[i*ld + j + l]);
+        }
+      }
+      done += len;
+      ++i;
+      j = 0;
+    }
+    return out;
+  }
+
+} // matrix namespace
+
+#endif // MATRIX_CONJUGATE_H
@@ -0,0 +1,168 @@
+////////////////////////////////////////
+//
+//  File:
+//      \file MatrixEigen.hpp
+//
+//  Description:
+//      \brief Matrix Eigen: Symmetric eigendecomposition (cyclic Jacobi)
+//
+//  Author:
+//      \author J. Caleb Wherry
+//
+////////////////////////////////////////
+
+// Include Guards:
+#ifndef MATRIX_EIGEN_H
+#define MATRIX_EIGEN_H
+
+// Forward Declared Dependencies:
+//
+
+// Local Include Dependencies:
+#include "AlignedBuffer.hpp"
+#include "MatrixGemm.hpp"
+
+// Compiler Include Dependencies:
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+
+/// matrix Namespace
+namespace matrix
+{
+
+  /// Eigenvalues and eigenvectors of a real symmetric n x n matrix (cyclic Jacobi)
+  ///
+  /// a (row stride lda) is overwritten: on return its diagonal holds the
+  /// eigenvalues. v (row stride ldv) receives the orthonormal eigenvectors as
+  /// columns, so the input equals v * diag(a) * v^T.
+  template <typename T>
+  void symmetricEigen(std::size_t n, T* a, std::size_t lda, T* v, std::size_t ldv,
+                      unsigned maxSweeps = 50)
+  {
+    // Start from V = I:
+    for (std::size_t i=0; i<n; ++i)
+    {
+      for (std::size_t j=0; j<n; ++j)
+      {
+        v[i*ldv + j] = (i == j) ? T(1) : T(0);
+      }
+    }
+
+    // Converged once the off-diagonal part is negligible next to the whole:
+    T total = 0;
+    for (std::size_t i=0; i<n; ++i)
+    {
+      for (std::size_t j=0; j<n; ++j)
+      {
+        total += a[i*lda + j]*a[i*lda + j];
+      }
+    }
+    const T eps = std::numeric_limits<T>::epsilon();
+    const T tolerance = eps*eps*total;
+
+    for (unsigned sweep=0; sweep<maxSweeps; ++sweep)
+    {
+      T off = 0;
+      for (std::size_t p=0; p<n; ++p)
+      {
+        for (std::size_t q=p+1; q<n; ++q)
+        {
+          off += a[p*lda + q]*a[p*lda + q];
+        }
+      }
+      if ( 2*off <= tolerance )
+      {
+        return;
+      }
+
+      // Annihilate each off-diagonal element in turn with a plane rotation:
+      for (std::size_t p=0; p<n; ++p)
+      {
+        for (std::size_t q=p+1; q<n; ++q)
+        {
+          const T apq = a[p*lda + q];
+          if ( apq == T(0) )
+          {
+            continue;
+          }
+
+          const T theta = (a[q*lda + q] - a[p*lda + p])/(2*apq);
+          const T t = ((theta < 0) ? T(-1) : T(1))/(std::abs(theta) + std::sqrt(theta*theta + 1));
+          const T c = 1/std::sqrt(t*t + 1);
+          const T s = t*c;
+
+          a[p*lda + p] -= t*apq;
+          a[q*lda + q] += t*apq;
+          a[p*lda + q] = 0;
+          a[q*lda + p] = 0;
+
+          for (std::size_t k=0; k<n; ++k)
+          {
+            if ( (k != p) && (k != q) )
+            {
+              const T akp = a[k*lda + p];
+              const T akq = a[k*lda + q];
+              a[k*lda + p] = a[p*lda + k] = c*akp - s*akq;
+              a[k*lda + q] = a[q*lda + k] = s*akp + c*akq;
+            }
+
+            const T vkp = v[k*ldv + p];
+            const T vkq = v[k*ldv + q];
+            v[k*ldv + p] = c*vkp - s*vkq;
+            v[k*ldv + q] = s*vkp + c*vkq;
+          }
+        }
+      }
+    }
+  }
+
+  /// c = a^power for a real symmetric n x n matrix, via a = V*diag(w)*V^T
+  ///
+  /// Costs one eigendecomposition and one GEMM whatever the exponent; the
+  /// result is accurate to rounding, not exact. Returns false for element
+  /// types the decomposition doesn't support.
+  template <typename T>
+  typename std::enable_if<std::is_floating_point<T>::value, bool>::type
+  symmetricPower(std::size_t n, const T* a, std::size_t lda, uint32_t power, T* c, std::size_t ldc)
+  {
+    AlignedBuffer<T> w(n*n), v(n*n), vw(n*n);
+    for (std::size_t i=0; i<n; ++i)
+    {
+      std::copy(a + i*lda, a + i*lda + n, w.data() + i*n);
+    }
+
+    symmetricEigen(n, w.data(), n, v.data(), n);
+
+    // V*diag(w^power), then times V^T (read through transposed strides):
+    for (std::size_t j=0; j<n; ++j)
+    {
+      const T scale = std::pow(w.data()[j*n + j], T(power));
+      for (std::size_t i=0; i<n; ++i)
+      {
+        vw.data()[i*n + j] = v.data()[i*n + j]*scale;
+      }
+    }
+
+    gemm<T>(n, n, n,
+            T(1), vw.data(), n, 1,
+                  v.data(), 1, n,
+            T(0), c, ldc, 1);
+
+    return true;
+  }
+
+  /// Integer and complex element types: not supported
+  template <typename T>
+  typename std::enable_if<!std::is_floating_point<T>::value, bool>::type
+  symmetricPower(std::size_t, const T*, std::size_t, uint32_t, T*, std::size_t)
+  {
+    return false;
+  }
+
+} // matrix namespace
+
+#endif // MATRIX_EIGEN_H
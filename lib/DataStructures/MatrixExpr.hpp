@@ -0,0 +1,512 @@
+////////////////////////////////////////
+//
+//  File:
+//      \file MatrixExpr.hpp
+//
+//  Description:
+//      \brief Matrix Expressions: Lazy, fused element-wise arithmetic
+//
+//  Author:
+//      \author J. Caleb Wherry
+//
+////////////////////////////////////////
+
+// Include Guards:
+#ifndef MATRIX_EXPR_H
+#define MATRIX_EXPR_H
+
+// Forward Declared Dependencies:
+namespace matrix
+{
+  template <typename T> class Matrix;
+}
+
+// Local Include Dependencies:
+#include "AlignedBuffer.hpp"
+#include "MatrixSimd.hpp"
+#include "ThreadPool.hpp"
+
+// Compiler Include Dependencies:
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <algorithm>
+#include <iostream>
+#include <utility>
+
+/// matrix Namespace
+namespace matrix
+{
+
+  /// Elements evaluated per block; intermediates of a fused expression live
+  ///  in block-sized stack buffers that stay in L1
+  const std::size_t exprBlockSize = 256;
+
+  /// Matrix Expression base class (CRTP)
+  ///
+  /// Every element-wise operator on matrices returns a lightweight node that
+  /// records the operation instead of computing it. Nothing is evaluated until
+  /// the node is assigned to (or used to construct) a Matrix, which runs the
+  /// whole expression in a single pass over the destination.
+  ///
+  /// Nodes hold the matrices they read by reference: an expression must not
+  /// outlive its operands, so store results in a Matrix, not in auto.
+  ///
+  /// A node has no Matrix members of its own: eval() gives the Matrix to call
+  /// them on, as in (A + B).eval().sum() or (A - B).eval().transpose().
+  template <typename E, typename T>
+  class MatrixExpr
+  {
+    public:
+      typedef T value_type;   ///< Element type
+
+      /// The concrete expression
+      const E& derived() const { return static_cast<const E&>(*this); };
+
+      /// Evaluate a single element
+      T operator()(const uint32_t& row, const uint32_t& col) const
+      {
+        const E& e = derived();
+
+        // Check range:
+        if ( (row >= e.getNumRows()) ||
+             (col >= e.getNumCols())
+           )
+        {
+          throw std::out_of_range("MatrixExpr::operator() - Indices out of bounds!");
+        }
+
+        T value;
+        return *e.evalBlock(std::size_t(row)*e.getNumCols() + col, 1, &value);
+      }
+
+      /// Evaluate into a Matrix
+      Matrix<T> eval() const { return Matrix<T>(*this); };
+
+    protected:
+      MatrixExpr() {};
+      ~MatrixExpr() {};
+  };
+
+
+  /// exprImpl namespace (expression internals)
+  namespace exprImpl
+  {
+
+    /// Operation tag
+    template <int Op>
+    struct OpTag {};
+
+    /// Non-deduced context, so scalars convert to the element type (1 -> 1.0)
+    template <typename T>
+    struct Identity { typedef T type; };
+
+    /// How a node stores its operand: matrices by reference, nodes by value
+    template <typename E>
+    struct Stored { typedef const E type; };
+
+    template <typename T>
+    struct Stored<Matrix<T>> { typedef const Matrix<T>& type; };
+
+    // Matrix OP Matrix kernels:
+    template <typename T>
+    void apply(OpTag<simd::opAdd>, const T* a, const T* b, T* c, std::size_t n) { simdAdd(a, b, c, n); }
+
+    template <typename T>
+    void apply(OpTag<simd::opSub>, const T* a, const T* b, T* c, std::size_t n) { simdSubtract(a, b, c, n); }
+
+    // Matrix OP scalar kernels:
+    template <typename T>
+    void apply(OpTag<simd::opAdd>, const T* a, const T& s, T* c, std::size_t n) { simdAddScalar(a, s, c, n); }
+
+    template <typename T>
+    void apply(OpTag<simd::opSub>, const T* a, const T& s, T* c, std::size_t n) { simdAddScalar(a, T(-s), c, n); }
+
+    template <typename T>
+    void apply(OpTag<simd::opMul>, const T* a, const T& s, T* c, std::size_t n) { simdMultiplyScalar(a, s, c, n); }
+
+    template <typename T>
+    void apply(OpTag<simd::opDiv>, const T* a, const T& s, T* c, std::size_t n) { simdDivideScalar(a, s, c, n); }
+
+    /// Throw unless both operands have the same shape
+    template <typename L, typename R, typename T>
+    void checkSameSize(const MatrixExpr<L,T>& lhs, const MatrixExpr<R,T>& rhs, const char* message)
+    {
+      if ( (lhs.derived().getNumRows() != rhs.derived().getNumRows()) ||
+           (lhs.derived().getNumCols() != rhs.derived().getNumCols())
+         )
+      {
+        throw std::logic_error(message);
+      }
+    }
+
+    /// A Matrix as-is (no copy)
+    template <typename T>
+    const Matrix<T>& evaluate(const Matrix<T>& m) { return m; }
+
+    /// Any other expression, evaluated into a new Matrix
+    template <typename E, typename T>
+    Matrix<T> evaluate(const MatrixExpr<E,T>& e) { return Matrix<T>(e); }
+
+  } // exprImpl namespace
+
+
+  /// Element-wise node: lhs OP rhs
+  template <typename L, typename R, int Op, typename T>
+  class MatrixBinaryExpr : public MatrixExpr<MatrixBinaryExpr<L,R,Op,T>, T>
+  {
+    private:
+      typename exprImpl::Stored<L>::type lhs;   ///< Left operand
+      typename exprImpl::Stored<R>::type rhs;   ///< Right operand
+
+    public:
+      /// Constructor
+      MatrixBinaryExpr(const L& _lhs, const R& _rhs) : lhs(_lhs), rhs(_rhs) {};
+
+      uint32_t getNumRows() const { return lhs.getNumRows(); };   ///< Row accessor
+      uint32_t getNumCols() const { return lhs.getNumCols(); };   ///< Columns accessor
+
+      /// Evaluate elements [lo, lo+n) into out (or return a pointer to them)
+      const T* evalBlock(std::size_t lo, std::size_t n, T* out) const
+      {
+        alignas(storageAlignment) T scratch[exprBlockSize];
+        const T* a = lhs.evalBlock(lo, n, out);
+        const T* b = rhs.evalBlock(lo, n, scratch);
+        exprImpl::apply(exprImpl::OpTag<Op>(), a, b, out, n);
+        return out;
+      }
+
+      /// Does the expression read from this memory?
+      bool references(const T* p) const { return lhs.references(p) || rhs.references(p); };
+
+      /// Does a view in the expression read memory in [lo, hi)?
+      bool overlaps(const T* lo, const T* hi) const { return lhs.overlaps(lo, hi) || rhs.overlaps(lo, hi); };
+  };
+
+
+  /// Scalar node: expr OP s
+  template <typename E, int Op, typename T>
+  class MatrixScalarExpr : public MatrixExpr<MatrixScalarExpr<E,Op,T>, T>
+  {
+    private:
+      typename exprImpl::Stored<E>::type expr;  ///< Matrix operand
+      T scalar;                                 ///< Scalar operand
+
+    public:
+      /// Constructor
+      MatrixScalarExpr(const E& _expr, const T& _scalar) : expr(_expr), scalar(_scalar) {};
+
+      uint32_t getNumRows() const { return expr.getNumRows(); };  ///< Row accessor
+      uint32_t getNumCols() const { return expr.getNumCols(); };  ///< Columns accessor
+
+      /// Evaluate elements [lo, lo+n) into out (or return a pointer to them)
+      const T* evalBlock(std::size_t lo, std::size_t n, T* out) const
+      {
+        const T* a = expr.evalBlock(lo, n, out);
+        exprImpl::apply(exprImpl::OpTag<Op>(), a, scalar, out, n);
+        return out;
+      }
+
+      /// Does the expression read from this memory?
+      bool references(const T* p) const { return expr.references(p); };
+
+      /// Does a view in the expression read memory in [lo, hi)?
+      bool overlaps(const T* lo, const T* hi) const { return expr.overlaps(lo, hi); };
+  };
+
+
+  /// Negation node: -expr
+  template <typename E, typename T>
+  class MatrixNegateExpr : public MatrixExpr<MatrixNegateExpr<E,T>, T>
+  {
+    private:
+      typename exprImpl::Stored<E>::type expr;  ///< Matrix operand
+
+    public:
+      /// Constructor
+      explicit MatrixNegateExpr(const E& _expr) : expr(_expr) {};
+
+      uint32_t getNumRows() const { return expr.getNumRows(); };  ///< Row accessor
+      uint32_t getNumCols() const { return expr.getNumCols(); };  ///< Columns accessor
+
+      /// Evaluate elements [lo, lo+n) into out (or return a pointer to them)
+      const T* evalBlock(std::size_t lo, std::size_t n, T* out) const
+      {
+        const T* a = expr.evalBlock(lo, n, out);
+        simdNegate(a, out, n);
+        return out;
+      }
+
+      /// Does the expression read from this memory?
+      bool references(const T* p) const { return expr.references(p); };
+
+      /// Does a view in the expression read memory in [lo, hi)?
+      bool overlaps(const T* lo, const T* hi) const { return expr.overlaps(lo, hi); };
+  };
+
+
+  /// Evaluate an expression into n contiguous elements at dst in one fused pass
+  ///
+  /// When dst is also read by the expression, each block is computed into a
+  /// scratch buffer first so no element is overwritten before it is read.
+  /// A view that reads dst at other positions gets a whole temporary instead.
+  template <typename E, typename T>
+  void evaluateInto(const MatrixExpr<E,T>& expr, T* dst, std::size_t n)
+  {
+    const E& e = expr.derived();
+    if ( e.overlaps(dst, dst + n) )
+    {
+      AlignedBuffer<T> temp(n);
+      evaluateInto(expr, temp.data(), n);
+      std::copy(temp.data(), temp.data() + n, dst);
+      return;
+    }
+
+    const bool aliased = e.references(dst);
+
+    parallelFor(0, n, [&](std::size_t lo, std::size_t hi) {
+      alignas(storageAlignment) T scratch[exprBlockSize];
+
+      for (std::size_t b=lo; b<hi; b+=exprBlockSize)
+      {
+        const std::size_t len = std::min(exprBlockSize, hi - b);
+        T* out = aliased ? scratch : dst + b;
+        const T* result = e.evalBlock(b, len, out);
+        if ( result != dst + b )
+        {
+          std::copy(result, result + len, dst + b);
+        }
+      }
+    });
+  }
+
+
+  /// Update n contiguous elements at dst in place: dst = dst OP expr
+  ///
+  /// Each block of the expression is computed into scratch before dst is
+  /// written, so expressions that read dst (A += A*2.0) need no special case.
+  /// Views that read dst at other positions are evaluated into a temporary.
+  template <int Op, typename E, typename T>
+  void updateInto(const MatrixExpr<E,T>& expr, T* dst, std::size_t n)
+  {
+    const E& e = expr.derived();
+    if ( e.overlaps(dst, dst + n) )
+    {
+      AlignedBuffer<T> temp(n);
+      evaluateInto(expr, temp.data(), n);
+      parallelFor(0, n, [&](std::size_t lo, std::size_t hi) {
+        exprImpl::apply(exprImpl::OpTag<Op>(), dst + lo, temp.data() + lo, dst + lo, hi - lo);
+      });
+      return;
+    }
+
+    parallelFor(0, n, [&](std::size_t lo, std::size_t hi) {
+      alignas(storageAlignment) T scratch[exprBlockSize];
+
+      for (std::size_t b=lo; b<hi; b+=exprBlockSize)
+      {
+        const std::size_t len = std::min(exprBlockSize, hi - b);
+        exprImpl::apply(exprImpl::OpTag<Op>(), dst + b, e.evalBlock(b, len, scratch), dst + b, len);
+      }
+    });
+  }
+
+  /// Update n contiguous elements at dst in place: dst = dst OP s
+  template <int Op, typename T>
+  void updateInto(const T& s, T* dst, std::size_t n)
+  {
+    parallelFor(0, n, [&](std::size_t lo, std::size_t hi) {
+      exprImpl::apply(exprImpl::OpTag<Op>(), dst + lo, s, dst + lo, hi - lo);
+    });
+  }
+
+
+  //
+  // Operators:
+  //
+
+  /// Matrix/Matrix Addition
+  template <typename L, typename R, typename T>
+  MatrixBinaryExpr<L,R,simd::opAdd,T> operator+(const MatrixExpr<L,T>& lhs, const MatrixExpr<R,T>& rhs)
+  {
+    exprImpl::checkSameSize(lhs, rhs, "Matrix::operator+ (Matrix/Matrix) - Matrices must be the same size!");
+    return MatrixBinaryExpr<L,R,simd::opAdd,T>(lhs.derived(), rhs.derived());
+  }
+
+  /// Matrix/Matrix Subtraction
+  template <typename L, typename R, typename T>
+  MatrixBinaryExpr<L,R,simd::opSub,T> operator-(const MatrixExpr<L,T>& lhs, const MatrixExpr<R,T>& rhs)
+  {
+    exprImpl::checkSameSize(lhs, rhs, "Matrix::operator- (Matrix/Matrix) - Matrices must be the same size!");
+    return MatrixBinaryExpr<L,R,simd::opSub,T>(lhs.derived(), rhs.derived());
+  }
+
+  /// Matrix/Scalar Multiplication
+  template <typename E, typename T>
+  MatrixScalarExpr<E,simd::opMul,T> operator*(const MatrixExpr<E,T>& lhs, const typename exprImpl::Identity<T>::type& rhs)
+  {
+    return MatrixScalarExpr<E,simd::opMul,T>(lhs.derived(), rhs);
+  }
+
+  /// Matrix/Scalar Division
+  template <typename E, typename T>
+  MatrixScalarExpr<E,simd::opDiv,T> operator/(const MatrixExpr<E,T>& lhs, const typename exprImpl::Identity<T>::type& rhs)
+  {
+    // Check for division by zero:
+    if ( rhs == T(0) )
+    {
+      throw std::logic_error("Matrix::operator/ (Matrix/Scalar) - Can't divide by zero!");
+    }
+
+    return MatrixScalarExpr<E,simd::opDiv,T>(lhs.derived(), rhs);
+  }
+
+  /// Matrix/Scalar Addition
+  template <typename E, typename T>
+  MatrixScalarExpr<E,simd::opAdd,T> operator+(const MatrixExpr<E,T>& lhs, const typename exprImpl::Identity<T>::type& rhs)
+  {
+    return MatrixScalarExpr<E,simd::opAdd,T>(lhs.derived(), rhs);
+  }
+
+  /// Matrix/Scalar Subtraction
+  template <typename E, typename T>
+  MatrixScalarExpr<E,simd::opSub,T> operator-(const MatrixExpr<E,T>& lhs, const typename exprImpl::Identity<T>::type& rhs)
+  {
+    return MatrixScalarExpr<E,simd::opSub,T>(lhs.derived(), rhs);
+  }
+
+  /// Matrix Negative
+  template <typename E, typename T>
+  MatrixNegateExpr<E,T> operator-(const MatrixExpr<E,T>& rhs)
+  {
+    return MatrixNegateExpr<E,T>(rhs.derived());
+  }
+
+
+  //
+  // Operators on temporaries: the result is computed in the temporary's buffer
+  //  and moved out, so chains like (A*B + C)*2.0 allocate only for the product.
+  //
+
+  /// Matrix/Matrix Addition (temporary lhs)
+  template <typename R, typename T>
+  Matrix<T> operator+(Matrix<T>&& lhs, const MatrixExpr<R,T>& rhs)
+  {
+    exprImpl::checkSameSize(lhs, rhs, "Matrix::operator+ (Matrix/Matrix) - Matrices must be the same size!");
+    lhs += rhs;
+    return std::move(lhs);
+  }
+
+  /// Matrix/Matrix Addition (temporary rhs)
+  template <typename L, typename T>
+  Matrix<T> operator+(const MatrixExpr<L,T>& lhs, Matrix<T>&& rhs)
+  {
+    exprImpl::checkSameSize(lhs, rhs, "Matrix::operator+ (Matrix/Matrix) - Matrices must be the same size!");
+    rhs += lhs;
+    return std::move(rhs);
+  }
+
+  /// Matrix/Matrix Addition (both temporary)
+  template <typename T>
+  Matrix<T> operator+(Matrix<T>&& lhs, Matrix<T>&& rhs)
+  {
+    return std::move(lhs) + static_cast<const Matrix<T>&>(rhs);
+  }
+
+  /// Matrix/Matrix Subtraction (temporary lhs)
+  template <typename R, typename T>
+  Matrix<T> operator-(Matrix<T>&& lhs, const MatrixExpr<R,T>& rhs)
+  {
+    exprImpl::checkSameSize(lhs, rhs, "Matrix::operator- (Matrix/Matrix) - Matrices must be the same size!");
+    lhs -= rhs;
+    return std::move(lhs);
+  }
+
+  /// Matrix/Matrix Subtraction (temporary rhs)
+  template <typename L, typename T>
+  Matrix<T> operator-(const MatrixExpr<L,T>& lhs, Matrix<T>&& rhs)
+  {
+    exprImpl::checkSameSize(lhs, rhs, "Matrix::operator- (Matrix/Matrix) - Matrices must be the same size!");
+    rhs = lhs.derived() - static_cast<const Matrix<T>&>(rhs);
+    return std::move(rhs);
+  }
+
+  /// Matrix/Matrix Subtraction (both temporary)
+  template <typename T>
+  Matrix<T> operator-(Matrix<T>&& lhs, Matrix<T>&& rhs)
+  {
+    return std::move(lhs) - static_cast<const Matrix<T>&>(rhs);
+  }
+
+  /// Matrix/Scalar Multiplication (temporary lhs)
+  template <typename T>
+  Matrix<T> operator*(Matrix<T>&& lhs, const typename exprImpl::Identity<T>::type& rhs)
+  {
+    lhs *= rhs;
+    return std::move(lhs);
+  }
+
+  /// Matrix/Scalar Division (temporary lhs)
+  template <typename T>
+  Matrix<T> operator/(Matrix<T>&& lhs, const typename exprImpl::Identity<T>::type& rhs)
+  {
+    lhs /= rhs;
+    return std::move(lhs);
+  }
+
+  /// Matrix/Scalar Addition (temporary lhs)
+  template <typename T>
+  Matrix<T> operator+(Matrix<T>&& lhs, const typename exprImpl::Identity<T>::type& rhs)
+  {
+    lhs += rhs;
+    return std::move(lhs);
+  }
+
+  /// Matrix/Scalar Subtraction (temporary lhs)
+  template <typename T>
+  Matrix<T> operator-(Matrix<T>&& lhs, const typename exprImpl::Identity<T>::type& rhs)
+  {
+    lhs -= rhs;
+    return std::move(lhs);
+  }
+
+  /// Matrix Negative (temporary)
+  template <typename T>
+  Matrix<T> operator-(Matrix<T>&& rhs)
+  {
+    T* a = rhs.data();
+    parallelFor(0, std::size_t(rhs.getNumRows())*rhs.getNumCols(), [=](std::size_t lo, std::size_t hi) {
+      simdNegate(a + lo, a + lo, hi - lo);
+    });
+    return std::move(rhs);
+  }
+
+
+  /// Matrix/Matrix Multiplication of expressions (operands evaluated first)
+  template <typename L, typename R, typename T>
+  Matrix<T> operator*(const MatrixExpr<L,T>& lhs, const MatrixExpr<R,T>& rhs)
+  {
+    const Matrix<T>& a = exprImpl::evaluate(lhs.derived());
+    const Matrix<T>& b = exprImpl::evaluate(rhs.derived());
+    return a * b;
+  }
+
+  /// Matrix Comparison of expressions
+  template <typename L, typename R, typename T>
+  bool operator==(const MatrixExpr<L,T>& lhs, const MatrixExpr<R,T>& rhs)
+  {
+    const Matrix<T>& a = exprImpl::evaluate(lhs.derived());
+    const Matrix<T>& b = exprImpl::evaluate(rhs.derived());
+    return a == b;
+  }
+
+  /// Display of an expression (evaluated first)
+  template <typename E, typename T>
+  std::ostream& operator<<(std::ostream& os, const MatrixExpr<E,T>& rhs)
+  {
+    return os << exprImpl::evaluate(rhs.derived());
+  }
+
+} // matrix namespace
+
+#endif // MATRIX_EXPR_H
@@ -0,0 +1,602 @@
+////////////////////////////////////////
+//
+//  File:
+//      \file MatrixFile.hpp
+//
+//  Description:
+//      \brief Matrix File: Versioned binary format, streaming writer, mapped loader
+//
+//  Author:
+//      \author J. Caleb Wherry
+//
+////////////////////////////////////////
+
+// Include Guards:
+#ifndef MATRIX_FILE_H
+#define MATRIX_FILE_H
+
+// Forward Declared Dependencies:
+//
+
+// Local Include Dependencies:
+#include "Matrix.hpp"
+#include "AlignedBuffer.hpp"
+#include "CpuFeatures.hpp"
+
+// Compiler Include Dependencies:
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <complex>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#if !defined(_WIN32)
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+/// matrix Namespace
+namespace matrix
+{
+
+  //
+  // File layout (all fields little-endian):
+  //
+  //   [0, 64)                 MatrixFileHeader
+  //   [payloadOffset, ...)    rows*cols elements, row-major, payloadOffset a
+  //                           multiple of storageAlignment
+  //
+  // The header carries a CRC-32C of itself and one of the payload, so a
+  // truncated or corrupted file is caught before any element is used.
+  //
+
+  /// Current version of the matrix file format
+  const uint32_t matrixFileVersion = 1;
+
+  /// Element type codes stored in the header
+  enum MatrixElementType
+  {
+    elementFloat32    = 1,    ///< float
+    elementFloat64    = 2,    ///< double
+    elementComplex64  = 3,    ///< std::complex<float>
+    elementComplex128 = 4,    ///< std::complex<double>
+    elementInt32      = 5,    ///< int32_t
+    elementInt64      = 6     ///< int64_t
+  };
+
+  /// Element layout codes stored in the header
+  enum MatrixLayout
+  {
+    layoutRowMajor = 0        ///< Element (i,j) at index i*cols + j
+  };
+
+  /// Element type code of T (only the types above can be stored)
+  template <typename T> struct MatrixFileType;
+  template <> struct MatrixFileType<float>                { static const uint32_t code = elementFloat32; };
+  template <> struct MatrixFileType<double>               { static const uint32_t code = elementFloat64; };
+  template <> struct MatrixFileType<std::complex<float>>  { static const uint32_t code = elementComplex64; };
+  template <> struct MatrixFileType<std::complex<double>> { static const uint32_t code = elementComplex128; };
+  template <> struct MatrixFileType<int32_t>              { static const uint32_t code = elementInt32; };
+  template <> struct MatrixFileType<int64_t>              { static const uint32_t code = elementInt64; };
+
+  /// Matrix file header (64 bytes, at the start of the file)
+  struct MatrixFileHeader
+  {
+    char magic[8];              ///< "CPPMATRX"
+    uint32_t version;           ///< Format version that wrote the file
+    uint32_t headerBytes;       ///< sizeof(MatrixFileHeader)
+    uint32_t elementType;       ///< MatrixElementType
+    uint32_t elementBytes;      ///< Size of one element
+    uint64_t rows;              ///< Number of rows
+    uint64_t cols;              ///< Number of columns
+    uint32_t layout;            ///< MatrixLayout
+    uint32_t payloadChecksum;   ///< CRC-32C of the payload
+    uint64_t payloadOffset;     ///< Byte offset of the first element
+    uint32_t headerChecksum;    ///< CRC-32C of this header with this field zeroed
+    uint32_t reserved;          ///< Zero
+  };
+
+  static_assert(sizeof(MatrixFileHeader) == 64, "MatrixFileHeader must be 64 bytes");
+
+
+  /// fileImpl namespace (format internals)
+  namespace fileImpl
+  {
+
+    /// Magic bytes opening every matrix file
+    const char magic[8] = { 'C', 'P', 'P', 'M', 'A', 'T', 'R', 'X' };
+
+    /// Bytes moved per read or write call
+    const std::size_t chunkBytes = std::size_t(1) << 22;
+
+    /// Does the host store integers little-endian (the file's byte order)?
+    inline bool hostIsLittleEndian()
+    {
+      const uint32_t probe = 1;
+      unsigned char first;
+      std::memcpy(&first, &probe, 1);
+      return first == 1;
+    }
+
+    /// CRC-32C (Castagnoli, reflected) lookup table
+    inline const uint32_t* crcTable()
+    {
+      static const std::vector<uint32_t> table = []() {
+        std::vector<uint32_t> t(256);
+        for (uint32_t i=0; i<256; ++i)
+        {
+          uint32_t c = i;
+          for (int k=0; k<8; ++k)
+          {
+            c = (c & 1) ? (c >> 1) ^ 0x82F63B78u : (c >> 1);
+          }
+          t[i] = c;
+        }
+        return t;
+      }();
+
+      return table.data();
+    }
+
+    /// Table-driven CRC-32C update (crc is the running, inverted value)
+    inline uint32_t crcScalar(uint32_t crc, const unsigned char* p, std::size_t n)
+    {
+      const uint32_t* table = crcTable();
+      for (std::size_t i=0; i<n; ++i)
+      {
+        crc = table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+      }
+      return crc;
+    }
+
+#if MATRIX_X86_DISPATCH
+
+    /// CRC-32C update with the SSE4.2 instruction, 8 bytes at a time
+    __attribute__((target("sse4.2")))
+    inline uint32_t crcSse42(uint32_t crc, const unsigned char* p, std::size_t n)
+    {
+      uint64_t c = crc;
+      std::size_t i = 0;
+      for (; i+8<=n; i+=8)
+      {
+        uint64_t word;
+        std::memcpy(&word, p + i, 8);
+        c = _mm_crc32_u64(c, word);
+      }
+      return crcScalar(uint32_t(c), p + i, n - i);
+    }
+
+#endif // MATRIX_X86_DISPATCH
+
+    /// Throw a runtime_error naming the file
+    inline void fail(const std::string& where, const std::string& path, const std::string& what)
+    {
+      throw std::runtime_error(where + " - " + what + " (" + path + ")!");
+    }
+
+    /// Header for a rows x cols matrix of T (checksums still zero)
+    template <typename T>
+    MatrixFileHeader makeHeader(uint32_t rows, uint32_t cols)
+    {
+      MatrixFileHeader header;
+      std::memset(&header, 0, sizeof(header));
+      std::memcpy(header.magic, magic, sizeof(magic));
+      header.version = matrixFileVersion;
+      header.headerBytes = sizeof(MatrixFileHeader);
+      header.elementType = MatrixFileType<T>::code;
+      header.elementBytes = sizeof(T);
+      header.rows = rows;
+      header.cols = cols;
+      header.layout = layoutRowMajor;
+      header.payloadOffset = sizeof(MatrixFileHeader);
+      return header;
+    }
+
+  } // fileImpl namespace
+
+
+  /// Running CRC-32C of n bytes (pass the previous result to continue, 0 to start)
+  inline uint32_t crc32c(uint32_t crc, const void* data, std::size_t n)
+  {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+#if MATRIX_X86_DISPATCH
+    if ( cpuFeatures().sse42 )
+    {
+      return ~fileImpl::crcSse42(~crc, p, n);
+    }
+#endif
+    return ~fileImpl::crcScalar(~crc, p, n);
+  }
+
+  /// Check a header read from a file of fileBytes bytes, for element type T
+  ///
+  /// Throws std::runtime_error naming the first problem: bad magic, unknown
+  /// version, damaged header, wrong element type, unsupported layout, a shape
+  /// Matrix can't hold, or a payload running past the end of the file.
+  template <typename T>
+  void checkMatrixFileHeader(const MatrixFileHeader& header, uint64_t fileBytes, const std::string& path)
+  {
+    const std::string where = "MatrixFile::checkHeader";
+
+    if ( std::memcmp(header.magic, fileImpl::magic, sizeof(fileImpl::magic)) != 0 )
+    {
+      fileImpl::fail(where, path, "Not a matrix file");
+    }
+    if ( (header.version == 0) || (header.version > matrixFileVersion) )
+    {
+      fileImpl::fail(where, path, "Unsupported format version " + std::to_string(header.version));
+    }
+
+    MatrixFileHeader copy = header;
+    copy.headerChecksum = 0;
+    if ( crc32c(0, &copy, sizeof(copy)) != header.headerChecksum )
+    {
+      fileImpl::fail(where, path, "Header checksum mismatch");
+    }
+
+    if ( (header.elementType != MatrixFileType<T>::code) || (header.elementBytes != sizeof(T)) )
+    {
+      fileImpl::fail(where, path, "Element type does not match");
+    }
+    if ( header.layout != layoutRowMajor )
+    {
+      fileImpl::fail(where, path, "Unsupported layout");
+    }
+    if ( (header.rows > UINT32_MAX) || (header.cols > UINT32_MAX) )
+    {
+      fileImpl::fail(where, path, "Dimensions too large");
+    }
+    if ( (header.payloadOffset < sizeof(MatrixFileHeader)) || (header.payloadOffset % storageAlignment != 0) )
+    {
+      fileImpl::fail(where, path, "Misaligned payload");
+    }
+
+    // rows*cols*sizeof(T) must not wrap, or a crafted header would pass the length check:
+    if ( (header.rows != 0) && (header.cols > UINT64_MAX/sizeof(T)/header.rows) )
+    {
+      fileImpl::fail(where, path, "Dimensions too large");
+    }
+
+    const uint64_t payloadBytes = header.rows*header.cols*sizeof(T);
+    if ( (header.payloadOffset > fileBytes) || (fileBytes - header.payloadOffset < payloadBytes) )
+    {
+      fileImpl::fail(where, path, "File is truncated");
+    }
+  }
+
+
+  /// Matrix File Writer class
+  ///
+  /// Streams a rows x cols matrix to disk a block of rows at a time, so a
+  /// matrix never has to exist in memory all at once. The payload checksum is
+  /// accumulated on the way out and the header is rewritten with it by close().
+  template <typename T>
+  class MatrixFileWriter
+  {
+
+    private:
+      std::FILE* file;                  ///< Open file (null once closed)
+      std::string path;                 ///< Where the file lives
+      MatrixFileHeader header;          ///< Header, completed by close()
+      uint64_t rowsWritten;             ///< Rows streamed out so far
+      uint32_t checksum;                ///< Running payload CRC-32C
+
+      /// Write n bytes or throw
+      void put(const void* bytes, std::size_t n);
+
+    public:
+
+
+      //
+      // Constructors:
+      //
+
+      /// Opening Constructor (creates or truncates the file)
+      MatrixFileWriter (
+        const std::string& _path,       ///< File to write.
+        uint32_t rows,                  ///< Rows the matrix will have.
+        uint32_t cols                   ///< Columns the matrix will have.
+      );
+
+      /// Deconstructor (closes the file if close() wasn't called; errors are dropped)
+      ~MatrixFileWriter();
+
+      MatrixFileWriter(const MatrixFileWriter&) = delete;
+      MatrixFileWriter& operator=(const MatrixFileWriter&) = delete;
+
+
+      //
+      // Operations:
+      //
+
+      /// Append count packed rows (count*cols elements)
+      void writeRows(const T* rows, std::size_t count);
+
+      /// Append every row of block (it must have the file's column count)
+      void writeRows(const Matrix<T>& block);
+
+      /// Finish the file: every row must have been written
+      void close();
+
+      uint64_t getRowsWritten() const { return rowsWritten; };   ///< Rows streamed out so far
+
+  }; // MatrixFileWriter class
+
+
+  //
+  // Template Implementation
+  //
+
+
+  // Opening constructor
+  template <typename T>
+  MatrixFileWriter<T>::MatrixFileWriter(const std::string& _path, uint32_t rows, uint32_t cols)
+        : file(nullptr),
+          path(_path),
+          header(fileImpl::makeHeader<T>(rows, cols)),
+          rowsWritten(0),
+          checksum(0)
+  {
+    if ( !fileImpl::hostIsLittleEndian() )
+    {
+      fileImpl::fail("MatrixFileWriter::MatrixFileWriter", path, "Big-endian hosts are not supported");
+    }
+
+    file = std::fopen(path.c_str(), "wb");
+    if ( file == nullptr )
+    {
+      fileImpl::fail("MatrixFileWriter::MatrixFileWriter", path, "Cannot open file for writing");
+    }
+
+    // Placeholder header; close() rewrites it with the checksums:
+    this->put(&header, sizeof(header));
+  }
+
+  // Destructor
+  template <typename T>
+  MatrixFileWriter<T>::~MatrixFileWriter()
+  {
+    if ( file != nullptr )
+    {
+      std::fclose(file);
+    }
+  }
+
+  // put
+  template <typename T>
+  void MatrixFileWriter<T>::put(const void* bytes, std::size_t n)
+  {
+    if ( std::fwrite(bytes, 1, n, file) != n )
+    {
+      fileImpl::fail("MatrixFileWriter::writeRows", path, "Write failed");
+    }
+  }
+
+  // writeRows (raw)
+  template <typename T>
+  void MatrixFileWriter<T>::writeRows(const T* rows, std::size_t count)
+  {
+    if ( file == nullptr )
+    {
+      throw std::logic_error("MatrixFileWriter::writeRows - File is already closed!");
+    }
+    if ( count > header.rows - rowsWritten )
+    {
+      throw std::logic_error("MatrixFileWriter::writeRows - More rows than the matrix has!");
+    }
+
+    // Checksum and write in chunks, while each chunk is still in cache:
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(rows);
+    const std::size_t total = count*header.cols*sizeof(T);
+    for (std::size_t done=0; done<total; done+=fileImpl::chunkBytes)
+    {
+      const std::size_t n = std::min(fileImpl::chunkBytes, total - done);
+      checksum = crc32c(checksum, bytes + done, n);
+      this->put(bytes + done, n);
+    }
+    rowsWritten += count;
+  }
+
+  // writeRows (Matrix)
+  template <typename T>
+  void MatrixFileWriter<T>::writeRows(const Matrix<T>& block)
+  {
+    if ( block.getNumCols() != header.cols )
+    {
+      throw std::logic_error("MatrixFileWriter::writeRows - Column count does not match!");
+    }
+
+    // Owned matrices are packed, so the rows are one run of elements:
+    this->writeRows(block.data(), block.getNumRows());
+  }
+
+  // close
+  template <typename T>
+  void MatrixFileWriter<T>::close()
+  {
+    if ( file == nullptr )
+    {
+      return;
+    }
+    if ( rowsWritten != header.rows )
+    {
+      throw std::logic_error("MatrixFileWriter::close - Not every row was written!");
+    }
+
+    // Complete the header and write it over the placeholder:
+    header.payloadChecksum = checksum;
+    header.headerChecksum = 0;
+    header.headerChecksum = crc32c(0, &header, sizeof(header));
+
+    const bool ok = (std::fflush(file) == 0) &&
+                    (std::fseek(file, 0, SEEK_SET) == 0) &&
+                    (std::fwrite(&header, 1, sizeof(header), file) == sizeof(header));
+    const bool closed = (std::fclose(file) == 0);
+    file = nullptr;
+
+    if ( !ok || !closed )
+    {
+      fileImpl::fail("MatrixFileWriter::close", path, "Write failed");
+    }
+  }
+
+
+  /// Write A to path in the binary matrix format
+  template <typename T>
+  void saveMatrix(const Matrix<T>& A, const std::string& path)
+  {
+    MatrixFileWriter<T> writer(path, A.getNumRows(), A.getNumCols());
+    writer.writeRows(A);
+    writer.close();
+  }
+
+  /// Read a matrix file into a newly allocated Matrix, verifying the payload checksum
+  template <typename T>
+  Matrix<T> loadMatrix(const std::string& path)
+  {
+    const std::string where = "MatrixFile::loadMatrix";
+
+    if ( !fileImpl::hostIsLittleEndian() )
+    {
+      fileImpl::fail(where, path, "Big-endian hosts are not supported");
+    }
+
+    std::unique_ptr<std::FILE, int(*)(std::FILE*)> file(std::fopen(path.c_str(), "rb"), &std::fclose);
+    if ( !file )
+    {
+      fileImpl::fail(where, path, "Cannot open file");
+    }
+
+    MatrixFileHeader header;
+    if ( (std::fseek(file.get(), 0, SEEK_END) != 0) )
+    {
+      fileImpl::fail(where, path, "Cannot size file");
+    }
+    const long end = std::ftell(file.get());
+    if ( (end < 0) || (std::fseek(file.get(), 0, SEEK_SET) != 0) ||
+         (std::fread(&header, 1, sizeof(header), file.get()) != sizeof(header)) )
+    {
+      fileImpl::fail(where, path, "File is truncated");
+    }
+    checkMatrixFileHeader<T>(header, uint64_t(end), path);
+
+    // Every element is read in, so skip initializing them:
+    AlignedBuffer<T> buffer(std::size_t(header.rows*header.cols));
+    unsigned char* bytes = reinterpret_cast<unsigned char*>(buffer.data());
+    const std::size_t total = buffer.size()*sizeof(T);
+    uint32_t checksum = 0;
+    if ( std::fseek(file.get(), long(header.payloadOffset), SEEK_SET) != 0 )
+    {
+      fileImpl::fail(where, path, "File is truncated");
+    }
+    for (std::size_t done=0; done<total; done+=fileImpl::chunkBytes)
+    {
+      const std::size_t n = std::min(fileImpl::chunkBytes, total - done);
+      if ( std::fread(bytes + done, 1, n, file.get()) != n )
+      {
+        fileImpl::fail(where, path, "File is truncated");
+      }
+      checksum = crc32c(checksum, bytes + done, n);
+    }
+
+    if ( checksum != header.payloadChecksum )
+    {
+      fileImpl::fail(where, path, "Payload checksum mismatch");
+    }
+
+    return Matrix<T>(uint32_t(header.rows), uint32_t(header.cols), std::move(buffer));
+  }
+
+  /// Map a matrix file into memory and return a Matrix over it (zero-copy)
+  ///
+  /// Nothing is read up front: the elements page in from the file as they are
+  /// touched, so even a huge matrix is usable at once. The mapping is private
+  /// copy-on-write, so the file is never modified; a page written through the
+  /// Matrix becomes a private copy. The header is always checked; the payload
+  /// checksum (one pass over all elements) only when verify is set. Copies of
+  /// the Matrix are ordinary allocated matrices; the mapping goes away with
+  /// the last Matrix using it. Where mmap isn't available the file is read
+  /// with loadMatrix().
+  template <typename T>
+  Matrix<T> mapMatrix(const std::string& path, bool verify = false)
+  {
+#if defined(_WIN32)
+    (void)verify;
+    return loadMatrix<T>(path);
+#else
+    const std::string where = "MatrixFile::mapMatrix";
+
+    if ( !fileImpl::hostIsLittleEndian() )
+    {
+      fileImpl::fail(where, path, "Big-endian hosts are not supported");
+    }
+
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if ( fd < 0 )
+    {
+      fileImpl::fail(where, path, "Cannot open file");
+    }
+
+    struct stat info;
+    if ( ::fstat(fd, &info) != 0 )
+    {
+      ::close(fd);
+      fileImpl::fail(where, path, "Cannot size file");
+    }
+    const std::size_t fileBytes = std::size_t(info.st_size);
+    if ( fileBytes < sizeof(MatrixFileHeader) )
+    {
+      ::close(fd);
+      fileImpl::fail(where, path, "File is truncated");
+    }
+
+    // The mapping outlives the descriptor:
+    void* base = ::mmap(nullptr, fileBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if ( base == MAP_FAILED )
+    {
+      fileImpl::fail(where, path, "Cannot map file");
+    }
+    std::shared_ptr<void> mapping(base, [fileBytes](void* p) { ::munmap(p, fileBytes); });
+
+    MatrixFileHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    checkMatrixFileHeader<T>(header, fileBytes, path);
+
+    T* elements = reinterpret_cast<T*>(static_cast<unsigned char*>(base) + header.payloadOffset);
+    const std::size_t count = std::size_t(header.rows*header.cols);
+    if ( verify && (crc32c(0, elements, count*sizeof(T)) != header.payloadChecksum) )
+    {
+      fileImpl::fail(where, path, "Payload checksum mismatch");
+    }
+
+    return Matrix<T>(uint32_t(header.rows), uint32_t(header.cols),
+                     AlignedBuffer<T>(elements, count, std::move(mapping)));
+#endif
+  }
+
+  /// Does the file at path hold an intact matrix of T? (header and payload checksums)
+  template <typename T>
+  bool verifyMatrixFile(const std::string& path)
+  {
+    try
+    {
+      mapMatrix<T>(path, true);
+      return true;
+    }
+    catch (const std::runtime_error&)
+    {
+      return false;
+    }
+  }
+
+} // matrix namespace
+
+#endif // MATRIX_FILE_H
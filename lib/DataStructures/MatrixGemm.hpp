@@ -0,0 +1,690 @@
+////////////////////////////////////////
+//
+//  File:
+//      \file MatrixGemm.hpp
+//
+//  Description:
+//      \brief Matrix GEMM: Blocked, packed matrix multiplication engine
+//
+//  Author:
+//      \author J. Caleb Wherry
+//
+////////////////////////////////////////
+
+// Include Guards:
+#ifndef MATRIX_GEMM_H
+#define MATRIX_GEMM_H
+
+// Forward Declared Dependencies:
+//
+
+// Local Include Dependencies:
+#include "AlignedBuffer.hpp"
+#include "CpuFeatures.hpp"
+#include "ThreadPool.hpp"
+#include "MatrixSimd.hpp"
+
+// Compiler Include Dependencies:
+#include <cstddef>
+#include <complex>
+#include <algorithm>
+#include <type_traits>
+
+/// matrix Namespace
+namespace matrix
+{
+
+  /// Blocking parameters for the GEMM engine
+  ///
+  /// MR x NR is the register tile computed by the micro-kernel, KC x NR panels
+  /// of B are sized for L1, MC x KC blocks of A for L2 and KC x NC panels of B
+  /// for L3. The generic values suit any element type.
+  template <typename T>
+  struct GemmBlocking
+  {
+    static const std::size_t MR = 4;      ///< Micro-tile rows
+    static const std::size_t NR = 4;      ///< Micro-tile columns
+    static const std::size_t MC = 64;     ///< Rows of A per L2 block
+    static const std::size_t KC = 256;    ///< Inner dimension per block
+    static const std::size_t NC = 1024;   ///< Columns of B per L3 panel
+  };
+
+  /// Blocking parameters for double (6x8 tile: twelve 256-bit accumulators)
+  template <>
+  struct GemmBlocking<double>
+  {
+    static const std::size_t MR = 6;
+    static const std::size_t NR = 8;
+    static const std::size_t MC = 72;
+    static const std::size_t KC = 256;
+    static const std::size_t NC = 4080;
+  };
+
+  /// Blocking parameters for float (6x16 tile: twelve 256-bit accumulators)
+  template <>
+  struct GemmBlocking<float>
+  {
+    static const std::size_t MR = 6;
+    static const std::size_t NR = 16;
+    static const std::size_t MC = 144;
+    static const std::size_t KC = 256;
+    static const std::size_t NC = 4080;
+  };
+
+  /// Below this many multiply-adds (m*n*k) packing costs more than it saves
+  const std::size_t gemmSmallThreshold = 16*16*16;
+
+  /// Operands gemm reads conjugated (complex types; ignored for real ones)
+  enum GemmConjugate
+  {
+    conjugateNone = 0,    ///< A*B
+    conjugateA    = 1,    ///< conj(A)*B
+    conjugateB    = 2,    ///< A*conj(B)
+    conjugateBoth = 3     ///< conj(A)*conj(B)
+  };
+
+  /// How complex products are split into real ones
+  enum ComplexGemm
+  {
+    complexGemm4M,        ///< Four real products: exact same rounding as the textbook formula
+    complexGemm3M         ///< Three real products and extra additions: 25% fewer flops, slightly larger error
+  };
+
+  template <typename T>
+  void gemm(std::size_t m, std::size_t n, std::size_t k,
+            const T& alpha,
+            const T* a, std::ptrdiff_t rsA, std::ptrdiff_t csA,
+            const T* b, std::ptrdiff_t rsB, std::ptrdiff_t csB,
+            const T& beta,
+            T* c, std::ptrdiff_t rsC, std::ptrdiff_t csC,
+            int conjugate = conjugateNone);
+
+  /// gemmImpl namespace (engine internals)
+  namespace gemmImpl
+  {
+
+    /// Micro-kernel: ab[MR*NR] = sum_p a[p*MR + i] * b[p*NR + j] over kc steps
+    template <typename T>
+    struct MicroKernel
+    {
+      typedef void (*Fn)(std::size_t kc, const T* a, const T* b, T* ab);
+    };
+
+    /// Portable micro-kernel (accumulators stay in registers after unrolling)
+    template <typename T, std::size_t MR, std::size_t NR>
+    void microKernelGeneric(std::size_t kc, const T* a, const T* b, T* ab)
+    {
+      T acc[MR*NR];
+      for (std::size_t i=0; i<MR*NR; ++i)
+      {
+        acc[i] = T(0);
+      }
+
+      for (std::size_t p=0; p<kc; ++p)
+      {
+        for (std::size_t i=0; i<MR; ++i)
+        {
+          const T a_i = a[i];
+          for (std::size_t j=0; j<NR; ++j)
+          {
+            acc[i*NR + j] += a_i * b[j];
+          }
+        }
+        a += MR;
+        b += NR;
+      }
+
+      std::copy(acc, acc + MR*NR, ab);
+    }
+
+#if MATRIX_X86_DISPATCH
+
+    /// AVX2/FMA 6x8 double micro-kernel
+    __attribute__((target("avx2,fma")))
+    inline void microKernelAvx2(std::size_t kc, const double* a, const double* b, double* ab)
+    {
+      __m256d c00 = _mm256_setzero_pd(), c01 = _mm256_setzero_pd();
+      __m256d c10 = _mm256_setzero_pd(), c11 = _mm256_setzero_pd();
+      __m256d c20 = _mm256_setzero_pd(), c21 = _mm256_setzero_pd();
+      __m256d c30 = _mm256_setzero_pd(), c31 = _mm256_setzero_pd();
+      __m256d c40 = _mm256_setzero_pd(), c41 = _mm256_setzero_pd();
+      __m256d c50 = _mm256_setzero_pd(), c51 = _mm256_setzero_pd();
+
+      for (std::size_t p=0; p<kc; ++p)
+      {
+        const __m256d b0 = _mm256_load_pd(b);
+        const __m256d b1 = _mm256_load_pd(b + 4);
+        __m256d ai;
+
+        ai = _mm256_broadcast_sd(a + 0); c00 = _mm256_fmadd_pd(ai, b0, c00); c01 = _mm256_fmadd_pd(ai, b1, c01);
+        ai = _mm256_broadcast_sd(a + 1); c10 = _mm256_fmadd_pd(ai, b0, c10); c11 = _mm256_fmadd_pd(ai, b1, c11);
+        ai = _mm256_broadcast_sd(a + 2); c20 = _mm256_fmadd_pd(ai, b0, c20); c21 = _mm256_fmadd_pd(ai, b1, c21);
+        ai = _mm256_broadcast_sd(a + 3); c30 = _mm256_fmadd_pd(ai, b0, c30); c31 = _mm256_fmadd_pd(ai, b1, c31);
+        ai = _mm256_broadcast_sd(a + 4); c40 = _mm256_fmadd_pd(ai, b0, c40); c41 = _mm256_fmadd_pd(ai, b1, c41);
+        ai = _mm256_broadcast_sd(a + 5); c50 = _mm256_fmadd_pd(ai, b0, c50); c51 = _mm256_fmadd_pd(ai, b1, c51);
+
+        a += 6;
+        b += 8;
+      }
+
+      _mm256_store_pd(ab +  0, c00); _mm256_store_pd(ab +  4, c01);
+      _mm256_store_pd(ab +  8, c10); _mm256_store_pd(ab + 12, c11);
+      _mm256_store_pd(ab + 16, c20); _mm256_store_pd(ab + 20, c21);
+      _mm256_store_pd(ab + 24, c30); _mm256_store_pd(ab + 28, c31);
+      _mm256_store_pd(ab + 32, c40); _mm256_store_pd(ab + 36, c41);
+      _mm256_store_pd(ab + 40, c50); _mm256_store_pd(ab + 44, c51);
+    }
+
+    /// AVX2/FMA 6x16 float micro-kernel
+    __attribute__((target("avx2,fma")))
+    inline void microKernelAvx2(std::size_t kc, const float* a, const float* b, float* ab)
+    {
+      __m256 c00 = _mm256_setzero_ps(), c01 = _mm256_setzero_ps();
+      __m256 c10 = _mm256_setzero_ps(), c11 = _mm256_setzero_ps();
+      __m256 c20 = _mm256_setzero_ps(), c21 = _mm256_setzero_ps();
+      __m256 c30 = _mm256_setzero_ps(), c31 = _mm256_setzero_ps();
+      __m256 c40 = _mm256_setzero_ps(), c41 = _mm256_setzero_ps();
+      __m256 c50 = _mm256_setzero_ps(), c51 = _mm256_setzero_ps();
+
+      for (std::size_t p=0; p<kc; ++p)
+      {
+        const __m256 b0 = _mm256_load_ps(b);
+        const __m256 b1 = _mm256_load_ps(b + 8);
+        __m256 ai;
+
+        ai = _mm256_broadcast_ss(a + 0); c00 = _mm256_fmadd_ps(ai, b0, c00); c01 = _mm256_fmadd_ps(ai, b1, c01);
+        ai = _mm256_broadcast_ss(a + 1); c10 = _mm256_fmadd_ps(ai, b0, c10); c11 = _mm256_fmadd_ps(ai, b1, c11);
+        ai = _mm256_broadcast_ss(a + 2); c20 = _mm256_fmadd_ps(ai, b0, c20); c21 = _mm256_fmadd_ps(ai, b1, c21);
+        ai = _mm256_broadcast_ss(a + 3); c30 = _mm256_fmadd_ps(ai, b0, c30); c31 = _mm256_fmadd_ps(ai, b1, c31);
+        ai = _mm256_broadcast_ss(a + 4); c40 = _mm256_fmadd_ps(ai, b0, c40); c41 = _mm256_fmadd_ps(ai, b1, c41);
+        ai = _mm256_broadcast_ss(a + 5); c50 = _mm256_fmadd_ps(ai, b0, c50); c51 = _mm256_fmadd_ps(ai, b1, c51);
+
+        a += 6;
+        b += 16;
+      }
+
+      _mm256_store_ps(ab +  0, c00); _mm256_store_ps(ab +  8, c01);
+      _mm256_store_ps(ab + 16, c10); _mm256_store_ps(ab + 24, c11);
+      _mm256_store_ps(ab + 32, c20); _mm256_store_ps(ab + 40, c21);
+      _mm256_store_ps(ab + 48, c30); _mm256_store_ps(ab + 56, c31);
+      _mm256_store_ps(ab + 64, c40); _mm256_store_ps(ab + 72, c41);
+      _mm256_store_ps(ab + 80, c50); _mm256_store_ps(ab + 88, c51);
+    }
+
+#endif // MATRIX_X86_DISPATCH
+
+    /// Pick the best micro-kernel for T on the running CPU
+    template <typename T>
+    typename MicroKernel<T>::Fn selectMicroKernel()
+    {
+      return &microKernelGeneric<T, GemmBlocking<T>::MR, GemmBlocking<T>::NR>;
+    }
+
+#if MATRIX_X86_DISPATCH
+    template <>
+    inline MicroKernel<double>::Fn selectMicroKernel<double>()
+    {
+      if ( cpuFeatures().avx2 && cpuFeatures().fma )
+      {
+        return static_cast<MicroKernel<double>::Fn>(&microKernelAvx2);
+      }
+      return &microKernelGeneric<double, GemmBlocking<double>::MR, GemmBlocking<double>::NR>;
+    }
+
+    template <>
+    inline MicroKernel<float>::Fn selectMicroKernel<float>()
+    {
+      if ( cpuFeatures().avx2 && cpuFeatures().fma )
+      {
+        return static_cast<MicroKernel<float>::Fn>(&microKernelAvx2);
+      }
+      return &microKernelGeneric<float, GemmBlocking<float>::MR, GemmBlocking<float>::NR>;
+    }
+#endif
+
+    /// Micro-kernel for T, chosen once per process
+    template <typename T>
+    typename MicroKernel<T>::Fn microKernel()
+    {
+      static const typename MicroKernel<T>::Fn fn = selectMicroKernel<T>();
+      return fn;
+    }
+
+    /// Pack an mc x kc block of A into MR-row micro-panels (zero padded)
+    template <typename T>
+    void packA(std::size_t mc, std::size_t kc,
+               const T* a, std::ptrdiff_t rsA, std::ptrdiff_t csA,
+               T* packed)
+    {
+      const std::size_t MR = GemmBlocking<T>::MR;
+
+      for (std::size_t i0=0; i0<mc; i0+=MR)
+      {
+        const std::size_t mr = std::min(MR, mc - i0);
+        const T* panel = a + std::ptrdiff_t(i0)*rsA;
+
+        for (std::size_t p=0; p<kc; ++p)
+        {
+          const T* col = panel + std::ptrdiff_t(p)*csA;
+          std::size_t i = 0;
+          for (; i<mr; ++i)
+          {
+            packed[i] = col[std::ptrdiff_t(i)*rsA];
+          }
+          for (; i<MR; ++i)
+          {
+            packed[i] = T(0);
+          }
+          packed += MR;
+        }
+      }
+    }
+
+    /// Pack a kc x nc panel of B into NR-column micro-panels (zero padded)
+    template <typename T>
+    void packB(std::size_t kc, std::size_t nc,
+               const T* b, std::ptrdiff_t rsB, std::ptrdiff_t csB,
+               T* packed)
+    {
+      const std::size_t NR = GemmBlocking<T>::NR;
+
+      for (std::size_t j0=0; j0<nc; j0+=NR)
+      {
+        const std::size_t nr = std::min(NR, nc - j0);
+        const T* panel = b + std::ptrdiff_t(j0)*csB;
+
+        for (std::size_t p=0; p<kc; ++p)
+        {
+          const T* row = panel + std::ptrdiff_t(p)*rsB;
+          std::size_t j = 0;
+          if ( csB == 1 )
+          {
+            for (; j<nr; ++j)
+            {
+              packed[j] = row[j];
+            }
+          }
+          else
+          {
+            for (; j<nr; ++j)
+            {
+              packed[j] = row[std::ptrdiff_t(j)*csB];
+            }
+          }
+          for (; j<NR; ++j)
+          {
+            packed[j] = T(0);
+          }
+          packed += NR;
+        }
+      }
+    }
+
+    /// C tile = alpha*AB + beta*C for the valid mr x nr corner of the tile
+    template <typename T>
+    void updateTile(std::size_t mr, std::size_t nr, const T& alpha, const T* ab,
+                    const T& beta, T* c, std::ptrdiff_t rsC, std::ptrdiff_t csC)
+    {
+      const std::size_t NR = GemmBlocking<T>::NR;
+
+      for (std::size_t i=0; i<mr; ++i)
+      {
+        T* row = c + std::ptrdiff_t(i)*rsC;
+        const T* abRow = ab + i*NR;
+
+        // beta == 0 must not read C (it may be uninitialized):
+        if ( beta == T(0) )
+        {
+          for (std::size_t j=0; j<nr; ++j)
+          {
+            row[std::ptrdiff_t(j)*csC] = alpha*abRow[j];
+          }
+        }
+        else
+        {
+          for (std::size_t j=0; j<nr; ++j)
+          {
+            T& c_ij = row[std::ptrdiff_t(j)*csC];
+            c_ij = alpha*abRow[j] + beta*c_ij;
+          }
+        }
+      }
+    }
+
+    /// Macro-kernel: multiply a packed mc x kc block by a packed kc x nc panel
+    template <typename T>
+    void macroKernel(std::size_t mc, std::size_t nc, std::size_t kc,
+                     const T& alpha, const T* aPacked, const T* bPacked,
+                     const T& beta, T* c, std::ptrdiff_t rsC, std::ptrdiff_t csC)
+    {
+      const std::size_t MR = GemmBlocking<T>::MR;
+      const std::size_t NR = GemmBlocking<T>::NR;
+      const typename MicroKernel<T>::Fn kernel = microKernel<T>();
+
+      alignas(storageAlignment) T ab[MR*NR];
+
+      for (std::size_t j0=0; j0<nc; j0+=NR)
+      {
+        const std::size_t nr = std::min(NR, nc - j0);
+
+        for (std::size_t i0=0; i0<mc; i0+=MR)
+        {
+          const std::size_t mr = std::min(MR, mc - i0);
+
+          kernel(kc, aPacked + i0*kc, bPacked + j0*kc, ab);
+          updateTile(mr, nr, alpha, ab, beta,
+                     c + std::ptrdiff_t(i0)*rsC + std::ptrdiff_t(j0)*csC, rsC, csC);
+        }
+      }
+    }
+
+    /// C = beta*C (k == 0 degenerate product)
+    template <typename T>
+    void scale(std::size_t m, std::size_t n, const T& beta,
+               T* c, std::ptrdiff_t rsC, std::ptrdiff_t csC)
+    {
+      for (std::size_t i=0; i<m; ++i)
+      {
+        for (std::size_t j=0; j<n; ++j)
+        {
+          T& c_ij = c[std::ptrdiff_t(i)*rsC + std::ptrdiff_t(j)*csC];
+          c_ij = (beta == T(0)) ? T(0) : beta*c_ij;
+        }
+      }
+    }
+
+    /// Method for complex products (process-wide)
+    inline ComplexGemm& complexMethod()
+    {
+      static ComplexGemm method = complexGemm4M;
+      return method;
+    }
+
+    /// Split rows x cols complex elements (any strides) into packed real and
+    ///  imaginary planes, negating the imaginary one when conjugated
+    template <typename R>
+    void splitPlanes(std::size_t rows, std::size_t cols,
+                     const std::complex<R>* x, std::ptrdiff_t rs, std::ptrdiff_t cs, bool conj,
+                     R* re, R* im)
+    {
+      const R sign = conj ? R(-1) : R(1);
+      parallelFor(0, rows, [=](std::size_t lo, std::size_t hi) {
+        for (std::size_t i=lo; i<hi; ++i)
+        {
+          const std::complex<R>* row = x + std::ptrdiff_t(i)*rs;
+          R* reRow = re + i*cols;
+          R* imRow = im + i*cols;
+          for (std::size_t j=0; j<cols; ++j)
+          {
+            const std::complex<R> x_ij = row[std::ptrdiff_t(j)*cs];
+            reRow[j] = x_ij.real();
+            imRow[j] = sign*x_ij.imag();
+          }
+        }
+      }, getParallelThreshold()/(cols + 1) + 1);
+    }
+
+    /// Complex GEMM through the real engine on planar (split) operands
+    ///
+    /// Interleaved complex elements can't use the real micro-kernels and each
+    /// complex multiply-add costs four multiplies and a NaN check; split into
+    /// real and imaginary planes, the product is three (3M) or four (4M) real
+    /// GEMMs at full SIMD speed. Conjugation is a sign flip while splitting, so
+    /// conjugated and (with swapped strides) conjugate-transposed operands cost
+    /// nothing extra.
+    template <typename T, bool Planar = false>
+    struct ComplexPath
+    {
+      static bool run(std::size_t, std::size_t, std::size_t, const T&,
+                      const T*, std::ptrdiff_t, std::ptrdiff_t, const T*, std::ptrdiff_t, std::ptrdiff_t,
+                      const T&, T*, std::ptrdiff_t, std::ptrdiff_t, int)
+      {
+        return false;
+      }
+    };
+
+    template <typename R>
+    struct ComplexPath<std::complex<R>, true>
+    {
+      typedef std::complex<R> T;
+
+      static bool run(std::size_t m, std::size_t n, std::size_t k, const T& alpha,
+                      const T* a, std::ptrdiff_t rsA, std::ptrdiff_t csA,
+                      const T* b, std::ptrdiff_t rsB, std::ptrdiff_t csB,
+                      const T& beta, T* c, std::ptrdiff_t rsC, std::ptrdiff_t csC, int conjugate)
+      {
+        AlignedBuffer<R> ar(m*k), ai(m*k), br(k*n), bi(k*n), cr(m*n), ci(m*n);
+        splitPlanes(m, k, a, rsA, csA, (conjugate & conjugateA) != 0, ar.data(), ai.data());
+        splitPlanes(k, n, b, rsB, csB, (conjugate & conjugateB) != 0, br.data(), bi.data());
+
+        auto real = [&](const R* x, const R* y, R scale, R keep, R* z) {
+          gemm<R>(m, n, k, scale, x, std::ptrdiff_t(k), 1, y, std::ptrdiff_t(n), 1, keep, z, std::ptrdiff_t(n), 1);
+        };
+
+        if ( complexMethod() == complexGemm3M )
+        {
+          // P1 = Ar*Br, P2 = Ai*Bi, P3 = (Ar + Ai)(Br + Bi); re = P1 - P2, im = P3 - P1 - P2:
+          AlignedBuffer<R> p3(m*n);
+          real(ar.data(), br.data(), R(1), R(0), cr.data());
+          real(ai.data(), bi.data(), R(1), R(0), ci.data());
+          simdAdd(ar.data(), ai.data(), ar.data(), m*k);
+          simdAdd(br.data(), bi.data(), br.data(), k*n);
+          real(ar.data(), br.data(), R(1), R(0), p3.data());
+          simdSubtract(p3.data(), cr.data(), p3.data(), m*n);
+          simdSubtract(p3.data(), ci.data(), p3.data(), m*n);
+          simdSubtract(cr.data(), ci.data(), cr.data(), m*n);
+          ci.swap(p3);
+        }
+        else
+        {
+          // re = Ar*Br - Ai*Bi, im = Ar*Bi + Ai*Br:
+          real(ar.data(), br.data(), R(1), R(0), cr.data());
+          real(ai.data(), bi.data(), R(-1), R(1), cr.data());
+          real(ar.data(), bi.data(), R(1), R(0), ci.data());
+          real(ai.data(), br.data(), R(1), R(1), ci.data());
+        }
+
+        // C = alpha*(re + i im) + beta*C, written out without complex multiplies:
+        const R* re = cr.data();
+        const R* im = ci.data();
+        const R alphaRe = alpha.real(), alphaIm = alpha.imag();
+        const R betaRe = beta.real(), betaIm = beta.imag();
+        const bool keep = (beta != T(0));
+        parallelFor(0, m, [=](std::size_t lo, std::size_t hi) {
+          for (std::size_t i=lo; i<hi; ++i)
+          {
+            T* row = c + std::ptrdiff_t(i)*rsC;
+            for (std::size_t j=0; j<n; ++j)
+            {
+              const R x = re[i*n + j], y = im[i*n + j];
+              R zr = alphaRe*x - alphaIm*y;
+              R zi = alphaRe*y + alphaIm*x;
+              T& c_ij = row[std::ptrdiff_t(j)*csC];
+              if ( keep )
+              {
+                zr += betaRe*c_ij.real() - betaIm*c_ij.imag();
+                zi += betaRe*c_ij.imag() + betaIm*c_ij.real();
+              }
+              c_ij = T(zr, zi);
+            }
+          }
+        }, getParallelThreshold()/(n + 1) + 1);
+
+        return true;
+      }
+    };
+
+    /// Does T take the planar complex path?
+    template <typename T>
+    struct IsPlanar : std::false_type {};
+
+    template <typename R>
+    struct IsPlanar<std::complex<R>> : std::is_floating_point<R> {};
+
+    /// Unpacked triple loop for products too small to amortize packing
+    template <typename T>
+    void small(std::size_t m, std::size_t n, std::size_t k,
+               const T& alpha,
+               const T* a, std::ptrdiff_t rsA, std::ptrdiff_t csA,
+               const T* b, std::ptrdiff_t rsB, std::ptrdiff_t csB,
+               const T& beta,
+               T* c, std::ptrdiff_t rsC, std::ptrdiff_t csC)
+    {
+      scale(m, n, beta, c, rsC, csC);
+
+      // i-p-j order keeps the innermost loop walking rows of B and C:
+      for (std::size_t i=0; i<m; ++i)
+      {
+        T* cRow = c + std::ptrdiff_t(i)*rsC;
+        for (std::size_t p=0; p<k; ++p)
+        {
+          const T a_ip = alpha*a[std::ptrdiff_t(i)*rsA + std::ptrdiff_t(p)*csA];
+          const T* bRow = b + std::ptrdiff_t(p)*rsB;
+          for (std::size_t j=0; j<n; ++j)
+          {
+            cRow[std::ptrdiff_t(j)*csC] += a_ip*bRow[std::ptrdiff_t(j)*csB];
+          }
+        }
+      }
+    }
+
+  } // gemmImpl namespace
+
+  /// General matrix multiply: C = alpha*A*B + beta*C
+  ///
+  /// A is m x k, B is k x n and C is m x n, each addressed through a row
+  /// stride and a column stride (in elements), so row-major, column-major and
+  /// transposed operands all go through the same engine. When beta is zero C is
+  /// only written, never read. For complex T, conjugate (GemmConjugate flags)
+  /// reads A and/or B conjugated; with transposed strides that gives
+  /// conjugate-transposed operands without forming them.
+  template <typename T>
+  void gemm(std::size_t m, std::size_t n, std::size_t k,
+            const T& alpha,
+            const T* a, std::ptrdiff_t rsA, std::ptrdiff_t csA,
+            const T* b, std::ptrdiff_t rsB, std::ptrdiff_t csB,
+            const T& beta,
+            T* c, std::ptrdiff_t rsC, std::ptrdiff_t csC,
+            int conjugate)
+  {
+    typedef GemmBlocking<T> B;
+
+    if ( (m == 0) || (n == 0) )
+    {
+      return;
+    }
+
+    if ( (k == 0) || (alpha == T(0)) )
+    {
+      gemmImpl::scale(m, n, beta, c, rsC, csC);
+      return;
+    }
+
+    // Complex floating point goes through the real engine (conjugated operands always):
+    if ( ((conjugate != conjugateNone) || (m*n*k > gemmSmallThreshold)) &&
+         gemmImpl::ComplexPath<T, gemmImpl::IsPlanar<T>::value>::run(m, n, k, alpha, a, rsA, csA, b, rsB, csB,
+                                                                     beta, c, rsC, csC, conjugate) )
+    {
+      return;
+    }
+
+    if ( m*n*k <= gemmSmallThreshold )
+    {
+      gemmImpl::small(m, n, k, alpha, a, rsA, csA, b, rsB, csB, beta, c, rsC, csC);
+      return;
+    }
+
+    // Packing buffers, sized to the problem so small products stay small:
+    const std::size_t mcMax = std::min(B::MC, (m + B::MR - 1)/B::MR*B::MR);
+    const std::size_t ncMax = std::min(B::NC, (n + B::NR - 1)/B::NR*B::NR);
+    const std::size_t kcMax = std::min(B::KC, k);
+    AlignedBuffer<T> bPacked(kcMax*ncMax);
+
+    // Parallel work is split into row blocks of A (MC rows each), and when
+    //  there are fewer blocks than threads, also into column slices of the B
+    //  panel, so tall-skinny and short-wide shapes both fill the pool:
+    const std::size_t mBlocks = (m + B::MC - 1)/B::MC;
+    const std::size_t threads = (m*n*k >= getGemmParallelThreshold()) ? parallelTasks(getNumThreads(), 1) : 1;
+
+    // One packed-A slot per task, allocated once and reused by every block
+    //  (slots rounded to 64 elements so each stays aligned):
+    const std::size_t aSlot = (mcMax*kcMax + 63)/64*64;
+    AlignedBuffer<T> aPacked(threads*aSlot);
+
+    for (std::size_t jc=0; jc<n; jc+=B::NC)
+    {
+      const std::size_t nc = std::min(B::NC, n - jc);
+      const std::size_t nPanels = (nc + B::NR - 1)/B::NR;
+
+      for (std::size_t pc=0; pc<k; pc+=B::KC)
+      {
+        const std::size_t kc = std::min(B::KC, k - pc);
+        const T* bBlock = b + std::ptrdiff_t(pc)*rsB + std::ptrdiff_t(jc)*csB;
+
+        // Only the first pass over K applies the caller's beta:
+        const T betaBlock = (pc == 0) ? beta : T(1);
+
+        if ( threads == 1 )
+        {
+          gemmImpl::packB(kc, nc, bBlock, rsB, csB, bPacked.data());
+
+          for (std::size_t ic=0; ic<m; ic+=B::MC)
+          {
+            const std::size_t mc = std::min(B::MC, m - ic);
+
+            gemmImpl::packA(mc, kc, a + std::ptrdiff_t(ic)*rsA + std::ptrdiff_t(pc)*csA, rsA, csA, aPacked.data());
+            gemmImpl::macroKernel(mc, nc, kc, alpha, aPacked.data(), bPacked.data(), betaBlock,
+                                  c + std::ptrdiff_t(ic)*rsC + std::ptrdiff_t(jc)*csC, rsC, csC);
+          }
+          continue;
+        }
+
+        // Pack the shared B panel cooperatively, one slice of NR-panels per task:
+        const std::size_t packTasks = std::min(threads, nPanels);
+        threadPool().run(packTasks, [&](std::size_t task) {
+          const std::size_t p0 = nPanels*task/packTasks, p1 = nPanels*(task + 1)/packTasks;
+          const std::size_t cols = std::min(nc, p1*B::NR) - p0*B::NR;
+          gemmImpl::packB(kc, cols, bBlock + std::ptrdiff_t(p0*B::NR)*csB, rsB, csB,
+                          bPacked.data() + p0*B::NR*kc);
+        });
+
+        // Then the (row block, column slice) pairs are independent; each task
+        //  takes a contiguous run of them and packs into its own A slot:
+        const std::size_t slices = std::min(nPanels, (threads + mBlocks - 1)/mBlocks);
+        const std::size_t pairs = mBlocks*slices;
+        const std::size_t tasks = std::min(threads, pairs);
+        threadPool().run(tasks, [&](std::size_t task) {
+          T* aBlock = aPacked.data() + task*aSlot;
+          for (std::size_t pair=pairs*task/tasks; pair<pairs*(task + 1)/tasks; ++pair)
+          {
+            const std::size_t ic = (pair / slices)*B::MC;
+            const std::size_t mc = std::min(B::MC, m - ic);
+            const std::size_t slice = pair % slices;
+            const std::size_t p0 = nPanels*slice/slices, p1 = nPanels*(slice + 1)/slices;
+            const std::size_t j0 = p0*B::NR;
+            const std::size_t cols = std::min(nc, p1*B::NR) - j0;
+
+            gemmImpl::packA(mc, kc, a + std::ptrdiff_t(ic)*rsA + std::ptrdiff_t(pc)*csA, rsA, csA, aBlock);
+            gemmImpl::macroKernel(mc, cols, kc, alpha, aBlock, bPacked.data() + j0*kc, betaBlock,
+                                  c + std::ptrdiff_t(ic)*rsC + std::ptrdiff_t(jc + j0)*csC, rsC, csC);
+          }
+        });
+      }
+    }
+  }
+
+  /// Method used for complex products
+  inline ComplexGemm getComplexGemmMethod()
+  {
+    return gemmImpl::complexMethod();
+  }
+
+  /// Choose between 4M (default) and 3M complex products
+  inline void setComplexGemmMethod(ComplexGemm method)
+  {
+    gemmImpl::complexMethod() = method;
+  }
+
+} // matrix namespace
+
+#endif // MATRIX_GEMM_H
@@ -0,0 +1,370 @@
+////////////////////////////////////////
+//
+//  File:
+//      \file MatrixGemv.hpp
+//
+//  Description:
+//      \brief Matrix GEMV: Matrix/vector multiplication kernels
+//
+//  Author:
+//      \author J. Caleb Wherry
+//
+////////////////////////////////////////
+
+// Include Guards:
+#ifndef MATRIX_GEMV_H
+#define MATRIX_GEMV_H
+
+// Forward Declared Dependencies:
+//
+
+// Local Include Dependencies:
+#include "CpuFeatures.hpp"
+#include "MatrixSimd.hpp"
+#include "ThreadPool.hpp"
+
+// Compiler Include Dependencies:
+#include <cstddef>
+#include <algorithm>
+
+/// matrix Namespace
+namespace matrix
+{
+
+  /// Columns of y updated together by the transposed kernel (kept in L1)
+  const std::size_t gemvColumnBlock = 1024;
+
+  /// gemvImpl namespace (kernel internals)
+  namespace gemvImpl
+  {
+
+    //
+    // Portable kernels:
+    //
+
+    /// out[r] = dot(row r of a, x) for 4 rows
+    template <typename T>
+    void dot4Scalar(const T* a, std::size_t lda, const T* x, std::size_t n, T* out)
+    {
+      const T* a0 = a;
+      const T* a1 = a + lda;
+      const T* a2 = a + 2*lda;
+      const T* a3 = a + 3*lda;
+      T s0 = T(0), s1 = T(0), s2 = T(0), s3 = T(0);
+
+      for (std::size_t j=0; j<n; ++j)
+      {
+        const T xj = x[j];
+        s0 += a0[j]*xj;
+        s1 += a1[j]*xj;
+        s2 += a2[j]*xj;
+        s3 += a3[j]*xj;
+      }
+
+      out[0] = s0;
+      out[1] = s1;
+      out[2] = s2;
+      out[3] = s3;
+    }
+
+    /// dot(a, x)
+    template <typename T>
+    T dot1Scalar(const T* a, const T* x, std::size_t n)
+    {
+      T s = T(0);
+      for (std::size_t j=0; j<n; ++j)
+      {
+        s += a[j]*x[j];
+      }
+      return s;
+    }
+
+    /// y += c0*a0 + c1*a1 + c2*a2 + c3*a3 (rows lda apart)
+    template <typename T>
+    void axpy4Scalar(const T* a, std::size_t lda, const T* c, T* y, std::size_t n)
+    {
+      const T* a0 = a;
+      const T* a1 = a + lda;
+      const T* a2 = a + 2*lda;
+      const T* a3 = a + 3*lda;
+
+      for (std::size_t j=0; j<n; ++j)
+      {
+        y[j] += c[0]*a0[j] + c[1]*a1[j] + c[2]*a2[j] + c[3]*a3[j];
+      }
+    }
+
+#if MATRIX_X86_DISPATCH
+
+    //
+    // AVX2 + FMA kernels:
+    //
+
+    __attribute__((target("avx2,fma")))
+    inline double hsumAvx2(__m256d v)
+    {
+      const __m128d pair = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+      return _mm_cvtsd_f64(_mm_add_sd(pair, _mm_unpackhi_pd(pair, pair)));
+    }
+
+    __attribute__((target("avx2,fma")))
+    inline float hsumAvx2(__m256 v)
+    {
+      __m128 quad = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+      quad = _mm_add_ps(quad, _mm_movehl_ps(quad, quad));
+      return _mm_cvtss_f32(_mm_add_ss(quad, _mm_shuffle_ps(quad, quad, 1)));
+    }
+
+    __attribute__((target("avx2,fma")))
+    inline void dot4Avx2(const double* a, std::size_t lda, const double* x, std::size_t n, double* out)
+    {
+      const double* a0 = a;
+      const double* a1 = a + lda;
+      const double* a2 = a + 2*lda;
+      const double* a3 = a + 3*lda;
+      __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd(), s2 = _mm256_setzero_pd(), s3 = _mm256_setzero_pd();
+
+      // Each load of x feeds four rows:
+      std::size_t j = 0;
+      for (; j+4<=n; j+=4)
+      {
+        const __m256d xj = _mm256_loadu_pd(x + j);
+        s0 = _mm256_fmadd_pd(_mm256_loadu_pd(a0 + j), xj, s0);
+        s1 = _mm256_fmadd_pd(_mm256_loadu_pd(a1 + j), xj, s1);
+        s2 = _mm256_fmadd_pd(_mm256_loadu_pd(a2 + j), xj, s2);
+        s3 = _mm256_fmadd_pd(_mm256_loadu_pd(a3 + j), xj, s3);
+      }
+
+      out[0] = hsumAvx2(s0) + dot1Scalar(a0 + j, x + j, n - j);
+      out[1] = hsumAvx2(s1) + dot1Scalar(a1 + j, x + j, n - j);
+      out[2] = hsumAvx2(s2) + dot1Scalar(a2 + j, x + j, n - j);
+      out[3] = hsumAvx2(s3) + dot1Scalar(a3 + j, x + j, n - j);
+    }
+
+    __attribute__((target("avx2,fma")))
+    inline void dot4Avx2(const float* a, std::size_t lda, const float* x, std::size_t n, float* out)
+    {
+      const float* a0 = a;
+      const float* a1 = a + lda;
+      const float* a2 = a + 2*lda;
+      const float* a3 = a + 3*lda;
+      __m256 s0 = _mm256_setzero_ps(), s1 = _mm256_setzero_ps(), s2 = _mm256_setzero_ps(), s3 = _mm256_setzero_ps();
+
+      std::size_t j = 0;
+      for (; j+8<=n; j+=8)
+      {
+        const __m256 xj = _mm256_loadu_ps(x + j);
+        s0 = _mm256_fmadd_ps(_mm256_loadu_ps(a0 + j), xj, s0);
+        s1 = _mm256_fmadd_ps(_mm256_loadu_ps(a1 + j), xj, s1);
+        s2 = _mm256_fmadd_ps(_mm256_loadu_ps(a2 + j), xj, s2);
+        s3 = _mm256_fmadd_ps(_mm256_loadu_ps(a3 + j), xj, s3);
+      }
+
+      out[0] = hsumAvx2(s0) + dot1Scalar(a0 + j, x + j, n - j);
+      out[1] = hsumAvx2(s1) + dot1Scalar(a1 + j, x + j, n - j);
+      out[2] = hsumAvx2(s2) + dot1Scalar(a2 + j, x + j, n - j);
+      out[3] = hsumAvx2(s3) + dot1Scalar(a3 + j, x + j, n - j);
+    }
+
+    __attribute__((target("avx2,fma")))
+    inline double dot1Avx2(const double* a, const double* x, std::size_t n)
+    {
+      __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+      std::size_t j = 0;
+      for (; j+8<=n; j+=8)
+      {
+        s0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + j),     _mm256_loadu_pd(x + j),     s0);
+        s1 = _mm256_fmadd_pd(_mm256_loadu_pd(a + j + 4), _mm256_loadu_pd(x + j + 4), s1);
+      }
+      return hsumAvx2(_mm256_add_pd(s0, s1)) + dot1Scalar(a + j, x + j, n - j);
+    }
+
+    __attribute__((target("avx2,fma")))
+    inline float dot1Avx2(const float* a, const float* x, std::size_t n)
+    {
+      __m256 s0 = _mm256_setzero_ps(), s1 = _mm256_setzero_ps();
+      std::size_t j = 0;
+      for (; j+16<=n; j+=16)
+      {
+        s0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + j),     _mm256_loadu_ps(x + j),     s0);
+        s1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + j + 8), _mm256_loadu_ps(x + j + 8), s1);
+      }
+      return hsumAvx2(_mm256_add_ps(s0, s1)) + dot1Scalar(a + j, x + j, n - j);
+    }
+
+    __attribute__((target("avx2,fma")))
+    inline void axpy4Avx2(const double* a, std::size_t lda, const double* c, double* y, std::size_t n)
+    {
+      const double* a0 = a;
+      const double* a1 = a + lda;
+      const double* a2 = a + 2*lda;
+      const double* a3 = a + 3*lda;
+      const __m256d c0 = _mm256_set1_pd(c[0]), c1 = _mm256_set1_pd(c[1]),
+                    c2 = _mm256_set1_pd(c[2]), c3 = _mm256_set1_pd(c[3]);
+
+      // Each load/store of y absorbs four rows:
+      std::size_t j = 0;
+      for (; j+4<=n; j+=4)
+      {
+        __m256d yj = _mm256_loadu_pd(y + j);
+        yj = _mm256_fmadd_pd(c0, _mm256_loadu_pd(a0 + j), yj);
+        yj = _mm256_fmadd_pd(c1, _mm256_loadu_pd(a1 + j), yj);
+        yj = _mm256_fmadd_pd(c2, _mm256_loadu_pd(a2 + j), yj);
+        yj = _mm256_fmadd_pd(c3, _mm256_loadu_pd(a3 + j), yj);
+        _mm256_storeu_pd(y + j, yj);
+      }
+      axpy4Scalar(a + j, lda, c, y + j, n - j);
+    }
+
+    __attribute__((target("avx2,fma")))
+    inline void axpy4Avx2(const float* a, std::size_t lda, const float* c, float* y, std::size_t n)
+    {
+      const float* a0 = a;
+      const float* a1 = a + lda;
+      const float* a2 = a + 2*lda;
+      const float* a3 = a + 3*lda;
+      const __m256 c0 = _mm256_set1_ps(c[0]), c1 = _mm256_set1_ps(c[1]),
+                   c2 = _mm256_set1_ps(c[2]), c3 = _mm256_set1_ps(c[3]);
+
+      std::size_t j = 0;
+      for (; j+8<=n; j+=8)
+      {
+        __m256 yj = _mm256_loadu_ps(y + j);
+        yj = _mm256_fmadd_ps(c0, _mm256_loadu_ps(a0 + j), yj);
+        yj = _mm256_fmadd_ps(c1, _mm256_loadu_ps(a1 + j), yj);
+        yj = _mm256_fmadd_ps(c2, _mm256_loadu_ps(a2 + j), yj);
+        yj = _mm256_fmadd_ps(c3, _mm256_loadu_ps(a3 + j), yj);
+        _mm256_storeu_ps(y + j, yj);
+      }
+      axpy4Scalar(a + j, lda, c, y + j, n - j);
+    }
+
+#endif // MATRIX_X86_DISPATCH
+
+
+    //
+    // Dispatchers:
+    //
+
+    template <typename T>
+    void dot4(const T* a, std::size_t lda, const T* x, std::size_t n, T* out) { dot4Scalar(a, lda, x, n, out); }
+
+    template <typename T>
+    T dot1(const T* a, const T* x, std::size_t n) { return dot1Scalar(a, x, n); }
+
+    template <typename T>
+    void axpy4(const T* a, std::size_t lda, const T* c, T* y, std::size_t n) { axpy4Scalar(a, lda, c, y, n); }
+
+#if MATRIX_X86_DISPATCH
+
+    inline void dot4(const double* a, std::size_t lda, const double* x, std::size_t n, double* out)
+    {
+      simd::useAvx2Fma() ? dot4Avx2(a, lda, x, n, out) : dot4Scalar(a, lda, x, n, out);
+    }
+
+    inline void dot4(const float* a, std::size_t lda, const float* x, std::size_t n, float* out)
+    {
+      simd::useAvx2Fma() ? dot4Avx2(a, lda, x, n, out) : dot4Scalar(a, lda, x, n, out);
+    }
+
+    inline double dot1(const double* a, const double* x, std::size_t n)
+    {
+      return simd::useAvx2Fma() ? dot1Avx2(a, x, n) : dot1Scalar(a, x, n);
+    }
+
+    inline float dot1(const float* a, const float* x, std::size_t n)
+    {
+      return simd::useAvx2Fma() ? dot1Avx2(a, x, n) : dot1Scalar(a, x, n);
+    }
+
+    inline void axpy4(const double* a, std::size_t lda, const double* c, double* y, std::size_t n)
+    {
+      simd::useAvx2Fma() ? axpy4Avx2(a, lda, c, y, n) : axpy4Scalar(a, lda, c, y, n);
+    }
+
+    inline void axpy4(const float* a, std::size_t lda, const float* c, float* y, std::size_t n)
+    {
+      simd::useAvx2Fma() ? axpy4Avx2(a, lda, c, y, n) : axpy4Scalar(a, lda, c, y, n);
+    }
+
+#endif // MATRIX_X86_DISPATCH
+
+  } // gemvImpl namespace
+
+
+  /// y = alpha*A*x + beta*y for a row-major m x n A with row stride lda
+  ///
+  /// Rows are split into bands across the thread pool; each band streams
+  /// four rows of A at a time against x. When beta is zero, y is not read.
+  template <typename T>
+  void gemv(std::size_t m, std::size_t n,
+            const T& alpha, const T* a, std::size_t lda,
+            const T* x,
+            const T& beta, T* y)
+  {
+    parallelFor(0, m, [&](std::size_t lo, std::size_t hi) {
+      T dots[4];
+      std::size_t i = lo;
+
+      for (; i+4<=hi; i+=4)
+      {
+        gemvImpl::dot4(a + i*lda, lda, x, n, dots);
+        for (std::size_t r=0; r<4; ++r)
+        {
+          y[i+r] = (beta == T(0)) ? alpha*dots[r] : alpha*dots[r] + beta*y[i+r];
+        }
+      }
+
+      for (; i<hi; ++i)
+      {
+        const T dot = gemvImpl::dot1(a + i*lda, x, n);
+        y[i] = (beta == T(0)) ? alpha*dot : alpha*dot + beta*y[i];
+      }
+    }, getParallelThreshold()/(n + 1) + 1);
+  }
+
+  /// y = alpha*A^T*x + beta*y for a row-major m x n A with row stride lda
+  ///
+  /// x has m elements and y has n. Columns of y are split into bands across
+  /// the thread pool, so no two tasks write the same element; each band is
+  /// updated one L1-sized block at a time with four rows of A per pass.
+  /// When beta is zero, y is not read.
+  template <typename T>
+  void gemvTransposed(std::size_t m, std::size_t n,
+                      const T& alpha, const T* a, std::size_t lda,
+                      const T* x,
+                      const T& beta, T* y)
+  {
+    parallelFor(0, n, [&](std::size_t lo, std::size_t hi) {
+      for (std::size_t j0=lo; j0<hi; j0+=gemvColumnBlock)
+      {
+        const std::size_t nb = std::min(gemvColumnBlock, hi - j0);
+        T* yb = y + j0;
+
+        if ( beta == T(0) )
+        {
+          std::fill(yb, yb + nb, T(0));
+        }
+        else if ( beta != T(1) )
+        {
+          simdMultiplyScalar(yb, beta, yb, nb);
+        }
+
+        std::size_t i = 0;
+        for (; i+4<=m; i+=4)
+        {
+          const T c[4] = { alpha*x[i], alpha*x[i+1], alpha*x[i+2], alpha*x[i+3] };
+          gemvImpl::axpy4(a + i*lda + j0, lda, c, yb, nb);
+        }
+
+        for (; i<m; ++i)
+        {
+          simdAxpy(T(alpha*x[i]), a + i*lda + j0, yb, nb);
+        }
+      }
+    }, getParallelThreshold()/(m + 1) + 1);
+  }
+
+} // matrix namespace
+
+#endif // MATRIX_GEMV_H
@@ -0,0 +1,480 @@
+////////////////////////////////////////
+//
+//  File:
+//      \file MatrixLU.hpp
+//
+//  Description:
+//      \brief Matrix LU: Blocked LU factorization with partial pivoting
+//
+//  Author:
+//      \author J. Caleb Wherry
+//
+////////////////////////////////////////
+
+// Include Guards:
+#ifndef MATRIX_LU_H
+#define MATRIX_LU_H
+
+// Forward Declared Dependencies:
+//
+
+// Local Include Dependencies:
+#include "Matrix.hpp"
+#include "MatrixGemm.hpp"
+#include "MatrixSimd.hpp"
+
+// Compiler Include Dependencies:
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <complex>
+#include <stdexcept>
+#include <vector>
+#include <limits>
+#include <type_traits>
+#include <algorithm>
+
+/// matrix Namespace
+namespace matrix
+{
+
+  /// Columns per panel of the blocked factorizations and triangular solves
+  const std::size_t factorBlockSize = 64;
+
+  /// factorImpl namespace (shared factorization kernels)
+  namespace factorImpl
+  {
+
+    /// Real part of an element (the element itself for real types)
+    template <typename T>
+    inline T realPart(const T& x) { return x; }
+
+    /// Real part of an element (complex element types)
+    template <typename U>
+    inline U realPart(const std::complex<U>& x) { return x.real(); }
+
+    /// Solve L*X = X in place for an n x n lower triangular L
+    ///
+    /// Each diagonal block is solved with row updates; everything below it is
+    /// then updated with one GEMM, so most of the work runs at GEMM speed.
+    /// With unitDiagonal, L's diagonal is taken as ones and never read.
+    template <typename T>
+    void solveLower(std::size_t n, std::size_t nrhs,
+                    const T* l, std::size_t ldl,
+                    T* x, std::size_t ldx,
+                    bool unitDiagonal)
+    {
+      for (std::size_t k0=0; k0<n; k0+=factorBlockSize)
+      {
+        const std::size_t kb = std::min(factorBlockSize, n - k0);
+
+        for (std::size_t i=k0; i<k0+kb; ++i)
+        {
+          for (std::size_t k=k0; k<i; ++k)
+          {
+            simdAxpy(T(-l[i*ldl + k]), x + k*ldx, x + i*ldx, nrhs);
+          }
+          if ( !unitDiagonal )
+          {
+            simdDivideScalar(x + i*ldx, l[i*ldl + i], x + i*ldx, nrhs);
+          }
+        }
+
+        if ( k0 + kb < n )
+        {
+          gemm<T>(n - k0 - kb, nrhs, kb,
+                  T(-1), l + (k0 + kb)*ldl + k0, ldl, 1,
+                         x + k0*ldx, ldx, 1,
+                  T(1),  x + (k0 + kb)*ldx, ldx, 1);
+        }
+      }
+    }
+
+    /// Solve U*X = X in place for an n x n upper triangular U
+    template <typename T>
+    void solveUpper(std::size_t n, std::size_t nrhs,
+                    const T* u, std::size_t ldu,
+                    T* x, std::size_t ldx,
+                    bool unitDiagonal)
+    {
+      for (std::size_t end=n; end>0; )
+      {
+        const std::size_t kb = std::min(factorBlockSize, end);
+        const std::size_t k0 = end - kb;
+
+        for (std::size_t i=end; i-->k0; )
+        {
+          for (std::size_t k=i+1; k<end; ++k)
+          {
+            simdAxpy(T(-u[i*ldu + k]), x + k*ldx, x + i*ldx, nrhs);
+          }
+          if ( !unitDiagonal )
+          {
+            simdDivideScalar(x + i*ldx, u[i*ldu + i], x + i*ldx, nrhs);
+          }
+        }
+
+        if ( k0 > 0 )
+        {
+          gemm<T>(k0, nrhs, kb,
+                  T(-1), u + k0, ldu, 1,
+                         x + k0*ldx, ldx, 1,
+                  T(1),  x, ldx, 1);
+        }
+
+        end = k0;
+      }
+    }
+
+    /// det of an n x n row-major array by fraction-free (Bareiss) elimination,
+    ///  overwriting it; every division is exact, so integer determinants are
+    ///  exact (as long as the minors fit in T)
+    template <typename T>
+    T bareissDeterminant(std::size_t n, T* a, std::size_t ld)
+    {
+      T sign = T(1), previous = T(1);
+      for (std::size_t k=0; k<n; ++k)
+      {
+        // Any nonzero pivot will do:
+        std::size_t p = k;
+        while ( (p < n) && (a[p*ld + k] == T(0)) )
+        {
+          ++p;
+        }
+        if ( p == n )
+        {
+          return T(0);
+        }
+        if ( p != k )
+        {
+          std::swap_ranges(a + k*ld + k, a + k*ld + n, a + p*ld + k);
+          sign = T(0) - sign;
+        }
+
+        // Each new entry is a (k+2) x (k+2) minor, so previous divides it:
+        const T pivot = a[k*ld + k];
+        for (std::size_t i=k+1; i<n; ++i)
+        {
+          const T l = a[i*ld + k];
+          for (std::size_t j=k+1; j<n; ++j)
+          {
+            a[i*ld + j] = (a[i*ld + j]*pivot - l*a[k*ld + j])/previous;
+          }
+        }
+        previous = pivot;
+      }
+
+      return sign*previous;
+    }
+
+  } // factorImpl namespace
+
+
+  /// LU Decomposition class
+  ///
+  /// Factors a square A as P*A = L*U once (L unit lower, U upper, P a row
+  /// permutation); solve(), inverse() and determinant() then reuse the
+  /// factors. The factorization is blocked: each panel of columns is
+  /// factored with partial pivoting, and the trailing matrix is updated with
+  /// one GEMM per panel. A pivot negligible next to U's largest element (at
+  /// working precision) marks the matrix singular. Elements must be
+  /// floating-point or complex; integer determinants are exact through
+  /// Matrix::determinant().
+  template <typename T>
+  class LUDecomposition
+  {
+
+    private:
+      Matrix<T> factors;                ///< L below the diagonal (unit diagonal implied), U on and above
+      std::vector<uint32_t> pivots;     ///< Row i was swapped with row pivots[i] (in order)
+      int pivotSign;                    ///< Sign of P's determinant
+      bool singular;                    ///< Was a zero or negligible pivot met?
+
+      /// Factor the columns [k0, k0+kb) of the rows [k0, n) (unblocked)
+      void factorPanel(std::size_t k0, std::size_t kb);
+
+      /// Apply P to the rows of b (n x nrhs, row stride ldb)
+      void permute(T* b, std::size_t nrhs, std::size_t ldb) const;
+
+    public:
+
+
+      //
+      // Constructors:
+      //
+
+      /// Factoring Constructor
+      explicit LUDecomposition (
+        const Matrix<T>& A      ///< Square matrix to factor.
+      );
+
+
+      //
+      // Accessors:
+      //
+
+      const Matrix<T>& getFactors() const { return factors; };          ///< Packed L and U
+      const std::vector<uint32_t>& getPivots() const { return pivots; }; ///< Row interchanges
+      Matrix<T> getL() const;                                           ///< Unit lower factor
+      Matrix<T> getU() const;                                           ///< Upper factor
+
+
+      //
+      // Operations:
+      //
+
+      bool isSingular() const { return singular; };   ///< Is some pivot zero or negligible?
+      T determinant() const;                          ///< det(A) (zero when singular)
+      Matrix<T> solve(const Matrix<T>& B) const;      ///< X with A*X = B (any number of columns)
+      std::vector<T> solve(const std::vector<T>& b) const;   ///< x with A*x = b
+      Matrix<T> inverse() const;                      ///< A^-1
+
+  }; // LUDecomposition class
+
+
+  //
+  // Template Implementation
+  //
+
+
+  // Factoring constructor
+  template <typename T>
+  LUDecomposition<T>::LUDecomposition(const Matrix<T>& A)
+        : factors(A),
+          pivots(A.getNumRows()),
+          pivotSign(1),
+          singular(false)
+  {
+    static_assert(!std::is_integral<T>::value, "LUDecomposition - Integer elements would be truncated by the elimination!");
+
+    // Only square matrices have an LU factorization here:
+    if ( !A.isSquare() )
+    {
+      throw std::logic_error("LUDecomposition::LUDecomposition - Matrix must be square!");
+    }
+
+    const std::size_t n = A.getNumRows();
+    const std::size_t ld = factors.getLeadingDim();
+    T* a = factors.data();
+
+    for (std::size_t k0=0; k0<n; k0+=factorBlockSize)
+    {
+      const std::size_t kb = std::min(factorBlockSize, n - k0);
+      const std::size_t rest = n - k0 - kb;
+
+      // Factor the panel (swaps whole rows, so the left and right parts follow):
+      this->factorPanel(k0, kb);
+
+      if ( rest > 0 )
+      {
+        // U12 = L11^-1 * A12:
+        factorImpl::solveLower<T>(kb, rest, a + k0*ld + k0, ld, a + k0*ld + k0 + kb, ld, true);
+
+        // A22 -= L21 * U12:
+        gemm<T>(rest, rest, kb,
+                T(-1), a + (k0 + kb)*ld + k0, ld, 1,
+                       a + k0*ld + k0 + kb, ld, 1,
+                T(1),  a + (k0 + kb)*ld + k0 + kb, ld, 1);
+      }
+    }
+
+    // Negligible next to U's largest element (at working precision), as QR's rank test:
+    typedef decltype(std::abs(T(0))) Real;
+    Real largest = 0;
+    for (std::size_t i=0; i<n; ++i)
+    {
+      for (std::size_t j=i; j<n; ++j)
+      {
+        largest = std::max(largest, Real(std::abs(a[i*ld + j])));
+      }
+    }
+
+    const Real tolerance = largest*Real(n)*std::numeric_limits<Real>::epsilon();
+    for (std::size_t i=0; i<n; ++i)
+    {
+      if ( !(std::abs(a[i*ld + i]) > tolerance) )
+      {
+        singular = true;
+      }
+    }
+  }
+
+  // factorPanel
+  template <typename T>
+  void LUDecomposition<T>::factorPanel(std::size_t k0, std::size_t kb)
+  {
+    const std::size_t n = factors.getNumRows();
+    const std::size_t ld = factors.getLeadingDim();
+    T* a = factors.data();
+
+    for (std::size_t j=k0; j<k0+kb; ++j)
+    {
+      // Pivot: largest magnitude in column j at or below the diagonal:
+      std::size_t p = j;
+      auto best = std::abs(a[j*ld + j]);
+      for (std::size_t i=j+1; i<n; ++i)
+      {
+        const auto mag = std::abs(a[i*ld + j]);
+        if ( mag > best )
+        {
+          best = mag;
+          p = i;
+        }
+      }
+
+      pivots[j] = uint32_t(p);
+      if ( p != j )
+      {
+        std::swap_ranges(a + j*ld, a + j*ld + n, a + p*ld);
+        pivotSign = -pivotSign;
+      }
+
+      // A zero column can't be eliminated; the matrix is singular:
+      const T pivot = a[j*ld + j];
+      if ( pivot == T(0) )
+      {
+        singular = true;
+        continue;
+      }
+
+      // Multipliers, then update the rest of the panel:
+      const std::size_t width = k0 + kb - (j + 1);
+      for (std::size_t i=j+1; i<n; ++i)
+      {
+        const T l = a[i*ld + j] /= pivot;
+        if ( width > 0 )
+        {
+          simdAxpy(T(-l), a + j*ld + j + 1, a + i*ld + j + 1, width);
+        }
+      }
+    }
+  }
+
+  // permute
+  template <typename T>
+  void LUDecomposition<T>::permute(T* b, std::size_t nrhs, std::size_t ldb) const
+  {
+    for (std::size_t i=0; i<pivots.size(); ++i)
+    {
+      if ( pivots[i] != i )
+      {
+        std::swap_ranges(b + i*ldb, b + i*ldb + nrhs, b + std::size_t(pivots[i])*ldb);
+      }
+    }
+  }
+
+  // getL
+  template <typename T>
+  Matrix<T> LUDecomposition<T>::getL() const
+  {
+    const uint32_t n = factors.getNumRows();
+    Matrix<T> result(n, n, T(0));
+
+    for (uint32_t i=0; i<n; ++i)
+    {
+      const T* src = factors.rowPtr(i);
+      T* dst = result.rowPtr(i);
+      std::copy(src, src + i, dst);
+      dst[i] = T(1);
+    }
+
+    return result;
+  }
+
+  // getU
+  template <typename T>
+  Matrix<T> LUDecomposition<T>::getU() const
+  {
+    const uint32_t n = factors.getNumRows();
+    Matrix<T> result(n, n, T(0));
+
+    for (uint32_t i=0; i<n; ++i)
+    {
+      const T* src = factors.rowPtr(i);
+      std::copy(src + i, src + n, result.rowPtr(i) + i);
+    }
+
+    return result;
+  }
+
+  // determinant
+  template <typename T>
+  T LUDecomposition<T>::determinant() const
+  {
+    // Numerically singular:
+    if ( singular )
+    {
+      return T(0);
+    }
+
+    // det(A) = det(P) * product of U's diagonal:
+    T det = T(pivotSign);
+    for (uint32_t i=0; i<factors.getNumRows(); ++i)
+    {
+      det *= factors.rowPtr(i)[i];
+    }
+
+    return det;
+  }
+
+  // solve (Matrix)
+  template <typename T>
+  Matrix<T> LUDecomposition<T>::solve(const Matrix<T>& B) const
+  {
+    // Right-hand sides need one row per unknown:
+    if ( B.getNumRows() != factors.getNumRows() )
+    {
+      throw std::logic_error("LUDecomposition::solve - Right-hand side must have as many rows as the matrix!");
+    }
+
+    // No unique solution without all the pivots:
+    if ( singular )
+    {
+      throw std::logic_error("LUDecomposition::solve - Matrix is singular!");
+    }
+
+    // P*A*X = P*B  =>  L*(U*X) = P*B:
+    Matrix<T> X = B;
+    const std::size_t n = factors.getNumRows(), nrhs = X.getNumCols();
+    this->permute(X.data(), nrhs, X.getLeadingDim());
+    factorImpl::solveLower<T>(n, nrhs, factors.data(), factors.getLeadingDim(), X.data(), X.getLeadingDim(), true);
+    factorImpl::solveUpper<T>(n, nrhs, factors.data(), factors.getLeadingDim(), X.data(), X.getLeadingDim(), false);
+
+    return X;
+  }
+
+  // solve (vector)
+  template <typename T>
+  std::vector<T> LUDecomposition<T>::solve(const std::vector<T>& b) const
+  {
+    // Right-hand side needs one element per unknown:
+    if ( b.size() != factors.getNumRows() )
+    {
+      throw std::logic_error("LUDecomposition::solve - Right-hand side must have as many rows as the matrix!");
+    }
+
+    // No unique solution without all the pivots:
+    if ( singular )
+    {
+      throw std::logic_error("LUDecomposition::solve - Matrix is singular!");
+    }
+
+    std::vector<T> x = b;
+    const std::size_t n = factors.getNumRows();
+    this->permute(x.data(), 1, 1);
+    factorImpl::solveLower<T>(n, 1, factors.data(), factors.getLeadingDim(), x.data(), 1, true);
+    factorImpl::solveUpper<T>(n, 1, factors.data(), factors.getLeadingDim(), x.data(), 1, false);
+
+    return x;
+  }
+
+  // inverse
+  template <typename T>
+  Matrix<T> LUDecomposition<T>::inverse() const
+  {
+    return this->solve(factors.identity());
+  }
+
+} // matrix namespace
+
+#endif // MATRIX_LU_H
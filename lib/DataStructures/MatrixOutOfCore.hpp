@@ -0,0 +1,398 @@
+////////////////////////////////////////
+//
+//  File:
+//      \file MatrixOutOfCore.hpp
+//
+//  Description:
+//      \brief Matrix Out-Of-Core: Tiled multiplication of matrix files larger than memory
+//
+//  Author:
+//      \author J. Caleb Wherry
+//
+////////////////////////////////////////
+
+// Include Guards:
+#ifndef MATRIX_OUT_OF_CORE_H
+#define MATRIX_OUT_OF_CORE_H
+
+// Forward Declared Dependencies:
+//
+
+// Local Include Dependencies:
+#include "MatrixFile.hpp"
+#include "MatrixGemm.hpp"
+#include "AlignedBuffer.hpp"
+
+// Compiler Include Dependencies:
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cmath>
+#include <string>
+#include <future>
+#include <stdexcept>
+#include <algorithm>
+
+/// matrix Namespace
+namespace matrix
+{
+
+  /// Default memory budget of multiplyOutOfCore (bytes)
+  const std::size_t outOfCoreBudget = std::size_t(256) << 20;
+
+  /// How multiplyOutOfCore tiled a product, and the I/O it did
+  struct OutOfCoreStats
+  {
+    uint32_t tileRows;        ///< Rows of each C (and A) tile
+    uint32_t tileCols;        ///< Columns of each C (and B) tile
+    uint32_t tileDepth;       ///< Columns of each A tile (rows of each B tile)
+    std::size_t bufferBytes;  ///< Memory held by tile buffers (never above the budget)
+    uint64_t bytesRead;       ///< Bytes read from the input files (and C, when re-read)
+    uint64_t bytesWritten;    ///< Bytes written to the output file
+  };
+
+  /// oocImpl namespace (out-of-core internals)
+  namespace oocImpl
+  {
+
+    /// Preferred tile depth: rows of B read per tile, long enough to stream well
+    const std::size_t depthTarget = 512;
+
+    /// Unbuffered file addressed by absolute byte offsets (64-bit everywhere)
+    class File
+    {
+      private:
+        std::FILE* file;
+        std::string path;
+
+        void seek(uint64_t offset)
+        {
+#if defined(_WIN32)
+          const bool ok = (_fseeki64(file, static_cast<__int64>(offset), SEEK_SET) == 0);
+#else
+          const bool ok = (fseeko(file, static_cast<off_t>(offset), SEEK_SET) == 0);
+#endif
+          if ( !ok )
+          {
+            fileImpl::fail("Matrix::multiplyOutOfCore", path, "Seek failed");
+          }
+        }
+
+      public:
+        File(const std::string& _path, const char* mode) : file(std::fopen(_path.c_str(), mode)), path(_path)
+        {
+          if ( file == nullptr )
+          {
+            fileImpl::fail("Matrix::multiplyOutOfCore", path, "Cannot open file");
+          }
+
+          // Tiles are large; stdio's buffer would only add a copy:
+          std::setvbuf(file, nullptr, _IONBF, 0);
+        }
+
+        ~File() { if ( file != nullptr ) { std::fclose(file); } }
+
+        File(const File&) = delete;
+        File& operator=(const File&) = delete;
+
+        const std::string& getPath() const { return path; };
+
+        uint64_t size()
+        {
+#if defined(_WIN32)
+          const bool ok = (_fseeki64(file, 0, SEEK_END) == 0);
+          const long long end = ok ? _ftelli64(file) : -1;
+#else
+          const bool ok = (fseeko(file, 0, SEEK_END) == 0);
+          const long long end = ok ? static_cast<long long>(ftello(file)) : -1;
+#endif
+          if ( end < 0 )
+          {
+            fileImpl::fail("Matrix::multiplyOutOfCore", path, "Cannot size file");
+          }
+          return uint64_t(end);
+        }
+
+        void read(uint64_t offset, void* dst, std::size_t n)
+        {
+          this->seek(offset);
+          if ( std::fread(dst, 1, n, file) != n )
+          {
+            fileImpl::fail("Matrix::multiplyOutOfCore", path, "File is truncated");
+          }
+        }
+
+        void write(uint64_t offset, const void* src, std::size_t n)
+        {
+          this->seek(offset);
+          if ( std::fwrite(src, 1, n, file) != n )
+          {
+            fileImpl::fail("Matrix::multiplyOutOfCore", path, "Write failed");
+          }
+        }
+
+        void close()
+        {
+          const bool ok = (std::fclose(file) == 0);
+          file = nullptr;
+          if ( !ok )
+          {
+            fileImpl::fail("Matrix::multiplyOutOfCore", path, "Write failed");
+          }
+        }
+    };
+
+    /// Read and check the header of a matrix file of T
+    template <typename T>
+    MatrixFileHeader readHeader(File& f)
+    {
+      const uint64_t bytes = f.size();
+      MatrixFileHeader header;
+      if ( bytes < sizeof(header) )
+      {
+        fileImpl::fail("Matrix::multiplyOutOfCore", f.getPath(), "File is truncated");
+      }
+      f.read(0, &header, sizeof(header));
+      checkMatrixFileHeader<T>(header, bytes, f.getPath());
+      return header;
+    }
+
+    /// Tile sizes for C (m x n) = A (m x k) * B (k x n) within a budget of
+    ///  elements: two C tiles plus two A and two B tiles (double buffering)
+    ///
+    /// A is re-read once per column of C tiles and B once per row of them, so
+    /// C tiles are made as large and square as the budget allows; the depth
+    /// only sets the size of each read and is kept moderate.
+    inline void planTiles(std::size_t m, std::size_t n, std::size_t k, std::size_t budget,
+                          std::size_t& mb, std::size_t& nb, std::size_t& kb)
+    {
+      // Depth no more than the side of an even three-way split, so a small
+      //  budget still buys wide tiles:
+      const std::size_t cube = std::size_t(std::sqrt(double(budget)/6.0));
+      kb = std::max<std::size_t>(1, std::min(std::min(k, depthTarget), cube));
+
+      // Largest square t with 2t^2 + 4t*kb <= budget:
+      const double root = std::sqrt(double(kb)*double(kb) + double(budget)/2.0) - double(kb);
+      std::size_t t = (root > 0.0) ? std::size_t(root) : 0;
+      while ( (t > 0) && (2*t*t + 4*t*kb > budget) )
+      {
+        --t;
+      }
+      if ( t == 0 )
+      {
+        throw std::logic_error("Matrix::multiplyOutOfCore - Memory budget is too small!");
+      }
+
+      mb = std::min(m, t);
+      nb = std::min(n, t);
+
+      // Budget a short dimension leaves unused goes to the other one, then to the depth:
+      if ( (mb == m) && (nb < n) )
+      {
+        nb = std::min(n, (budget - 2*kb*mb)/(2*mb + 2*kb));
+      }
+      else if ( (nb == n) && (mb < m) )
+      {
+        mb = std::min(m, (budget - 2*kb*nb)/(2*nb + 2*kb));
+      }
+      if ( (mb == m) && (nb == n) && (k > kb) )
+      {
+        kb = std::max(kb, std::min(k, (budget - 2*mb*nb)/(2*(mb + nb))));
+      }
+    }
+
+  } // oocImpl namespace
+
+
+  /// Out-of-core matrix multiply: file C = file A * file B
+  ///
+  /// A, B and C are in the binary matrix file format (MatrixFile.hpp) and need
+  /// not fit in memory: C is computed a tile at a time, each tile accumulated
+  /// over a sweep of A and B tiles with the in-core GEMM engine and written
+  /// back once complete. A background thread reads the next pair of input
+  /// tiles and writes the previous C tile while the current one is computed,
+  /// so with enough arithmetic per tile the run is bound by disk bandwidth.
+  /// Tiles are fetched with explicit reads rather than through a mapping, so
+  /// memory stays under memoryBudget bytes and nothing is left to page faults.
+  ///
+  /// Only the input headers are checked; run verifyMatrixFile() first to also
+  /// check their payloads. C gets full checksums.
+  template <typename T>
+  OutOfCoreStats multiplyOutOfCore(
+    const std::string& pathA,                     ///< Left factor (m x k).
+    const std::string& pathB,                     ///< Right factor (k x n).
+    const std::string& pathC,                     ///< Product (m x n), created or replaced.
+    std::size_t memoryBudget = outOfCoreBudget    ///< Bytes of tile buffers allowed.
+  )
+  {
+    if ( (pathC == pathA) || (pathC == pathB) )
+    {
+      throw std::logic_error("Matrix::multiplyOutOfCore - Output would overwrite an input!");
+    }
+
+    oocImpl::File fileA(pathA, "rb");
+    oocImpl::File fileB(pathB, "rb");
+    const MatrixFileHeader headerA = oocImpl::readHeader<T>(fileA);
+    const MatrixFileHeader headerB = oocImpl::readHeader<T>(fileB);
+    if ( headerA.cols != headerB.rows )
+    {
+      throw std::logic_error("Matrix::multiplyOutOfCore - Matrix dimensions do not agree!");
+    }
+
+    const std::size_t m = std::size_t(headerA.rows);
+    const std::size_t n = std::size_t(headerB.cols);
+    const std::size_t k = std::size_t(headerA.cols);
+
+    OutOfCoreStats stats;
+    std::size_t mb = 0, nb = 0, kb = 0;
+    if ( (m > 0) && (n > 0) )
+    {
+      oocImpl::planTiles(m, n, k, memoryBudget/sizeof(T), mb, nb, kb);
+    }
+    stats.tileRows = uint32_t(mb);
+    stats.tileCols = uint32_t(nb);
+    stats.tileDepth = uint32_t(kb);
+    stats.bufferBytes = (2*mb*nb + 2*kb*(mb + nb))*sizeof(T);
+    stats.bytesRead = 0;
+    stats.bytesWritten = 0;
+
+    MatrixFileHeader headerC = fileImpl::makeHeader<T>(uint32_t(m), uint32_t(n));
+    oocImpl::File fileC(pathC, "w+b");
+    fileC.write(0, &headerC, sizeof(headerC));
+
+    // Tiles are visited row of tiles by row of tiles; each takes kTiles steps:
+    const std::size_t iTiles = (mb > 0) ? (m + mb - 1)/mb : 0;
+    const std::size_t jTiles = (nb > 0) ? (n + nb - 1)/nb : 0;
+    const std::size_t kTiles = ((k > 0) && (kb > 0)) ? (k + kb - 1)/kb : 1;
+    const std::size_t steps = iTiles*jTiles*kTiles;
+
+    // With full-width tiles C is written front to back and checksummed on the way:
+    const bool streamed = (nb == n);
+    uint32_t checksum = 0;
+
+    AlignedBuffer<T> aTile[2] = { AlignedBuffer<T>(mb*kb), AlignedBuffer<T>(mb*kb) };
+    AlignedBuffer<T> bTile[2] = { AlignedBuffer<T>(kb*nb), AlignedBuffer<T>(kb*nb) };
+    AlignedBuffer<T> cTile[2] = { AlignedBuffer<T>(mb*nb), AlignedBuffer<T>(mb*nb) };
+
+    const uint64_t offsetA = headerA.payloadOffset;
+    const uint64_t offsetB = headerB.payloadOffset;
+    const uint64_t offsetC = headerC.payloadOffset;
+
+    // Read the A and B tiles of step s into buffer s%2:
+    auto load = [&](std::size_t s) {
+      const std::size_t tile = s/kTiles, p0 = (s%kTiles)*kb;
+      const std::size_t i0 = (tile/jTiles)*mb, j0 = (tile%jTiles)*nb;
+      const std::size_t h = std::min(mb, m - i0), w = std::min(nb, n - j0), d = std::min(kb, k - std::min(k, p0));
+      T* a = aTile[s%2].data();
+      T* b = bTile[s%2].data();
+
+      if ( d == k )
+      {
+        fileA.read(offsetA + uint64_t(i0)*k*sizeof(T), a, h*d*sizeof(T));
+      }
+      else
+      {
+        for (std::size_t i=0; i<h; ++i)
+        {
+          fileA.read(offsetA + (uint64_t(i0 + i)*k + p0)*sizeof(T), a + i*d, d*sizeof(T));
+        }
+      }
+
+      if ( w == n )
+      {
+        fileB.read(offsetB + uint64_t(p0)*n*sizeof(T), b, d*w*sizeof(T));
+      }
+      else
+      {
+        for (std::size_t p=0; p<d; ++p)
+        {
+          fileB.read(offsetB + (uint64_t(p0 + p)*n + j0)*sizeof(T), b + p*w, w*sizeof(T));
+        }
+      }
+      stats.bytesRead += (h + w)*d*sizeof(T);
+    };
+
+    // Write C tile t from buffer t%2:
+    auto store = [&](std::size_t tile) {
+      const std::size_t i0 = (tile/jTiles)*mb, j0 = (tile%jTiles)*nb;
+      const std::size_t h = std::min(mb, m - i0), w = std::min(nb, n - j0);
+      const T* c = cTile[tile%2].data();
+
+      if ( streamed )
+      {
+        fileC.write(offsetC + uint64_t(i0)*n*sizeof(T), c, h*w*sizeof(T));
+        checksum = crc32c(checksum, c, h*w*sizeof(T));
+      }
+      else
+      {
+        for (std::size_t i=0; i<h; ++i)
+        {
+          fileC.write(offsetC + (uint64_t(i0 + i)*n + j0)*sizeof(T), c + i*w, w*sizeof(T));
+        }
+      }
+      stats.bytesWritten += h*w*sizeof(T);
+    };
+
+    // Declared after the buffers, so an exception still waits for the I/O thread before they go:
+    std::future<void> io;
+    if ( steps > 0 )
+    {
+      io = std::async(std::launch::async, [&]() { load(0); });
+    }
+
+    for (std::size_t s=0; s<steps; ++s)
+    {
+      io.get();
+
+      // Tile t-1 finished on the previous step; write it out while t starts:
+      const std::size_t tile = s/kTiles, p = s%kTiles;
+      const bool storePrevious = (p == 0) && (tile > 0);
+      io = std::async(std::launch::async, [&, s, tile, storePrevious]() {
+        if ( storePrevious )
+        {
+          store(tile - 1);
+        }
+        if ( s + 1 < steps )
+        {
+          load(s + 1);
+        }
+      });
+
+      const std::size_t i0 = (tile/jTiles)*mb, j0 = (tile%jTiles)*nb, p0 = p*kb;
+      const std::size_t h = std::min(mb, m - i0), w = std::min(nb, n - j0), d = std::min(kb, k - std::min(k, p0));
+      gemm<T>(h, w, d, T(1),
+              aTile[s%2].data(), std::ptrdiff_t(d), 1,
+              bTile[s%2].data(), std::ptrdiff_t(w), 1,
+              (p == 0) ? T(0) : T(1),
+              cTile[tile%2].data(), std::ptrdiff_t(w), 1);
+    }
+
+    if ( steps > 0 )
+    {
+      io.get();
+      store(iTiles*jTiles - 1);
+    }
+
+    // Column-tiled output has to be read back, in order, for its checksum:
+    if ( !streamed )
+    {
+      AlignedBuffer<T> row(n);
+      for (std::size_t i=0; i<m; ++i)
+      {
+        fileC.read(offsetC + uint64_t(i)*n*sizeof(T), row.data(), n*sizeof(T));
+        checksum = crc32c(checksum, row.data(), n*sizeof(T));
+      }
+      stats.bytesRead += uint64_t(m)*n*sizeof(T);
+    }
+
+    headerC.payloadChecksum = checksum;
+    headerC.headerChecksum = crc32c(0, &headerC, sizeof(headerC));
+    fileC.write(0, &headerC, sizeof(headerC));
+    fileC.close();
+
+    return stats;
+  }
+
+} // matrix namespace
+
+#endif // MATRIX_OUT_OF_CORE_H
@@ -0,0 +1,388 @@
+////////////////////////////////////////
+//
+//  File:
+//      \file MatrixPredicates.hpp
+//
+//  Description:
+//      \brief Matrix Predicates: In-place, early-exit structural checks with tolerances
+//
+//  Author:
+//      \author J. Caleb Wherry
+//
+////////////////////////////////////////
+
+// Include Guards:
+#ifndef MATRIX_PREDICATES_H
+#define MATRIX_PREDICATES_H
+
+// Forward Declared Dependencies:
+//
+
+// Local Include Dependencies:
+#include "MatrixGemm.hpp"
+#include "ThreadPool.hpp"
+
+// Compiler Include Dependencies:
+#include <cstddef>
+#include <cmath>
+#include <complex>
+#include <type_traits>
+#include <vector>
+#include <algorithm>
+
+/// matrix Namespace
+namespace matrix
+{
+
+  /// predicateImpl namespace (kernels behind Matrix's boolean properties)
+  ///
+  /// Every check reads the matrix where it lies and returns at the first
+  /// mismatch. Elements x and y agree when |x - y| <= absTol + relTol*max(|x|, |y|),
+  /// so zero tolerances mean exact equality.
+  namespace predicateImpl
+  {
+
+    /// Side of the square tiles the mirror checks walk (keeps a[i][j] and a[j][i] in cache)
+    const std::size_t predicateTile = 32;
+
+    /// Rows of each product checked per GEMM
+    const std::size_t predicateBand = 128;
+
+    /// Element as stored (real types) or conjugated
+    template <typename T>
+    inline T conjugateIf(const T& x, bool) { return x; }
+
+    /// Element as stored or conjugated (complex element types)
+    template <typename U>
+    inline std::complex<U> conjugateIf(const std::complex<U>& x, bool conj) { return conj ? std::conj(x) : x; }
+
+    /// |x| (signed, floating-point and complex element types)
+    template <typename T>
+    inline double magnitude(const T& x, std::false_type) { return double(std::abs(x)); }
+
+    /// |x| (unsigned element types, where std::abs is ambiguous)
+    template <typename T>
+    inline double magnitude(const T& x, std::true_type) { return double(x); }
+
+    /// |x - y| (signed, floating-point and complex element types)
+    template <typename T>
+    inline double distance(const T& x, const T& y, std::false_type) { return double(std::abs(x - y)); }
+
+    /// |x - y| (unsigned element types, without wrapping around)
+    template <typename T>
+    inline double distance(const T& x, const T& y, std::true_type) { return double((x > y) ? x - y : y - x); }
+
+    /// Do x and y agree to within the tolerances?
+    template <typename T>
+    inline bool nearlyEqual(const T& x, const T& y, double absTol, double relTol)
+    {
+      if ( x == y )
+      {
+        return true;
+      }
+
+      const double diff = distance(x, y, std::is_unsigned<T>());
+      const double scale = std::max(magnitude(x, std::is_unsigned<T>()), magnitude(y, std::is_unsigned<T>()));
+      return diff <= absTol + relTol*scale;
+    }
+
+    /// sum_k x[k*incx] * op(y[k*incy]), op conjugating when conjY is set
+    template <typename T>
+    inline T dot(std::size_t n, const T* x, std::size_t incx, const T* y, std::size_t incy, bool conjY)
+    {
+      T sum = T(0);
+      for (std::size_t k=0; k<n; ++k)
+      {
+        sum += x[k*incx]*conjugateIf(y[k*incy], conjY);
+      }
+      return sum;
+    }
+
+    /// Does left(i) agree with right(i) for every i < n?
+    ///
+    /// The product checks screen their diagonals this way first: it costs
+    /// O(n^2) and rejects most candidates before any GEMM runs.
+    template <typename T, typename Left, typename Right>
+    bool diagonalAgrees(std::size_t n, const Left& left, const Right& right, double absTol, double relTol)
+    {
+      return parallelAll(0, n, [&](std::size_t lo, std::size_t hi) {
+        for (std::size_t i=lo; i<hi; ++i)
+        {
+          if ( !nearlyEqual<T>(left(i), right(i), absTol, relTol) )
+          {
+            return false;
+          }
+        }
+        return true;
+      }, getParallelThreshold()/(n + 1) + 1);
+    }
+
+    /// Does the band c (rows x cols, row stride ldc, holding rows row0..) agree with expected(i, j)?
+    template <typename T, typename Expected>
+    bool bandAgrees(std::size_t row0, std::size_t rows, std::size_t cols, const T* c, std::size_t ldc,
+                    const Expected& expected, double absTol, double relTol)
+    {
+      for (std::size_t r=0; r<rows; ++r)
+      {
+        bool ok = true;
+        for (std::size_t j=0; j<cols; ++j)
+        {
+          ok &= nearlyEqual<T>(c[r*ldc + j], expected(row0 + r, j), absTol, relTol);
+        }
+        if ( !ok )
+        {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    /// Is a (n x n) equal to its mirror, a[i][j] = s*op(a[j][i])?
+    ///
+    /// s is -1 with negate and op conjugates with conj, which covers the
+    /// symmetric, skew-symmetric, Hermitian and skew-Hermitian checks. Only
+    /// the lower triangle (and diagonal) is walked, tile by tile.
+    template <typename T>
+    bool mirrored(std::size_t n, const T* a, std::size_t ld, bool negate, bool conj, double absTol, double relTol)
+    {
+      const std::size_t blocks = (n + predicateTile - 1)/predicateTile;
+      return parallelAll(0, blocks, [=](std::size_t lo, std::size_t hi) {
+        for (std::size_t bi=lo; bi<hi; ++bi)
+        {
+          const std::size_t i0 = bi*predicateTile;
+          const std::size_t i1 = std::min(i0 + predicateTile, n);
+          for (std::size_t j0=0; j0<i1; j0+=predicateTile)
+          {
+            const std::size_t j1 = std::min(j0 + predicateTile, n);
+            for (std::size_t i=i0; i<i1; ++i)
+            {
+              bool ok = true;
+              const std::size_t jEnd = std::min(j1, i + 1);
+              for (std::size_t j=j0; j<jEnd; ++j)
+              {
+                const T mirror = conjugateIf(a[j*ld + i], conj);
+                ok &= nearlyEqual<T>(a[i*ld + j], negate ? T(-mirror) : mirror, absTol, relTol);
+              }
+              if ( !ok )
+              {
+                return false;
+              }
+            }
+          }
+        }
+        return true;
+      }, getParallelThreshold()/(predicateTile*n/2 + 1) + 1);
+    }
+
+    /// Is a (n x n) the identity?
+    template <typename T>
+    bool identity(std::size_t n, const T* a, std::size_t ld, double absTol, double relTol)
+    {
+      return parallelAll(0, n, [=](std::size_t lo, std::size_t hi) {
+        for (std::size_t i=lo; i<hi; ++i)
+        {
+          bool ok = true;
+          for (std::size_t j=0; j<n; ++j)
+          {
+            ok &= nearlyEqual<T>(a[i*ld + j], (i == j) ? T(1) : T(0), absTol, relTol);
+          }
+          if ( !ok )
+          {
+            return false;
+          }
+        }
+        return true;
+      }, getParallelThreshold()/(n + 1) + 1);
+    }
+
+    /// Is a*op(a)^T = I, op conjugating with conj? (orthogonal / unitary)
+    ///
+    /// The Gram matrix is Hermitian, so only its lower triangle is formed, one
+    /// band of rows at a time.
+    template <typename T>
+    bool orthonormal(std::size_t n, const T* a, std::size_t ld, bool conj, double absTol, double relTol)
+    {
+      // Every row needs unit length:
+      if ( !diagonalAgrees<T>(n,
+                              [=](std::size_t i) { return dot(n, a + i*ld, 1, a + i*ld, 1, conj); },
+                              [](std::size_t) { return T(1); },
+                              absTol, relTol) )
+      {
+        return false;
+      }
+
+      std::vector<T> s(conj ? predicateBand*n : 0), c(predicateBand*n);
+      for (std::size_t i0=0; i0<n; i0+=predicateBand)
+      {
+        const std::size_t bb = std::min(predicateBand, n - i0);
+        const std::size_t cols = i0 + bb;
+
+        // conj(A_band)*A^T is the conjugate of (A*A^H)_band, which is I exactly when that is:
+        const T* rows = a + i0*ld;
+        std::size_t ldr = ld;
+        if ( conj )
+        {
+          for (std::size_t r=0; r<bb; ++r)
+          {
+            for (std::size_t k=0; k<n; ++k)
+            {
+              s[r*n + k] = conjugateIf(a[(i0 + r)*ld + k], true);
+            }
+          }
+          rows = s.data();
+          ldr = n;
+        }
+
+        gemm<T>(bb, cols, n,
+                T(1), rows, ldr, 1,
+                      a, 1, ld,
+                T(0), c.data(), cols, 1);
+
+        if ( !bandAgrees(i0, bb, cols, c.data(), cols,
+                         [](std::size_t i, std::size_t j) { return (i == j) ? T(1) : T(0); },
+                         absTol, relTol) )
+        {
+          return false;
+        }
+      }
+
+      return true;
+    }
+
+    /// Is a*a^H = a^H*a?
+    ///
+    /// Both products are Hermitian, so only their lower triangles are compared.
+    template <typename T>
+    bool normal(std::size_t n, const T* a, std::size_t ld, double absTol, double relTol)
+    {
+      // Each row must be as long as the matching column:
+      if ( !diagonalAgrees<T>(n,
+                              [=](std::size_t i) { return dot(n, a + i*ld, 1, a + i*ld, 1, true); },
+                              [=](std::size_t i) { return dot(n, a + i, ld, a + i, ld, true); },
+                              absTol, relTol) )
+      {
+        return false;
+      }
+
+      std::vector<T> s1(predicateBand*n), s2(predicateBand*n), c1(predicateBand*n), c2(predicateBand*n);
+      for (std::size_t i0=0; i0<n; i0+=predicateBand)
+      {
+        const std::size_t bb = std::min(predicateBand, n - i0);
+        const std::size_t cols = i0 + bb;
+
+        // s1 = conj(A_band) and s2 = (A^H)_band, the conjugated band columns:
+        for (std::size_t r=0; r<bb; ++r)
+        {
+          for (std::size_t k=0; k<n; ++k)
+          {
+            s1[r*n + k] = conjugateIf(a[(i0 + r)*ld + k], true);
+          }
+        }
+        for (std::size_t k=0; k<n; ++k)
+        {
+          for (std::size_t r=0; r<bb; ++r)
+          {
+            s2[r*n + k] = conjugateIf(a[k*ld + i0 + r], true);
+          }
+        }
+
+        // c1 = conj((A*A^H)_band), c2 = (A^H*A)_band:
+        gemm<T>(bb, cols, n,
+                T(1), s1.data(), n, 1,
+                      a, 1, ld,
+                T(0), c1.data(), cols, 1);
+        gemm<T>(bb, cols, n,
+                T(1), s2.data(), n, 1,
+                      a, ld, 1,
+                T(0), c2.data(), cols, 1);
+
+        const T* p = c2.data();
+        if ( !bandAgrees(i0, bb, cols, c1.data(), cols,
+                         [=](std::size_t i, std::size_t j) { return conjugateIf(p[(i - i0)*cols + j], true); },
+                         absTol, relTol) )
+        {
+          return false;
+        }
+      }
+
+      return true;
+    }
+
+    /// Is a*a = a?
+    template <typename T>
+    bool projection(std::size_t n, const T* a, std::size_t ld, double absTol, double relTol)
+    {
+      // (A^2)_ii against a_ii:
+      if ( !diagonalAgrees<T>(n,
+                              [=](std::size_t i) { return dot(n, a + i*ld, 1, a + i, ld, false); },
+                              [=](std::size_t i) { return a[i*ld + i]; },
+                              absTol, relTol) )
+      {
+        return false;
+      }
+
+      std::vector<T> c(predicateBand*n);
+      for (std::size_t i0=0; i0<n; i0+=predicateBand)
+      {
+        const std::size_t bb = std::min(predicateBand, n - i0);
+
+        gemm<T>(bb, n, n,
+                T(1), a + i0*ld, ld, 1,
+                      a, ld, 1,
+                T(0), c.data(), n, 1);
+
+        if ( !bandAgrees(i0, bb, n, c.data(), n,
+                         [=](std::size_t i, std::size_t j) { return a[i*ld + j]; },
+                         absTol, relTol) )
+        {
+          return false;
+        }
+      }
+
+      return true;
+    }
+
+    /// Is a*b = b*a (both n x n)?
+    template <typename T>
+    bool commute(std::size_t n, const T* a, std::size_t lda, const T* b, std::size_t ldb, double absTol, double relTol)
+    {
+      // (AB)_ii against (BA)_ii:
+      if ( !diagonalAgrees<T>(n,
+                              [=](std::size_t i) { return dot(n, a + i*lda, 1, b + i, ldb, false); },
+                              [=](std::size_t i) { return dot(n, b + i*ldb, 1, a + i, lda, false); },
+                              absTol, relTol) )
+      {
+        return false;
+      }
+
+      std::vector<T> c1(predicateBand*n), c2(predicateBand*n);
+      for (std::size_t i0=0; i0<n; i0+=predicateBand)
+      {
+        const std::size_t bb = std::min(predicateBand, n - i0);
+
+        gemm<T>(bb, n, n,
+                T(1), a + i0*lda, lda, 1,
+                      b, ldb, 1,
+                T(0), c1.data(), n, 1);
+        gemm<T>(bb, n, n,
+                T(1), b + i0*ldb, ldb, 1,
+                      a, lda, 1,
+                T(0), c2.data(), n, 1);
+
+        const T* p = c2.data();
+        if ( !bandAgrees(i0, bb, n, c1.data(), n,
+                         [=](std::size_t i, std::size_t j) { return p[(i - i0)*n + j]; },
+                         absTol, relTol) )
+        {
+          return false;
+        }
+      }
+
+      return true;
+    }
+
+  } // predicateImpl namespace
+
+} // matrix namespace
+
+#endif // MATRIX_PREDICATES_H
@@ -0,0 +1,406 @@
+////////////////////////////////////////
+//
+//  File:
+//      \file MatrixQR.hpp
+//
+//  Description:
+//      \brief Matrix QR: Blocked Householder QR factorization and least squares
+//
+//  Author:
+//      \author J. Caleb Wherry
+//
+////////////////////////////////////////
+
+// Include Guards:
+#ifndef MATRIX_QR_H
+#define MATRIX_QR_H
+
+// Forward Declared Dependencies:
+//
+
+// Local Include Dependencies:
+#include "Matrix.hpp"
+#include "MatrixLU.hpp"
+#include "AlignedBuffer.hpp"
+#include "MatrixGemm.hpp"
+#include "MatrixSimd.hpp"
+
+// Compiler Include Dependencies:
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <complex>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include <algorithm>
+
+/// matrix Namespace
+namespace matrix
+{
+
+  /// QR Decomposition class
+  ///
+  /// Factors an m x n A (m >= n) as A = Q*R with Householder reflections,
+  /// Q = H_0*H_1*...*H_(n-1) and H_j = I - tau_j*v_j*v_j^H. Each panel of
+  /// columns is reduced unblocked; its reflectors are then gathered into one
+  /// block reflector I - V*T*V^H and applied to the rest of the matrix with
+  /// GEMMs. Least-squares solves never form A^H*A, so they keep the accuracy
+  /// the normal equations lose.
+  template <typename T>
+  class QRDecomposition
+  {
+
+    private:
+      Matrix<T> factors;        ///< R on and above the diagonal, v_j below it (v_j's leading 1 implied)
+      std::vector<T> taus;      ///< Reflector scales
+
+      /// Reduce the columns [k0, k0+kb) (unblocked)
+      void factorPanel(std::size_t k0, std::size_t kb);
+
+      /// C = Q_k^H*C (adjoint) or Q_k*C for the panel [k0, k0+kb); C holds rows [k0, m)
+      void applyBlock(std::size_t k0, std::size_t kb, T* c, std::size_t ncols, std::size_t ldc, bool adjoint) const;
+
+      /// Q^H*B for every panel, in place (B has m rows)
+      void applyAdjoint(T* b, std::size_t ncols, std::size_t ldb) const;
+
+    public:
+
+
+      //
+      // Constructors:
+      //
+
+      /// Factoring Constructor
+      explicit QRDecomposition (
+        const Matrix<T>& A      ///< Matrix to factor, at least as many rows as columns.
+      );
+
+
+      //
+      // Accessors:
+      //
+
+      const Matrix<T>& getFactors() const { return factors; };    ///< Packed reflectors and R
+      const std::vector<T>& getTaus() const { return taus; };     ///< Reflector scales
+      Matrix<T> getQ() const;                                     ///< Thin Q (m x n, orthonormal columns)
+      Matrix<T> getR() const;                                     ///< R (n x n, upper triangular)
+
+
+      //
+      // Operations:
+      //
+
+      bool isFullRank() const;                        ///< No negligible diagonal element in R?
+      Matrix<T> solve(const Matrix<T>& B) const;      ///< X minimizing ||A*X - B|| (any number of columns)
+      std::vector<T> solve(const std::vector<T>& b) const;   ///< x minimizing ||A*x - b||
+
+  }; // QRDecomposition class
+
+
+  //
+  // Template Implementation
+  //
+
+
+  // Factoring constructor
+  template <typename T>
+  QRDecomposition<T>::QRDecomposition(const Matrix<T>& A)
+        : factors(A),
+          taus(A.getNumCols(), T(0))
+  {
+    // Wide matrices have no unique least-squares solution:
+    if ( A.getNumRows() < A.getNumCols() )
+    {
+      throw std::logic_error("QRDecomposition::QRDecomposition - Matrix must have at least as many rows as columns!");
+    }
+
+    const std::size_t n = A.getNumCols();
+    const std::size_t ld = factors.getLeadingDim();
+    T* a = factors.data();
+
+    for (std::size_t k0=0; k0<n; k0+=factorBlockSize)
+    {
+      const std::size_t kb = std::min(factorBlockSize, n - k0);
+      this->factorPanel(k0, kb);
+
+      // Trailing columns get the whole panel's reflectors at once:
+      if ( k0 + kb < n )
+      {
+        this->applyBlock(k0, kb, a + k0*ld + k0 + kb, n - k0 - kb, ld, true);
+      }
+    }
+  }
+
+  // factorPanel
+  template <typename T>
+  void QRDecomposition<T>::factorPanel(std::size_t k0, std::size_t kb)
+  {
+    typedef decltype(std::abs(T(0))) Real;
+
+    const std::size_t m = factors.getNumRows();
+    const std::size_t ld = factors.getLeadingDim();
+    T* a = factors.data();
+    std::vector<T> w(kb);
+
+    for (std::size_t j=k0; j<k0+kb; ++j)
+    {
+      // Reflector taking a(j:m, j) to beta*e_0 (as LAPACK's larfg):
+      const T alpha = a[j*ld + j];
+      // Column norm rescaled if its sum of squares over- or underflows (as dnrm2):
+      Real ss = 0;
+      for (std::size_t i=j+1; i<m; ++i)
+      {
+        ss += std::norm(a[i*ld + j]);
+      }
+      const Real xnorm = reduceImpl::euclidean<Real>(a + (j + 1)*ld + j, m - (j + 1), ld, ss);
+
+      if ( (xnorm == 0) && (factorImpl::realPart(alpha) == alpha) )
+      {
+        taus[j] = T(0);
+        continue;
+      }
+
+      const Real mag = std::hypot(Real(std::abs(alpha)), xnorm);
+      const Real beta = (factorImpl::realPart(alpha) >= 0) ? -mag : mag;
+      const T tau = (T(beta) - alpha)/T(beta);
+      const T scale = T(1)/(alpha - T(beta));
+      for (std::size_t i=j+1; i<m; ++i)
+      {
+        a[i*ld + j] *= scale;
+      }
+      a[j*ld + j] = T(beta);
+      taus[j] = tau;
+
+      // Apply H_j^H = I - conj(tau)*v*v^H to the rest of the panel, a row at a time:
+      const std::size_t width = k0 + kb - (j + 1);
+      if ( width == 0 )
+      {
+        continue;
+      }
+
+      std::copy(a + j*ld + j + 1, a + j*ld + j + 1 + width, w.begin());
+      for (std::size_t i=j+1; i<m; ++i)
+      {
+        simdAxpy(conjugate(a[i*ld + j]), a + i*ld + j + 1, w.data(), width);
+      }
+      simdMultiplyScalar(w.data(), conjugate(tau), w.data(), width);
+
+      simdAxpy(T(-1), w.data(), a + j*ld + j + 1, width);
+      for (std::size_t i=j+1; i<m; ++i)
+      {
+        simdAxpy(T(-a[i*ld + j]), w.data(), a + i*ld + j + 1, width);
+      }
+    }
+  }
+
+  // applyBlock
+  template <typename T>
+  void QRDecomposition<T>::applyBlock(std::size_t k0, std::size_t kb, T* c, std::size_t ncols, std::size_t ldc, bool adjoint) const
+  {
+    const std::size_t rows = factors.getNumRows() - k0;
+    const std::size_t ld = factors.getLeadingDim();
+    const T* a = factors.data();
+
+    // V (unit lower trapezoid) and conj(V), packed rows x kb:
+    AlignedBuffer<T> v(rows*kb), vc(rows*kb);
+    for (std::size_t i=0; i<rows; ++i)
+    {
+      for (std::size_t c2=0; c2<kb; ++c2)
+      {
+        const T x = (i == c2) ? T(1) : ((i < c2) ? T(0) : a[(k0 + i)*ld + k0 + c2]);
+        v.data()[i*kb + c2] = x;
+        vc.data()[i*kb + c2] = conjugate(x);
+      }
+    }
+
+    // T (upper triangular) with H_k0*...*H_(k0+kb-1) = I - V*T*V^H (as LAPACK's
+    //  larft), built from the Gram matrix V^H*V:
+    AlignedBuffer<T> t(kb*kb), g(kb*kb);
+    gemm<T>(kb, kb, rows,
+            T(1), vc.data(), 1, kb,
+                  v.data(), kb, 1,
+            T(0), g.data(), kb, 1);
+
+    std::fill(t.data(), t.data() + kb*kb, T(0));
+    for (std::size_t i=0; i<kb; ++i)
+    {
+      const T tau = taus[k0 + i];
+      for (std::size_t r=0; r<i; ++r)
+      {
+        T sum = T(0);
+        for (std::size_t c2=r; c2<i; ++c2)
+        {
+          sum += t.data()[r*kb + c2]*g.data()[c2*kb + i];
+        }
+        t.data()[r*kb + i] = -tau*sum;
+      }
+      t.data()[i*kb + i] = tau;
+    }
+
+    // W = V^H*C, then T^H*W (adjoint) or T*W, then C -= V*W:
+    AlignedBuffer<T> w(kb*ncols), tw(kb*ncols);
+    gemm<T>(kb, ncols, rows,
+            T(1), vc.data(), 1, kb,
+                  c, ldc, 1,
+            T(0), w.data(), ncols, 1);
+
+    if ( adjoint )
+    {
+      for (std::size_t i=0; i<kb*kb; ++i)
+      {
+        t.data()[i] = conjugate(t.data()[i]);
+      }
+      gemm<T>(kb, ncols, kb,
+              T(1), t.data(), 1, kb,
+                    w.data(), ncols, 1,
+              T(0), tw.data(), ncols, 1);
+    }
+    else
+    {
+      gemm<T>(kb, ncols, kb,
+              T(1), t.data(), kb, 1,
+                    w.data(), ncols, 1,
+              T(0), tw.data(), ncols, 1);
+    }
+
+    gemm<T>(rows, ncols, kb,
+            T(-1), v.data(), kb, 1,
+                   tw.data(), ncols, 1,
+            T(1),  c, ldc, 1);
+  }
+
+  // applyAdjoint
+  template <typename T>
+  void QRDecomposition<T>::applyAdjoint(T* b, std::size_t ncols, std::size_t ldb) const
+  {
+    const std::size_t n = factors.getNumCols();
+    for (std::size_t k0=0; k0<n; k0+=factorBlockSize)
+    {
+      this->applyBlock(k0, std::min(factorBlockSize, n - k0), b + k0*ldb, ncols, ldb, true);
+    }
+  }
+
+  // getQ
+  template <typename T>
+  Matrix<T> QRDecomposition<T>::getQ() const
+  {
+    const uint32_t m = factors.getNumRows(), n = factors.getNumCols();
+
+    // Q*[I; 0], last panel first:
+    Matrix<T> Q(m, n, T(0));
+    for (uint32_t i=0; i<n; ++i)
+    {
+      Q.rowPtr(i)[i] = T(1);
+    }
+
+    const std::size_t ldq = Q.getLeadingDim();
+    for (std::size_t p=(n + factorBlockSize - 1)/factorBlockSize; p-->0; )
+    {
+      const std::size_t k0 = p*factorBlockSize;
+      this->applyBlock(k0, std::min(factorBlockSize, n - k0), Q.data() + k0*ldq, n, ldq, false);
+    }
+
+    return Q;
+  }
+
+  // getR
+  template <typename T>
+  Matrix<T> QRDecomposition<T>::getR() const
+  {
+    const uint32_t n = factors.getNumCols();
+    Matrix<T> R(n, n, T(0));
+    for (uint32_t i=0; i<n; ++i)
+    {
+      const T* src = factors.rowPtr(i);
+      std::copy(src + i, src + n, R.rowPtr(i) + i);
+    }
+
+    return R;
+  }
+
+  // isFullRank
+  template <typename T>
+  bool QRDecomposition<T>::isFullRank() const
+  {
+    typedef decltype(std::abs(T(0))) Real;
+
+    // Negligible next to R's largest diagonal element (at working precision):
+    const uint32_t m = factors.getNumRows(), n = factors.getNumCols();
+    Real largest = 0;
+    for (uint32_t i=0; i<n; ++i)
+    {
+      largest = std::max(largest, Real(std::abs(factors.rowPtr(i)[i])));
+    }
+
+    const Real tolerance = largest*Real(m)*std::numeric_limits<Real>::epsilon();
+    for (uint32_t i=0; i<n; ++i)
+    {
+      if ( !(std::abs(factors.rowPtr(i)[i]) > tolerance) )
+      {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  // solve (Matrix)
+  template <typename T>
+  Matrix<T> QRDecomposition<T>::solve(const Matrix<T>& B) const
+  {
+    // Right-hand sides need one row per equation:
+    if ( B.getNumRows() != factors.getNumRows() )
+    {
+      throw std::logic_error("QRDecomposition::solve - Right-hand side must have as many rows as the matrix!");
+    }
+
+    // R must be invertible:
+    if ( !this->isFullRank() )
+    {
+      throw std::logic_error("QRDecomposition::solve - Matrix is rank deficient!");
+    }
+
+    // R*X = (Q^H*B)(0:n, :):
+    Matrix<T> Y = B;
+    const std::size_t n = factors.getNumCols(), nrhs = Y.getNumCols();
+    this->applyAdjoint(Y.data(), nrhs, Y.getLeadingDim());
+
+    Matrix<T> X(n, nrhs);
+    for (std::size_t i=0; i<n; ++i)
+    {
+      std::copy(Y.data() + i*Y.getLeadingDim(), Y.data() + i*Y.getLeadingDim() + nrhs, X.data() + i*X.getLeadingDim());
+    }
+    factorImpl::solveUpper<T>(n, nrhs, factors.data(), factors.getLeadingDim(), X.data(), X.getLeadingDim(), false);
+
+    return X;
+  }
+
+  // solve (vector)
+  template <typename T>
+  std::vector<T> QRDecomposition<T>::solve(const std::vector<T>& b) const
+  {
+    // Right-hand side needs one element per equation:
+    if ( b.size() != factors.getNumRows() )
+    {
+      throw std::logic_error("QRDecomposition::solve - Right-hand side must have as many rows as the matrix!");
+    }
+
+    // R must be invertible:
+    if ( !this->isFullRank() )
+    {
+      throw std::logic_error("QRDecomposition::solve - Matrix is rank deficient!");
+    }
+
+    std::vector<T> y = b;
+    const std::size_t n = factors.getNumCols();
+    this->applyAdjoint(y.data(), 1, 1);
+    y.resize(n);
+    factorImpl::solveUpper<T>(n, 1, factors.data(), factors.getLeadingDim(), y.data(), 1, false);
+
+    return y;
+  }
+
+} // matrix namespace
+
+#endif // MATRIX_QR_H
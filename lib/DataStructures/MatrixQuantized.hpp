@@ -0,0 +1,692 @@
+////////////////////////////////////////
+//
+//  File:
+//      \file MatrixQuantized.hpp
+//
+//  Description:
+//      \brief Matrix Quantized: Wider-accumulator and int8/int16 quantized products
+//
+//  Author:
+//      \author J. Caleb Wherry
+//
+////////////////////////////////////////
+
+// Include Guards:
+#ifndef MATRIX_QUANTIZED_H
+#define MATRIX_QUANTIZED_H
+
+// Forward Declared Dependencies:
+//
+
+// Local Include Dependencies:
+#include "Matrix.hpp"
+#include "MatrixGemm.hpp"
+#include "MatrixSimd.hpp"
+#include "CpuFeatures.hpp"
+#include "AlignedBuffer.hpp"
+#include "ThreadPool.hpp"
+
+// Compiler Include Dependencies:
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+
+/// matrix Namespace
+namespace matrix
+{
+
+  /// Inner-dimension block of multiplyAccumulate (columns of A converted per pass)
+  const std::size_t accumulateBlock = 256;
+
+  /// Matrix multiply in a wider type: C = A*B with every product and sum in Acc
+  ///
+  /// A*B computes in T, so Matrix<float> rounds every sum to float and integer
+  /// matrices wrap on overflow. Here A and B are converted to Acc one block
+  /// of accumulateBlock inner indices at a time (never as whole copies) and
+  /// run through the GEMM engine in Acc: float inputs summed in double, int
+  /// inputs in long long, and so on.
+  template <typename Acc, typename T>
+  Matrix<Acc> multiplyAccumulate(const Matrix<T>& A, const Matrix<T>& B)
+  {
+    if ( A.getNumCols() != B.getNumRows() )
+    {
+      throw std::logic_error("multiplyAccumulate - Matrices' inner dimensions do not match, can not multiply them!");
+    }
+
+    const std::size_t m = A.getNumRows(), n = B.getNumCols(), k = A.getNumCols();
+    Matrix<Acc> C(static_cast<uint32_t>(m), static_cast<uint32_t>(n));
+    if ( (m == 0) || (n == 0) || (k == 0) )
+    {
+      return C;
+    }
+
+    const std::size_t kc = std::min(k, accumulateBlock);
+    const std::size_t lda = A.getLeadingDim(), ldb = B.getLeadingDim();
+    AlignedBuffer<Acc> blockA(m*kc), blockB(kc*n);
+    const T* a = A.data();
+    const T* b = B.data();
+    Acc* wa = blockA.data();
+    Acc* wb = blockB.data();
+
+    for (std::size_t p0=0; p0<k; p0+=kc)
+    {
+      const std::size_t kb = std::min(kc, k - p0);
+
+      parallelFor(0, m, [=](std::size_t lo, std::size_t hi) {
+        for (std::size_t i=lo; i<hi; ++i)
+        {
+          for (std::size_t l=0; l<kb; ++l)
+          {
+            wa[i*kb + l] = static_cast<Acc>(a[i*lda + p0 + l]);
+          }
+        }
+      }, getParallelThreshold()/(kb + 1) + 1);
+
+      parallelFor(0, kb, [=](std::size_t lo, std::size_t hi) {
+        for (std::size_t l=lo; l<hi; ++l)
+        {
+          for (std::size_t j=0; j<n; ++j)
+          {
+            wb[l*n + j] = static_cast<Acc>(b[(p0 + l)*ldb + j]);
+          }
+        }
+      }, getParallelThreshold()/(n + 1) + 1);
+
+      gemm<Acc>(m, n, kb,
+                Acc(1), wa, std::ptrdiff_t(kb), 1,
+                        wb, std::ptrdiff_t(n), 1,
+                (p0 == 0) ? Acc(0) : Acc(1), C.data(), std::ptrdiff_t(C.getLeadingDim()), 1);
+    }
+
+    return C;
+  }
+
+
+  /// Which way a QuantizedMatrix's scale factors run
+  enum QuantizeAxis
+  {
+    quantizeRows    = 0,    ///< One scale per row (left operand of a product)
+    quantizeColumns = 1     ///< One scale per column (right operand of a product)
+  };
+
+  /// Default largest quantized magnitude for Q
+  ///
+  /// int8 uses its whole symmetric range. int16 keeps 12 bits so that 512
+  /// products still sum exactly in int32; pass a larger level count for more
+  /// precision at the cost of shorter exact blocks.
+  template <typename Q>
+  struct QuantizeLevels;
+
+  template <>
+  struct QuantizeLevels<int8_t>
+  {
+    static const int32_t value = 127;
+  };
+
+  template <>
+  struct QuantizeLevels<int16_t>
+  {
+    static const int32_t value = 2047;
+  };
+
+  /// Quantized Matrix class
+  ///
+  /// Symmetric linear quantization of a float or double matrix: element (i,j)
+  /// is scale*value(i,j) with value an integer in [-levels, levels] and one
+  /// scale per row or per column (largest magnitude / levels). Values are
+  /// stored row-major and packed. Quantize the left operand of a product by
+  /// rows and the right one by columns; quantizedMultiply() then needs no
+  /// per-element scaling inside the inner loop.
+  template <typename Q>
+  class QuantizedMatrix
+  {
+
+    static_assert(std::is_same<Q, int8_t>::value || std::is_same<Q, int16_t>::value,
+                  "QuantizedMatrix - Q must be int8_t or int16_t!");
+
+    private:
+      AlignedBuffer<Q> values;      ///< Quantized elements (row-major, packed)
+      std::vector<float> scales;    ///< Scale of each row or column
+      uint32_t numRows;             ///< Number of rows
+      uint32_t numCols;             ///< Number of columns
+      QuantizeAxis axis;            ///< Whether scales are per row or per column
+      int32_t levels;               ///< Largest magnitude of a quantized value
+
+    public:
+
+      //
+      // Constructors:
+      //
+
+      /// Quantizing Constructor (rounds to nearest and clamps to [-levels, levels])
+      template <typename T>
+      QuantizedMatrix (
+        const Matrix<T>& source,                          ///< Float or double matrix to quantize.
+        QuantizeAxis _axis,                               ///< One scale per row or per column.
+        int32_t _levels = QuantizeLevels<Q>::value        ///< Largest quantized magnitude.
+      );
+
+
+      //
+      // Accessors:
+      //
+
+      uint32_t getNumRows() const { return numRows; };          ///< Row accessor
+      uint32_t getNumCols() const { return numCols; };          ///< Columns accessor
+      QuantizeAxis getAxis() const { return axis; };            ///< Scale axis accessor
+      int32_t getLevels() const { return levels; };             ///< Largest quantized magnitude
+      const Q* data() const { return values.data(); };          ///< Row-major quantized values
+      const std::vector<float>& getScales() const { return scales; };   ///< Scales by row or column
+
+      /// Quantized value accessor
+      Q operator() (
+        uint32_t row,     ///< Row of value.
+        uint32_t col      ///< Column of value.
+      ) const;
+
+      /// Back to floating point: element (i,j) = scale*value(i,j)
+      Matrix<float> dequantize() const;
+
+  }; // QuantizedMatrix class
+
+
+  /// quantImpl namespace (quantized GEMM internals)
+  namespace quantImpl
+  {
+
+    /// Most inner indices summed in int32 before flushing to float
+    const std::size_t quantKC = 512;
+
+    /// Columns of B packed per block
+    const std::size_t quantNC = 512;
+
+    /// Inner-dimension block whose int32 sums can't overflow, a multiple of group
+    inline std::size_t blockDepth(int64_t productBound, std::size_t group)
+    {
+      const std::size_t safe = std::size_t(std::numeric_limits<int32_t>::max() / productBound);
+      const std::size_t depth = std::min(quantKC, safe);
+      return std::max(group, depth - depth % group);
+    }
+
+    /// Portable tile: ab[MR*NR] = sum over kg groups of a[i]*b[j] (G-wide dot products)
+    template <typename TA, typename TB, std::size_t MR, std::size_t NR, std::size_t G>
+    void tileGeneric(std::size_t kg, const TA* a, const TB* b, int32_t* ab)
+    {
+      int32_t acc[MR*NR];
+      for (std::size_t i=0; i<MR*NR; ++i)
+      {
+        acc[i] = 0;
+      }
+
+      for (std::size_t g=0; g<kg; ++g)
+      {
+        for (std::size_t i=0; i<MR; ++i)
+        {
+          for (std::size_t j=0; j<NR; ++j)
+          {
+            int32_t sum = 0;
+            for (std::size_t t=0; t<G; ++t)
+            {
+              sum += int32_t(a[i*G + t])*int32_t(b[j*G + t]);
+            }
+            acc[i*NR + j] += sum;
+          }
+        }
+        a += MR*G;
+        b += NR*G;
+      }
+
+      std::copy(acc, acc + MR*NR, ab);
+    }
+
+    /// Portable kernel: Q times Q, one inner index per step
+    template <typename Q>
+    struct PortableKernel
+    {
+      typedef Q TypeA;                        ///< Packed A element
+      typedef Q TypeB;                        ///< Packed B element
+      static const std::size_t MR = 4;        ///< Tile rows
+      static const std::size_t NR = 8;        ///< Tile columns
+      static const std::size_t G = 1;         ///< Inner indices per step
+      static const bool offsetA = false;      ///< Is A packed as value + 128?
+
+      static void tile(std::size_t kg, const Q* a, const Q* b, int32_t* ab)
+      {
+        tileGeneric<Q, Q, MR, NR, G>(kg, a, b, ab);
+      }
+    };
+
+#if MATRIX_X86_DISPATCH
+
+    /// AVX2 6x16 tile: int16 pairs through vpmaddwd (exact: no saturation)
+    __attribute__((target("avx2")))
+    inline void tileMaddAvx2(std::size_t kg, const int16_t* a, const int16_t* b, int32_t* ab)
+    {
+      __m256i c00 = _mm256_setzero_si256(), c01 = _mm256_setzero_si256();
+      __m256i c10 = _mm256_setzero_si256(), c11 = _mm256_setzero_si256();
+      __m256i c20 = _mm256_setzero_si256(), c21 = _mm256_setzero_si256();
+      __m256i c30 = _mm256_setzero_si256(), c31 = _mm256_setzero_si256();
+      __m256i c40 = _mm256_setzero_si256(), c41 = _mm256_setzero_si256();
+      __m256i c50 = _mm256_setzero_si256(), c51 = _mm256_setzero_si256();
+
+      for (std::size_t g=0; g<kg; ++g)
+      {
+        const __m256i b0 = _mm256_load_si256(reinterpret_cast<const __m256i*>(b));
+        const __m256i b1 = _mm256_load_si256(reinterpret_cast<const __m256i*>(b + 16));
+        int32_t pair[6];
+        std::memcpy(pair, a, sizeof(pair));
+        __m256i ai;
+
+        ai = _mm256_set1_epi32(pair[0]); c00 = _mm256_add_epi32(c00, _mm256_madd_epi16(ai, b0)); c01 = _mm256_add_epi32(c01, _mm256_madd_epi16(ai, b1));
+        ai = _mm256_set1_epi32(pair[1]); c10 = _mm256_add_epi32(c10, _mm256_madd_epi16(ai, b0)); c11 = _mm256_add_epi32(c11, _mm256_madd_epi16(ai, b1));
+        ai = _mm256_set1_epi32(pair[2]); c20 = _mm256_add_epi32(c20, _mm256_madd_epi16(ai, b0)); c21 = _mm256_add_epi32(c21, _mm256_madd_epi16(ai, b1));
+        ai = _mm256_set1_epi32(pair[3]); c30 = _mm256_add_epi32(c30, _mm256_madd_epi16(ai, b0)); c31 = _mm256_add_epi32(c31, _mm256_madd_epi16(ai, b1));
+        ai = _mm256_set1_epi32(pair[4]); c40 = _mm256_add_epi32(c40, _mm256_madd_epi16(ai, b0)); c41 = _mm256_add_epi32(c41, _mm256_madd_epi16(ai, b1));
+        ai = _mm256_set1_epi32(pair[5]); c50 = _mm256_add_epi32(c50, _mm256_madd_epi16(ai, b0)); c51 = _mm256_add_epi32(c51, _mm256_madd_epi16(ai, b1));
+
+        a += 12;
+        b += 32;
+      }
+
+      __m256i* out = reinterpret_cast<__m256i*>(ab);
+      _mm256_store_si256(out +  0, c00); _mm256_store_si256(out +  1, c01);
+      _mm256_store_si256(out +  2, c10); _mm256_store_si256(out +  3, c11);
+      _mm256_store_si256(out +  4, c20); _mm256_store_si256(out +  5, c21);
+      _mm256_store_si256(out +  6, c30); _mm256_store_si256(out +  7, c31);
+      _mm256_store_si256(out +  8, c40); _mm256_store_si256(out +  9, c41);
+      _mm256_store_si256(out + 10, c50); _mm256_store_si256(out + 11, c51);
+    }
+
+    /// AVX-512 VNNI 6x32 tile: unsigned A bytes times signed B bytes, four per vpdpbusd
+    __attribute__((target("avx512f,avx512vnni")))
+    inline void tileVnni(std::size_t kg, const uint8_t* a, const int8_t* b, int32_t* ab)
+    {
+      __m512i c00 = _mm512_setzero_si512(), c01 = _mm512_setzero_si512();
+      __m512i c10 = _mm512_setzero_si512(), c11 = _mm512_setzero_si512();
+      __m512i c20 = _mm512_setzero_si512(), c21 = _mm512_setzero_si512();
+      __m512i c30 = _mm512_setzero_si512(), c31 = _mm512_setzero_si512();
+      __m512i c40 = _mm512_setzero_si512(), c41 = _mm512_setzero_si512();
+      __m512i c50 = _mm512_setzero_si512(), c51 = _mm512_setzero_si512();
+
+      for (std::size_t g=0; g<kg; ++g)
+      {
+        const __m512i b0 = _mm512_load_si512(b);
+        const __m512i b1 = _mm512_load_si512(b + 64);
+        int32_t quad[6];
+        std::memcpy(quad, a, sizeof(quad));
+        __m512i ai;
+
+        ai = _mm512_set1_epi32(quad[0]); c00 = _mm512_dpbusd_epi32(c00, ai, b0); c01 = _mm512_dpbusd_epi32(c01, ai, b1);
+        ai = _mm512_set1_epi32(quad[1]); c10 = _mm512_dpbusd_epi32(c10, ai, b0); c11 = _mm512_dpbusd_epi32(c11, ai, b1);
+        ai = _mm512_set1_epi32(quad[2]); c20 = _mm512_dpbusd_epi32(c20, ai, b0); c21 = _mm512_dpbusd_epi32(c21, ai, b1);
+        ai = _mm512_set1_epi32(quad[3]); c30 = _mm512_dpbusd_epi32(c30, ai, b0); c31 = _mm512_dpbusd_epi32(c31, ai, b1);
+        ai = _mm512_set1_epi32(quad[4]); c40 = _mm512_dpbusd_epi32(c40, ai, b0); c41 = _mm512_dpbusd_epi32(c41, ai, b1);
+        ai = _mm512_set1_epi32(quad[5]); c50 = _mm512_dpbusd_epi32(c50, ai, b0); c51 = _mm512_dpbusd_epi32(c51, ai, b1);
+
+        a += 24;
+        b += 128;
+      }
+
+      _mm512_store_si512(ab +   0, c00); _mm512_store_si512(ab +  16, c01);
+      _mm512_store_si512(ab +  32, c10); _mm512_store_si512(ab +  48, c11);
+      _mm512_store_si512(ab +  64, c20); _mm512_store_si512(ab +  80, c21);
+      _mm512_store_si512(ab +  96, c30); _mm512_store_si512(ab + 112, c31);
+      _mm512_store_si512(ab + 128, c40); _mm512_store_si512(ab + 144, c41);
+      _mm512_store_si512(ab + 160, c50); _mm512_store_si512(ab + 176, c51);
+    }
+
+    /// AVX2 kernel: int8 or int16 values widened to int16 pairs
+    struct MaddKernel
+    {
+      typedef int16_t TypeA;
+      typedef int16_t TypeB;
+      static const std::size_t MR = 6;
+      static const std::size_t NR = 16;
+      static const std::size_t G = 2;
+      static const bool offsetA = false;
+
+      static void tile(std::size_t kg, const int16_t* a, const int16_t* b, int32_t* ab)
+      {
+        tileMaddAvx2(kg, a, b, ab);
+      }
+    };
+
+    /// VNNI kernel: int8 only; A is shifted to unsigned and 128*colsum(B) taken back off
+    struct VnniKernel
+    {
+      typedef uint8_t TypeA;
+      typedef int8_t TypeB;
+      static const std::size_t MR = 6;
+      static const std::size_t NR = 32;
+      static const std::size_t G = 4;
+      static const bool offsetA = true;
+
+      static void tile(std::size_t kg, const uint8_t* a, const int8_t* b, int32_t* ab)
+      {
+        tileVnni(kg, a, b, ab);
+      }
+    };
+
+#endif // MATRIX_X86_DISPATCH
+
+    /// C = diag(sA)*(qA*qB)*diag(sB) through kernel K
+    ///
+    /// GOTO-style blocking: for each block of inner indices (short enough that
+    /// int32 can't overflow) A is packed into MR-row micro-panels, then each
+    /// block of quantNC columns of B into NR-column micro-panels, G inner
+    /// indices interleaved per column as the kernel's dot-product instruction
+    /// wants them. Tiles are flushed to float with both scales applied, so C
+    /// is written once per inner block and no int32 copy of C ever exists.
+    template <typename K, typename Q>
+    void multiplyPacked(const QuantizedMatrix<Q>& A, const QuantizedMatrix<Q>& B, float* c, std::size_t ldc)
+    {
+      typedef typename K::TypeA TA;
+      typedef typename K::TypeB TB;
+      const std::size_t MR = K::MR, NR = K::NR, G = K::G;
+      const bool offsetA = K::offsetA;
+
+      const std::size_t m = A.getNumRows(), n = B.getNumCols(), k = A.getNumCols();
+      const int64_t boundA = offsetA ? 255 : A.getLevels();
+      const std::size_t kc = std::min(blockDepth(boundA*B.getLevels(), G), (k + G - 1)/G*G);
+      const std::size_t nc = std::min(quantNC, (n + NR - 1)/NR*NR);
+      const std::size_t mBlocks = (m + MR - 1)/MR;
+
+      AlignedBuffer<TA> packA(mBlocks*MR*kc);
+      AlignedBuffer<TB> packB(nc*kc);
+      std::vector<int32_t> compensation(nc, 0);
+      const Q* qa = A.data();
+      const Q* qb = B.data();
+      const float* sa = A.getScales().data();
+      const float* sb = B.getScales().data();
+
+      for (std::size_t p0=0; p0<k; p0+=kc)
+      {
+        const std::size_t kb = std::min(kc, k - p0);
+        const std::size_t kg = (kb + G - 1)/G;
+        const bool first = (p0 == 0);
+
+        // A: micro-panel blk holds rows blk*MR.. as [g][row][t]:
+        TA* pa = packA.data();
+        parallelFor(0, mBlocks, [=](std::size_t lo, std::size_t hi) {
+          for (std::size_t blk=lo; blk<hi; ++blk)
+          {
+            TA* dst = pa + blk*kg*MR*G;
+            for (std::size_t g=0; g<kg; ++g)
+            {
+              for (std::size_t r=0; r<MR; ++r)
+              {
+                const std::size_t i = blk*MR + r;
+                for (std::size_t t=0; t<G; ++t)
+                {
+                  const std::size_t l = g*G + t;
+                  const int32_t v = ((i < m) && (l < kb)) ? int32_t(qa[i*k + p0 + l]) : 0;
+                  *dst++ = offsetA ? TA(v + 128) : TA(v);
+                }
+              }
+            }
+          }
+        }, getParallelThreshold()/(kg*MR*G + 1) + 1);
+
+        for (std::size_t j0=0; j0<n; j0+=nc)
+        {
+          const std::size_t nb = std::min(nc, n - j0);
+          const std::size_t panels = (nb + NR - 1)/NR;
+
+          // B: micro-panel holds columns j0 + panel*NR.. as [g][column][t]:
+          TB* pb = packB.data();
+          int32_t* comp = compensation.data();
+          parallelFor(0, panels, [=](std::size_t lo, std::size_t hi) {
+            for (std::size_t panel=lo; panel<hi; ++panel)
+            {
+              TB* dst = pb + panel*kg*NR*G;
+              for (std::size_t g=0; g<kg; ++g)
+              {
+                for (std::size_t col=0; col<NR; ++col)
+                {
+                  const std::size_t j = panel*NR + col;
+                  for (std::size_t t=0; t<G; ++t)
+                  {
+                    const std::size_t l = g*G + t;
+                    *dst++ = ((j < nb) && (l < kb)) ? TB(qb[(p0 + l)*n + j0 + j]) : TB(0);
+                  }
+                }
+              }
+
+              if ( offsetA )
+              {
+                for (std::size_t col=0; col<NR; ++col)
+                {
+                  const std::size_t j = panel*NR + col;
+                  int32_t sum = 0;
+                  for (std::size_t l=0; (j < nb) && (l < kb); ++l)
+                  {
+                    sum += qb[(p0 + l)*n + j0 + j];
+                  }
+                  comp[j] = 128*sum;
+                }
+              }
+            }
+          }, getParallelThreshold()/(kg*NR*G + 1) + 1);
+
+          // Tiles, flushed through both scales into C:
+          parallelFor(0, mBlocks, [=](std::size_t lo, std::size_t hi) {
+            alignas(64) int32_t ab[MR*NR];
+            for (std::size_t blk=lo; blk<hi; ++blk)
+            {
+              const std::size_t i0 = blk*MR;
+              const std::size_t rows = std::min(MR, m - i0);
+              for (std::size_t panel=0; panel<panels; ++panel)
+              {
+                K::tile(kg, pa + blk*kg*MR*G, pb + panel*kg*NR*G, ab);
+
+                const std::size_t jp = panel*NR;
+                const std::size_t cols = std::min(NR, nb - jp);
+                for (std::size_t r=0; r<rows; ++r)
+                {
+                  float* cr = c + (i0 + r)*ldc + j0 + jp;
+                  const float* sbr = sb + j0 + jp;
+                  const int32_t* abr = ab + r*NR;
+                  const int32_t* compr = comp + jp;
+                  const float s = sa[i0 + r];
+                  for (std::size_t col=0; col<cols; ++col)
+                  {
+                    const int32_t sum = offsetA ? (abr[col] - compr[col]) : abr[col];
+                    const float v = (s*sbr[col])*float(sum);
+                    cr[col] = first ? v : (cr[col] + v);
+                  }
+                }
+              }
+            }
+          }, getGemmParallelThreshold()/(MR*nb*kb + 1) + 1);
+        }
+      }
+    }
+
+    /// Which kernel a product uses: VNNI (int8, AVX-512 VNNI), pmaddwd (AVX2) or portable
+    enum Kernel
+    {
+      kernelPortable = 0,
+      kernelMadd     = 1,
+      kernelVnni     = 2
+    };
+
+    /// Best kernel for Q allowed by both the CPU and setSimdLevel()
+    template <typename Q>
+    Kernel selectKernel()
+    {
+#if MATRIX_X86_DISPATCH
+      if ( std::is_same<Q, int8_t>::value && (simdLevel() >= simdAvx512) && cpuFeatures().avx512vnni )
+      {
+        return kernelVnni;
+      }
+      if ( simdLevel() >= simdAvx2 )
+      {
+        return kernelMadd;
+      }
+#endif
+      return kernelPortable;
+    }
+
+    /// VNNI product for int8 (never selected for int16, which falls back to portable)
+    template <typename Q>
+    void multiplyVnni(const QuantizedMatrix<Q>& A, const QuantizedMatrix<Q>& B, float* c, std::size_t ldc)
+    {
+      multiplyPacked<PortableKernel<Q>>(A, B, c, ldc);
+    }
+
+#if MATRIX_X86_DISPATCH
+    template <>
+    inline void multiplyVnni<int8_t>(const QuantizedMatrix<int8_t>& A, const QuantizedMatrix<int8_t>& B, float* c, std::size_t ldc)
+    {
+      multiplyPacked<VnniKernel>(A, B, c, ldc);
+    }
+#endif
+
+  } // quantImpl namespace
+
+
+  /// Quantized matrix multiply: C = A*B in float from int8/int16 operands
+  ///
+  /// C(i,j) = scaleA[i]*scaleB[j]*sum_p valueA(i,p)*valueB(p,j), the sum
+  /// formed exactly in int32 over blocks of up to 512 inner indices (fewer
+  /// when the level counts could overflow) and blocks added in float. A must
+  /// be quantized by rows and B by columns. On x86 int8 products use AVX-512
+  /// VNNI (vpdpbusd, 64 multiply-adds per instruction) and otherwise AVX2
+  /// vpmaddwd on values widened to int16; the widest path allowed by
+  /// setSimdLevel() is taken.
+  template <typename Q>
+  Matrix<float> quantizedMultiply(const QuantizedMatrix<Q>& A, const QuantizedMatrix<Q>& B)
+  {
+    if ( A.getNumCols() != B.getNumRows() )
+    {
+      throw std::logic_error("quantizedMultiply - Matrices' inner dimensions do not match, can not multiply them!");
+    }
+    if ( (A.getAxis() != quantizeRows) || (B.getAxis() != quantizeColumns) )
+    {
+      throw std::logic_error("quantizedMultiply - Left matrix must be quantized by rows and right matrix by columns!");
+    }
+
+    Matrix<float> C(A.getNumRows(), B.getNumCols());
+    if ( (C.getNumRows() == 0) || (C.getNumCols() == 0) || (A.getNumCols() == 0) )
+    {
+      return C;
+    }
+
+    switch ( quantImpl::selectKernel<Q>() )
+    {
+#if MATRIX_X86_DISPATCH
+      case quantImpl::kernelVnni:
+        quantImpl::multiplyVnni(A, B, C.data(), C.getLeadingDim());
+        break;
+      case quantImpl::kernelMadd:
+        quantImpl::multiplyPacked<quantImpl::MaddKernel>(A, B, C.data(), C.getLeadingDim());
+        break;
+#endif
+      default:
+        quantImpl::multiplyPacked<quantImpl::PortableKernel<Q>>(A, B, C.data(), C.getLeadingDim());
+        break;
+    }
+
+    return C;
+  }
+
+
+  //
+  // Template Implementation
+  //
+
+
+  // Quantizing constructor
+  template <typename Q>
+  template <typename T>
+  QuantizedMatrix<Q>::QuantizedMatrix(const Matrix<T>& source, QuantizeAxis _axis, int32_t _levels)
+        : values(std::size_t(source.getNumRows())*source.getNumCols()),
+          scales((_axis == quantizeRows) ? source.getNumRows() : source.getNumCols(), 1.0f),
+          numRows(source.getNumRows()),
+          numCols(source.getNumCols()),
+          axis(_axis),
+          levels(_levels)
+  {
+    static_assert(std::is_floating_point<T>::value, "QuantizedMatrix - Only float and double matrices can be quantized!");
+
+    if ( (levels < 1) || (levels > std::numeric_limits<Q>::max()) )
+    {
+      throw std::logic_error("QuantizedMatrix::QuantizedMatrix - Levels must be between 1 and the largest value of the integer type!");
+    }
+
+    const T* src = source.data();
+    const std::size_t ld = source.getLeadingDim();
+    const bool byRows = (axis == quantizeRows);
+
+    // Largest magnitude of each row or column sets its scale (all-zero ones keep 1):
+    std::vector<double> largest(scales.size(), 0.0);
+    for (std::size_t i=0; i<numRows; ++i)
+    {
+      for (std::size_t j=0; j<numCols; ++j)
+      {
+        double& big = largest[byRows ? i : j];
+        big = std::max(big, std::abs(double(src[i*ld + j])));
+      }
+    }
+    for (std::size_t s=0; s<scales.size(); ++s)
+    {
+      if ( (largest[s] > 0.0) && std::isfinite(largest[s]) )
+      {
+        scales[s] = float(largest[s]/levels);
+      }
+    }
+
+    Q* dst = values.data();
+    const double bound = levels;
+    for (std::size_t i=0; i<numRows; ++i)
+    {
+      for (std::size_t j=0; j<numCols; ++j)
+      {
+        const double inverse = 1.0/double(scales[byRows ? i : j]);
+        const double q = std::nearbyint(double(src[i*ld + j])*inverse);
+        dst[i*numCols + j] = Q(std::max(-bound, std::min(bound, q)));
+      }
+    }
+  }
+
+  // Operator ()
+  template <typename Q>
+  Q QuantizedMatrix<Q>::operator()(uint32_t row, uint32_t col) const
+  {
+    if ( (row >= numRows) || (col >= numCols) )
+    {
+      throw std::out_of_range("QuantizedMatrix::operator() - Indices out of bounds!");
+    }
+
+    return values.data()[std::size_t(row)*numCols + col];
+  }
+
+  // dequantize
+  template <typename Q>
+  Matrix<float> QuantizedMatrix<Q>::dequantize() const
+  {
+    Matrix<float> D(numRows, numCols);
+    float* dst = D.data();
+    const std::size_t ld = D.getLeadingDim();
+    const Q* src = values.data();
+
+    for (std::size_t i=0; i<numRows; ++i)
+    {
+      for (std::size_t j=0; j<numCols; ++j)
+      {
+        dst[i*ld + j] = scales[(axis == quantizeRows) ? i : j]*float(src[i*numCols + j]);
+      }
+    }
+
+    return D;
+  }
+
+} // matrix namespace
+
+#endif // MATRIX_QUANTIZED_H
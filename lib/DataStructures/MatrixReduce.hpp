@@ -0,0 +1,384 @@
+////////////////////////////////////////
+//
+//  File:
+//      \file MatrixReduce.hpp
+//
+//  Description:
+//      \brief Matrix Reduce: Sums, means and norms over elements, rows and columns
+//
+//  Author:
+//      \author J. Caleb Wherry
+//
+////////////////////////////////////////
+
+// Include Guards:
+#ifndef MATRIX_REDUCE_H
+#define MATRIX_REDUCE_H
+
+// Forward Declared Dependencies:
+//
+
+// Local Include Dependencies:
+#include "MatrixSimd.hpp"
+#include "ThreadPool.hpp"
+
+// Compiler Include Dependencies:
+#include <cstddef>
+#include <cmath>
+#include <complex>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <type_traits>
+
+/// matrix Namespace
+namespace matrix
+{
+
+  /// How sums add their elements up
+  enum Summation
+  {
+    summationLanes,       ///< Fastest: independent SIMD accumulators, error grows with n
+    summationPairwise,    ///< Recursive halving over SIMD leaves, error grows with log(n)
+    summationKahan        ///< Compensated in every SIMD lane, error independent of n
+  };
+
+  /// Norm taken of each row or column
+  enum VectorNorm
+  {
+    vectorNorm1,          ///< Sum of magnitudes
+    vectorNorm2,          ///< Euclidean length
+    vectorNormInf         ///< Largest magnitude
+  };
+
+  /// reduceImpl namespace (kernels behind Matrix's reductions)
+  namespace reduceImpl
+  {
+
+    /// Accumulators per contiguous magnitude reduction (spread over several registers)
+    const std::size_t reduceBlock = 256;
+
+    /// Elements summed directly at the leaves of the pairwise sum
+    const std::size_t pairwiseLeaf = 512;
+
+    /// Rows added directly at the leaves of the pairwise column sums
+    const std::size_t pairwiseRows = 32;
+
+    /// Is a sum of squares trustworthy, i.e. neither overflowed nor (partly) underflowed?
+    template <typename R, bool Floating = std::is_floating_point<R>::value>
+    struct SquareRange
+    {
+      static bool contains(const R&) { return true; }
+    };
+
+    /// Is a sum of squares trustworthy? (floating point magnitudes)
+    template <typename R>
+    struct SquareRange<R, true>
+    {
+      static bool contains(const R& ss)
+      {
+        return (ss >= std::numeric_limits<R>::min()/std::numeric_limits<R>::epsilon()) &&
+               (ss <= std::numeric_limits<R>::max());
+      }
+    };
+
+    /// Pairwise sum of a[0..n)
+    template <typename T>
+    T pairwise(const T* a, std::size_t n)
+    {
+      if ( n <= pairwiseLeaf )
+      {
+        return simdSum(a, n);
+      }
+
+      const std::size_t half = n/2;
+      return pairwise(a, half) + pairwise(a + half, n - half);
+    }
+
+    /// Sum of a[0..n)
+    template <typename T>
+    T sum(const T* a, std::size_t n, Summation method)
+    {
+      switch ( method )
+      {
+        case summationPairwise: return pairwise(a, n);
+        case summationKahan:    return simdSumCompensated(a, n);
+        default:                return simdSum(a, n);
+      }
+    }
+
+    /// Sum (or, for accMaxAbs, maximum) of the magnitudes of a[0..n)
+    template <int Op, typename R, typename T>
+    R accumulate(const T* a, std::size_t n)
+    {
+      R acc[reduceBlock];
+      const std::size_t width = std::min(n, reduceBlock);
+      std::fill(acc, acc + width, R(0));
+
+      for (std::size_t i=0; i<n; i+=reduceBlock)
+      {
+        simd::accumulate<Op>(acc, a + i, std::min(reduceBlock, n - i));
+      }
+
+      R total = R(0);
+      for (std::size_t l=0; l<width; ++l)
+      {
+        total = (Op == simd::accMaxAbs) ? std::max(total, acc[l]) : R(total + acc[l]);
+      }
+      return total;
+    }
+
+    /// Euclidean length of a[0], a[inc], ..., a[(n-1)*inc], given its sum of squares ss
+    ///
+    /// ss comes from the fast unscaled pass; only when it overflowed or lost
+    /// digits to underflow is the vector walked again, scaled by a power of two
+    /// near its largest magnitude (exact, so nothing else is lost).
+    template <typename R, typename T>
+    R euclidean(const T* a, std::size_t n, std::size_t inc, const R& ss)
+    {
+      if ( SquareRange<R>::contains(ss) || std::isnan(ss) )
+      {
+        return R(std::sqrt(ss));
+      }
+
+      R largest = R(0);
+      for (std::size_t k=0; k<n; ++k)
+      {
+        largest = std::max(largest, R(simd::magnitude(a[k*inc])));
+      }
+      if ( (largest == R(0)) || std::isinf(largest) )
+      {
+        return largest;
+      }
+
+      const R scale = R(std::ldexp(R(1), -std::ilogb(largest)));
+      R scaled = R(0);
+      for (std::size_t k=0; k<n; ++k)
+      {
+        const R m = R(simd::magnitude(a[k*inc]))*scale;
+        scaled += m*m;
+      }
+      return R(std::sqrt(scaled))/scale;
+    }
+
+    /// Euclidean length of the contiguous a[0..n)
+    template <typename R, typename T>
+    R euclidean(const T* a, std::size_t n)
+    {
+      return euclidean<R>(a, n, 1, accumulate<simd::accSquare, R>(a, n));
+    }
+
+    /// out[j] = sum_i a[i][j] for the columns [j0, j0 + w) and rows [r0, r1), pairwise over rows
+    template <typename T>
+    void columnPairwise(std::size_t r0, std::size_t r1, std::size_t j0, std::size_t w,
+                        const T* a, std::size_t ld, T* out)
+    {
+      if ( r1 - r0 <= pairwiseRows )
+      {
+        std::fill(out, out + w, T(0));
+        for (std::size_t i=r0; i<r1; ++i)
+        {
+          simdAdd(out, a + i*ld + j0, out, w);
+        }
+        return;
+      }
+
+      const std::size_t mid = r0 + (r1 - r0)/2;
+      std::vector<T> lower(w);
+      columnPairwise(r0, mid, j0, w, a, ld, out);
+      columnPairwise(mid, r1, j0, w, a, ld, lower.data());
+      simdAdd(out, lower.data(), out, w);
+    }
+
+    /// out[j] = sum_i a[i][j] (rows x cols, row stride ld)
+    ///
+    /// Each task owns a range of columns and streams down the rows, so every
+    /// step is one contiguous element-wise kernel.
+    template <typename T>
+    void columnSums(std::size_t rows, std::size_t cols, const T* a, std::size_t ld, T* out, Summation method)
+    {
+      parallelFor(0, cols, [=](std::size_t lo, std::size_t hi) {
+        const std::size_t w = hi - lo;
+        T* acc = out + lo;
+
+        if ( method == summationPairwise )
+        {
+          columnPairwise(0, rows, lo, w, a, ld, acc);
+          return;
+        }
+
+        std::fill(acc, acc + w, T(0));
+        if ( method == summationKahan )
+        {
+          // Kahan, one column per lane: y = a - c, t = acc + y, c = (t - acc) - y, acc = t:
+          std::vector<T> c(w, T(0)), y(w), t(w);
+          for (std::size_t i=0; i<rows; ++i)
+          {
+            simdSubtract(a + i*ld + lo, c.data(), y.data(), w);
+            simdAdd(acc, y.data(), t.data(), w);
+            simdSubtract(t.data(), acc, c.data(), w);
+            simdSubtract(c.data(), y.data(), c.data(), w);
+            std::copy(t.begin(), t.end(), acc);
+          }
+          simdSubtract(acc, c.data(), acc, w);
+          return;
+        }
+
+        for (std::size_t i=0; i<rows; ++i)
+        {
+          simdAdd(acc, a + i*ld + lo, acc, w);
+        }
+      }, getParallelThreshold()/(rows + 1) + 1);
+    }
+
+    /// out[j] = OP over i of |a[i][j]| (rows x cols, row stride ld)
+    template <int Op, typename R, typename T>
+    void columnAccumulate(std::size_t rows, std::size_t cols, const T* a, std::size_t ld, R* out)
+    {
+      parallelFor(0, cols, [=](std::size_t lo, std::size_t hi) {
+        std::fill(out + lo, out + hi, R(0));
+        for (std::size_t i=0; i<rows; ++i)
+        {
+          simd::accumulate<Op>(out + lo, a + i*ld + lo, hi - lo);
+        }
+      }, getParallelThreshold()/(rows + 1) + 1);
+    }
+
+    /// p-norm of every row (out has rows entries)
+    template <typename R, typename T>
+    void rowNorms(std::size_t rows, std::size_t cols, const T* a, std::size_t ld, R* out, VectorNorm norm)
+    {
+      parallelFor(0, rows, [=](std::size_t lo, std::size_t hi) {
+        for (std::size_t i=lo; i<hi; ++i)
+        {
+          const T* row = a + i*ld;
+          out[i] = (norm == vectorNorm1)   ? accumulate<simd::accAbs, R>(row, cols) :
+                   (norm == vectorNormInf) ? accumulate<simd::accMaxAbs, R>(row, cols) :
+                                             euclidean<R>(row, cols);
+        }
+      }, getParallelThreshold()/(cols + 1) + 1);
+    }
+
+    /// p-norm of every column (out has cols entries)
+    template <typename R, typename T>
+    void columnNorms(std::size_t rows, std::size_t cols, const T* a, std::size_t ld, R* out, VectorNorm norm)
+    {
+      if ( norm == vectorNorm1 )
+      {
+        columnAccumulate<simd::accAbs>(rows, cols, a, ld, out);
+      }
+      else if ( norm == vectorNormInf )
+      {
+        columnAccumulate<simd::accMaxAbs>(rows, cols, a, ld, out);
+      }
+      else
+      {
+        // Squares first, then the square roots (each column rescaled only if it needs it):
+        columnAccumulate<simd::accSquare>(rows, cols, a, ld, out);
+        for (std::size_t j=0; j<cols; ++j)
+        {
+          out[j] = euclidean<R>(a + j, rows, ld, out[j]);
+        }
+      }
+    }
+
+    /// x -= sum_i (b_i^H x) b_i over the count orthonormal vectors b_i stored
+    ///  one after another (n elements each); run twice, which is enough to keep
+    ///  x orthogonal to working precision
+    template <typename T>
+    void orthogonalize(T* x, std::size_t n, const T* basis, std::size_t count)
+    {
+      for (int pass=0; pass<2; ++pass)
+      {
+        for (std::size_t i=0; i<count; ++i)
+        {
+          const T* b = basis + i*n;
+          T projection = T(0);
+          for (std::size_t k=0; k<n; ++k)
+          {
+            projection += conjugate(b[k])*x[k];
+          }
+          simdAxpy(T(-projection), b, x, n);
+        }
+      }
+    }
+
+    /// Largest singular value of the upper bidiagonal matrix with diagonal
+    ///  alpha and superdiagonal beta (beta has one entry fewer, or as many)
+    ///
+    /// Bisection on the Golub-Kahan form: the symmetric tridiagonal matrix with
+    /// a zero diagonal and alpha_1, beta_1, alpha_2, ... beside it has
+    /// eigenvalues +-sigma_i, and Sturm counts find the largest without ever
+    /// squaring an element.
+    template <typename R>
+    R largestSingularValue(const std::vector<R>& alpha, const std::vector<R>& beta)
+    {
+      const std::size_t k = alpha.size();
+      std::vector<R> off;
+      for (std::size_t i=0; i<k; ++i)
+      {
+        off.push_back(alpha[i]);
+        if ( (i + 1 < k) && (i < beta.size()) )
+        {
+          off.push_back(beta[i]);
+        }
+      }
+
+      // Gershgorin bound, then halve [lo, hi] until it can't shrink further:
+      R hi = R(0);
+      for (std::size_t i=0; i<=off.size(); ++i)
+      {
+        const R left = (i > 0) ? std::abs(off[i-1]) : R(0);
+        const R right = (i < off.size()) ? std::abs(off[i]) : R(0);
+        hi = std::max(hi, left + right);
+      }
+      R lo = R(0);
+
+      const R tiny = std::numeric_limits<R>::min();
+      while ( true )
+      {
+        const R mid = lo + (hi - lo)/2;
+        if ( (mid <= lo) || (mid >= hi) )
+        {
+          break;
+        }
+
+        // Pivots of the LDL^T factorization of T - mid*I; each positive one is
+        //  an eigenvalue above mid:
+        std::size_t above = 0;
+        R q = -mid;
+        for (std::size_t i=0; ; ++i)
+        {
+          if ( q == R(0) )
+          {
+            q = -tiny;
+          }
+          if ( q > R(0) )
+          {
+            ++above;
+          }
+          if ( i == off.size() )
+          {
+            break;
+          }
+          q = -mid - off[i]*off[i]/q;
+        }
+
+        if ( above > 0 )
+        {
+          lo = mid;
+        }
+        else
+        {
+          hi = mid;
+        }
+      }
+
+      return hi;
+    }
+
+  } // reduceImpl namespace
+
+} // matrix namespace
+
+#endif // MATRIX_REDUCE_H
@@ -0,0 +1,240 @@
+////////////////////////////////////////
+//
+//  File:
+//      \file MatrixRows.hpp
+//
+//  Description:
+//      \brief Matrix Rows: Unchecked row spans and random-access row iterators
+//
+//  Author:
+//      \author J. Caleb Wherry
+//
+////////////////////////////////////////
+
+// Include Guards:
+#ifndef MATRIX_ROWS_H
+#define MATRIX_ROWS_H
+
+// Forward Declared Dependencies:
+//
+
+// Local Include Dependencies:
+//
+
+// Compiler Include Dependencies:
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <iterator>
+#include <type_traits>
+
+/// matrix Namespace
+namespace matrix
+{
+
+  /// Row Span class
+  ///
+  /// One contiguous row of a matrix: a pointer and a length, like std::span.
+  /// Indexing is unchecked and begin()/end() are plain pointers, so loops and
+  /// <algorithm> calls over a row compile to the same code as over an array.
+  /// T is const-qualified for rows of a const matrix. A span must not outlive
+  /// the matrix it refers to.
+  template <typename T>
+  class RowSpan
+  {
+
+    private:
+      T* first;         ///< First element
+      uint32_t count;   ///< Number of elements
+
+    public:
+
+      typedef T element_type;                                 ///< Element type (maybe const)
+      typedef typename std::remove_cv<T>::type value_type;    ///< Element type
+      typedef std::size_t size_type;                          ///< Size type
+      typedef std::ptrdiff_t difference_type;                 ///< Difference type
+      typedef T& reference;                                   ///< Element reference
+      typedef T* pointer;                                     ///< Element pointer
+      typedef T* iterator;                                    ///< Element iterator
+
+
+      //
+      // Constructors:
+      //
+
+      /// Default Constructor (empty span)
+      RowSpan() : first(nullptr), count(0) {};
+
+      /// Pointer Constructor
+      RowSpan (
+        T* _first,          ///< First element.
+        uint32_t _count     ///< Number of elements.
+      ) : first(_first), count(_count) {};
+
+      /// Converting Constructor (a mutable row as a const row)
+      template <typename U, typename = typename std::enable_if<std::is_convertible<U*, T*>::value>::type>
+      RowSpan (
+        const RowSpan<U>& rhs   ///< Span to convert.
+      ) : first(rhs.data()), count(rhs.size()) {};
+
+
+      //
+      // Accessors:
+      //
+
+      T* data() const { return first; };                      ///< First element
+      uint32_t size() const { return count; };                ///< Number of elements
+      bool empty() const { return count == 0; };              ///< No elements?
+
+      T* begin() const { return first; };                     ///< First element
+      T* end() const { return first + count; };               ///< One past the last element
+
+      /// Element Access (unchecked)
+      T& operator[](uint32_t i) const { return first[i]; };
+
+      /// Element Access (checked)
+      T& at(uint32_t i) const;
+
+  }; // RowSpan class
+
+
+  /// Row Iterator class
+  ///
+  /// Random-access iterator over the rows of a row-major matrix; each step
+  /// moves one leading dimension and dereferencing yields a RowSpan. Works
+  /// with <algorithm> (and with the parallel execution policies, which need
+  /// nothing beyond a random-access iterator).
+  template <typename T>
+  class RowIterator
+  {
+
+    private:
+      T* row;                   ///< First element of the current row
+      std::ptrdiff_t stride;    ///< Distance (in elements) between rows
+      uint32_t cols;            ///< Elements per row
+
+    public:
+
+      typedef std::random_access_iterator_tag iterator_category;    ///< Iterator category
+      typedef RowSpan<T> value_type;                                ///< A row
+      typedef std::ptrdiff_t difference_type;                       ///< Rows between iterators
+      typedef RowSpan<T> reference;                                 ///< Rows are returned by value
+      typedef void pointer;                                         ///< No operator->
+
+
+      //
+      // Constructors:
+      //
+
+      /// Default Constructor (singular iterator)
+      RowIterator() : row(nullptr), stride(0), cols(0) {};
+
+      /// Pointer Constructor
+      RowIterator (
+        T* _row,                    ///< First element of the row.
+        std::ptrdiff_t _stride,     ///< Distance between rows.
+        uint32_t _cols              ///< Elements per row.
+      ) : row(_row), stride(_stride), cols(_cols) {};
+
+      /// Converting Constructor (a mutable iterator as a const iterator)
+      template <typename U, typename = typename std::enable_if<std::is_convertible<U*, T*>::value>::type>
+      RowIterator (
+        const RowIterator<U>& rhs   ///< Iterator to convert.
+      ) : row(rhs.base()), stride(rhs.getStride()), cols(rhs.getNumCols()) {};
+
+
+      //
+      // Accessors:
+      //
+
+      T* base() const { return row; };                        ///< First element of the current row
+      std::ptrdiff_t getStride() const { return stride; };    ///< Row stride accessor
+      uint32_t getNumCols() const { return cols; };           ///< Columns accessor
+
+
+      //
+      // Operators:
+      //
+
+      RowSpan<T> operator*() const { return RowSpan<T>(row, cols); };                             ///< Current row
+      RowSpan<T> operator[](difference_type n) const { return RowSpan<T>(row + n*stride, cols); }; ///< Row n steps away
+
+      RowIterator& operator++() { row += stride; return *this; };                                ///< Pre-increment
+      RowIterator& operator--() { row -= stride; return *this; };                                ///< Pre-decrement
+      RowIterator operator++(int) { RowIterator old(*this); row += stride; return old; };        ///< Post-increment
+      RowIterator operator--(int) { RowIterator old(*this); row -= stride; return old; };        ///< Post-decrement
+      RowIterator& operator+=(difference_type n) { row += n*stride; return *this; };             ///< Advance
+      RowIterator& operator-=(difference_type n) { row -= n*stride; return *this; };             ///< Retreat
+
+      RowIterator operator+(difference_type n) const { return RowIterator(row + n*stride, stride, cols); };    ///< Advanced copy
+      RowIterator operator-(difference_type n) const { return RowIterator(row - n*stride, stride, cols); };    ///< Retreated copy
+
+      /// Rows between iterators (stride must not be zero)
+      difference_type operator-(const RowIterator& rhs) const { return (stride == 0) ? 0 : (row - rhs.row)/stride; };
+
+      // Comparison (iterators of one matrix)
+      bool operator==(const RowIterator& rhs) const { return row == rhs.row; };     ///< Equal
+      bool operator!=(const RowIterator& rhs) const { return row != rhs.row; };     ///< Not equal
+      bool operator<(const RowIterator& rhs) const { return row < rhs.row; };       ///< Less
+      bool operator>(const RowIterator& rhs) const { return row > rhs.row; };       ///< Greater
+      bool operator<=(const RowIterator& rhs) const { return row <= rhs.row; };     ///< Less or equal
+      bool operator>=(const RowIterator& rhs) const { return row >= rhs.row; };     ///< Greater or equal
+
+  }; // RowIterator class
+
+  /// n + iterator
+  template <typename T>
+  RowIterator<T> operator+(std::ptrdiff_t n, const RowIterator<T>& it) { return it + n; }
+
+
+  /// Row Range class
+  ///
+  /// The rows of a matrix as a range: for (auto row : A.rows()) { ... }
+  template <typename T>
+  class RowRange
+  {
+
+    private:
+      RowIterator<T> first;     ///< First row
+      uint32_t count;           ///< Number of rows
+
+    public:
+
+      typedef RowIterator<T> iterator;    ///< Row iterator
+
+      /// Constructor
+      RowRange (
+        const RowIterator<T>& _first,   ///< First row.
+        uint32_t _count                 ///< Number of rows.
+      ) : first(_first), count(_count) {};
+
+      RowIterator<T> begin() const { return first; };                     ///< First row
+      RowIterator<T> end() const { return first + count; };              ///< One past the last row
+      uint32_t size() const { return count; };                            ///< Number of rows
+      bool empty() const { return count == 0; };                          ///< No rows?
+      RowSpan<T> operator[](uint32_t i) const { return first[i]; };      ///< Row i (unchecked)
+
+  }; // RowRange class
+
+
+
+  //
+  // Template Implementation
+  //
+
+  // at
+  template <typename T>
+  T& RowSpan<T>::at(uint32_t i) const
+  {
+    // Check range:
+    if (i >= count)
+    {
+      throw std::out_of_range("RowSpan::at - Index out of bounds!");
+    }
+
+    return first[i];
+  }
+
+} // matrix namespace
+
+#endif // MATRIX_ROWS_H
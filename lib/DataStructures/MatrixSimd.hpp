@@ -0,0 +1,1241 @@
+////////////////////////////////////////
+//
+//  File:
+//      \file MatrixSimd.hpp
+//
+//  Description:
+//      \brief Matrix SIMD: Runtime-dispatched element-wise kernels
+//
+//  Author:
+//      \author J. Caleb Wherry
+//
+////////////////////////////////////////
+
+// Include Guards:
+#ifndef MATRIX_SIMD_H
+#define MATRIX_SIMD_H
+
+// Forward Declared Dependencies:
+//
+
+// Local Include Dependencies:
+#include "CpuFeatures.hpp"
+
+// Compiler Include Dependencies:
+#include <cstddef>
+#include <cmath>
+#include <complex>
+#include <algorithm>
+#include <limits>
+
+/// matrix Namespace
+namespace matrix
+{
+
+  /// Instruction set used by the element-wise kernels
+  enum SimdLevel
+  {
+    simdScalar = 0,   ///< Portable C++ loops
+    simdSse2   = 1,   ///< 128-bit SSE2
+    simdAvx2   = 2,   ///< 256-bit AVX2
+    simdAvx512 = 3    ///< 512-bit AVX-512F
+  };
+
+  /// Complex conjugate of an element (identity for real element types)
+  template <typename T>
+  inline T conjugate(const T& x) { return x; }
+
+  /// Complex conjugate of an element (complex element types)
+  template <typename U>
+  inline std::complex<U> conjugate(const std::complex<U>& x) { return std::conj(x); }
+
+  /// Best level supported by the running CPU (CPUID, done once)
+  inline SimdLevel detectedSimdLevel()
+  {
+    static const SimdLevel level = []() {
+      const CpuFeatures& f = cpuFeatures();
+      if ( f.avx512f ) return simdAvx512;
+      if ( f.avx2 )    return simdAvx2;
+      if ( f.sse2 )    return simdSse2;
+      return simdScalar;
+    }();
+
+    return level;
+  }
+
+  /// simd namespace (kernel internals)
+  namespace simd
+  {
+    /// Level currently in use (starts at the detected level)
+    inline SimdLevel& activeLevel()
+    {
+      static SimdLevel level = detectedSimdLevel();
+      return level;
+    }
+  }
+
+  /// Level the element-wise kernels currently dispatch to
+  inline SimdLevel simdLevel()
+  {
+    return simd::activeLevel();
+  }
+
+  /// Restrict the kernels to a lower level (clamped to what the CPU supports)
+  inline void setSimdLevel(SimdLevel level)
+  {
+    simd::activeLevel() = (level < detectedSimdLevel()) ? level : detectedSimdLevel();
+  }
+
+  /// simd namespace (kernel internals)
+  namespace simd
+  {
+
+    /// AVX2 + FMA allowed by both the CPU and setSimdLevel()?
+    inline bool useAvx2Fma()
+    {
+      return (simdLevel() >= simdAvx2) && cpuFeatures().fma;
+    }
+
+    /// Element-wise operation selector
+    enum Op { opAdd, opSub, opMul, opDiv };
+
+    /// Number of partial sums a sum kernel returns (widest vector, in doubles)
+    const std::size_t sumLanes = 8;
+
+    /// Magnitude accumulation selector (acc[i] = acc[i] OP |a[i]|)
+    enum Accumulate { accAbs, accSquare, accMaxAbs };
+
+
+    //
+    // Portable kernels:
+    //
+
+    /// x OP y
+    template <int Op, typename T>
+    inline T apply(const T& x, const T& y)
+    {
+      return (Op == opAdd) ? x + y :
+             (Op == opSub) ? x - y :
+             (Op == opMul) ? x * y :
+                             x / y;
+    }
+
+    /// c[i] = a[i] OP b[i]
+    template <int Op, typename T>
+    void binaryScalar(const T* a, const T* b, T* c, std::size_t n)
+    {
+      for (std::size_t i=0; i<n; ++i)
+      {
+        c[i] = apply<Op>(a[i], b[i]);
+      }
+    }
+
+    /// c[i] = a[i] OP s
+    template <int Op, typename T>
+    void broadcastScalar(const T* a, const T& s, T* c, std::size_t n)
+    {
+      for (std::size_t i=0; i<n; ++i)
+      {
+        c[i] = apply<Op>(a[i], s);
+      }
+    }
+
+    /// lanes[i % sumLanes] += a[i]
+    template <typename T>
+    void sumScalar(const T* a, std::size_t n, T* lanes)
+    {
+      for (std::size_t i=0; i<n; ++i)
+      {
+        lanes[i % sumLanes] += a[i];
+      }
+    }
+
+    /// a[i] == b[i] for all i
+    template <typename T>
+    bool equalScalar(const T* a, const T* b, std::size_t n)
+    {
+      for (std::size_t i=0; i<n; ++i)
+      {
+        if ( a[i] != b[i] )
+        {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    /// Interleaved complex times complex scalar (c = a*s)
+    inline void complexScaleScalar(const double* a, const std::complex<double>& s, double* c, std::size_t n)
+    {
+      const double sr = s.real(), si = s.imag();
+      for (std::size_t i=0; i<2*n; i+=2)
+      {
+        const double r = a[i], im = a[i+1];
+        c[i]   = r*sr - im*si;
+        c[i+1] = r*si + im*sr;
+      }
+    }
+
+    /// y[i] += a * x[i]
+    template <typename T>
+    void axpyScalar(const T& a, const T* x, T* y, std::size_t n)
+    {
+      for (std::size_t i=0; i<n; ++i)
+      {
+        y[i] += a*x[i];
+      }
+    }
+
+    /// |x|
+    template <typename T>
+    inline T magnitude(const T& x) { return std::abs(x); }
+
+    /// |x| for complex x (hypot only when the squares would leave the normal range)
+    template <typename U>
+    inline U magnitude(const std::complex<U>& x)
+    {
+      const U sq = std::norm(x);
+      return ( (sq >= std::numeric_limits<U>::min()) && (sq <= std::numeric_limits<U>::max()) ) ? std::sqrt(sq) : std::abs(x);
+    }
+
+    /// |x|^2
+    template <typename T>
+    inline T squaredMagnitude(const T& x) { return x*x; }
+
+    /// |x|^2 for complex x
+    template <typename U>
+    inline U squaredMagnitude(const std::complex<U>& x) { return std::norm(x); }
+
+    /// acc[i] = acc[i] OP |a[i]| (acc holds magnitudes, a may be complex)
+    template <int Op, typename R, typename T>
+    void accumulateScalar(R* acc, const T* a, std::size_t n)
+    {
+      for (std::size_t i=0; i<n; ++i)
+      {
+        acc[i] = (Op == accAbs)    ? R(acc[i] + magnitude(a[i])) :
+                 (Op == accSquare) ? R(acc[i] + squaredMagnitude(a[i])) :
+                                     std::max(acc[i], R(magnitude(a[i])));
+      }
+    }
+
+    /// Kahan-compensated lanes[i % sumLanes] += a[i]
+    template <typename T>
+    void sumCompensatedScalar(const T* a, std::size_t n, T* lanes)
+    {
+      T s[sumLanes], c[sumLanes];
+      for (std::size_t l=0; l<sumLanes; ++l)
+      {
+        s[l] = lanes[l];
+        c[l] = T(0);
+      }
+
+      for (std::size_t i=0; i<n; ++i)
+      {
+        const std::size_t l = i % sumLanes;
+        const T y = a[i] - c[l];
+        const T t = s[l] + y;
+        c[l] = (t - s[l]) - y;
+        s[l] = t;
+      }
+
+      for (std::size_t l=0; l<sumLanes; ++l)
+      {
+        lanes[l] = s[l] - c[l];
+      }
+    }
+
+#if MATRIX_X86_DISPATCH
+
+    //
+    // SSE2 kernels:
+    //
+
+    template <int Op> __attribute__((target("sse2")))
+    inline __m128d applySse2(__m128d x, __m128d y)
+    {
+      return (Op == opAdd) ? _mm_add_pd(x, y) :
+             (Op == opSub) ? _mm_sub_pd(x, y) :
+             (Op == opMul) ? _mm_mul_pd(x, y) :
+                             _mm_div_pd(x, y);
+    }
+
+    template <int Op> __attribute__((target("sse2")))
+    inline __m128 applySse2(__m128 x, __m128 y)
+    {
+      return (Op == opAdd) ? _mm_add_ps(x, y) :
+             (Op == opSub) ? _mm_sub_ps(x, y) :
+             (Op == opMul) ? _mm_mul_ps(x, y) :
+                             _mm_div_ps(x, y);
+    }
+
+    template <int Op> __attribute__((target("sse2")))
+    void binarySse2(const double* a, const double* b, double* c, std::size_t n)
+    {
+      std::size_t i = 0;
+      for (; i+2<=n; i+=2)
+      {
+        _mm_storeu_pd(c + i, applySse2<Op>(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+      }
+      binaryScalar<Op>(a + i, b + i, c + i, n - i);
+    }
+
+    template <int Op> __attribute__((target("sse2")))
+    void binarySse2(const float* a, const float* b, float* c, std::size_t n)
+    {
+      std::size_t i = 0;
+      for (; i+4<=n; i+=4)
+      {
+        _mm_storeu_ps(c + i, applySse2<Op>(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+      }
+      binaryScalar<Op>(a + i, b + i, c + i, n - i);
+    }
+
+    template <int Op> __attribute__((target("sse2")))
+    void broadcastSse2(const double* a, double s, double* c, std::size_t n)
+    {
+      const __m128d vs = _mm_set1_pd(s);
+      std::size_t i = 0;
+      for (; i+2<=n; i+=2)
+      {
+        _mm_storeu_pd(c + i, applySse2<Op>(_mm_loadu_pd(a + i), vs));
+      }
+      broadcastScalar<Op>(a + i, s, c + i, n - i);
+    }
+
+    template <int Op> __attribute__((target("sse2")))
+    void broadcastSse2(const float* a, float s, float* c, std::size_t n)
+    {
+      const __m128 vs = _mm_set1_ps(s);
+      std::size_t i = 0;
+      for (; i+4<=n; i+=4)
+      {
+        _mm_storeu_ps(c + i, applySse2<Op>(_mm_loadu_ps(a + i), vs));
+      }
+      broadcastScalar<Op>(a + i, s, c + i, n - i);
+    }
+
+    __attribute__((target("sse2")))
+    inline void sumSse2(const double* a, std::size_t n, double* lanes)
+    {
+      __m128d s0 = _mm_setzero_pd(), s1 = _mm_setzero_pd(), s2 = _mm_setzero_pd(), s3 = _mm_setzero_pd();
+      std::size_t i = 0;
+      for (; i+8<=n; i+=8)
+      {
+        s0 = _mm_add_pd(s0, _mm_loadu_pd(a + i));
+        s1 = _mm_add_pd(s1, _mm_loadu_pd(a + i + 2));
+        s2 = _mm_add_pd(s2, _mm_loadu_pd(a + i + 4));
+        s3 = _mm_add_pd(s3, _mm_loadu_pd(a + i + 6));
+      }
+      _mm_storeu_pd(lanes + 0, s0);
+      _mm_storeu_pd(lanes + 2, s1);
+      _mm_storeu_pd(lanes + 4, s2);
+      _mm_storeu_pd(lanes + 6, s3);
+      sumScalar(a + i, n - i, lanes);
+    }
+
+    __attribute__((target("sse2")))
+    inline void sumSse2(const float* a, std::size_t n, float* lanes)
+    {
+      __m128 s0 = _mm_setzero_ps(), s1 = _mm_setzero_ps();
+      std::size_t i = 0;
+      for (; i+8<=n; i+=8)
+      {
+        s0 = _mm_add_ps(s0, _mm_loadu_ps(a + i));
+        s1 = _mm_add_ps(s1, _mm_loadu_ps(a + i + 4));
+      }
+      _mm_storeu_ps(lanes + 0, s0);
+      _mm_storeu_ps(lanes + 4, s1);
+      sumScalar(a + i, n - i, lanes);
+    }
+
+    __attribute__((target("sse2")))
+    inline bool equalSse2(const double* a, const double* b, std::size_t n)
+    {
+      std::size_t i = 0;
+      for (; i+2<=n; i+=2)
+      {
+        if ( _mm_movemask_pd(_mm_cmpneq_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i))) != 0 )
+        {
+          return false;
+        }
+      }
+      return equalScalar(a + i, b + i, n - i);
+    }
+
+    __attribute__((target("sse2")))
+    inline bool equalSse2(const float* a, const float* b, std::size_t n)
+    {
+      std::size_t i = 0;
+      for (; i+4<=n; i+=4)
+      {
+        if ( _mm_movemask_ps(_mm_cmpneq_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i))) != 0 )
+        {
+          return false;
+        }
+      }
+      return equalScalar(a + i, b + i, n - i);
+    }
+
+    __attribute__((target("sse2")))
+    inline void complexScaleSse2(const double* a, const std::complex<double>& s, double* c, std::size_t n)
+    {
+      const __m128d vr = _mm_set1_pd(s.real());
+      const __m128d vi = _mm_set_pd(s.imag(), -s.imag());
+      for (std::size_t i=0; i<2*n; i+=2)
+      {
+        const __m128d x = _mm_loadu_pd(a + i);
+        const __m128d swapped = _mm_shuffle_pd(x, x, 1);
+        _mm_storeu_pd(c + i, _mm_add_pd(_mm_mul_pd(x, vr), _mm_mul_pd(swapped, vi)));
+      }
+    }
+
+
+    //
+    // AVX2 kernels:
+    //
+
+    template <int Op> __attribute__((target("avx2")))
+    inline __m256d applyAvx2(__m256d x, __m256d y)
+    {
+      return (Op == opAdd) ? _mm256_add_pd(x, y) :
+             (Op == opSub) ? _mm256_sub_pd(x, y) :
+             (Op == opMul) ? _mm256_mul_pd(x, y) :
+                             _mm256_div_pd(x, y);
+    }
+
+    template <int Op> __attribute__((target("avx2")))
+    inline __m256 applyAvx2(__m256 x, __m256 y)
+    {
+      return (Op == opAdd) ? _mm256_add_ps(x, y) :
+             (Op == opSub) ? _mm256_sub_ps(x, y) :
+             (Op == opMul) ? _mm256_mul_ps(x, y) :
+                             _mm256_div_ps(x, y);
+    }
+
+    template <int Op> __attribute__((target("avx2")))
+    void binaryAvx2(const double* a, const double* b, double* c, std::size_t n)
+    {
+      std::size_t i = 0;
+      for (; i+8<=n; i+=8)
+      {
+        _mm256_storeu_pd(c + i,     applyAvx2<Op>(_mm256_loadu_pd(a + i),     _mm256_loadu_pd(b + i)));
+        _mm256_storeu_pd(c + i + 4, applyAvx2<Op>(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4)));
+      }
+      binaryScalar<Op>(a + i, b + i, c + i, n - i);
+    }
+
+    template <int Op> __attribute__((target("avx2")))
+    void binaryAvx2(const float* a, const float* b, float* c, std::size_t n)
+    {
+      std::size_t i = 0;
+      for (; i+16<=n; i+=16)
+      {
+        _mm256_storeu_ps(c + i,     applyAvx2<Op>(_mm256_loadu_ps(a + i),     _mm256_loadu_ps(b + i)));
+        _mm256_storeu_ps(c + i + 8, applyAvx2<Op>(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8)));
+      }
+      binaryScalar<Op>(a + i, b + i, c + i, n - i);
+    }
+
+    template <int Op> __attribute__((target("avx2")))
+    void broadcastAvx2(const double* a, double s, double* c, std::size_t n)
+    {
+      const __m256d vs = _mm256_set1_pd(s);
+      std::size_t i = 0;
+      for (; i+8<=n; i+=8)
+      {
+        _mm256_storeu_pd(c + i,     applyAvx2<Op>(_mm256_loadu_pd(a + i),     vs));
+        _mm256_storeu_pd(c + i + 4, applyAvx2<Op>(_mm256_loadu_pd(a + i + 4), vs));
+      }
+      broadcastScalar<Op>(a + i, s, c + i, n - i);
+    }
+
+    template <int Op> __attribute__((target("avx2")))
+    void broadcastAvx2(const float* a, float s, float* c, std::size_t n)
+    {
+      const __m256 vs = _mm256_set1_ps(s);
+      std::size_t i = 0;
+      for (; i+16<=n; i+=16)
+      {
+        _mm256_storeu_ps(c + i,     applyAvx2<Op>(_mm256_loadu_ps(a + i),     vs));
+        _mm256_storeu_ps(c + i + 8, applyAvx2<Op>(_mm256_loadu_ps(a + i + 8), vs));
+      }
+      broadcastScalar<Op>(a + i, s, c + i, n - i);
+    }
+
+    __attribute__((target("avx2")))
+    inline void sumAvx2(const double* a, std::size_t n, double* lanes)
+    {
+      __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd(), s2 = _mm256_setzero_pd(), s3 = _mm256_setzero_pd();
+      std::size_t i = 0;
+      for (; i+16<=n; i+=16)
+      {
+        s0 = _mm256_add_pd(s0, _mm256_loadu_pd(a + i));
+        s1 = _mm256_add_pd(s1, _mm256_loadu_pd(a + i + 4));
+        s2 = _mm256_add_pd(s2, _mm256_loadu_pd(a + i + 8));
+        s3 = _mm256_add_pd(s3, _mm256_loadu_pd(a + i + 12));
+      }
+      _mm256_storeu_pd(lanes + 0, _mm256_add_pd(s0, s2));
+      _mm256_storeu_pd(lanes + 4, _mm256_add_pd(s1, s3));
+      sumScalar(a + i, n - i, lanes);
+    }
+
+    __attribute__((target("avx2")))
+    inline void sumAvx2(const float* a, std::size_t n, float* lanes)
+    {
+      __m256 s0 = _mm256_setzero_ps(), s1 = _mm256_setzero_ps(), s2 = _mm256_setzero_ps(), s3 = _mm256_setzero_ps();
+      std::size_t i = 0;
+      for (; i+32<=n; i+=32)
+      {
+        s0 = _mm256_add_ps(s0, _mm256_loadu_ps(a + i));
+        s1 = _mm256_add_ps(s1, _mm256_loadu_ps(a + i + 8));
+        s2 = _mm256_add_ps(s2, _mm256_loadu_ps(a + i + 16));
+        s3 = _mm256_add_ps(s3, _mm256_loadu_ps(a + i + 24));
+      }
+      _mm256_storeu_ps(lanes, _mm256_add_ps(_mm256_add_ps(s0, s1), _mm256_add_ps(s2, s3)));
+      sumScalar(a + i, n - i, lanes);
+    }
+
+    __attribute__((target("avx2")))
+    inline bool equalAvx2(const double* a, const double* b, std::size_t n)
+    {
+      std::size_t i = 0;
+      for (; i+4<=n; i+=4)
+      {
+        if ( _mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), _CMP_NEQ_UQ)) != 0 )
+        {
+          return false;
+        }
+      }
+      return equalScalar(a + i, b + i, n - i);
+    }
+
+    __attribute__((target("avx2")))
+    inline bool equalAvx2(const float* a, const float* b, std::size_t n)
+    {
+      std::size_t i = 0;
+      for (; i+8<=n; i+=8)
+      {
+        if ( _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), _CMP_NEQ_UQ)) != 0 )
+        {
+          return false;
+        }
+      }
+      return equalScalar(a + i, b + i, n - i);
+    }
+
+    __attribute__((target("avx2")))
+    inline void complexScaleAvx2(const double* a, const std::complex<double>& s, double* c, std::size_t n)
+    {
+      const __m256d vr = _mm256_set1_pd(s.real());
+      const __m256d vi = _mm256_set_pd(s.imag(), -s.imag(), s.imag(), -s.imag());
+      std::size_t i = 0;
+      for (; i+4<=2*n; i+=4)
+      {
+        const __m256d x = _mm256_loadu_pd(a + i);
+        const __m256d swapped = _mm256_permute_pd(x, 0x5);
+        _mm256_storeu_pd(c + i, _mm256_add_pd(_mm256_mul_pd(x, vr), _mm256_mul_pd(swapped, vi)));
+      }
+      complexScaleScalar(a + i, s, c + i, n - i/2);
+    }
+
+    __attribute__((target("avx2,fma")))
+    inline void axpyAvx2(const double& a, const double* x, double* y, std::size_t n)
+    {
+      const __m256d va = _mm256_set1_pd(a);
+      std::size_t i = 0;
+      for (; i+8<=n; i+=8)
+      {
+        _mm256_storeu_pd(y + i,     _mm256_fmadd_pd(va, _mm256_loadu_pd(x + i),     _mm256_loadu_pd(y + i)));
+        _mm256_storeu_pd(y + i + 4, _mm256_fmadd_pd(va, _mm256_loadu_pd(x + i + 4), _mm256_loadu_pd(y + i + 4)));
+      }
+      axpyScalar(a, x + i, y + i, n - i);
+    }
+
+    __attribute__((target("avx2,fma")))
+    inline void axpyAvx2(const float& a, const float* x, float* y, std::size_t n)
+    {
+      const __m256 va = _mm256_set1_ps(a);
+      std::size_t i = 0;
+      for (; i+16<=n; i+=16)
+      {
+        _mm256_storeu_ps(y + i,     _mm256_fmadd_ps(va, _mm256_loadu_ps(x + i),     _mm256_loadu_ps(y + i)));
+        _mm256_storeu_ps(y + i + 8, _mm256_fmadd_ps(va, _mm256_loadu_ps(x + i + 8), _mm256_loadu_ps(y + i + 8)));
+      }
+      axpyScalar(a, x + i, y + i, n - i);
+    }
+
+    template <int Op> __attribute__((target("avx2")))
+    inline __m256d accumulateAvx2(__m256d acc, __m256d x)
+    {
+      const __m256d ax = _mm256_andnot_pd(_mm256_set1_pd(-0.0), x);
+      return (Op == accAbs)    ? _mm256_add_pd(acc, ax) :
+             (Op == accSquare) ? _mm256_add_pd(acc, _mm256_mul_pd(x, x)) :
+                                 _mm256_max_pd(ax, acc);
+    }
+
+    template <int Op> __attribute__((target("avx2")))
+    inline __m256 accumulateAvx2(__m256 acc, __m256 x)
+    {
+      const __m256 ax = _mm256_andnot_ps(_mm256_set1_ps(-0.0f), x);
+      return (Op == accAbs)    ? _mm256_add_ps(acc, ax) :
+             (Op == accSquare) ? _mm256_add_ps(acc, _mm256_mul_ps(x, x)) :
+                                 _mm256_max_ps(ax, acc);
+    }
+
+    template <int Op> __attribute__((target("avx2")))
+    void accumulateAvx2(double* acc, const double* a, std::size_t n)
+    {
+      std::size_t i = 0;
+      for (; i+8<=n; i+=8)
+      {
+        _mm256_storeu_pd(acc + i,     accumulateAvx2<Op>(_mm256_loadu_pd(acc + i),     _mm256_loadu_pd(a + i)));
+        _mm256_storeu_pd(acc + i + 4, accumulateAvx2<Op>(_mm256_loadu_pd(acc + i + 4), _mm256_loadu_pd(a + i + 4)));
+      }
+      accumulateScalar<Op>(acc + i, a + i, n - i);
+    }
+
+    template <int Op> __attribute__((target("avx2")))
+    void accumulateAvx2(float* acc, const float* a, std::size_t n)
+    {
+      std::size_t i = 0;
+      for (; i+16<=n; i+=16)
+      {
+        _mm256_storeu_ps(acc + i,     accumulateAvx2<Op>(_mm256_loadu_ps(acc + i),     _mm256_loadu_ps(a + i)));
+        _mm256_storeu_ps(acc + i + 8, accumulateAvx2<Op>(_mm256_loadu_ps(acc + i + 8), _mm256_loadu_ps(a + i + 8)));
+      }
+      accumulateScalar<Op>(acc + i, a + i, n - i);
+    }
+
+    __attribute__((target("avx2")))
+    inline void sumCompensatedAvx2(const double* a, std::size_t n, double* lanes)
+    {
+      __m256d s0 = _mm256_loadu_pd(lanes), s1 = _mm256_loadu_pd(lanes + 4);
+      __m256d c0 = _mm256_setzero_pd(), c1 = _mm256_setzero_pd();
+      std::size_t i = 0;
+      for (; i+8<=n; i+=8)
+      {
+        const __m256d y0 = _mm256_sub_pd(_mm256_loadu_pd(a + i), c0);
+        const __m256d y1 = _mm256_sub_pd(_mm256_loadu_pd(a + i + 4), c1);
+        const __m256d t0 = _mm256_add_pd(s0, y0);
+        const __m256d t1 = _mm256_add_pd(s1, y1);
+        c0 = _mm256_sub_pd(_mm256_sub_pd(t0, s0), y0);
+        c1 = _mm256_sub_pd(_mm256_sub_pd(t1, s1), y1);
+        s0 = t0;
+        s1 = t1;
+      }
+      _mm256_storeu_pd(lanes,     _mm256_sub_pd(s0, c0));
+      _mm256_storeu_pd(lanes + 4, _mm256_sub_pd(s1, c1));
+      sumCompensatedScalar(a + i, n - i, lanes);
+    }
+
+    __attribute__((target("avx2")))
+    inline void sumCompensatedAvx2(const float* a, std::size_t n, float* lanes)
+    {
+      __m256 s = _mm256_loadu_ps(lanes), c = _mm256_setzero_ps();
+      std::size_t i = 0;
+      for (; i+8<=n; i+=8)
+      {
+        const __m256 y = _mm256_sub_ps(_mm256_loadu_ps(a + i), c);
+        const __m256 t = _mm256_add_ps(s, y);
+        c = _mm256_sub_ps(_mm256_sub_ps(t, s), y);
+        s = t;
+      }
+      _mm256_storeu_ps(lanes, _mm256_sub_ps(s, c));
+      sumCompensatedScalar(a + i, n - i, lanes);
+    }
+
+
+    //
+    // AVX-512 kernels:
+    //
+
+    template <int Op> __attribute__((target("avx512f")))
+    inline __m512d applyAvx512(__m512d x, __m512d y)
+    {
+      return (Op == opAdd) ? _mm512_add_pd(x, y) :
+             (Op == opSub) ? _mm512_sub_pd(x, y) :
+             (Op == opMul) ? _mm512_mul_pd(x, y) :
+                             _mm512_div_pd(x, y);
+    }
+
+    template <int Op> __attribute__((target("avx512f")))
+    inline __m512 applyAvx512(__m512 x, __m512 y)
+    {
+      return (Op == opAdd) ? _mm512_add_ps(x, y) :
+             (Op == opSub) ? _mm512_sub_ps(x, y) :
+             (Op == opMul) ? _mm512_mul_ps(x, y) :
+                             _mm512_div_ps(x, y);
+    }
+
+    template <int Op> __attribute__((target("avx512f")))
+    void binaryAvx512(const double* a, const double* b, double* c, std::size_t n)
+    {
+      std::size_t i = 0;
+      for (; i+8<=n; i+=8)
+      {
+        _mm512_storeu_pd(c + i, applyAvx512<Op>(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i)));
+      }
+      binaryScalar<Op>(a + i, b + i, c + i, n - i);
+    }
+
+    template <int Op> __attribute__((target("avx512f")))
+    void binaryAvx512(const float* a, const float* b, float* c, std::size_t n)
+    {
+      std::size_t i = 0;
+      for (; i+16<=n; i+=16)
+      {
+        _mm512_storeu_ps(c + i, applyAvx512<Op>(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i)));
+      }
+      binaryScalar<Op>(a + i, b + i, c + i, n - i);
+    }
+
+    template <int Op> __attribute__((target("avx512f")))
+    void broadcastAvx512(const double* a, double s, double* c, std::size_t n)
+    {
+      const __m512d vs = _mm512_set1_pd(s);
+      std::size_t i = 0;
+      for (; i+8<=n; i+=8)
+      {
+        _mm512_storeu_pd(c + i, applyAvx512<Op>(_mm512_loadu_pd(a + i), vs));
+      }
+      broadcastScalar<Op>(a + i, s, c + i, n - i);
+    }
+
+    template <int Op> __attribute__((target("avx512f")))
+    void broadcastAvx512(const float* a, float s, float* c, std::size_t n)
+    {
+      const __m512 vs = _mm512_set1_ps(s);
+      std::size_t i = 0;
+      for (; i+16<=n; i+=16)
+      {
+        _mm512_storeu_ps(c + i, applyAvx512<Op>(_mm512_loadu_ps(a + i), vs));
+      }
+      broadcastScalar<Op>(a + i, s, c + i, n - i);
+    }
+
+    __attribute__((target("avx512f")))
+    inline void sumAvx512(const double* a, std::size_t n, double* lanes)
+    {
+      __m512d s0 = _mm512_setzero_pd(), s1 = _mm512_setzero_pd(), s2 = _mm512_setzero_pd(), s3 = _mm512_setzero_pd();
+      std::size_t i = 0;
+      for (; i+32<=n; i+=32)
+      {
+        s0 = _mm512_add_pd(s0, _mm512_loadu_pd(a + i));
+        s1 = _mm512_add_pd(s1, _mm512_loadu_pd(a + i + 8));
+        s2 = _mm512_add_pd(s2, _mm512_loadu_pd(a + i + 16));
+        s3 = _mm512_add_pd(s3, _mm512_loadu_pd(a + i + 24));
+      }
+      _mm512_storeu_pd(lanes, _mm512_add_pd(_mm512_add_pd(s0, s1), _mm512_add_pd(s2, s3)));
+      sumScalar(a + i, n - i, lanes);
+    }
+
+    __attribute__((target("avx512f")))
+    inline void sumAvx512(const float* a, std::size_t n, float* lanes)
+    {
+      __m512 s0 = _mm512_setzero_ps(), s1 = _mm512_setzero_ps(), s2 = _mm512_setzero_ps(), s3 = _mm512_setzero_ps();
+      std::size_t i = 0;
+      for (; i+64<=n; i+=64)
+      {
+        s0 = _mm512_add_ps(s0, _mm512_loadu_ps(a + i));
+        s1 = _mm512_add_ps(s1, _mm512_loadu_ps(a + i + 16));
+        s2 = _mm512_add_ps(s2, _mm512_loadu_ps(a + i + 32));
+        s3 = _mm512_add_ps(s3, _mm512_loadu_ps(a + i + 48));
+      }
+
+      // Fold the 16 float lanes onto the 8 partial sums (lane l and l+8 share parity):
+      alignas(64) float wide[16];
+      _mm512_store_ps(wide, _mm512_add_ps(_mm512_add_ps(s0, s1), _mm512_add_ps(s2, s3)));
+      for (std::size_t l=0; l<16; ++l)
+      {
+        lanes[l % sumLanes] += wide[l];
+      }
+      sumScalar(a + i, n - i, lanes);
+    }
+
+    __attribute__((target("avx512f")))
+    inline bool equalAvx512(const double* a, const double* b, std::size_t n)
+    {
+      std::size_t i = 0;
+      for (; i+8<=n; i+=8)
+      {
+        if ( _mm512_cmp_pd_mask(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i), _CMP_NEQ_UQ) != 0 )
+        {
+          return false;
+        }
+      }
+      return equalScalar(a + i, b + i, n - i);
+    }
+
+    __attribute__((target("avx512f")))
+    inline bool equalAvx512(const float* a, const float* b, std::size_t n)
+    {
+      std::size_t i = 0;
+      for (; i+16<=n; i+=16)
+      {
+        if ( _mm512_cmp_ps_mask(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), _CMP_NEQ_UQ) != 0 )
+        {
+          return false;
+        }
+      }
+      return equalScalar(a + i, b + i, n - i);
+    }
+
+    __attribute__((target("avx512f")))
+    inline void complexScaleAvx512(const double* a, const std::complex<double>& s, double* c, std::size_t n)
+    {
+      const __m512d vr = _mm512_set1_pd(s.real());
+      const __m512d vi = _mm512_set_pd(s.imag(), -s.imag(), s.imag(), -s.imag(),
+                                       s.imag(), -s.imag(), s.imag(), -s.imag());
+      std::size_t i = 0;
+      for (; i+8<=2*n; i+=8)
+      {
+        const __m512d x = _mm512_loadu_pd(a + i);
+        const __m512d swapped = _mm512_mask_permute_pd(x, 0xFF, x, 0x55);
+        _mm512_storeu_pd(c + i, _mm512_add_pd(_mm512_mul_pd(x, vr), _mm512_mul_pd(swapped, vi)));
+      }
+      complexScaleScalar(a + i, s, c + i, n - i/2);
+    }
+
+#endif // MATRIX_X86_DISPATCH
+
+
+    //
+    // Dispatchers (float and double):
+    //
+
+    /// c[i] = a[i] OP b[i]
+    template <int Op, typename T>
+    void binary(const T* a, const T* b, T* c, std::size_t n)
+    {
+      binaryScalar<Op>(a, b, c, n);
+    }
+
+    /// c[i] = a[i] OP s
+    template <int Op, typename T>
+    void broadcast(const T* a, const T& s, T* c, std::size_t n)
+    {
+      broadcastScalar<Op>(a, s, c, n);
+    }
+
+    /// Partial sums of a[0..n) folded onto sumLanes lanes by index
+    template <typename T>
+    void sum(const T* a, std::size_t n, T* lanes)
+    {
+      sumScalar(a, n, lanes);
+    }
+
+    /// a[i] == b[i] for all i
+    template <typename T>
+    bool equal(const T* a, const T* b, std::size_t n)
+    {
+      return equalScalar(a, b, n);
+    }
+
+    /// y[i] += a * x[i]
+    template <typename T>
+    void axpy(const T& a, const T* x, T* y, std::size_t n)
+    {
+      axpyScalar(a, x, y, n);
+    }
+
+    /// acc[i] = acc[i] OP |a[i]|
+    template <int Op, typename R, typename T>
+    void accumulate(R* acc, const T* a, std::size_t n)
+    {
+      accumulateScalar<Op>(acc, a, n);
+    }
+
+    /// Kahan-compensated partial sums of a[0..n) folded onto sumLanes lanes by index
+    template <typename T>
+    void sumCompensated(const T* a, std::size_t n, T* lanes)
+    {
+      sumCompensatedScalar(a, n, lanes);
+    }
+
+#if MATRIX_X86_DISPATCH
+
+#define MATRIX_SIMD_DISPATCH(AVX512, AVX2, SSE2, SCALAR)  \
+      switch ( simdLevel() )                              \
+      {                                                   \
+        case simdAvx512: return AVX512;                   \
+        case simdAvx2:   return AVX2;                     \
+        case simdSse2:   return SSE2;                     \
+        default:         return SCALAR;                   \
+      }
+
+    template <int Op>
+    void binary(const double* a, const double* b, double* c, std::size_t n)
+    {
+      MATRIX_SIMD_DISPATCH(binaryAvx512<Op>(a, b, c, n), binaryAvx2<Op>(a, b, c, n),
+                           binarySse2<Op>(a, b, c, n),   binaryScalar<Op>(a, b, c, n))
+    }
+
+    template <int Op>
+    void binary(const float* a, const float* b, float* c, std::size_t n)
+    {
+      MATRIX_SIMD_DISPATCH(binaryAvx512<Op>(a, b, c, n), binaryAvx2<Op>(a, b, c, n),
+                           binarySse2<Op>(a, b, c, n),   binaryScalar<Op>(a, b, c, n))
+    }
+
+    template <int Op>
+    void broadcast(const double* a, const double& s, double* c, std::size_t n)
+    {
+      MATRIX_SIMD_DISPATCH(broadcastAvx512<Op>(a, s, c, n), broadcastAvx2<Op>(a, s, c, n),
+                           broadcastSse2<Op>(a, s, c, n),   broadcastScalar<Op>(a, s, c, n))
+    }
+
+    template <int Op>
+    void broadcast(const float* a, const float& s, float* c, std::size_t n)
+    {
+      MATRIX_SIMD_DISPATCH(broadcastAvx512<Op>(a, s, c, n), broadcastAvx2<Op>(a, s, c, n),
+                           broadcastSse2<Op>(a, s, c, n),   broadcastScalar<Op>(a, s, c, n))
+    }
+
+    inline void sum(const double* a, std::size_t n, double* lanes)
+    {
+      MATRIX_SIMD_DISPATCH(sumAvx512(a, n, lanes), sumAvx2(a, n, lanes),
+                           sumSse2(a, n, lanes),   sumScalar(a, n, lanes))
+    }
+
+    inline void sum(const float* a, std::size_t n, float* lanes)
+    {
+      MATRIX_SIMD_DISPATCH(sumAvx512(a, n, lanes), sumAvx2(a, n, lanes),
+                           sumSse2(a, n, lanes),   sumScalar(a, n, lanes))
+    }
+
+    inline bool equal(const double* a, const double* b, std::size_t n)
+    {
+      MATRIX_SIMD_DISPATCH(equalAvx512(a, b, n), equalAvx2(a, b, n),
+                           equalSse2(a, b, n),   equalScalar(a, b, n))
+    }
+
+    inline bool equal(const float* a, const float* b, std::size_t n)
+    {
+      MATRIX_SIMD_DISPATCH(equalAvx512(a, b, n), equalAvx2(a, b, n),
+                           equalSse2(a, b, n),   equalScalar(a, b, n))
+    }
+
+    inline void complexScale(const double* a, const std::complex<double>& s, double* c, std::size_t n)
+    {
+      MATRIX_SIMD_DISPATCH(complexScaleAvx512(a, s, c, n), complexScaleAvx2(a, s, c, n),
+                           complexScaleSse2(a, s, c, n),   complexScaleScalar(a, s, c, n))
+    }
+
+#undef MATRIX_SIMD_DISPATCH
+
+    // AXPY is FMA bound, so it has only the AVX2 + FMA variant:
+    inline void axpy(const double& a, const double* x, double* y, std::size_t n)
+    {
+      useAvx2Fma() ? axpyAvx2(a, x, y, n) : axpyScalar(a, x, y, n);
+    }
+
+    inline void axpy(const float& a, const float* x, float* y, std::size_t n)
+    {
+      useAvx2Fma() ? axpyAvx2(a, x, y, n) : axpyScalar(a, x, y, n);
+    }
+
+    // The magnitude reductions stream memory at a few operations per load, so
+    //  AVX2 already saturates bandwidth and there is no wider variant:
+    template <int Op>
+    void accumulate(double* acc, const double* a, std::size_t n)
+    {
+      (simdLevel() >= simdAvx2) ? accumulateAvx2<Op>(acc, a, n) : accumulateScalar<Op>(acc, a, n);
+    }
+
+    template <int Op>
+    void accumulate(float* acc, const float* a, std::size_t n)
+    {
+      (simdLevel() >= simdAvx2) ? accumulateAvx2<Op>(acc, a, n) : accumulateScalar<Op>(acc, a, n);
+    }
+
+    inline void sumCompensated(const double* a, std::size_t n, double* lanes)
+    {
+      (simdLevel() >= simdAvx2) ? sumCompensatedAvx2(a, n, lanes) : sumCompensatedScalar(a, n, lanes);
+    }
+
+    inline void sumCompensated(const float* a, std::size_t n, float* lanes)
+    {
+      (simdLevel() >= simdAvx2) ? sumCompensatedAvx2(a, n, lanes) : sumCompensatedScalar(a, n, lanes);
+    }
+
+#else
+
+    inline void complexScale(const double* a, const std::complex<double>& s, double* c, std::size_t n)
+    {
+      complexScaleScalar(a, s, c, n);
+    }
+
+#endif // MATRIX_X86_DISPATCH
+
+    /// View interleaved complex<double> storage as 2n doubles
+    inline const double* asReal(const std::complex<double>* p) { return reinterpret_cast<const double*>(p); }
+    inline double* asReal(std::complex<double>* p) { return reinterpret_cast<double*>(p); }
+
+  } // simd namespace
+
+
+  //
+  // Element-wise kernels used by Matrix. The templates are portable loops; the
+  //  float, double and complex<double> overloads dispatch on simdLevel().
+  //
+
+  /// c = a + b
+  template <typename T>
+  void simdAdd(const T* a, const T* b, T* c, std::size_t n)
+  {
+    simd::binary<simd::opAdd>(a, b, c, n);
+  }
+
+  /// c = a - b
+  template <typename T>
+  void simdSubtract(const T* a, const T* b, T* c, std::size_t n)
+  {
+    simd::binary<simd::opSub>(a, b, c, n);
+  }
+
+  /// c = a + s
+  template <typename T>
+  void simdAddScalar(const T* a, const T& s, T* c, std::size_t n)
+  {
+    simd::broadcast<simd::opAdd>(a, s, c, n);
+  }
+
+  /// c = a * s
+  template <typename T>
+  void simdMultiplyScalar(const T* a, const T& s, T* c, std::size_t n)
+  {
+    simd::broadcast<simd::opMul>(a, s, c, n);
+  }
+
+  /// c = a / s
+  template <typename T>
+  void simdDivideScalar(const T* a, const T& s, T* c, std::size_t n)
+  {
+    simd::broadcast<simd::opDiv>(a, s, c, n);
+  }
+
+  /// c = -a
+  template <typename T>
+  void simdNegate(const T* a, T* c, std::size_t n)
+  {
+    for (std::size_t i=0; i<n; ++i)
+    {
+      c[i] = -a[i];
+    }
+  }
+
+  /// y += a*x
+  template <typename T>
+  void simdAxpy(const T& a, const T* x, T* y, std::size_t n)
+  {
+    simd::axpy(a, x, y, n);
+  }
+
+  /// Sum of a[0..n)
+  template <typename T>
+  T simdSum(const T* a, std::size_t n)
+  {
+    T lanes[simd::sumLanes];
+    for (std::size_t l=0; l<simd::sumLanes; ++l)
+    {
+      lanes[l] = T(0);
+    }
+
+    simd::sum(a, n, lanes);
+
+    T total = T(0);
+    for (std::size_t l=0; l<simd::sumLanes; ++l)
+    {
+      total += lanes[l];
+    }
+    return total;
+  }
+
+  /// Sum of a[0..n), Kahan-compensated in every lane (error independent of n)
+  template <typename T>
+  T simdSumCompensated(const T* a, std::size_t n)
+  {
+    T lanes[simd::sumLanes];
+    for (std::size_t l=0; l<simd::sumLanes; ++l)
+    {
+      lanes[l] = T(0);
+    }
+
+    simd::sumCompensated(a, n, lanes);
+
+    T total = T(0);
+    for (std::size_t l=0; l<simd::sumLanes; ++l)
+    {
+      total += lanes[l];
+    }
+    return total;
+  }
+
+  /// acc += |a| (acc holds magnitudes; a may be complex)
+  template <typename R, typename T>
+  void simdAccumulateAbs(R* acc, const T* a, std::size_t n)
+  {
+    simd::accumulate<simd::accAbs>(acc, a, n);
+  }
+
+  /// acc += |a|^2
+  template <typename R, typename T>
+  void simdAccumulateSquares(R* acc, const T* a, std::size_t n)
+  {
+    simd::accumulate<simd::accSquare>(acc, a, n);
+  }
+
+  /// acc = max(acc, |a|)
+  template <typename R, typename T>
+  void simdAccumulateMaxAbs(R* acc, const T* a, std::size_t n)
+  {
+    simd::accumulate<simd::accMaxAbs>(acc, a, n);
+  }
+
+  /// a == b element-wise
+  template <typename T>
+  bool simdEqual(const T* a, const T* b, std::size_t n)
+  {
+    return simd::equal(a, b, n);
+  }
+
+  /// c = conj(a) (a copy for real element types)
+  template <typename T>
+  void simdConjugate(const T* a, T* c, std::size_t n)
+  {
+    std::copy(a, a + n, c);
+  }
+
+  /// c = conj(a), one pass over the interleaved (re, im) pairs
+  template <typename R>
+  void simdConjugate(const std::complex<R>* a, std::complex<R>* c, std::size_t n)
+  {
+    const R* x = reinterpret_cast<const R*>(a);
+    R* y = reinterpret_cast<R*>(c);
+    for (std::size_t i=0; i<2*n; i+=2)
+    {
+      y[i] = x[i];
+      y[i+1] = -x[i+1];
+    }
+  }
+
+  /// Are all imaginary parts of a[0..n) zero? (always, for real element types)
+  template <typename T>
+  bool simdAllReal(const T*, std::size_t)
+  {
+    return true;
+  }
+
+  /// Are all imaginary parts of a[0..n) zero? (NaN counts as non-zero)
+  template <typename R>
+  bool simdAllReal(const std::complex<R>* a, std::size_t n)
+  {
+    // Branch-free blocks the compiler can vectorize, with an early exit between them:
+    const std::size_t block = 64;
+    const R* x = reinterpret_cast<const R*>(a);
+    for (std::size_t i0=0; i0<n; i0+=block)
+    {
+      const std::size_t i1 = std::min(n, i0 + block);
+      bool nonzero = false;
+      for (std::size_t i=i0; i<i1; ++i)
+      {
+        nonzero |= (x[2*i + 1] != R(0));
+      }
+      if ( nonzero )
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // float/double negate (multiply by -1 flips the sign bit exactly, zeros included):
+  inline void simdNegate(const double* a, double* c, std::size_t n) { simdMultiplyScalar(a, -1.0, c, n); }
+  inline void simdNegate(const float* a, float* c, std::size_t n) { simdMultiplyScalar(a, -1.0f, c, n); }
+
+  // complex<double> works on the interleaved (re, im) doubles:
+  inline void simdAdd(const std::complex<double>* a, const std::complex<double>* b, std::complex<double>* c, std::size_t n)
+  {
+    simd::binary<simd::opAdd>(simd::asReal(a), simd::asReal(b), simd::asReal(c), 2*n);
+  }
+
+  inline void simdSubtract(const std::complex<double>* a, const std::complex<double>* b, std::complex<double>* c, std::size_t n)
+  {
+    simd::binary<simd::opSub>(simd::asReal(a), simd::asReal(b), simd::asReal(c), 2*n);
+  }
+
+  inline void simdNegate(const std::complex<double>* a, std::complex<double>* c, std::size_t n)
+  {
+    simdMultiplyScalar(simd::asReal(a), -1.0, simd::asReal(c), 2*n);
+  }
+
+  inline void simdAddScalar(const std::complex<double>* a, const std::complex<double>& s, std::complex<double>* c, std::size_t n)
+  {
+    for (std::size_t i=0; i<n; ++i)
+    {
+      c[i] = a[i] + s;
+    }
+  }
+
+  inline void simdMultiplyScalar(const std::complex<double>* a, const std::complex<double>& s, std::complex<double>* c, std::size_t n)
+  {
+    // A real-valued scalar scales both parts:
+    if ( s.imag() == 0 )
+    {
+      simdMultiplyScalar(simd::asReal(a), s.real(), simd::asReal(c), 2*n);
+      return;
+    }
+
+    simd::complexScale(simd::asReal(a), s, simd::asReal(c), n);
+  }
+
+  inline void simdDivideScalar(const std::complex<double>* a, const std::complex<double>& s, std::complex<double>* c, std::size_t n)
+  {
+    // A real-valued divisor divides both parts exactly:
+    if ( s.imag() == 0 )
+    {
+      simdDivideScalar(simd::asReal(a), s.real(), simd::asReal(c), 2*n);
+      return;
+    }
+
+    // Otherwise multiply by the reciprocal:
+    simd::complexScale(simd::asReal(a), std::complex<double>(1)/s, simd::asReal(c), n);
+  }
+
+  inline std::complex<double> simdSum(const std::complex<double>* a, std::size_t n)
+  {
+    // Lane parity follows element index parity, so even lanes hold real parts:
+    double lanes[simd::sumLanes] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+    simd::sum(simd::asReal(a), 2*n, lanes);
+
+    double re = 0, im = 0;
+    for (std::size_t l=0; l<simd::sumLanes; l+=2)
+    {
+      re += lanes[l];
+      im += lanes[l+1];
+    }
+    return std::complex<double>(re, im);
+  }
+
+  inline std::complex<double> simdSumCompensated(const std::complex<double>* a, std::size_t n)
+  {
+    double lanes[simd::sumLanes] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+    simd::sumCompensated(simd::asReal(a), 2*n, lanes);
+
+    double re = 0, im = 0;
+    for (std::size_t l=0; l<simd::sumLanes; l+=2)
+    {
+      re += lanes[l];
+      im += lanes[l+1];
+    }
+    return std::complex<double>(re, im);
+  }
+
+  inline bool simdEqual(const std::complex<double>* a, const std::complex<double>* b, std::size_t n)
+  {
+    return simd::equal(simd::asReal(a), simd::asReal(b), 2*n);
+  }
+
+} // matrix namespace
+
+#endif // MATRIX_SIMD_H
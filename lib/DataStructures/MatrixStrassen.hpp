@@ -0,0 +1,256 @@
+////////////////////////////////////////
+//
+//  File:
+//      \file MatrixStrassen.hpp
+//
+//  Description:
+//      \brief Matrix Strassen: Strassen-Winograd recursion over the GEMM engine
+//
+//  Author:
+//      \author J. Caleb Wherry
+//
+////////////////////////////////////////
+
+// Include Guards:
+#ifndef MATRIX_STRASSEN_H
+#define MATRIX_STRASSEN_H
+
+// Forward Declared Dependencies:
+//
+
+// Local Include Dependencies:
+#include "MatrixGemm.hpp"
+#include "MatrixSimd.hpp"
+#include "AlignedBuffer.hpp"
+#include "ThreadPool.hpp"
+
+// Compiler Include Dependencies:
+#include <cstddef>
+#include <algorithm>
+
+/// matrix Namespace
+namespace matrix
+{
+
+  /// strassenImpl namespace (recursion internals)
+  namespace strassenImpl
+  {
+
+    /// Strassen-Winograd settings shared by all products
+    struct Settings
+    {
+      std::size_t crossover;        ///< Smallest dimension that recurses (0 = never)
+      std::size_t workspaceBytes;   ///< Most scratch memory one product may use
+    };
+
+    /// Process-wide settings (off until a crossover is set)
+    inline Settings& settings()
+    {
+      static Settings s = { 0, std::size_t(1) << 30 };
+      return s;
+    }
+
+    /// Elements of scratch one level needs for an m x k by k x n product
+    ///
+    /// X holds A-side sums (m/2 x k/2) and later P1 (m/2 x n/2); Y holds the
+    /// B-side sums (k/2 x n/2).
+    inline std::size_t levelWorkspace(std::size_t m, std::size_t n, std::size_t k)
+    {
+      return (m/2)*std::max(k/2, n/2) + (k/2)*(n/2);
+    }
+
+    /// Levels of recursion for an m x k by k x n product, and the scratch they need
+    inline std::size_t plan(std::size_t m, std::size_t n, std::size_t k, std::size_t elementBytes,
+                            std::size_t& workspace)
+    {
+      const Settings& s = settings();
+      std::size_t levels = 0;
+      workspace = 0;
+
+      while ( (s.crossover > 0) && (std::min(std::min(m, n), k) >= std::max<std::size_t>(s.crossover, 2)) )
+      {
+        const std::size_t more = levelWorkspace(m, n, k);
+        if ( (workspace + more)*elementBytes > s.workspaceBytes )
+        {
+          break;
+        }
+        workspace += more;
+        ++levels;
+        m /= 2;
+        n /= 2;
+        k /= 2;
+      }
+      return levels;
+    }
+
+    /// c = a + b or c = a - b over m x n blocks with row strides (c may be a or b)
+    template <typename T>
+    void combine(std::size_t m, std::size_t n,
+                 const T* a, std::size_t lda, const T* b, std::size_t ldb,
+                 T* c, std::size_t ldc, bool subtract)
+    {
+      parallelFor(0, m, [=](std::size_t lo, std::size_t hi) {
+        for (std::size_t i=lo; i<hi; ++i)
+        {
+          if ( subtract )
+          {
+            simdSubtract(a + i*lda, b + i*ldb, c + i*ldc, n);
+          }
+          else
+          {
+            simdAdd(a + i*lda, b + i*ldb, c + i*ldc, n);
+          }
+        }
+      }, getParallelThreshold()/(n + 1) + 1);
+    }
+
+    /// c = a*b (m x k by k x n, row strides), plain GEMM
+    template <typename T>
+    void classical(std::size_t m, std::size_t n, std::size_t k,
+                   const T* a, std::size_t lda, const T* b, std::size_t ldb,
+                   const T& beta, T* c, std::size_t ldc)
+    {
+      gemm<T>(m, n, k,
+              T(1), a, std::ptrdiff_t(lda), 1,
+                    b, std::ptrdiff_t(ldb), 1,
+              beta, c, std::ptrdiff_t(ldc), 1);
+    }
+
+    /// c = a*b with levels of Strassen-Winograd recursion, scratch at work
+    ///
+    /// The even-sized leading part goes through Winograd's variant (7
+    /// products, 15 additions) in the two-temporary schedule of Douglas et al.,
+    /// which uses C's quadrants as the rest of the scratch. An odd last row,
+    /// column or inner index is peeled off and fixed up with GEMM afterwards.
+    /// Every product and addition runs across the thread pool.
+    template <typename T>
+    void multiply(std::size_t m, std::size_t n, std::size_t k,
+                  const T* a, std::size_t lda, const T* b, std::size_t ldb,
+                  T* c, std::size_t ldc, std::size_t levels, T* work)
+    {
+      if ( levels == 0 )
+      {
+        classical(m, n, k, a, lda, b, ldb, T(0), c, ldc);
+        return;
+      }
+
+      const std::size_t mh = m/2, nh = n/2, kh = k/2;
+      const T* a11 = a;
+      const T* a12 = a + kh;
+      const T* a21 = a + mh*lda;
+      const T* a22 = a21 + kh;
+      const T* b11 = b;
+      const T* b12 = b + nh;
+      const T* b21 = b + kh*ldb;
+      const T* b22 = b21 + nh;
+      T* c11 = c;
+      T* c12 = c + nh;
+      T* c21 = c + mh*ldc;
+      T* c22 = c21 + nh;
+
+      const std::size_t ldx = std::max(kh, nh), ldy = nh;
+      T* x = work;
+      T* y = x + mh*ldx;
+      T* next = y + kh*nh;
+
+      auto product = [&](const T* p, std::size_t ldp, const T* q, std::size_t ldq, T* r, std::size_t ldr) {
+        multiply(mh, nh, kh, p, ldp, q, ldq, r, ldr, levels - 1, next);
+      };
+
+      combine(mh, kh, a11, lda, a21, lda, x, ldx, true);      // S3 = A11 - A21
+      combine(kh, nh, b22, ldb, b12, ldb, y, ldy, true);      // T3 = B22 - B12
+      product(x, ldx, y, ldy, c21, ldc);                      // P7 = S3*T3
+      combine(mh, kh, a21, lda, a22, lda, x, ldx, false);     // S1 = A21 + A22
+      combine(kh, nh, b12, ldb, b11, ldb, y, ldy, true);      // T1 = B12 - B11
+      product(x, ldx, y, ldy, c22, ldc);                      // P5 = S1*T1
+      combine(mh, kh, x, ldx, a11, lda, x, ldx, true);        // S2 = S1 - A11
+      combine(kh, nh, b22, ldb, y, ldy, y, ldy, true);        // T2 = B22 - T1
+      product(x, ldx, y, ldy, c12, ldc);                      // P6 = S2*T2
+      combine(mh, kh, a12, lda, x, ldx, x, ldx, true);        // S4 = A12 - S2
+      product(x, ldx, b22, ldb, c11, ldc);                    // P3 = S4*B22
+      product(a11, lda, b11, ldb, x, ldx);                    // P1 = A11*B11
+      combine(mh, nh, x, ldx, c12, ldc, c12, ldc, false);     // U2 = P1 + P6
+      combine(mh, nh, c12, ldc, c21, ldc, c21, ldc, false);   // U3 = U2 + P7
+      combine(mh, nh, c12, ldc, c22, ldc, c12, ldc, false);   // U4 = U2 + P5
+      combine(mh, nh, c21, ldc, c22, ldc, c22, ldc, false);   // C22 = U3 + P5
+      combine(mh, nh, c12, ldc, c11, ldc, c12, ldc, false);   // C12 = U4 + P3
+      combine(kh, nh, y, ldy, b21, ldb, y, ldy, true);        // T4 = T2 - B21
+      product(a22, lda, y, ldy, c11, ldc);                    // P4 = A22*T4
+      combine(mh, nh, c21, ldc, c11, ldc, c21, ldc, true);    // C21 = U3 - P4
+      product(a12, lda, b21, ldb, c11, ldc);                  // P2 = A12*B21
+      combine(mh, nh, x, ldx, c11, ldc, c11, ldc, false);     // C11 = P1 + P2
+
+      // Peeling: odd inner index, then odd last column and row:
+      const std::size_t me = 2*mh, ne = 2*nh, ke = 2*kh;
+      if ( ke < k )
+      {
+        classical(me, ne, 1, a + ke, lda, b + ke*ldb, ldb, T(1), c, ldc);
+      }
+      if ( ne < n )
+      {
+        classical(m, 1, k, a, lda, b + ne, ldb, T(0), c + ne, ldc);
+      }
+      if ( me < m )
+      {
+        classical(1, ne, k, a + me*lda, lda, b, ldb, T(0), c + me*ldc, ldc);
+      }
+    }
+
+  } // strassenImpl namespace
+
+
+  /// Smallest dimension at which products use Strassen-Winograd (0 = never)
+  inline std::size_t getStrassenCrossover()
+  {
+    return strassenImpl::settings().crossover;
+  }
+
+  /// Set the Strassen-Winograd crossover: a product recurses while its
+  ///  smallest dimension is at least this (0 turns the recursion off)
+  inline void setStrassenCrossover(std::size_t dimension)
+  {
+    strassenImpl::settings().crossover = dimension;
+  }
+
+  /// Most scratch memory (bytes) one Strassen-Winograd product may use
+  inline std::size_t getStrassenWorkspace()
+  {
+    return strassenImpl::settings().workspaceBytes;
+  }
+
+  /// Cap the scratch memory of a product; levels that would exceed it aren't taken
+  inline void setStrassenWorkspace(std::size_t bytes)
+  {
+    strassenImpl::settings().workspaceBytes = bytes;
+  }
+
+  /// Matrix multiply with Strassen-Winograd recursion: C = A*B
+  ///
+  /// A is m x k, B is k x n and C is m x n, all row-major with row strides.
+  /// Each level trades one of eight half-size products for 15 additions, so
+  /// it pays off only on large operands: products recurse while their
+  /// smallest dimension is at least the crossover and the scratch (about
+  /// (mk + kn)/3 elements over all levels) fits the workspace cap, then the
+  /// blocked GEMM engine takes over. Any size works; odd sizes are peeled.
+  /// Rounding errors grow a little faster with depth than for plain GEMM
+  /// (still normwise stable), which is why the recursion is opt-in.
+  template <typename T>
+  void strassen(std::size_t m, std::size_t n, std::size_t k,
+                const T* a, std::size_t lda, const T* b, std::size_t ldb,
+                T* c, std::size_t ldc)
+  {
+    std::size_t workspace = 0;
+    const std::size_t levels = strassenImpl::plan(m, n, k, sizeof(T), workspace);
+    if ( levels == 0 )
+    {
+      strassenImpl::classical(m, n, k, a, lda, b, ldb, T(0), c, ldc);
+      return;
+    }
+
+    AlignedBuffer<T> work(workspace);
+    strassenImpl::multiply(m, n, k, a, lda, b, ldb, c, ldc, levels, work.data());
+  }
+
+} // matrix namespace
+
+#endif // MATRIX_STRASSEN_H
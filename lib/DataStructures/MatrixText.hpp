@@ -0,0 +1,1444 @@
+////////////////////////////////////////
+//
+//  File:
+//      \file MatrixText.hpp
+//
+//  Description:
+//      \brief Matrix Text: Buffered printing, Matrix Market and CSV files
+//
+//  Author:
+//      \author J. Caleb Wherry
+//
+////////////////////////////////////////
+
+// Include Guards:
+#ifndef MATRIX_TEXT_H
+#define MATRIX_TEXT_H
+
+// Forward Declared Dependencies:
+//
+
+// Local Include Dependencies:
+#include "Matrix.hpp"
+#include "MatrixFile.hpp"
+#include "AlignedBuffer.hpp"
+#include "ThreadPool.hpp"
+
+// Compiler Include Dependencies:
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <cctype>
+#include <complex>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <algorithm>
+
+/// matrix Namespace
+namespace matrix
+{
+
+  //
+  // Text formats:
+  //
+  //   Printing (operator<<)   pad, then each element followed by a space, one
+  //                           row per line. Floating-point elements print in
+  //                           the shortest form that reads back to the same
+  //                           value, unless the stream is set to fixed or
+  //                           scientific, which then use its precision.
+  //   Matrix Market           "%%MatrixMarket matrix array|coordinate
+  //                           real|double|integer|complex|pattern
+  //                           general|symmetric|skew-symmetric|hermitian",
+  //                           '%' comment lines, the size line, then the
+  //                           entries (array: column by column; coordinate:
+  //                           1-based "row col value" lines).
+  //   CSV                     One row per line, fields split by a delimiter.
+  //
+  // Numbers use a '.' decimal point. The printf and strtod fallbacks follow
+  // the C library's LC_NUMERIC, which stays "C" unless setlocale() changes it.
+  //
+
+  /// textImpl namespace (formatting and parsing internals)
+  namespace textImpl
+  {
+
+    /// Bytes of input each parse chunk starts at (chunks end on line breaks)
+    const std::size_t chunkBytes = std::size_t(1) << 20;
+
+    /// Characters of output formatted per window before it is written
+    const std::size_t windowChars = std::size_t(1) << 22;
+
+    /// Guess at the characters one element takes (sizes output windows)
+    const std::size_t elementChars = 24;
+
+    /// Room for one formatted real number
+    const std::size_t maxChars = 64;
+
+
+    //
+    // Number parsing:
+    //
+
+    /// Whitespace, line breaks included
+    inline bool isSpace(char c)
+    {
+      return (c == ' ') || (c == '\t') || (c == '\r') || (c == '\n') || (c == '\v') || (c == '\f');
+    }
+
+    /// Can c follow a number?
+    inline bool endsNumber(char c, char delimiter)
+    {
+      return isSpace(c) || (c == delimiter);
+    }
+
+    /// Powers of ten 10^0 .. 10^27 (exact as long doubles, and as doubles to 10^22)
+    inline const long double* powersOfTen()
+    {
+      static const long double powers[] = {
+        1e0L, 1e1L, 1e2L, 1e3L, 1e4L, 1e5L, 1e6L, 1e7L, 1e8L, 1e9L, 1e10L, 1e11L, 1e12L, 1e13L,
+        1e14L, 1e15L, 1e16L, 1e17L, 1e18L, 1e19L, 1e20L, 1e21L, 1e22L, 1e23L, 1e24L, 1e25L, 1e26L, 1e27L
+      };
+      return powers;
+    }
+
+    /// Limits of the exact fast path for F: mantissa and power of ten both exact
+    template <typename F>
+    struct FastPath
+    {
+      static const uint64_t maxMantissa = uint64_t(1) << 53;
+      static const int maxExponent = 22;
+    };
+
+    template <>
+    struct FastPath<float>
+    {
+      static const uint64_t maxMantissa = uint64_t(1) << 24;
+      static const int maxExponent = 10;
+    };
+
+    /// Wider type W whose exact operands give F's longer mantissas (none: W = F)
+    template <typename F>
+    struct WidePath
+    {
+      typedef F Wide;
+      static const int maxExponent = -1;
+    };
+
+    template <>
+    struct WidePath<float>
+    {
+      typedef double Wide;
+      static const int maxExponent = 22;
+    };
+
+    template <>
+    struct WidePath<double>
+    {
+      typedef long double Wide;
+      static const int maxExponent = (std::numeric_limits<long double>::digits >= 64) ? 27 : -1;
+    };
+
+    // Low significand bits of a double or (x87) long double:
+    inline uint64_t significandBits(double x)
+    {
+      uint64_t bits;
+      std::memcpy(&bits, &x, sizeof(bits));
+      return bits;
+    }
+
+    inline uint64_t significandBits(long double x)
+    {
+      uint64_t bits;
+      if ( std::numeric_limits<long double>::digits == 64 )
+      {
+        std::memcpy(&bits, &x, sizeof(bits));
+        return bits;
+      }
+      int exponent;
+      return static_cast<uint64_t>(std::ldexp(std::frexp(x, &exponent), 63));
+    }
+
+    /// wide (positive, one rounding from exact) as F, unless it may round differently
+    ///
+    /// wide is within half a unit of its last place of the exact value, so
+    /// rounding it to F gives the exact value's rounding unless the bits
+    /// below F's last place sit at (or a unit from) the halfway pattern.
+    template <typename F, typename W>
+    bool narrowExactly(W wide, F& out)
+    {
+      if ( !((wide >= W(std::numeric_limits<F>::min())) && (wide <= W(std::numeric_limits<F>::max()))) )
+      {
+        return false;
+      }
+
+      const int extra = std::max(1, std::min(std::numeric_limits<W>::digits - std::numeric_limits<F>::digits, 63));
+      const uint64_t low = significandBits(wide) & ((uint64_t(1) << extra) - 1), half = uint64_t(1) << (extra - 1);
+      if ( (low + 1 >= half) && (low <= half + 1) )
+      {
+        return false;
+      }
+      out = F(wide);
+      return true;
+    }
+
+    /// mantissa*10^exponent as F, when one exact step settles it (else false)
+    template <typename F>
+    bool decimalToFloat(uint64_t mantissa, int exponent, F& out)
+    {
+      if ( (mantissa <= FastPath<F>::maxMantissa) && (std::abs(exponent) <= FastPath<F>::maxExponent) )
+      {
+        const F power = F(powersOfTen()[std::abs(exponent)]);
+        out = (exponent < 0) ? F(mantissa)/power : F(mantissa)*power;
+        return true;
+      }
+
+      typedef typename WidePath<F>::Wide W;
+      return (mantissa != 0) && (mantissa <= (uint64_t(1) << std::min(std::numeric_limits<W>::digits, 63))) &&
+             (std::abs(exponent) <= WidePath<F>::maxExponent) &&
+             narrowExactly((exponent < 0) ? W(mantissa)/W(powersOfTen()[-exponent]) : W(mantissa)*W(powersOfTen()[exponent]), out);
+    }
+
+    /// Library conversion of a whole null-terminated token
+    template <typename F>
+    F strtoReal(const char* s, char** end)
+    {
+      return std::is_same<F, float>::value ? F(std::strtof(s, end)) :
+             std::is_same<F, double>::value ? F(std::strtod(s, end)) : F(std::strtold(s, end));
+    }
+
+    /// Real number at p, ending at end, whitespace or delimiter; advances p
+    ///
+    /// Up to 19 significant digits with a power of ten both exactly
+    /// representable (Clinger's fast path) are converted with one correctly
+    /// rounded multiply or divide. Longer mantissas (17-digit doubles) take
+    /// the same step in a wider type (x87 long double for double) and are
+    /// kept unless they land on a tie. Anything else (more digits, large
+    /// exponents, inf, nan, hex) is handed to strtod.
+    template <typename F>
+    bool parseReal(const char*& p, const char* end, char delimiter, F& out)
+    {
+      const char* start = p;
+      const char* q = p;
+      bool negative = false;
+      if ( (q < end) && ((*q == '+') || (*q == '-')) )
+      {
+        negative = (*q == '-');
+        ++q;
+      }
+
+      uint64_t mantissa = 0;
+      int digits = 0, exponent = 0;
+      bool any = false, exact = true;
+      for (; (q < end) && (unsigned(*q - '0') < 10); ++q)
+      {
+        any = true;
+        if ( digits < 19 )
+        {
+          mantissa = mantissa*10 + unsigned(*q - '0');
+          digits += (mantissa != 0);
+        }
+        else
+        {
+          ++exponent;
+          exact = false;
+        }
+      }
+      if ( (q < end) && (*q == '.') )
+      {
+        for (++q; (q < end) && (unsigned(*q - '0') < 10); ++q)
+        {
+          any = true;
+          if ( digits < 19 )
+          {
+            mantissa = mantissa*10 + unsigned(*q - '0');
+            digits += (mantissa != 0);
+            --exponent;
+          }
+          else
+          {
+            exact = false;
+          }
+        }
+      }
+      if ( any && (q < end) && ((*q == 'e') || (*q == 'E')) )
+      {
+        const char* e = q + 1;
+        bool negativeExponent = false;
+        if ( (e < end) && ((*e == '+') || (*e == '-')) )
+        {
+          negativeExponent = (*e == '-');
+          ++e;
+        }
+        int value = 0;
+        const char* first = e;
+        for (; (e < end) && (unsigned(*e - '0') < 10); ++e)
+        {
+          value = std::min(value*10 + (*e - '0'), 100000);
+        }
+        if ( e != first )
+        {
+          exponent += negativeExponent ? -value : value;
+          q = e;
+        }
+      }
+
+      F value;
+      if ( any && exact && ((q == end) || endsNumber(*q, delimiter)) && decimalToFloat(mantissa, exponent, value) )
+      {
+        out = negative ? -value : value;
+        p = q;
+        return true;
+      }
+
+      // Slow path on a null-terminated copy of the whole token:
+      q = start;
+      while ( (q < end) && !endsNumber(*q, delimiter) )
+      {
+        ++q;
+      }
+      if ( q == start )
+      {
+        return false;
+      }
+      const std::string token(start, q);
+      char* stop = nullptr;
+      out = strtoReal<F>(token.c_str(), &stop);
+      if ( stop != token.c_str() + token.size() )
+      {
+        return false;
+      }
+      p = q;
+      return true;
+    }
+
+    /// Integer at p, ending at end, whitespace or delimiter; advances p
+    template <typename I>
+    bool parseInteger(const char*& p, const char* end, char delimiter, I& out)
+    {
+      const char* q = p;
+      bool negative = false;
+      if ( (q < end) && ((*q == '+') || (*q == '-')) )
+      {
+        negative = (*q == '-');
+        ++q;
+      }
+
+      // Magnitude limit of I in the chosen direction:
+      const unsigned long long limit = negative ?
+        (std::is_signed<I>::value ? 0ull - static_cast<unsigned long long>(std::numeric_limits<I>::min()) : 0ull) :
+        static_cast<unsigned long long>(std::numeric_limits<I>::max());
+      unsigned long long value = 0;
+      const char* first = q;
+      for (; (q < end) && (unsigned(*q - '0') < 10); ++q)
+      {
+        const unsigned digit = unsigned(*q - '0');
+        if ( (value > limit/10) || ((value == limit/10) && (digit > limit%10)) )
+        {
+          return false;
+        }
+        value = value*10 + digit;
+      }
+      if ( (q == first) || ((q < end) && !endsNumber(*q, delimiter)) )
+      {
+        return false;
+      }
+
+      out = negative ? static_cast<I>(0ull - value) : static_cast<I>(value);
+      p = q;
+      return true;
+    }
+
+    //
+    // Number formatting:
+    //
+
+    /// How floating-point elements are printed
+    enum FloatStyle
+    {
+      styleShortest,      ///< Fewest digits that read back exactly
+      styleFixed,         ///< printf %f with the stream's precision
+      styleScientific,    ///< printf %e with the stream's precision
+      styleHex            ///< printf %a
+    };
+
+    /// Floating-point format, taken from a stream's flags
+    struct NumberFormat
+    {
+      FloatStyle style;
+      int precision;
+    };
+
+    /// Shortest round-trip formatting, whatever a stream says
+    inline NumberFormat shortestFormat()
+    {
+      NumberFormat format = { styleShortest, 0 };
+      return format;
+    }
+
+    /// The format os would use for floating-point numbers
+    inline NumberFormat streamFormat(const std::ios_base& os)
+    {
+      const std::ios_base::fmtflags field = os.flags() & std::ios_base::floatfield;
+      NumberFormat format = { styleShortest, int(os.precision()) };
+      if ( field == (std::ios_base::fixed | std::ios_base::scientific) )
+      {
+        format.style = styleHex;
+      }
+      else if ( field == std::ios_base::fixed )
+      {
+        format.style = styleFixed;
+      }
+      else if ( field == std::ios_base::scientific )
+      {
+        format.style = styleScientific;
+      }
+      return format;
+    }
+
+    /// Digits of an unsigned integer, written backwards from end; returns the first
+    inline char* formatDigits(char* end, unsigned long long value)
+    {
+      static const char pairs[] =
+        "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+        "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+        "8081828384858687888990919293949596979899";
+
+      // Two digits per division:
+      while ( value >= 100 )
+      {
+        const unsigned pair = unsigned(value % 100);
+        value /= 100;
+        end -= 2;
+        end[0] = pairs[2*pair];
+        end[1] = pairs[2*pair + 1];
+      }
+      if ( value >= 10 )
+      {
+        end -= 2;
+        end[0] = pairs[2*value];
+        end[1] = pairs[2*value + 1];
+        return end;
+      }
+      *--end = char('0' + value);
+      return end;
+    }
+
+    // Integer into out; returns the end:
+    inline char* formatInteger(char* out, unsigned long long value)
+    {
+      char digits[24];
+      char* end = digits + sizeof(digits);
+      return std::copy(formatDigits(end, value), end, out);
+    }
+
+    inline char* formatInteger(char* out, long long value)
+    {
+      if ( value < 0 )
+      {
+        *out++ = '-';
+        return formatInteger(out, 0ull - static_cast<unsigned long long>(value));
+      }
+      return formatInteger(out, static_cast<unsigned long long>(value));
+    }
+
+    // printf one number into size chars (literal formats, so the compiler checks them);
+    //  returns the length it needed, which may be size or more:
+    inline int printFloat(char* out, std::size_t size, FloatStyle style, int precision, double x)
+    {
+      switch ( style )
+      {
+        case styleFixed:      return std::snprintf(out, size, "%.*f", precision, x);
+        case styleScientific: return std::snprintf(out, size, "%.*e", precision, x);
+        case styleHex:        return std::snprintf(out, size, "%a", x);
+        default:              return std::snprintf(out, size, "%.*g", precision, x);
+      }
+    }
+
+    inline int printFloat(char* out, std::size_t size, FloatStyle style, int precision, long double x)
+    {
+      switch ( style )
+      {
+        case styleFixed:      return std::snprintf(out, size, "%.*Lf", precision, x);
+        case styleScientific: return std::snprintf(out, size, "%.*Le", precision, x);
+        case styleHex:        return std::snprintf(out, size, "%La", x);
+        default:              return std::snprintf(out, size, "%.*Lg", precision, x);
+      }
+    }
+
+    inline int printFloat(char* out, std::size_t size, FloatStyle style, int precision, float x)
+    {
+      return printFloat(out, size, style, precision, double(x));
+    }
+
+    /// x printed in a printf style onto text; %f of a large x or a long
+    ///  precision does not fit maxChars, so those are printed in place
+    template <typename F>
+    void appendPrinted(std::string& text, F x, const NumberFormat& format)
+    {
+      char buffer[maxChars];
+      const int n = printFloat(buffer, maxChars, format.style, format.precision, x);
+      if ( n < 0 )
+      {
+        return;
+      }
+      if ( std::size_t(n) < maxChars )
+      {
+        text.append(buffer, n);
+        return;
+      }
+
+      const std::size_t at = text.size();
+      text.resize(at + n + 1);
+      printFloat(&text[at], n + 1, format.style, format.precision, x);
+      text.resize(at + n);
+    }
+
+    /// Digit counts bracketing the shortest round-trip form of F
+    template <typename F>
+    struct FloatDigits
+    {
+      static const int least = std::numeric_limits<F>::digits10;        ///< Always reads back
+      static const int most = std::numeric_limits<F>::max_digits10;     ///< Always enough
+    };
+
+    /// Powers of ten 10^-400 .. 10^400 as long doubles (within an ulp), indexed by exponent
+    inline const long double* scalePowers()
+    {
+      static const std::vector<long double> powers = []() {
+        std::vector<long double> t(801);
+        for (int k=-400; k<=400; ++k)
+        {
+          t[std::size_t(k + 400)] = std::pow(10.0L, k);
+        }
+        return t;
+      }();
+
+      return powers.data() + 400;
+    }
+
+    /// d (exactly digits digits, first at 10^exponent) as printf's %.{digits}g would print it
+    inline char* formatDecimal(char* out, bool negative, uint64_t d, int digits, int exponent)
+    {
+      char buffer[24];
+      char* last = buffer + sizeof(buffer);
+      const char* first = formatDigits(last, d);
+      while ( (last - first > 1) && (last[-1] == '0') )
+      {
+        --last;
+      }
+      const int n = int(last - first);
+
+      if ( negative )
+      {
+        *out++ = '-';
+      }
+      if ( (exponent < -4) || (exponent >= digits) )
+      {
+        *out++ = *first;
+        if ( n > 1 )
+        {
+          *out++ = '.';
+          out = std::copy(first + 1, static_cast<const char*>(last), out);
+        }
+        *out++ = 'e';
+        *out++ = (exponent < 0) ? '-' : '+';
+        const int magnitude = std::abs(exponent);
+        if ( magnitude < 10 )
+        {
+          *out++ = '0';
+        }
+        return formatInteger(out, static_cast<unsigned long long>(magnitude));
+      }
+      if ( exponent < 0 )
+      {
+        *out++ = '0';
+        *out++ = '.';
+        out = std::fill_n(out, -exponent - 1, '0');
+        return std::copy(first, static_cast<const char*>(last), out);
+      }
+
+      const int whole = exponent + 1;
+      out = std::copy(first, first + std::min(n, whole), out);
+      out = std::fill_n(out, std::max(0, whole - n), '0');
+      if ( n > whole )
+      {
+        *out++ = '.';
+        out = std::copy(first + whole, static_cast<const char*>(last), out);
+      }
+      return out;
+    }
+
+    /// Does d (digits digits, first at 10^exponent) read back to |x|?
+    ///
+    /// Exact either way: decimalToFloat() when it can decide, else strtod on
+    /// the printed digits (scratch must hold maxChars).
+    template <typename F>
+    bool readsBack(uint64_t d, int digits, int exponent, F x, char* scratch)
+    {
+      if ( d == static_cast<uint64_t>(powersOfTen()[digits]) )
+      {
+        d /= 10;
+        ++exponent;
+      }
+
+      F back;
+      if ( decimalToFloat(d, exponent - digits + 1, back) )
+      {
+        return back == std::abs(x);
+      }
+      char* end = formatDecimal(scratch, false, d, digits, exponent);
+      return strtoReal<F>(std::string(scratch, end).c_str(), nullptr) == std::abs(x);
+    }
+
+    /// d (digits digits, first at 10^exponent, carrying into a new digit) as %.{digits}g prints it
+    inline char* formatCandidate(char* out, bool negative, uint64_t d, int digits, int exponent)
+    {
+      if ( d == static_cast<uint64_t>(powersOfTen()[digits]) )
+      {
+        d /= 10;
+        ++exponent;
+      }
+      return formatDecimal(out, negative, d, digits, exponent);
+    }
+
+    /// Shortest round-trip form of a normal, nonzero x, or nullptr when unsure
+    ///
+    /// x is scaled in long double to a max_digits10-digit integer y, good to
+    /// a few ulps. For digits10, digits10+1, ... digits, the decimal nearest
+    /// x of that length is what %.{digits}g prints; the first that reads back
+    /// to x is printed. When y is too close to the tie between two neighbours
+    /// to tell which is nearer, the one that reads back is the nearest if only
+    /// one does; if both do, printf (which rounds exactly) picks.
+    template <typename F>
+    char* formatScaled(char* out, F x)
+    {
+      const int most = FloatDigits<F>::most;
+      const long double* scale = scalePowers();
+      const long double magnitude = std::abs(static_cast<long double>(x));
+      const long double* powers = powersOfTen();
+
+      int binary;
+      std::frexp(x, &binary);
+      int exponent = int(std::floor((binary - 1)*0.30102999566398120));
+      long double y = magnitude*scale[most - 1 - exponent];
+      if ( y >= powers[most] )
+      {
+        ++exponent;
+        y = magnitude*scale[most - 1 - exponent];
+      }
+      else if ( y < powers[most - 1] )
+      {
+        --exponent;
+        y = magnitude*scale[most - 1 - exponent];
+      }
+      // Scaling error allowance: eight long double ulps of the largest y:
+      static const long double slack = 8.0L*powers[most]/std::ldexp(1.0L, std::numeric_limits<long double>::digits);
+      const uint64_t integral = static_cast<uint64_t>(y);
+      const long double below = y - static_cast<long double>(integral);
+
+      for (int digits=FloatDigits<F>::least; digits<=most; ++digits)
+      {
+        const uint64_t unit = static_cast<uint64_t>(powers[most - digits]);
+        const uint64_t whole = integral/unit;
+        const long double beyond = static_cast<long double>(integral % unit) + below - 0.5L*unit;
+        const bool up = (beyond > 0) || ((beyond == 0) && (whole % 2 == 1));
+
+        if ( std::abs(beyond) > slack )
+        {
+          if ( readsBack(whole + up, digits, exponent, x, out) )
+          {
+            return formatCandidate(out, x < 0, whole + up, digits, exponent);
+          }
+          continue;
+        }
+
+        // Too close to the tie: of two neighbours within half an ulp of x, the
+        //  farther one can't read back unless the nearer one also does:
+        const bool down = readsBack(whole, digits, exponent, x, out);
+        const bool upper = readsBack(whole + 1, digits, exponent, x, out);
+        if ( down && upper )
+        {
+          return out + printFloat(out, maxChars, styleShortest, digits, x);
+        }
+        if ( down || upper )
+        {
+          return formatCandidate(out, x < 0, whole + upper, digits, exponent);
+        }
+      }
+      return nullptr;
+    }
+
+    /// Floating-point number into out; returns the end
+    ///
+    /// The shortest form is the first of %.{digits10}g .. %.{max_digits10}g
+    /// that reads back to x, character for character: a value with a shorter
+    /// decimal form prints it at digits10 (trailing zeros dropped), and at
+    /// more digits the nearest decimal of that length reads back whenever any
+    /// does. Integers below 10^digits10 are printed directly and other normal
+    /// floats and doubles go through formatScaled(); printf is left for
+    /// subnormals and long double. Subnormals carry fewer digits, so their
+    /// search starts at %.1g and may stop short of %.{digits10}g.
+    template <typename F>
+    char* formatReal(char* out, F x)
+    {
+      if ( !std::isfinite(x) )
+      {
+        return out + printFloat(out, maxChars, styleShortest, 1, x);
+      }
+
+      static const F integerLimit = F(std::pow(10.0L, FloatDigits<F>::least));
+      if ( (x == std::trunc(x)) && (std::abs(x) < integerLimit) )
+      {
+        if ( std::signbit(x) )
+        {
+          *out++ = '-';
+        }
+        return formatInteger(out, static_cast<unsigned long long>(std::abs(x)));
+      }
+
+      const bool normal = (std::fpclassify(x) == FP_NORMAL);
+      if ( normal && (FloatDigits<F>::most <= 17) )
+      {
+        char* end = formatScaled(out, x);
+        if ( end )
+        {
+          return end;
+        }
+      }
+
+      // Subnormals carry fewer digits, so their search starts at one:
+      for (int digits=(normal ? FloatDigits<F>::least : 1); digits<FloatDigits<F>::most; ++digits)
+      {
+        const int n = printFloat(out, maxChars, styleShortest, digits, x);
+        const char* p = out;
+        F back;
+        if ( parseReal(p, out + n, ' ', back) && (back == x) )
+        {
+          return out + n;
+        }
+      }
+      return out + printFloat(out, maxChars, styleShortest, FloatDigits<F>::most, x);
+    }
+
+    // One element appended to text:
+    template <typename T>
+    typename std::enable_if<std::is_floating_point<T>::value>::type
+    appendValue(std::string& text, const T& x, const NumberFormat& format)
+    {
+      if ( format.style != styleShortest )
+      {
+        appendPrinted(text, x, format);
+        return;
+      }
+      char buffer[maxChars];
+      text.append(buffer, formatReal(buffer, x));
+    }
+
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value && (sizeof(T) > 1)>::type
+    appendValue(std::string& text, const T& x, const NumberFormat&)
+    {
+      char buffer[maxChars];
+      typedef typename std::conditional<std::is_signed<T>::value, long long, unsigned long long>::type Wide;
+      text.append(buffer, formatInteger(buffer, Wide(x)));
+    }
+
+    template <typename U>
+    void appendValue(std::string& text, const std::complex<U>& x, const NumberFormat& format)
+    {
+      text += '(';
+      appendValue(text, x.real(), format);
+      text += ',';
+      appendValue(text, x.imag(), format);
+      text += ')';
+    }
+
+    /// Anything else goes through a stream
+    template <typename T>
+    typename std::enable_if<!std::is_floating_point<T>::value && !(std::is_integral<T>::value && (sizeof(T) > 1))>::type
+    appendValue(std::string& text, const T& x, const NumberFormat&)
+    {
+      std::ostringstream os;
+      os << x;
+      text += os.str();
+    }
+
+    /// Format items [0, count) in order, in parallel, one window at a time
+    ///
+    /// format(lo, hi, text) appends items [lo, hi) to text; put(text) writes
+    /// each piece in item order. A window of items is split across the
+    /// thread pool, so memory stays bounded by windowChars whatever the size.
+    template <typename Format, typename Put>
+    void writeOrdered(std::size_t count, std::size_t itemChars, const Format& format, const Put& put)
+    {
+      const std::size_t window = std::max<std::size_t>(1, windowChars/std::max<std::size_t>(1, itemChars));
+      const std::size_t parts = std::min<std::size_t>(getNumThreads(), std::min(window, count)*itemChars/(chunkBytes/4) + 1);
+      std::vector<std::string> text(parts);
+
+      for (std::size_t w0=0; w0<count; w0+=window)
+      {
+        const std::size_t w1 = std::min(count, w0 + window);
+        parallelFor(0, parts, [&](std::size_t lo, std::size_t hi) {
+          for (std::size_t part=lo; part<hi; ++part)
+          {
+            text[part].clear();
+            format(w0 + (w1 - w0)*part/parts, w0 + (w1 - w0)*(part + 1)/parts, text[part]);
+          }
+        }, 1);
+
+        for (std::size_t part=0; part<parts; ++part)
+        {
+          put(text[part]);
+        }
+      }
+    }
+
+
+    // One real or integer element:
+    template <typename T>
+    typename std::enable_if<std::is_floating_point<T>::value, bool>::type
+    parseValue(const char*& p, const char* end, char delimiter, T& out)
+    {
+      return parseReal(p, end, delimiter, out);
+    }
+
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value, bool>::type
+    parseValue(const char*& p, const char* end, char delimiter, T& out)
+    {
+      return parseInteger(p, end, delimiter, out);
+    }
+
+    /// Is T a std::complex?
+    template <typename T> struct IsComplex : std::false_type {};
+    template <typename U> struct IsComplex<std::complex<U>> : std::true_type {};
+
+    // Real and imaginary parts (std::real would turn integers into doubles):
+    template <typename T>
+    const T& realPart(const T& x) { return x; }
+
+    template <typename U>
+    U realPart(const std::complex<U>& x) { return x.real(); }
+
+    template <typename T>
+    T imagPart(const T&) { return T(0); }
+
+    template <typename U>
+    U imagPart(const std::complex<U>& x) { return x.imag(); }
+
+    // Conjugate (identity for reals), for hermitian mirrors:
+    template <typename T>
+    T conjugate(const T& x) { return x; }
+
+    template <typename U>
+    std::complex<U> conjugate(const std::complex<U>& x) { return std::conj(x); }
+
+    /// Skip spaces and tabs on the current line
+    inline const char* skipBlanks(const char* p, const char* end, char delimiter)
+    {
+      while ( (p < end) && ((*p == ' ') || (*p == '\t')) && (*p != delimiter) )
+      {
+        ++p;
+      }
+      return p;
+    }
+
+    /// Skip whitespace, line breaks included
+    inline const char* skipSpaces(const char* p, const char* end)
+    {
+      while ( (p < end) && isSpace(*p) )
+      {
+        ++p;
+      }
+      return p;
+    }
+
+    /// Past the next line break (or end)
+    inline const char* nextLine(const char* p, const char* end)
+    {
+      if ( p >= end )
+      {
+        return end;
+      }
+      const void* nl = std::memchr(p, '\n', std::size_t(end - p));
+      return nl ? static_cast<const char*>(nl) + 1 : end;
+    }
+
+    /// Chunk boundaries over [begin, end): about chunkBytes apart, each at a line start
+    inline std::vector<const char*> lineChunks(const char* begin, const char* end)
+    {
+      const std::size_t bytes = std::size_t(end - begin);
+      const std::size_t count = bytes/chunkBytes + 1;
+      std::vector<const char*> bounds(count + 1);
+      bounds[0] = begin;
+      for (std::size_t c=1; c<count; ++c)
+      {
+        const char* at = std::max(bounds[c-1], begin + bytes*c/count);
+        bounds[c] = (at == begin) ? begin : nextLine(at - 1, end);
+      }
+      bounds[count] = end;
+      return bounds;
+    }
+
+    /// Whole file in memory
+    struct TextFile
+    {
+      std::unique_ptr<char[]> bytes;    ///< File contents
+      std::size_t size;                 ///< Length in bytes
+    };
+
+    /// Read all of path
+    inline TextFile readTextFile(const std::string& path, const std::string& where)
+    {
+      std::unique_ptr<std::FILE, int(*)(std::FILE*)> file(std::fopen(path.c_str(), "rb"), &std::fclose);
+      if ( !file )
+      {
+        fileImpl::fail(where, path, "Cannot open file");
+      }
+      if ( std::fseek(file.get(), 0, SEEK_END) != 0 )
+      {
+        fileImpl::fail(where, path, "Cannot size file");
+      }
+      const long size = std::ftell(file.get());
+      if ( (size < 0) || (std::fseek(file.get(), 0, SEEK_SET) != 0) )
+      {
+        fileImpl::fail(where, path, "Cannot size file");
+      }
+
+      TextFile text;
+      text.size = std::size_t(size);
+      text.bytes.reset(new char[text.size + 1]);
+      for (std::size_t done=0; done<text.size; done+=fileImpl::chunkBytes)
+      {
+        const std::size_t n = std::min(fileImpl::chunkBytes, text.size - done);
+        if ( std::fread(text.bytes.get() + done, 1, n, file.get()) != n )
+        {
+          fileImpl::fail(where, path, "Read failed");
+        }
+      }
+      text.bytes[text.size] = '\0';
+      return text;
+    }
+
+    /// Write header, then items [0, count) formatted by format(lo, hi, text), to path
+    template <typename Format>
+    void writeTextFile(const std::string& path, const std::string& where, const std::string& header,
+                       std::size_t count, std::size_t itemChars, const Format& format)
+    {
+      std::unique_ptr<std::FILE, int(*)(std::FILE*)> file(std::fopen(path.c_str(), "wb"), &std::fclose);
+      if ( !file )
+      {
+        fileImpl::fail(where, path, "Cannot open file");
+      }
+
+      const auto put = [&](const std::string& text) {
+        if ( std::fwrite(text.data(), 1, text.size(), file.get()) != text.size() )
+        {
+          fileImpl::fail(where, path, "Write failed");
+        }
+      };
+      put(header);
+      writeOrdered(count, itemChars, format, put);
+
+      if ( std::fclose(file.release()) != 0 )
+      {
+        fileImpl::fail(where, path, "Write failed");
+      }
+    }
+
+    /// Matrix Market field name of T
+    template <typename T>
+    const char* marketField()
+    {
+      return IsComplex<T>::value ? "complex" : (std::is_integral<T>::value ? "integer" : "real");
+    }
+
+    /// Matrix Market banner fields
+    struct MarketHeader
+    {
+      bool coordinate;          ///< Coordinate (else array) format
+      std::string field;        ///< real, double, integer, complex or pattern
+      std::string symmetry;     ///< general, symmetric, skew-symmetric or hermitian
+      uint64_t rows, cols, entries;
+    };
+
+    /// Element from one Matrix Market entry (a complex field has two numbers)
+    template <typename T>
+    bool parseEntry(const char*& p, const char* end, bool, T& out)
+    {
+      return parseValue(p, end, ' ', out);
+    }
+
+    template <typename U>
+    bool parseEntry(const char*& p, const char* end, bool complexField, std::complex<U>& out)
+    {
+      U re = U(0), im = U(0);
+      if ( !parseValue(p, end, ' ', re) )
+      {
+        return false;
+      }
+      if ( complexField )
+      {
+        const char* q = skipBlanks(p, end, '\n');
+        if ( !parseValue(q, end, ' ', im) )
+        {
+          return false;
+        }
+        p = q;
+      }
+      out = std::complex<U>(re, im);
+      return true;
+    }
+
+  } // textImpl namespace
+
+
+  /// Write A to path as a Matrix Market array (general, column by column)
+  template <typename T>
+  void saveMatrixMarket(const Matrix<T>& A, const std::string& path)
+  {
+    const std::string header = std::string("%%MatrixMarket matrix array ") + textImpl::marketField<T>() + " general\n" +
+                               std::to_string(A.getNumRows()) + " " + std::to_string(A.getNumCols()) + "\n";
+    const T* a = A.data();
+    const std::size_t rows = A.getNumRows(), ld = A.getLeadingDim();
+    const textImpl::NumberFormat format = textImpl::shortestFormat();
+
+    textImpl::writeTextFile(path, "MatrixText::saveMatrixMarket", header, A.getNumCols(), rows*textImpl::elementChars,
+      [=](std::size_t lo, std::size_t hi, std::string& text) {
+        for (std::size_t j=lo; j<hi; ++j)
+        {
+          for (std::size_t i=0; i<rows; ++i)
+          {
+            const T& x = a[i*ld + j];
+            textImpl::appendValue(text, textImpl::realPart(x), format);
+            if ( textImpl::IsComplex<T>::value )
+            {
+              text += ' ';
+              textImpl::appendValue(text, textImpl::imagPart(x), format);
+            }
+            text += '\n';
+          }
+        }
+      });
+  }
+
+  /// Write A to path as CSV, one row per line
+  template <typename T>
+  void saveCsv(const Matrix<T>& A, const std::string& path, char delimiter = ',')
+  {
+    static_assert(!textImpl::IsComplex<T>::value, "saveCsv - CSV holds real or integer elements");
+
+    const T* a = A.data();
+    const std::size_t cols = A.getNumCols(), ld = A.getLeadingDim();
+    const textImpl::NumberFormat format = textImpl::shortestFormat();
+
+    textImpl::writeTextFile(path, "MatrixText::saveCsv", std::string(), A.getNumRows(), cols*textImpl::elementChars,
+      [=](std::size_t lo, std::size_t hi, std::string& text) {
+        for (std::size_t i=lo; i<hi; ++i)
+        {
+          for (std::size_t j=0; j<cols; ++j)
+          {
+            if ( j > 0 )
+            {
+              text += delimiter;
+            }
+            textImpl::appendValue(text, a[i*ld + j], format);
+          }
+          text += '\n';
+        }
+      });
+  }
+
+
+  /// Read a Matrix Market file (array or coordinate) into a dense Matrix
+  ///
+  /// The file is read whole and split into chunks at line breaks; the
+  /// chunks are parsed in parallel straight into the matrix's storage.
+  /// Array entries are counted per chunk first, so each chunk knows the
+  /// element it starts at. Symmetric, skew-symmetric and hermitian files
+  /// fill both triangles; coordinate entries not listed are zero, and
+  /// pattern entries are one. Duplicate coordinate entries (which the
+  /// format does not allow) leave one of their values.
+  template <typename T>
+  Matrix<T> loadMatrixMarket(const std::string& path)
+  {
+    const std::string where = "MatrixText::loadMatrixMarket";
+    const textImpl::TextFile file = textImpl::readTextFile(path, where);
+    const char* p = file.bytes.get();
+    const char* end = p + file.size;
+
+    // Banner:
+    const char* line = textImpl::nextLine(p, end);
+    std::string banner(p, line);
+    std::transform(banner.begin(), banner.end(), banner.begin(), [](char c) { return char(std::tolower((unsigned char)c)); });
+    std::istringstream words(banner);
+    std::string magic, object, format;
+    textImpl::MarketHeader header;
+    words >> magic >> object >> format >> header.field >> header.symmetry;
+    if ( (magic != "%%matrixmarket") || (object != "matrix") || ((format != "array") && (format != "coordinate")) )
+    {
+      fileImpl::fail(where, path, "Not a Matrix Market matrix file");
+    }
+    header.coordinate = (format == "coordinate");
+    const bool complexField = (header.field == "complex");
+    const bool pattern = (header.field == "pattern");
+    if ( ((header.field != "real") && (header.field != "double") && (header.field != "integer") && !complexField && !pattern) ||
+         (pattern && !header.coordinate) )
+    {
+      fileImpl::fail(where, path, "Unsupported field '" + header.field + "'");
+    }
+    if ( (header.symmetry != "general") && (header.symmetry != "symmetric") &&
+         (header.symmetry != "skew-symmetric") && (header.symmetry != "hermitian") )
+    {
+      fileImpl::fail(where, path, "Unsupported symmetry '" + header.symmetry + "'");
+    }
+    if ( complexField && !textImpl::IsComplex<T>::value )
+    {
+      fileImpl::fail(where, path, "Complex entries can't be read into a real matrix");
+    }
+    if ( std::is_integral<T>::value && (header.field != "integer") && !pattern )
+    {
+      fileImpl::fail(where, path, "Non-integer entries can't be read into an integer matrix");
+    }
+
+    // Comments, then the size line:
+    for (p = line; p < end; p = textImpl::nextLine(p, end))
+    {
+      const char* eol = textImpl::nextLine(p, end);
+      if ( (*p != '%') && (textImpl::skipSpaces(p, eol) != eol) )
+      {
+        break;
+      }
+    }
+    line = textImpl::nextLine(p, end);
+    const char* q = textImpl::skipBlanks(p, line, '\n');
+    bool sized = textImpl::parseInteger(q, line, ' ', header.rows);
+    q = textImpl::skipBlanks(q, line, '\n');
+    sized = sized && textImpl::parseInteger(q, line, ' ', header.cols);
+    header.entries = 0;
+    if ( header.coordinate )
+    {
+      q = textImpl::skipBlanks(q, line, '\n');
+      sized = sized && textImpl::parseInteger(q, line, ' ', header.entries);
+    }
+    if ( !sized || (textImpl::skipSpaces(q, line) != line) )
+    {
+      fileImpl::fail(where, path, "Bad size line");
+    }
+    if ( (header.rows > std::numeric_limits<uint32_t>::max()) || (header.cols > std::numeric_limits<uint32_t>::max()) )
+    {
+      fileImpl::fail(where, path, "Matrix is too large");
+    }
+
+    const bool general = (header.symmetry == "general");
+    const bool skew = (header.symmetry == "skew-symmetric");
+    const bool hermitian = (header.symmetry == "hermitian");
+    if ( !general && (header.rows != header.cols) )
+    {
+      fileImpl::fail(where, path, "Symmetric matrices must be square");
+    }
+
+    const uint32_t rows = uint32_t(header.rows), cols = uint32_t(header.cols);
+    const std::vector<const char*> bounds = textImpl::lineChunks(line, end);
+    const std::size_t chunks = bounds.size() - 1;
+
+    // Elements not in the file are zero (the whole matrix for coordinate files):
+    AlignedBuffer<T> buffer = (general && !header.coordinate) ? AlignedBuffer<T>(std::size_t(rows)*cols) :
+                                                                AlignedBuffer<T>(std::size_t(rows)*cols, T(0));
+    T* a = buffer.data();
+
+    // Mirror (i, j) into (j, i) for the symmetric forms:
+    const auto store = [=](std::size_t i, std::size_t j, const T& value) {
+      a[i*cols + j] = value;
+      if ( !general && (i != j) )
+      {
+        a[j*cols + i] = skew ? T(-value) : (hermitian ? textImpl::conjugate(value) : value);
+      }
+    };
+    const auto bad = [&](const char* at) {
+      fileImpl::fail(where, path, "Bad entry at byte " + std::to_string(at - file.bytes.get()));
+    };
+
+    if ( header.coordinate )
+    {
+      std::vector<uint64_t> counts(chunks, 0);
+      parallelFor(0, chunks, [&](std::size_t lo, std::size_t hi) {
+        for (std::size_t c=lo; c<hi; ++c)
+        {
+          uint64_t count = 0;
+          for (const char* s=bounds[c]; s<bounds[c+1]; )
+          {
+            const char* eol = textImpl::nextLine(s, bounds[c+1]);
+            const char* t = textImpl::skipSpaces(s, eol);
+            if ( (t == eol) || (*t == '%') )
+            {
+              s = eol;
+              continue;
+            }
+
+            uint64_t i = 0, j = 0;
+            T value = T(1);
+            bool ok = textImpl::parseInteger(t, eol, ' ', i);
+            t = textImpl::skipBlanks(t, eol, '\n');
+            ok = ok && textImpl::parseInteger(t, eol, ' ', j);
+            if ( !pattern )
+            {
+              t = textImpl::skipBlanks(t, eol, '\n');
+              ok = ok && textImpl::parseEntry(t, eol, complexField, value);
+            }
+            if ( !ok || (textImpl::skipSpaces(t, eol) != eol) || (i == 0) || (j == 0) || (i > rows) || (j > cols) ||
+                 (!general && (j > i)) || (skew && (i == j)) )
+            {
+              bad(s);
+            }
+            store(std::size_t(i - 1), std::size_t(j - 1), value);
+            ++count;
+            s = eol;
+          }
+          counts[c] = count;
+        }
+      }, 1);
+
+      uint64_t total = 0;
+      for (const uint64_t count : counts)
+      {
+        total += count;
+      }
+      if ( total != header.entries )
+      {
+        fileImpl::fail(where, path, "Expected " + std::to_string(header.entries) + " entries, found " + std::to_string(total));
+      }
+    }
+    else
+    {
+      // Count numbers per chunk (entries never straddle a line break):
+      std::vector<uint64_t> first(chunks + 1, 0);
+      parallelFor(0, chunks, [&](std::size_t lo, std::size_t hi) {
+        for (std::size_t c=lo; c<hi; ++c)
+        {
+          uint64_t count = 0;
+          bool inToken = false;
+          for (const char* s=bounds[c]; s<bounds[c+1]; ++s)
+          {
+            const bool space = textImpl::isSpace(*s);
+            count += (!space && !inToken);
+            inToken = !space;
+          }
+          first[c+1] = count;
+        }
+      }, 1);
+
+      const uint64_t perEntry = complexField ? 2 : 1;
+      for (std::size_t c=0; c<chunks; ++c)
+      {
+        if ( first[c+1] % perEntry != 0 )
+        {
+          bad(bounds[c]);
+        }
+        first[c+1] = first[c] + first[c+1]/perEntry;
+      }
+      const uint64_t expected = general ? uint64_t(rows)*cols :
+                                (skew ? uint64_t(rows)*(rows - (rows > 0))/2 : uint64_t(rows)*(rows + 1)/2);
+      if ( first[chunks] != expected )
+      {
+        fileImpl::fail(where, path, "Expected " + std::to_string(expected) + " entries, found " + std::to_string(first[chunks]));
+      }
+
+      // Column by column (only the lower triangle of the symmetric forms):
+      const uint32_t skip = skew ? 1 : 0;
+      parallelFor(0, chunks, [&](std::size_t lo, std::size_t hi) {
+        for (std::size_t c=lo; c<hi; ++c)
+        {
+          if ( first[c] == first[c+1] )
+          {
+            continue;
+          }
+
+          // Position of this chunk's first entry:
+          uint64_t k = first[c];
+          std::size_t i = 0, j = 0;
+          if ( general )
+          {
+            i = std::size_t(k % std::max<uint32_t>(rows, 1));
+            j = std::size_t(k / std::max<uint32_t>(rows, 1));
+          }
+          else
+          {
+            while ( k >= rows - j - skip )
+            {
+              k -= rows - j - skip;
+              ++j;
+            }
+            i = j + skip + std::size_t(k);
+          }
+
+          const char* s = textImpl::skipSpaces(bounds[c], bounds[c+1]);
+          for (uint64_t n=first[c]; n<first[c+1]; ++n)
+          {
+            T value;
+            if ( !textImpl::parseEntry(s, bounds[c+1], complexField, value) )
+            {
+              bad(s);
+            }
+            store(i, j, value);
+            if ( ++i == rows )
+            {
+              ++j;
+              i = general ? 0 : j + skip;
+            }
+            s = textImpl::skipSpaces(s, bounds[c+1]);
+          }
+        }
+      }, 1);
+    }
+
+    return Matrix<T>(rows, cols, std::move(buffer));
+  }
+
+  /// Read a CSV file of real or integer elements, one row per line
+  ///
+  /// Blank lines are skipped; every other line is a row and must have as
+  /// many fields as the first. Lines are counted per chunk first, so each
+  /// chunk parses its rows in parallel straight into the matrix's storage.
+  template <typename T>
+  Matrix<T> loadCsv(const std::string& path, char delimiter = ',')
+  {
+    static_assert(!textImpl::IsComplex<T>::value, "loadCsv - CSV holds real or integer elements");
+
+    const std::string where = "MatrixText::loadCsv";
+    const textImpl::TextFile file = textImpl::readTextFile(path, where);
+    const char* begin = file.bytes.get();
+    const char* end = begin + file.size;
+    if ( (file.size >= 3) && (std::memcmp(begin, "\xEF\xBB\xBF", 3) == 0) )
+    {
+      begin += 3;
+    }
+
+    // Is [s, eol) blank?
+    const auto blank = [](const char* s, const char* eol) { return textImpl::skipSpaces(s, eol) == eol; };
+
+    // Columns from the first row:
+    uint32_t cols = 0;
+    for (const char* s=begin; s<end; )
+    {
+      const char* eol = textImpl::nextLine(s, end);
+      if ( !blank(s, eol) )
+      {
+        cols = 1 + uint32_t(std::count(s, eol, delimiter));
+        break;
+      }
+      s = eol;
+    }
+
+    // Rows per chunk, then each chunk's first row:
+    const std::vector<const char*> bounds = textImpl::lineChunks(begin, end);
+    const std::size_t chunks = bounds.size() - 1;
+    std::vector<uint64_t> first(chunks + 1, 0);
+    parallelFor(0, chunks, [&](std::size_t lo, std::size_t hi) {
+      for (std::size_t c=lo; c<hi; ++c)
+      {
+        uint64_t count = 0;
+        for (const char* s=bounds[c]; s<bounds[c+1]; )
+        {
+          const char* eol = textImpl::nextLine(s, bounds[c+1]);
+          count += !blank(s, eol);
+          s = eol;
+        }
+        first[c+1] = count;
+      }
+    }, 1);
+    for (std::size_t c=0; c<chunks; ++c)
+    {
+      first[c+1] += first[c];
+    }
+    if ( first[chunks] > std::numeric_limits<uint32_t>::max() )
+    {
+      fileImpl::fail(where, path, "Matrix is too large");
+    }
+
+    const uint32_t rows = uint32_t(first[chunks]);
+    AlignedBuffer<T> buffer(std::size_t(rows)*cols);
+    T* a = buffer.data();
+
+    parallelFor(0, chunks, [&](std::size_t lo, std::size_t hi) {
+      for (std::size_t c=lo; c<hi; ++c)
+      {
+        uint64_t i = first[c];
+        for (const char* s=bounds[c]; s<bounds[c+1]; )
+        {
+          const char* eol = textImpl::nextLine(s, bounds[c+1]);
+          if ( blank(s, eol) )
+          {
+            s = eol;
+            continue;
+          }
+
+          const char* t = s;
+          for (uint32_t j=0; j<cols; ++j)
+          {
+            t = textImpl::skipBlanks(t, eol, delimiter);
+            if ( !textImpl::parseValue(t, eol, delimiter, a[i*cols + j]) )
+            {
+              fileImpl::fail(where, path, "Bad number in row " + std::to_string(i + 1) + ", column " + std::to_string(j + 1));
+            }
+            t = textImpl::skipBlanks(t, eol, delimiter);
+            if ( (j + 1 < cols) ? ((t == eol) || (*t != delimiter)) : !blank(t, eol) )
+            {
+              fileImpl::fail(where, path, "Row " + std::to_string(i + 1) + " does not have " + std::to_string(cols) + " fields");
+            }
+            ++t;
+          }
+          ++i;
+          s = eol;
+        }
+      }
+    }, 1);
+
+    return Matrix<T>(rows, cols, std::move(buffer));
+  }
+
+
+  // Operator << (declared in Matrix.hpp)
+  //
+  // Rows are formatted in parallel into buffers and written a window at a
+  // time, rather than element by element through the stream, and the stream
+  // is not flushed per row.
+  template <typename T>
+  std::ostream& operator<<(std::ostream& os, const Matrix<T>& rhs)
+  {
+    const std::string pad = rhs.getPad();
+    const textImpl::NumberFormat format = textImpl::streamFormat(os);
+    const T* a = rhs.data();
+    const std::size_t cols = rhs.getNumCols(), ld = rhs.getLeadingDim();
+
+    textImpl::writeOrdered(rhs.getNumRows(), pad.size() + cols*textImpl::elementChars + 1,
+      [&](std::size_t lo, std::size_t hi, std::string& text) {
+        for (std::size_t i=lo; i<hi; ++i)
+        {
+          // Output pad in front of each row, a space after each element:
+          text += pad;
+          for (std::size_t j=0; j<cols; ++j)
+          {
+            textImpl::appendValue(text, a[i*ld + j], format);
+            text += ' ';
+          }
+          text += '\n';
+        }
+      },
+      [&](const std::string& text) { os.write(text.data(), std::streamsize(text.size())); });
+
+    return os;
+  }
+
+} // matrix namespace
+
+#endif // MATRIX_TEXT_H
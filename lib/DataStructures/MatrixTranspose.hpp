@@ -0,0 +1,334 @@
+////////////////////////////////////////
+//
+//  File:
+//      \file MatrixTranspose.hpp
+//
+//  Description:
+//      \brief Matrix Transpose: Cache-oblivious and in-place transpose kernels
+//
+//  Author:
+//      \author J. Caleb Wherry
+//
+////////////////////////////////////////
+
+// Include Guards:
+#ifndef MATRIX_TRANSPOSE_H
+#define MATRIX_TRANSPOSE_H
+
+// Forward Declared Dependencies:
+//
+
+// Local Include Dependencies:
+#include "CpuFeatures.hpp"
+#include "MatrixSimd.hpp"
+#include "ThreadPool.hpp"
+
+// Compiler Include Dependencies:
+#include <cstddef>
+#include <complex>
+#include <vector>
+#include <algorithm>
+#include <utility>
+
+/// matrix Namespace
+namespace matrix
+{
+
+  /// Side of the square tiles the transposes bottom out in (a source and a
+  ///  destination tile of doubles fit in L1 together)
+  const std::size_t transposeTile = 32;
+
+  /// transposeImpl namespace (kernel internals)
+  namespace transposeImpl
+  {
+
+    /// Element as stored (real types) or conjugated
+    template <typename T>
+    inline T conjugateIf(const T& x, bool) { return x; }
+
+    /// Element as stored or conjugated (complex element types)
+    template <typename U>
+    inline std::complex<U> conjugateIf(const std::complex<U>& x, bool conj) { return conj ? std::conj(x) : x; }
+
+
+    //
+    // Portable kernels:
+    //
+
+    /// b = a^T for one tile (a: rows x cols, row stride lda; b: cols x rows, row stride ldb)
+    template <typename T>
+    void tileScalar(std::size_t rows, std::size_t cols, const T* a, std::size_t lda, T* b, std::size_t ldb, bool conj)
+    {
+      for (std::size_t i=0; i<rows; ++i)
+      {
+        for (std::size_t j=0; j<cols; ++j)
+        {
+          b[j*ldb + i] = conjugateIf(a[i*lda + j], conj);
+        }
+      }
+    }
+
+#if MATRIX_X86_DISPATCH
+
+    //
+    // AVX kernels (4x4 doubles, 8x8 floats and 2x2 complex transposed in registers):
+    //
+
+    __attribute__((target("avx2")))
+    inline void tileAvx2(std::size_t rows, std::size_t cols, const double* a, std::size_t lda, double* b, std::size_t ldb, bool)
+    {
+      std::size_t i = 0;
+      for (; i+4<=rows; i+=4)
+      {
+        std::size_t j = 0;
+        for (; j+4<=cols; j+=4)
+        {
+          const double* s = a + i*lda + j;
+          const __m256d r0 = _mm256_loadu_pd(s);
+          const __m256d r1 = _mm256_loadu_pd(s + lda);
+          const __m256d r2 = _mm256_loadu_pd(s + 2*lda);
+          const __m256d r3 = _mm256_loadu_pd(s + 3*lda);
+
+          const __m256d t0 = _mm256_unpacklo_pd(r0, r1);
+          const __m256d t1 = _mm256_unpackhi_pd(r0, r1);
+          const __m256d t2 = _mm256_unpacklo_pd(r2, r3);
+          const __m256d t3 = _mm256_unpackhi_pd(r2, r3);
+
+          double* d = b + j*ldb + i;
+          _mm256_storeu_pd(d,         _mm256_permute2f128_pd(t0, t2, 0x20));
+          _mm256_storeu_pd(d + ldb,   _mm256_permute2f128_pd(t1, t3, 0x20));
+          _mm256_storeu_pd(d + 2*ldb, _mm256_permute2f128_pd(t0, t2, 0x31));
+          _mm256_storeu_pd(d + 3*ldb, _mm256_permute2f128_pd(t1, t3, 0x31));
+        }
+        tileScalar(4, cols - j, a + i*lda + j, lda, b + j*ldb + i, ldb, false);
+      }
+      tileScalar(rows - i, cols, a + i*lda, lda, b + i, ldb, false);
+    }
+
+    __attribute__((target("avx2")))
+    inline void tileAvx2(std::size_t rows, std::size_t cols, const float* a, std::size_t lda, float* b, std::size_t ldb, bool)
+    {
+      std::size_t i = 0;
+      for (; i+8<=rows; i+=8)
+      {
+        std::size_t j = 0;
+        for (; j+8<=cols; j+=8)
+        {
+          const float* s = a + i*lda + j;
+          __m256 r[8], t[8];
+          for (std::size_t k=0; k<8; ++k)
+          {
+            r[k] = _mm256_loadu_ps(s + k*lda);
+          }
+
+          for (std::size_t k=0; k<8; k+=2)
+          {
+            t[k]     = _mm256_unpacklo_ps(r[k], r[k+1]);
+            t[k + 1] = _mm256_unpackhi_ps(r[k], r[k+1]);
+          }
+          for (std::size_t k=0; k<8; k+=4)
+          {
+            r[k]     = _mm256_shuffle_ps(t[k],     t[k + 2], 0x44);
+            r[k + 1] = _mm256_shuffle_ps(t[k],     t[k + 2], 0xEE);
+            r[k + 2] = _mm256_shuffle_ps(t[k + 1], t[k + 3], 0x44);
+            r[k + 3] = _mm256_shuffle_ps(t[k + 1], t[k + 3], 0xEE);
+          }
+
+          float* d = b + j*ldb + i;
+          for (std::size_t k=0; k<4; ++k)
+          {
+            _mm256_storeu_ps(d + k*ldb,       _mm256_permute2f128_ps(r[k], r[k + 4], 0x20));
+            _mm256_storeu_ps(d + (k + 4)*ldb, _mm256_permute2f128_ps(r[k], r[k + 4], 0x31));
+          }
+        }
+        tileScalar(8, cols - j, a + i*lda + j, lda, b + j*ldb + i, ldb, false);
+      }
+      tileScalar(rows - i, cols, a + i*lda, lda, b + i, ldb, false);
+    }
+
+    __attribute__((target("avx2")))
+    inline void tileAvx2(std::size_t rows, std::size_t cols, const std::complex<double>* a, std::size_t lda,
+                         std::complex<double>* b, std::size_t ldb, bool conj)
+    {
+      // Each complex is one 128-bit lane; conjugating flips the imaginary sign bits:
+      const __m256d flip = conj ? _mm256_set_pd(-0.0, 0.0, -0.0, 0.0) : _mm256_setzero_pd();
+      std::size_t i = 0;
+      for (; i+2<=rows; i+=2)
+      {
+        std::size_t j = 0;
+        for (; j+2<=cols; j+=2)
+        {
+          const double* s = simd::asReal(a + i*lda + j);
+          const __m256d r0 = _mm256_xor_pd(_mm256_loadu_pd(s), flip);
+          const __m256d r1 = _mm256_xor_pd(_mm256_loadu_pd(s + 2*lda), flip);
+
+          double* d = simd::asReal(b + j*ldb + i);
+          _mm256_storeu_pd(d,         _mm256_permute2f128_pd(r0, r1, 0x20));
+          _mm256_storeu_pd(d + 2*ldb, _mm256_permute2f128_pd(r0, r1, 0x31));
+        }
+        tileScalar(2, cols - j, a + i*lda + j, lda, b + j*ldb + i, ldb, conj);
+      }
+      tileScalar(rows - i, cols, a + i*lda, lda, b + i, ldb, conj);
+    }
+
+#endif // MATRIX_X86_DISPATCH
+
+
+    //
+    // Dispatchers:
+    //
+
+    template <typename T>
+    void tile(std::size_t rows, std::size_t cols, const T* a, std::size_t lda, T* b, std::size_t ldb, bool conj)
+    {
+      tileScalar(rows, cols, a, lda, b, ldb, conj);
+    }
+
+#if MATRIX_X86_DISPATCH
+
+    inline void tile(std::size_t rows, std::size_t cols, const double* a, std::size_t lda, double* b, std::size_t ldb, bool conj)
+    {
+      (simdLevel() >= simdAvx2) ? tileAvx2(rows, cols, a, lda, b, ldb, conj) : tileScalar(rows, cols, a, lda, b, ldb, conj);
+    }
+
+    inline void tile(std::size_t rows, std::size_t cols, const float* a, std::size_t lda, float* b, std::size_t ldb, bool conj)
+    {
+      (simdLevel() >= simdAvx2) ? tileAvx2(rows, cols, a, lda, b, ldb, conj) : tileScalar(rows, cols, a, lda, b, ldb, conj);
+    }
+
+    inline void tile(std::size_t rows, std::size_t cols, const std::complex<double>* a, std::size_t lda,
+                     std::complex<double>* b, std::size_t ldb, bool conj)
+    {
+      (simdLevel() >= simdAvx2) ? tileAvx2(rows, cols, a, lda, b, ldb, conj) : tileScalar(rows, cols, a, lda, b, ldb, conj);
+    }
+
+#endif // MATRIX_X86_DISPATCH
+
+
+    /// b = a^T by recursive halving of the longer side (cache-oblivious)
+    ///
+    /// Every level of the memory hierarchy sees a sub-problem that fits it
+    /// once the recursion gets small enough, without tuning a block size per
+    /// level; the leaves are single tiles.
+    template <typename T>
+    void recursive(std::size_t rows, std::size_t cols, const T* a, std::size_t lda, T* b, std::size_t ldb, bool conj)
+    {
+      if ( (rows <= transposeTile) && (cols <= transposeTile) )
+      {
+        tile(rows, cols, a, lda, b, ldb, conj);
+      }
+      else if ( rows >= cols )
+      {
+        const std::size_t half = (rows/2 + transposeTile - 1)/transposeTile*transposeTile;
+        recursive(half, cols, a, lda, b, ldb, conj);
+        recursive(rows - half, cols, a + half*lda, lda, b + half, ldb, conj);
+      }
+      else
+      {
+        const std::size_t half = (cols/2 + transposeTile - 1)/transposeTile*transposeTile;
+        recursive(rows, half, a, lda, b, ldb, conj);
+        recursive(rows, cols - half, a + half, lda, b + half*ldb, ldb, conj);
+      }
+    }
+
+  } // transposeImpl namespace
+
+
+  /// b = a^T (or a^H with conj) for a row-major rows x cols a
+  ///
+  /// a has row stride lda and b (cols x rows) row stride ldb; they must not
+  /// overlap. Bands of a's rows run across the thread pool, each transposed
+  /// cache-obliviously down to register-transposed tiles.
+  template <typename T>
+  void transposeCopy(std::size_t rows, std::size_t cols, const T* a, std::size_t lda, T* b, std::size_t ldb, bool conj = false)
+  {
+    const std::size_t tiles = (rows + transposeTile - 1)/transposeTile;
+    parallelFor(0, tiles, [=](std::size_t lo, std::size_t hi) {
+      const std::size_t r0 = lo*transposeTile;
+      const std::size_t r1 = std::min(hi*transposeTile, rows);
+      transposeImpl::recursive(r1 - r0, cols, a + r0*lda, lda, b + r0, ldb, conj);
+    }, getParallelThreshold()/(transposeTile*cols + 1) + 1);
+  }
+
+  /// a = a^T (or a^H with conj) in place, for a packed row-major rows x cols a
+  ///
+  /// Square matrices swap tile pairs across the diagonal. Other shapes follow
+  /// the permutation's cycles (element k moves to k*rows mod (rows*cols - 1)),
+  /// which needs one bit of scratch per element instead of a second matrix.
+  template <typename T>
+  void transposeInPlace(std::size_t rows, std::size_t cols, T* a, bool conj = false)
+  {
+    using transposeImpl::conjugateIf;
+
+    if ( rows == cols )
+    {
+      const std::size_t n = rows;
+      const std::size_t tiles = (n + transposeTile - 1)/transposeTile;
+      parallelFor(0, tiles, [=](std::size_t lo, std::size_t hi) {
+        for (std::size_t bi=lo; bi<hi; ++bi)
+        {
+          const std::size_t i0 = bi*transposeTile, i1 = std::min(i0 + transposeTile, n);
+          for (std::size_t j0=i0; j0<n; j0+=transposeTile)
+          {
+            const std::size_t j1 = std::min(j0 + transposeTile, n);
+            for (std::size_t i=i0; i<i1; ++i)
+            {
+              // Diagonal tile: only the part above the diagonal swaps:
+              for (std::size_t j=std::max(j0, i + 1); j<j1; ++j)
+              {
+                const T upper = a[i*n + j];
+                a[i*n + j] = conjugateIf(a[j*n + i], conj);
+                a[j*n + i] = conjugateIf(upper, conj);
+              }
+            }
+          }
+        }
+      }, getParallelThreshold()/(transposeTile*n/2 + 1) + 1);
+
+      if ( conj )
+      {
+        for (std::size_t i=0; i<n; ++i)
+        {
+          a[i*n + i] = conjugateIf(a[i*n + i], conj);
+        }
+      }
+      return;
+    }
+
+    const std::size_t size = rows*cols;
+    if ( size < 2 )
+    {
+      if ( size == 1 )
+      {
+        a[0] = conjugateIf(a[0], conj);
+      }
+      return;
+    }
+
+    // First and last elements stay put; every other one sits on a cycle:
+    std::vector<bool> moved(size, false);
+    a[0] = conjugateIf(a[0], conj);
+    a[size - 1] = conjugateIf(a[size - 1], conj);
+    for (std::size_t start=1; start<size-1; ++start)
+    {
+      if ( moved[start] )
+      {
+        continue;
+      }
+
+      T carried = a[start];
+      std::size_t k = start;
+      do
+      {
+        const std::size_t next = (k*rows) % (size - 1);
+        std::swap(carried, a[next]);
+        a[next] = conjugateIf(a[next], conj);
+        moved[next] = true;
+        k = next;
+      } while ( k != start );
+    }
+  }
+
+} // matrix namespace
+
+#endif // MATRIX_TRANSPOSE_H
@@ -0,0 +1,1115 @@
+////////////////////////////////////////
+//
+//  File:
+//      \file MatrixView.hpp
+//
+//  Description:
+//      \brief Matrix View: Zero-copy blocks, rows, columns, diagonals and slices
+//
+//  Author:
+//      \author J. Caleb Wherry
+//
+////////////////////////////////////////
+
+// Include Guards:
+#ifndef MATRIX_VIEW_H
+#define MATRIX_VIEW_H
+
+// Forward Declared Dependencies:
+//
+
+// Local Include Dependencies:
+#include "Matrix.hpp"
+
+// Compiler Include Dependencies:
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <stdexcept>
+#include <algorithm>
+#include <vector>
+
+/// matrix Namespace
+namespace matrix
+{
+
+  /// Shortest row a view reduces where it lies; shorter rows are gathered into blocks first
+  const std::size_t viewRunLength = 16;
+
+  /// viewImpl namespace (view internals)
+  namespace viewImpl
+  {
+
+    /// Plain assignment, next to the simd::Op updates
+    const int opAssign = -1;
+
+    // Contiguous dst = src or dst = dst OP src:
+    template <typename T>
+    void store(exprImpl::OpTag<opAssign>, const T* src, T* dst, std::size_t n) { std::copy(src, src + n, dst); }
+
+    template <int Op, typename T>
+    void store(exprImpl::OpTag<Op>, const T* src, T* dst, std::size_t n) { exprImpl::apply(exprImpl::OpTag<Op>(), dst, src, dst, n); }
+
+    // Contiguous dst = s or dst = dst OP s:
+    template <typename T>
+    void store(exprImpl::OpTag<opAssign>, const T& s, T* dst, std::size_t n) { std::fill(dst, dst + n, s); }
+
+    template <int Op, typename T>
+    void store(exprImpl::OpTag<Op>, const T& s, T* dst, std::size_t n) { exprImpl::apply(exprImpl::OpTag<Op>(), dst, s, dst, n); }
+
+    // One strided element, d OP s:
+    template <typename T>
+    T combine(exprImpl::OpTag<opAssign>, const T&, const T& s) { return s; }
+
+    template <typename T>
+    T combine(exprImpl::OpTag<simd::opAdd>, const T& d, const T& s) { return d + s; }
+
+    template <typename T>
+    T combine(exprImpl::OpTag<simd::opSub>, const T& d, const T& s) { return d - s; }
+
+    template <typename T>
+    T combine(exprImpl::OpTag<simd::opMul>, const T& d, const T& s) { return d * s; }
+
+    template <typename T>
+    T combine(exprImpl::OpTag<simd::opDiv>, const T& d, const T& s) { return d / s; }
+
+  } // viewImpl namespace
+
+
+  /// Const Matrix View class
+  ///
+  /// A non-owning window onto matrix elements: a pointer, a shape and a row
+  /// and a column stride, so element (i,j) is data()[i*rowStride + j*colStride].
+  /// Blocks, rows, columns, the diagonal, strided slices and transposes of a
+  /// Matrix (or of another view) are views of the same memory; nothing is
+  /// copied. A view is an operand of element-wise expressions like a Matrix,
+  /// hands GEMM and GEMV its strides directly and reduces in place.
+  /// Factorizations copy it into the matrix they factor, as they would copy
+  /// a Matrix. A view must not outlive the memory it refers to.
+  template <typename T>
+  class ConstMatrixView : public MatrixExpr<ConstMatrixView<T>, T>
+  {
+
+    protected:
+      const T* ptr;             ///< Element (0,0)
+      uint32_t numRows;         ///< Number of rows
+      uint32_t numCols;         ///< Number of columns
+      std::size_t rowStride;    ///< Distance (in elements) between rows
+      std::size_t colStride;    ///< Distance (in elements) between columns
+
+      /// Offset of the slice at (row, col), after checking it lies inside the view
+      std::size_t sliceOffset(uint32_t row, uint32_t col, uint32_t rows, uint32_t cols,
+                              uint32_t rowStep, uint32_t colStep) const;
+
+      /// Is each row contiguous?
+      bool rowsContiguous() const { return (numCols <= 1) || (colStride == 1); };
+
+      /// Is each column contiguous?
+      bool columnsContiguous() const { return (numRows <= 1) || (rowStride == 1); };
+
+      /// Reduce every element: fn(block, n) on contiguous blocks, joined by combine
+      template <typename R, typename Fn, typename Combine>
+      R reduceElements(const R& identity, const Fn& fn, const Combine& combine) const;
+
+    public:
+
+      /// Magnitude type of the elements (T itself, or U for complex<U>)
+      typedef typename Matrix<T>::Real Real;
+
+
+      //
+      // Constructors:
+      //
+
+      /// Default Constructor (empty view)
+      ConstMatrixView();
+
+      /// Strided Constructor
+      ConstMatrixView (
+        const T* _data,                 ///< Element (0,0).
+        uint32_t _numRows,              ///< Number of rows.
+        uint32_t _numCols,              ///< Number of columns.
+        std::size_t _rowStride,         ///< Distance between rows.
+        std::size_t _colStride = 1      ///< Distance between columns.
+      );
+
+      /// Whole Matrix Constructor
+      ConstMatrixView (
+        const Matrix<T>& matrix         ///< Matrix to view.
+      );
+
+
+      //
+      // Accessors:
+      //
+
+      const T* data() const { return ptr; };                      ///< Element (0,0)
+      uint32_t getNumRows() const { return numRows; };            ///< Row accessor
+      uint32_t getNumCols() const { return numCols; };            ///< Columns accessor
+      std::size_t getRowStride() const { return rowStride; };     ///< Row stride accessor
+      std::size_t getColStride() const { return colStride; };     ///< Column stride accessor
+      std::size_t size() const { return std::size_t(numRows)*numCols; };   ///< Number of elements
+
+      /// Are the elements contiguous and row-major, like a Matrix's?
+      bool isPacked() const { return rowsContiguous() && ((numRows <= 1) || (rowStride == numCols)); };
+
+      /// Element Access
+      const T& operator()(const uint32_t& row, const uint32_t& col) const;
+
+
+      //
+      // Views of this view:
+      //
+
+      ConstMatrixView block(uint32_t row, uint32_t col, uint32_t rows, uint32_t cols) const;   ///< rows x cols block at (row, col)
+      ConstMatrixView row(uint32_t row) const;          ///< One row (1 x cols)
+      ConstMatrixView column(uint32_t col) const;       ///< One column (rows x 1)
+      ConstMatrixView diagonal() const;                 ///< Main diagonal as a column
+      ConstMatrixView transpose() const;                ///< Transpose (strides swapped)
+
+      /// Every rowStep-th row and colStep-th column of the rows x cols grid starting at (row, col)
+      ConstMatrixView slice(uint32_t row, uint32_t col, uint32_t rows, uint32_t cols, uint32_t rowStep, uint32_t colStep) const;
+
+
+      //
+      // Expression interface (see MatrixExpr.hpp):
+      //
+
+      /// Elements [lo, lo+n) in row-major order (a pointer into the view when
+      ///  they are contiguous there, else gathered into out)
+      const T* evalBlock(std::size_t lo, std::size_t n, T* out) const;
+
+      /// Does the view span p?
+      bool references(const T* p) const;
+
+      /// Does the view span any of [lo, hi)?
+      bool overlaps(const T* lo, const T* hi) const;
+
+
+      //
+      // Operations (each copies the view into a Matrix first):
+      //
+
+      Matrix<T> inverse() const { return Matrix<T>(*this).inverse(); };                         ///< Matrix Inverse
+      Matrix<T> solve(const Matrix<T>& B) const { return Matrix<T>(*this).solve(B); };          ///< X with A*X = B
+      Matrix<T> leastSquares(const Matrix<T>& B) const { return Matrix<T>(*this).leastSquares(B); };   ///< X minimizing ||A*X - B||
+      T determinant() const { return Matrix<T>(*this).determinant(); };                         ///< det(A)
+
+      /// op(A)*op(B) for views, GEMM on their strides (Matrix operands convert to views)
+      static Matrix<T> multiply(const ConstMatrixView& a, const ConstMatrixView& b);
+
+
+      //
+      // Numerical Properties (in place):
+      //
+
+      T trace() const;                  ///< Sum of diagonal elements
+      T sum(Summation method = summationLanes) const;     ///< Sum of all elements
+      T mean(Summation method = summationLanes) const;    ///< Average of all elements
+      Real p1Norm() const;              ///< P=1 Norm: Maximum absolute column sum
+      Real p2Norm() const { return Matrix<T>(*this).p2Norm(); };   ///< P=2 Norm (Lanczos on a copy)
+      Real pInfNorm() const;            ///< P=inf Norm: Maximum absolute row sum
+      Real frobeniusNorm() const;       ///< Square root of the sum of squared magnitudes
+      Real maxNorm() const;             ///< Largest element magnitude
+
+
+      //
+      // Row and Column Reductions (in place when rows or columns are contiguous):
+      //
+
+      std::vector<T> rowSums(Summation method = summationLanes) const;       ///< Sum of each row
+      std::vector<T> columnSums(Summation method = summationLanes) const;    ///< Sum of each column
+      std::vector<Real> rowNorms(VectorNorm norm = vectorNorm2) const;       ///< Norm of each row
+      std::vector<Real> columnNorms(VectorNorm norm = vectorNorm2) const;    ///< Norm of each column
+
+  }; // ConstMatrixView class
+
+
+  /// Matrix View class
+  ///
+  /// A ConstMatrixView whose elements can be written. Like a pointer, the
+  /// view itself is shallow: copying a MatrixView makes another view of the
+  /// same elements, while assigning to one (=, +=, *=, ...) writes through to
+  /// them. Right-hand sides that read the view's memory at other positions
+  /// (A.block(0,0,n,n) = A.block(1,1,n,n)) are evaluated into a temporary first.
+  template <typename T>
+  class MatrixView : public ConstMatrixView<T>
+  {
+
+    private:
+      /// dst = expr or dst OP= expr over the view
+      template <int Op, typename E>
+      void update(const MatrixExpr<E,T>& expr, const char* message);
+
+      /// dst = s or dst OP= s over the view
+      template <int Op>
+      void update(const T& s);
+
+    public:
+
+      //
+      // Constructors:
+      //
+
+      /// Default Constructor (empty view)
+      MatrixView() {};
+
+      /// Strided Constructor
+      MatrixView (
+        T* _data,                       ///< Element (0,0).
+        uint32_t _numRows,              ///< Number of rows.
+        uint32_t _numCols,              ///< Number of columns.
+        std::size_t _rowStride,         ///< Distance between rows.
+        std::size_t _colStride = 1      ///< Distance between columns.
+      ) : ConstMatrixView<T>(_data, _numRows, _numCols, _rowStride, _colStride) {};
+
+      /// Whole Matrix Constructor
+      MatrixView (
+        Matrix<T>& matrix               ///< Matrix to view.
+      ) : ConstMatrixView<T>(matrix) {};
+
+      /// Copy Constructor (another view of the same elements)
+      MatrixView(const MatrixView<T>& rhs) = default;
+
+
+      //
+      // Accessors:
+      //
+
+      T* data() const { return const_cast<T*>(this->ptr); };      ///< Element (0,0)
+
+      /// Element Access
+      T& operator()(const uint32_t& row, const uint32_t& col) const;
+
+
+      //
+      // Views of this view:
+      //
+
+      MatrixView block(uint32_t row, uint32_t col, uint32_t rows, uint32_t cols) const;   ///< rows x cols block at (row, col)
+      MatrixView row(uint32_t row) const;               ///< One row (1 x cols)
+      MatrixView column(uint32_t col) const;            ///< One column (rows x 1)
+      MatrixView diagonal() const;                      ///< Main diagonal as a column
+      MatrixView transpose() const;                     ///< Transpose (strides swapped)
+
+      /// Every rowStep-th row and colStep-th column of the rows x cols grid starting at (row, col)
+      MatrixView slice(uint32_t row, uint32_t col, uint32_t rows, uint32_t cols, uint32_t rowStep, uint32_t colStep) const;
+
+
+      //
+      // Assignment (writes the elements):
+      //
+
+      /// Copy elements from another view of the same size
+      MatrixView<T>& operator=(const MatrixView<T>& rhs);
+
+      /// Elements from a matrix, view or expression of the same size
+      template <typename E>
+      MatrixView<T>& operator=(const MatrixExpr<E,T>& rhs);
+
+      /// Every element set to value
+      MatrixView<T>& operator=(const T& value);
+
+      template <typename E>
+      MatrixView<T>& operator+=(const MatrixExpr<E,T>& rhs);    ///< Matrix/Matrix Addition
+      template <typename E>
+      MatrixView<T>& operator-=(const MatrixExpr<E,T>& rhs);    ///< Matrix/Matrix Subtraction
+      MatrixView<T>& operator*=(const T& rhs);                  ///< Matrix/Scalar Multiplication
+      MatrixView<T>& operator/=(const T& rhs);                  ///< Matrix/Scalar Division
+      MatrixView<T>& operator+=(const T& rhs);                  ///< Matrix/Scalar Addition
+      MatrixView<T>& operator-=(const T& rhs);                  ///< Matrix/Scalar Subtraction
+
+      /// this = alpha*a*b + beta*this, GEMM straight into the view (the
+      ///  building block of blocked algorithms: C11 -= A12*B21 and the like)
+      MatrixView<T>& multiplyAdd(
+        const ConstMatrixView<T>& a,    ///< Left factor (rows x k).
+        const ConstMatrixView<T>& b,    ///< Right factor (k x cols).
+        const T& alpha = T(1),          ///< Product scale.
+        const T& beta = T(0)            ///< Scale of the view's old elements.
+      );
+
+  }; // MatrixView class
+
+
+  //
+  // Operators:
+  //
+
+  /// View/View Multiplication (GEMM on the strides, no copies)
+  template <typename T>
+  Matrix<T> operator*(const ConstMatrixView<T>& lhs, const ConstMatrixView<T>& rhs)
+  {
+    return ConstMatrixView<T>::multiply(lhs, rhs);
+  }
+
+  /// Matrix/View Multiplication
+  template <typename T>
+  Matrix<T> operator*(const Matrix<T>& lhs, const ConstMatrixView<T>& rhs)
+  {
+    return ConstMatrixView<T>::multiply(lhs, rhs);
+  }
+
+  /// View/Matrix Multiplication
+  template <typename T>
+  Matrix<T> operator*(const ConstMatrixView<T>& lhs, const Matrix<T>& rhs)
+  {
+    return ConstMatrixView<T>::multiply(lhs, rhs);
+  }
+
+  /// View/Vector Multiplication (GEMV on contiguous rows or columns)
+  template <typename T>
+  std::vector<T> operator*(const ConstMatrixView<T>& lhs, const std::vector<T>& rhs);
+
+
+  //
+  // Template Implementation
+  //
+
+
+  // Default constructor
+  template <typename T>
+  ConstMatrixView<T>::ConstMatrixView()
+        : ptr(nullptr),
+          numRows(0),
+          numCols(0),
+          rowStride(0),
+          colStride(1)
+  {
+  }
+
+  // Strided constructor
+  template <typename T>
+  ConstMatrixView<T>::ConstMatrixView(const T* _data, uint32_t _numRows, uint32_t _numCols,
+                                      std::size_t _rowStride, std::size_t _colStride)
+        : ptr(_data),
+          numRows(_numRows),
+          numCols(_numCols),
+          rowStride(_rowStride),
+          colStride(_colStride)
+  {
+  }
+
+  // Whole matrix constructor
+  template <typename T>
+  ConstMatrixView<T>::ConstMatrixView(const Matrix<T>& matrix)
+        : ptr(matrix.data()),
+          numRows(matrix.getNumRows()),
+          numCols(matrix.getNumCols()),
+          rowStride(matrix.getLeadingDim()),
+          colStride(1)
+  {
+  }
+
+  // sliceOffset
+  template <typename T>
+  std::size_t ConstMatrixView<T>::sliceOffset(uint32_t row, uint32_t col, uint32_t rows, uint32_t cols,
+                                              uint32_t rowStep, uint32_t colStep) const
+  {
+    if ( (rowStep == 0) || (colStep == 0) )
+    {
+      throw std::logic_error("MatrixView::slice - Steps must be at least 1!");
+    }
+
+    // Last row and column taken (or the start itself for empty slices) must be in range:
+    const uint64_t lastRow = uint64_t(row) + ((rows > 0) ? uint64_t(rows - 1)*rowStep : 0);
+    const uint64_t lastCol = uint64_t(col) + ((cols > 0) ? uint64_t(cols - 1)*colStep : 0);
+    if ( (uint64_t(row) + (rows > 0) > numRows) || (uint64_t(col) + (cols > 0) > numCols) ||
+         ((rows > 0) && (lastRow >= numRows)) || ((cols > 0) && (lastCol >= numCols)) )
+    {
+      throw std::out_of_range("MatrixView::slice - Slice out of bounds!");
+    }
+
+    return std::size_t(row)*rowStride + std::size_t(col)*colStride;
+  }
+
+  // Operator ()
+  template <typename T>
+  const T& ConstMatrixView<T>::operator()(const uint32_t& row, const uint32_t& col) const
+  {
+    if ( (row >= numRows) || (col >= numCols) )
+    {
+      throw std::out_of_range("MatrixView::operator() - Indices out of bounds!");
+    }
+
+    return ptr[std::size_t(row)*rowStride + std::size_t(col)*colStride];
+  }
+
+  // block
+  template <typename T>
+  ConstMatrixView<T> ConstMatrixView<T>::block(uint32_t row, uint32_t col, uint32_t rows, uint32_t cols) const
+  {
+    return ConstMatrixView<T>(ptr + sliceOffset(row, col, rows, cols, 1, 1), rows, cols, rowStride, colStride);
+  }
+
+  // row
+  template <typename T>
+  ConstMatrixView<T> ConstMatrixView<T>::row(uint32_t row) const
+  {
+    return ConstMatrixView<T>(ptr + sliceOffset(row, 0, 1, numCols, 1, 1), 1, numCols, rowStride, colStride);
+  }
+
+  // column
+  template <typename T>
+  ConstMatrixView<T> ConstMatrixView<T>::column(uint32_t col) const
+  {
+    return ConstMatrixView<T>(ptr + sliceOffset(0, col, numRows, 1, 1, 1), numRows, 1, rowStride, colStride);
+  }
+
+  // diagonal
+  template <typename T>
+  ConstMatrixView<T> ConstMatrixView<T>::diagonal() const
+  {
+    return ConstMatrixView<T>(ptr, std::min(numRows, numCols), 1, rowStride + colStride, colStride);
+  }
+
+  // transpose
+  template <typename T>
+  ConstMatrixView<T> ConstMatrixView<T>::transpose() const
+  {
+    return ConstMatrixView<T>(ptr, numCols, numRows, colStride, rowStride);
+  }
+
+  // slice
+  template <typename T>
+  ConstMatrixView<T> ConstMatrixView<T>::slice(uint32_t row, uint32_t col, uint32_t rows, uint32_t cols,
+                                               uint32_t rowStep, uint32_t colStep) const
+  {
+    return ConstMatrixView<T>(ptr + sliceOffset(row, col, rows, cols, rowStep, colStep), rows, cols,
+                              rowStride*rowStep, colStride*colStep);
+  }
+
+  // evalBlock
+  template <typename T>
+  const T* ConstMatrixView<T>::evalBlock(std::size_t lo, std::size_t n, T* out) const
+  {
+    if ( isPacked() )
+    {
+      return ptr + lo;
+    }
+    if ( n == 0 )
+    {
+      return out;
+    }
+
+    std::size_t i = lo/numCols, j = lo%numCols;
+
+    // Inside one contiguous row: no copy:
+    if ( rowsContiguous() && (j + n <= numCols) )
+    {
+      return ptr + i*rowStride + j;
+    }
+
+    for (std::size_t done=0; done<n; )
+    {
+      const std::size_t len = std::min(n - done, numCols - j);
+      const T* src = ptr + i*rowStride + j*colStride;
+      if ( colStride == 1 )
+      {
+        std::copy(src, src + len, out + done);
+      }
+      else
+      {
+        for (std::size_t l=0; l<len; ++l)
+        {
+          out[done + l] = src[l*colStride];
+        }
+      }
+      done += len;
+      ++i;
+      j = 0;
+    }
+    return out;
+  }
+
+  // references
+  template <typename T>
+  bool ConstMatrixView<T>::references(const T* p) const
+  {
+    return this->overlaps(p, p + 1);
+  }
+
+  // overlaps
+  template <typename T>
+  bool ConstMatrixView<T>::overlaps(const T* lo, const T* hi) const
+  {
+    if ( this->size() == 0 )
+    {
+      return false;
+    }
+
+    // The view lies within [first, last]:
+    const T* first = ptr;
+    const T* last = ptr + std::size_t(numRows - 1)*rowStride + std::size_t(numCols - 1)*colStride;
+    return (lo <= last) && (first < hi);
+  }
+
+  // multiply
+  template <typename T>
+  Matrix<T> ConstMatrixView<T>::multiply(const ConstMatrixView<T>& a, const ConstMatrixView<T>& b)
+  {
+    if ( a.numCols != b.numRows )
+    {
+      throw std::logic_error("Matrix::operator* (Matrix/Matrix) - Matrices' inner dimensions do not match, can not multiply them!");
+    }
+
+    // Every element is written (beta = 0 never reads C):
+    Matrix<T> result(a.numRows, b.numCols, typename Matrix<T>::Uninitialized());
+    gemm<T>(a.numRows, b.numCols, a.numCols,
+            T(1), a.ptr, std::ptrdiff_t(a.rowStride), std::ptrdiff_t(a.colStride),
+                  b.ptr, std::ptrdiff_t(b.rowStride), std::ptrdiff_t(b.colStride),
+            T(0), result.data(), std::ptrdiff_t(result.getLeadingDim()), 1);
+    return result;
+  }
+
+  // reduceElements
+  template <typename T>
+  template <typename R, typename Fn, typename Combine>
+  R ConstMatrixView<T>::reduceElements(const R& identity, const Fn& fn, const Combine& combine) const
+  {
+    const T* a = ptr;
+    const std::size_t rows = numRows, cols = numCols, rs = rowStride;
+
+    // Packed: one stream, like a Matrix:
+    if ( isPacked() )
+    {
+      return parallelReduce(0, this->size(), identity,
+        [=](std::size_t lo, std::size_t hi) { return fn(a + lo, hi - lo); },
+        combine);
+    }
+
+    // Long contiguous rows (or columns, through the transpose) in place:
+    if ( rowsContiguous() && (cols >= viewRunLength) )
+    {
+      return parallelReduce(0, rows, identity,
+        [=](std::size_t lo, std::size_t hi) {
+          R acc = identity;
+          for (std::size_t i=lo; i<hi; ++i)
+          {
+            acc = combine(acc, fn(a + i*rs, cols));
+          }
+          return acc;
+        },
+        combine, getParallelThreshold()/(cols + 1) + 1);
+    }
+    if ( columnsContiguous() && (rows >= viewRunLength) )
+    {
+      return this->transpose().reduceElements(identity, fn, combine);
+    }
+
+    // Anything else is gathered one block at a time:
+    return parallelReduce(0, this->size(), identity,
+      [=](std::size_t lo, std::size_t hi) {
+        alignas(storageAlignment) T scratch[exprBlockSize];
+        R acc = identity;
+        for (std::size_t b=lo; b<hi; b+=exprBlockSize)
+        {
+          const std::size_t len = std::min(exprBlockSize, hi - b);
+          acc = combine(acc, fn(this->evalBlock(b, len, scratch), len));
+        }
+        return acc;
+      },
+      combine);
+  }
+
+  // Trace
+  template <typename T>
+  T ConstMatrixView<T>::trace() const
+  {
+    const T* a = ptr;
+    const std::size_t stride = rowStride + colStride;
+    return parallelReduce(0, std::min(numRows, numCols), T(0),
+      [=](std::size_t lo, std::size_t hi) {
+        T diagSum = 0;
+        for (std::size_t i=lo; i<hi; ++i)
+        {
+          diagSum += a[i*stride];
+        }
+        return diagSum;
+      },
+      [](const T& x, const T& y) { return x + y; },
+      getParallelThreshold()/8 + 1);
+  }
+
+  // Sum
+  template <typename T>
+  T ConstMatrixView<T>::sum(Summation method) const
+  {
+    return reduceElements(T(0),
+      [=](const T* a, std::size_t n) { return reduceImpl::sum(a, n, method); },
+      [](const T& x, const T& y) { return x + y; });
+  }
+
+  // mean
+  template <typename T>
+  T ConstMatrixView<T>::mean(Summation method) const
+  {
+    if ( this->size() == 0 )
+    {
+      throw std::logic_error("MatrixView::mean - View is empty!");
+    }
+
+    return this->sum(method)/T(this->size());
+  }
+
+  // p1Norm
+  template <typename T>
+  typename ConstMatrixView<T>::Real ConstMatrixView<T>::p1Norm() const
+  {
+    const std::vector<Real> norms = this->columnNorms(vectorNorm1);
+    return norms.empty() ? Real(0) : *std::max_element(norms.begin(), norms.end());
+  }
+
+  // pInfNorm
+  template <typename T>
+  typename ConstMatrixView<T>::Real ConstMatrixView<T>::pInfNorm() const
+  {
+    const std::vector<Real> norms = this->rowNorms(vectorNorm1);
+    return norms.empty() ? Real(0) : *std::max_element(norms.begin(), norms.end());
+  }
+
+  // frobeniusNorm
+  template <typename T>
+  typename ConstMatrixView<T>::Real ConstMatrixView<T>::frobeniusNorm() const
+  {
+    const Real squares = reduceElements(Real(0),
+      [](const T* a, std::size_t n) { return reduceImpl::accumulate<simd::accSquare, Real>(a, n); },
+      [](const Real& x, const Real& y) { return x + y; });
+
+    // Over- or underflowed sums are redone, rescaled, on a copy:
+    if ( reduceImpl::SquareRange<Real>::contains(squares) || std::isnan(squares) )
+    {
+      return Real(std::sqrt(squares));
+    }
+    return Matrix<T>(*this).frobeniusNorm();
+  }
+
+  // maxNorm
+  template <typename T>
+  typename ConstMatrixView<T>::Real ConstMatrixView<T>::maxNorm() const
+  {
+    return reduceElements(Real(0),
+      [](const T* a, std::size_t n) { return reduceImpl::accumulate<simd::accMaxAbs, Real>(a, n); },
+      [](const Real& x, const Real& y) { return std::max(x, y); });
+  }
+
+  // rowSums
+  template <typename T>
+  std::vector<T> ConstMatrixView<T>::rowSums(Summation method) const
+  {
+    if ( !rowsContiguous() )
+    {
+      return columnsContiguous() ? this->transpose().columnSums(method) : Matrix<T>(*this).rowSums(method);
+    }
+
+    std::vector<T> result(numRows);
+    const T* a = ptr;
+    const std::size_t cols = numCols, ld = rowStride;
+    T* out = result.data();
+    parallelFor(0, numRows, [=](std::size_t lo, std::size_t hi) {
+      for (std::size_t i=lo; i<hi; ++i)
+      {
+        out[i] = reduceImpl::sum(a + i*ld, cols, method);
+      }
+    }, getParallelThreshold()/(cols + 1) + 1);
+
+    return result;
+  }
+
+  // columnSums
+  template <typename T>
+  std::vector<T> ConstMatrixView<T>::columnSums(Summation method) const
+  {
+    if ( !rowsContiguous() )
+    {
+      return columnsContiguous() ? this->transpose().rowSums(method) : Matrix<T>(*this).columnSums(method);
+    }
+
+    std::vector<T> result(numCols);
+    reduceImpl::columnSums(numRows, numCols, ptr, rowStride, result.data(), method);
+    return result;
+  }
+
+  // rowNorms
+  template <typename T>
+  std::vector<typename ConstMatrixView<T>::Real> ConstMatrixView<T>::rowNorms(VectorNorm norm) const
+  {
+    if ( !rowsContiguous() )
+    {
+      return columnsContiguous() ? this->transpose().columnNorms(norm) : Matrix<T>(*this).rowNorms(norm);
+    }
+
+    std::vector<Real> result(numRows);
+    reduceImpl::rowNorms(numRows, numCols, ptr, rowStride, result.data(), norm);
+    return result;
+  }
+
+  // columnNorms
+  template <typename T>
+  std::vector<typename ConstMatrixView<T>::Real> ConstMatrixView<T>::columnNorms(VectorNorm norm) const
+  {
+    if ( !rowsContiguous() )
+    {
+      return columnsContiguous() ? this->transpose().rowNorms(norm) : Matrix<T>(*this).columnNorms(norm);
+    }
+
+    std::vector<Real> result(numCols);
+    reduceImpl::columnNorms(numRows, numCols, ptr, rowStride, result.data(), norm);
+    return result;
+  }
+
+  // View/Vector multiplication
+  template <typename T>
+  std::vector<T> operator*(const ConstMatrixView<T>& lhs, const std::vector<T>& rhs)
+  {
+    if ( rhs.size() != lhs.getNumCols() )
+    {
+      throw std::logic_error("Matrix::operator* (Matrix/Vector) - Vector length does not match the number of columns!");
+    }
+
+    const std::size_t m = lhs.getNumRows(), n = lhs.getNumCols();
+    std::vector<T> result(m);
+    if ( (n <= 1) || (lhs.getColStride() == 1) )
+    {
+      gemv<T>(m, n, T(1), lhs.data(), lhs.getRowStride(), rhs.data(), T(0), result.data());
+    }
+    else if ( (m <= 1) || (lhs.getRowStride() == 1) )
+    {
+      // Contiguous columns: the view is the transpose of a row-major n x m matrix:
+      gemvTransposed<T>(n, m, T(1), lhs.data(), lhs.getColStride(), rhs.data(), T(0), result.data());
+    }
+    else
+    {
+      return Matrix<T>(lhs)*rhs;
+    }
+
+    return result;
+  }
+
+
+  // Operator () (MatrixView)
+  template <typename T>
+  T& MatrixView<T>::operator()(const uint32_t& row, const uint32_t& col) const
+  {
+    return const_cast<T&>(ConstMatrixView<T>::operator()(row, col));
+  }
+
+  // block (MatrixView)
+  template <typename T>
+  MatrixView<T> MatrixView<T>::block(uint32_t row, uint32_t col, uint32_t rows, uint32_t cols) const
+  {
+    return MatrixView<T>(data() + this->sliceOffset(row, col, rows, cols, 1, 1), rows, cols, this->rowStride, this->colStride);
+  }
+
+  // row (MatrixView)
+  template <typename T>
+  MatrixView<T> MatrixView<T>::row(uint32_t row) const
+  {
+    return MatrixView<T>(data() + this->sliceOffset(row, 0, 1, this->numCols, 1, 1), 1, this->numCols, this->rowStride, this->colStride);
+  }
+
+  // column (MatrixView)
+  template <typename T>
+  MatrixView<T> MatrixView<T>::column(uint32_t col) const
+  {
+    return MatrixView<T>(data() + this->sliceOffset(0, col, this->numRows, 1, 1, 1), this->numRows, 1, this->rowStride, this->colStride);
+  }
+
+  // diagonal (MatrixView)
+  template <typename T>
+  MatrixView<T> MatrixView<T>::diagonal() const
+  {
+    return MatrixView<T>(data(), std::min(this->numRows, this->numCols), 1, this->rowStride + this->colStride, this->colStride);
+  }
+
+  // transpose (MatrixView)
+  template <typename T>
+  MatrixView<T> MatrixView<T>::transpose() const
+  {
+    return MatrixView<T>(data(), this->numCols, this->numRows, this->colStride, this->rowStride);
+  }
+
+  // slice (MatrixView)
+  template <typename T>
+  MatrixView<T> MatrixView<T>::slice(uint32_t row, uint32_t col, uint32_t rows, uint32_t cols,
+                                     uint32_t rowStep, uint32_t colStep) const
+  {
+    return MatrixView<T>(data() + this->sliceOffset(row, col, rows, cols, rowStep, colStep), rows, cols,
+                         this->rowStride*rowStep, this->colStride*colStep);
+  }
+
+  // update (expression)
+  template <typename T>
+  template <int Op, typename E>
+  void MatrixView<T>::update(const MatrixExpr<E,T>& expr, const char* message)
+  {
+    exprImpl::checkSameSize(*this, expr, message);
+
+    // Operands reading this view's memory (other than in place) go through a temporary:
+    const E& e = expr.derived();
+    const T* first = this->ptr;
+    const T* end = first + ((this->size() == 0) ? 0 :
+                   std::size_t(this->numRows - 1)*this->rowStride + std::size_t(this->numCols - 1)*this->colStride + 1);
+    if ( (this->size() > 0) && (e.references(first) || e.overlaps(first, end)) )
+    {
+      const Matrix<T> temp(expr);
+      update<Op>(temp, message);
+      return;
+    }
+
+    T* base = data();
+    const std::size_t cols = this->numCols, rs = this->rowStride, cs = this->colStride;
+    parallelFor(0, this->numRows, [&](std::size_t lo, std::size_t hi) {
+      alignas(storageAlignment) T scratch[exprBlockSize];
+
+      for (std::size_t i=lo; i<hi; ++i)
+      {
+        for (std::size_t j0=0; j0<cols; j0+=exprBlockSize)
+        {
+          const std::size_t len = std::min(exprBlockSize, cols - j0);
+          const T* src = e.evalBlock(i*cols + j0, len, scratch);
+          T* dst = base + i*rs + j0*cs;
+          if ( cs == 1 )
+          {
+            viewImpl::store(exprImpl::OpTag<Op>(), src, dst, len);
+          }
+          else
+          {
+            for (std::size_t l=0; l<len; ++l)
+            {
+              dst[l*cs] = viewImpl::combine(exprImpl::OpTag<Op>(), dst[l*cs], src[l]);
+            }
+          }
+        }
+      }
+    }, getParallelThreshold()/(cols + 1) + 1);
+  }
+
+  // update (scalar)
+  template <typename T>
+  template <int Op>
+  void MatrixView<T>::update(const T& s)
+  {
+    T* base = data();
+    const std::size_t cols = this->numCols, rs = this->rowStride, cs = this->colStride;
+    parallelFor(0, this->numRows, [&](std::size_t lo, std::size_t hi) {
+      for (std::size_t i=lo; i<hi; ++i)
+      {
+        T* dst = base + i*rs;
+        if ( cs == 1 )
+        {
+          viewImpl::store(exprImpl::OpTag<Op>(), s, dst, cols);
+        }
+        else
+        {
+          for (std::size_t j=0; j<cols; ++j)
+          {
+            dst[j*cs] = viewImpl::combine(exprImpl::OpTag<Op>(), dst[j*cs], s);
+          }
+        }
+      }
+    }, getParallelThreshold()/(cols + 1) + 1);
+  }
+
+  // Operator = (view)
+  template <typename T>
+  MatrixView<T>& MatrixView<T>::operator=(const MatrixView<T>& rhs)
+  {
+    update<viewImpl::opAssign>(static_cast<const ConstMatrixView<T>&>(rhs), "MatrixView::operator= - Views must be the same size!");
+    return *this;
+  }
+
+  // Operator = (expression)
+  template <typename T>
+  template <typename E>
+  MatrixView<T>& MatrixView<T>::operator=(const MatrixExpr<E,T>& rhs)
+  {
+    update<viewImpl::opAssign>(rhs, "MatrixView::operator= - Views must be the same size!");
+    return *this;
+  }
+
+  // Operator = (scalar)
+  template <typename T>
+  MatrixView<T>& MatrixView<T>::operator=(const T& value)
+  {
+    update<viewImpl::opAssign>(value);
+    return *this;
+  }
+
+  // Operator += (expression)
+  template <typename T>
+  template <typename E>
+  MatrixView<T>& MatrixView<T>::operator+=(const MatrixExpr<E,T>& rhs)
+  {
+    update<simd::opAdd>(rhs, "MatrixView::operator+= (Matrix/Matrix) - Views must be the same size!");
+    return *this;
+  }
+
+  // Operator -= (expression)
+  template <typename T>
+  template <typename E>
+  MatrixView<T>& MatrixView<T>::operator-=(const MatrixExpr<E,T>& rhs)
+  {
+    update<simd::opSub>(rhs, "MatrixView::operator-= (Matrix/Matrix) - Views must be the same size!");
+    return *this;
+  }
+
+  // Operator *= (scalar)
+  template <typename T>
+  MatrixView<T>& MatrixView<T>::operator*=(const T& rhs)
+  {
+    update<simd::opMul>(rhs);
+    return *this;
+  }
+
+  // Operator /= (scalar)
+  template <typename T>
+  MatrixView<T>& MatrixView<T>::operator/=(const T& rhs)
+  {
+    if ( rhs == T(0) )
+    {
+      throw std::logic_error("MatrixView::operator/= (Matrix/Scalar) - Can't divide by zero!");
+    }
+
+    update<simd::opDiv>(rhs);
+    return *this;
+  }
+
+  // Operator += (scalar)
+  template <typename T>
+  MatrixView<T>& MatrixView<T>::operator+=(const T& rhs)
+  {
+    update<simd::opAdd>(rhs);
+    return *this;
+  }
+
+  // Operator -= (scalar)
+  template <typename T>
+  MatrixView<T>& MatrixView<T>::operator-=(const T& rhs)
+  {
+    update<simd::opSub>(rhs);
+    return *this;
+  }
+
+  // multiplyAdd
+  template <typename T>
+  MatrixView<T>& MatrixView<T>::multiplyAdd(const ConstMatrixView<T>& a, const ConstMatrixView<T>& b,
+                                            const T& alpha, const T& beta)
+  {
+    if ( a.getNumCols() != b.getNumRows() )
+    {
+      throw std::logic_error("MatrixView::multiplyAdd - Matrices' inner dimensions do not match, can not multiply them!");
+    }
+    if ( (a.getNumRows() != this->numRows) || (b.getNumCols() != this->numCols) )
+    {
+      throw std::logic_error("MatrixView::multiplyAdd - Product must be the same size as the view!");
+    }
+
+    // GEMM can't read what it writes, so overlapping factors are copied first:
+    const T* first = this->ptr;
+    const T* end = first + ((this->size() == 0) ? 0 :
+                   std::size_t(this->numRows - 1)*this->rowStride + std::size_t(this->numCols - 1)*this->colStride + 1);
+    if ( a.overlaps(first, end) || b.overlaps(first, end) )
+    {
+      const Matrix<T> ca(a), cb(b);
+      return this->multiplyAdd(ca, cb, alpha, beta);
+    }
+
+    gemm<T>(this->numRows, this->numCols, a.getNumCols(),
+            alpha, a.data(), std::ptrdiff_t(a.getRowStride()), std::ptrdiff_t(a.getColStride()),
+                   b.data(), std::ptrdiff_t(b.getRowStride()), std::ptrdiff_t(b.getColStride()),
+            beta, data(), std::ptrdiff_t(this->rowStride), std::ptrdiff_t(this->colStride));
+    return *this;
+  }
+
+
+  //
+  // Matrix view accessors (declared in Matrix.hpp):
+  //
+
+  // view
+  template <typename T>
+  MatrixView<T> Matrix<T>::view()
+  {
+    return MatrixView<T>(*this);
+  }
+
+  // view (const)
+  template <typename T>
+  ConstMatrixView<T> Matrix<T>::view() const
+  {
+    return ConstMatrixView<T>(*this);
+  }
+
+  // block
+  template <typename T>
+  MatrixView<T> Matrix<T>::block(uint32_t row, uint32_t col, uint32_t rows, uint32_t cols)
+  {
+    return this->view().block(row, col, rows, cols);
+  }
+
+  // block (const)
+  template <typename T>
+  ConstMatrixView<T> Matrix<T>::block(uint32_t row, uint32_t col, uint32_t rows, uint32_t cols) const
+  {
+    return this->view().block(row, col, rows, cols);
+  }
+
+  // row
+  template <typename T>
+  MatrixView<T> Matrix<T>::row(uint32_t row)
+  {
+    return this->view().row(row);
+  }
+
+  // row (const)
+  template <typename T>
+  ConstMatrixView<T> Matrix<T>::row(uint32_t row) const
+  {
+    return this->view().row(row);
+  }
+
+  // column
+  template <typename T>
+  MatrixView<T> Matrix<T>::column(uint32_t col)
+  {
+    return this->view().column(col);
+  }
+
+  // column (const)
+  template <typename T>
+  ConstMatrixView<T> Matrix<T>::column(uint32_t col) const
+  {
+    return this->view().column(col);
+  }
+
+  // diagonal
+  template <typename T>
+  MatrixView<T> Matrix<T>::diagonal()
+  {
+    return this->view().diagonal();
+  }
+
+  // diagonal (const)
+  template <typename T>
+  ConstMatrixView<T> Matrix<T>::diagonal() const
+  {
+    return this->view().diagonal();
+  }
+
+  // slice
+  template <typename T>
+  MatrixView<T> Matrix<T>::slice(uint32_t row, uint32_t col, uint32_t rows, uint32_t cols, uint32_t rowStep, uint32_t colStep)
+  {
+    return this->view().slice(row, col, rows, cols, rowStep, colStep);
+  }
+
+  // slice (const)
+  template <typename T>
+  ConstMatrixView<T> Matrix<T>::slice(uint32_t row, uint32_t col, uint32_t rows, uint32_t cols, uint32_t rowStep, uint32_t colStep) const
+  {
+    return this->view().slice(row, col, rows, cols, rowStep, colStep);
+  }
+
+} // matrix namespace
+
+#endif // MATRIX_VIEW_H
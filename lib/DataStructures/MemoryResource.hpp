@@ -0,0 +1,395 @@
+////////////////////////////////////////
+//
+//  File:
+//      \file MemoryResource.hpp
+//
+//  Description:
+//      \brief Memory Resource: Pluggable allocation policies for matrix storage
+//
+//  Author:
+//      \author J. Caleb Wherry
+//
+////////////////////////////////////////
+
+// Include Guards:
+#ifndef MEMORY_RESOURCE_H
+#define MEMORY_RESOURCE_H
+
+// Forward Declared Dependencies:
+//
+
+// Local Include Dependencies:
+//
+
+// Compiler Include Dependencies:
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <vector>
+#include <algorithm>
+
+#if !defined(_WIN32)
+  #include <sys/mman.h>
+#endif
+
+/// matrix Namespace
+namespace matrix
+{
+
+  /// Memory Resource class
+  ///
+  /// Where AlignedBuffer (and so Matrix) gets its memory. Each buffer remembers
+  /// the resource that allocated it and hands the memory back to it, so
+  /// resources can be mixed freely. Buffers take the calling thread's current
+  /// resource (see MemoryResourceScope), which is defaultResource() unless set.
+  class MemoryResource
+  {
+    public:
+      virtual ~MemoryResource() {}
+
+      /// Allocate bytes aligned to alignment (a power of two); throws std::bad_alloc
+      virtual void* allocate(std::size_t bytes, std::size_t alignment) = 0;
+
+      /// Return memory from allocate(bytes, ...) with the same bytes
+      virtual void deallocate(void* ptr, std::size_t bytes) = 0;
+  };
+
+
+  /// Aligned Resource class (the heap, through posix_memalign / _aligned_malloc)
+  class AlignedResource : public MemoryResource
+  {
+    public:
+      void* allocate(std::size_t bytes, std::size_t alignment) override
+      {
+        void* ptr = nullptr;
+        alignment = std::max(alignment, sizeof(void*));
+
+#if defined(_WIN32)
+        ptr = _aligned_malloc(bytes, alignment);
+#else
+        if ( posix_memalign(&ptr, alignment, bytes) != 0 )
+        {
+          ptr = nullptr;
+        }
+#endif
+
+        if ( ptr == nullptr )
+        {
+          throw std::bad_alloc();
+        }
+        return ptr;
+      }
+
+      void deallocate(void* ptr, std::size_t) override
+      {
+#if defined(_WIN32)
+        _aligned_free(ptr);
+#else
+        std::free(ptr);
+#endif
+      }
+  };
+
+  /// The heap resource every thread starts with
+  inline MemoryResource& defaultResource()
+  {
+    static AlignedResource resource;
+    return resource;
+  }
+
+
+  /// How HugePageResource gets its huge pages
+  enum HugePages
+  {
+    hugePagesTransparent,   ///< 2 MiB-aligned mappings the kernel is asked to back with huge pages
+    hugePagesExplicit       ///< Reserved huge pages (MAP_HUGETLB); transparent ones if none are free
+  };
+
+  /// Huge Page Resource class
+  ///
+  /// Large blocks are mapped directly and aligned to 2 MiB so the kernel can
+  /// back them with huge pages: one TLB entry then covers 2 MiB instead of
+  /// 4 KiB, which matters once GEMM streams panels through many megabytes.
+  /// Blocks below minimumBytes aren't worth a mapping and come from the heap.
+  /// Pages are only placed when first written, so on NUMA machines they land
+  /// on the node of the thread that first touches them (Matrix's parallel
+  /// fill does that with the same row split the parallel kernels use). Where
+  /// mmap isn't available this is the heap resource.
+  class HugePageResource : public MemoryResource
+  {
+    private:
+      HugePages mode;
+      std::size_t minimumBytes;
+
+    public:
+      /// Size (and alignment) of a huge page
+      static const std::size_t pageBytes = std::size_t(2) << 20;
+
+      HugePageResource(HugePages _mode = hugePagesTransparent, std::size_t _minimumBytes = pageBytes)
+            : mode(_mode),
+              minimumBytes(_minimumBytes)
+      {
+      }
+
+      void* allocate(std::size_t bytes, std::size_t alignment) override
+      {
+#if defined(_WIN32)
+        return defaultResource().allocate(bytes, alignment);
+#else
+        if ( bytes < minimumBytes )
+        {
+          return defaultResource().allocate(bytes, alignment);
+        }
+        if ( alignment > pageBytes )
+        {
+          throw std::bad_alloc();
+        }
+
+        const std::size_t length = roundUp(bytes);
+  #if defined(MAP_HUGETLB)
+        if ( mode == hugePagesExplicit )
+        {
+          void* ptr = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+          if ( ptr != MAP_FAILED )
+          {
+            return ptr;
+          }
+        }
+  #endif
+
+        // Over-map by a page, then trim to a 2 MiB-aligned block:
+        void* raw = ::mmap(nullptr, length + pageBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if ( raw == MAP_FAILED )
+        {
+          throw std::bad_alloc();
+        }
+        const std::uintptr_t start = reinterpret_cast<std::uintptr_t>(raw);
+        const std::uintptr_t aligned = (start + pageBytes - 1) & ~std::uintptr_t(pageBytes - 1);
+        if ( aligned > start )
+        {
+          ::munmap(raw, aligned - start);
+        }
+        if ( aligned + length < start + length + pageBytes )
+        {
+          ::munmap(reinterpret_cast<void*>(aligned + length), start + pageBytes - aligned);
+        }
+
+        void* ptr = reinterpret_cast<void*>(aligned);
+  #if defined(MADV_HUGEPAGE)
+        ::madvise(ptr, length, MADV_HUGEPAGE);
+  #endif
+        return ptr;
+#endif
+      }
+
+      void deallocate(void* ptr, std::size_t bytes) override
+      {
+#if defined(_WIN32)
+        defaultResource().deallocate(ptr, bytes);
+#else
+        if ( bytes < minimumBytes )
+        {
+          defaultResource().deallocate(ptr, bytes);
+          return;
+        }
+        ::munmap(ptr, roundUp(bytes));
+#endif
+      }
+
+      /// bytes rounded up to whole huge pages
+      static std::size_t roundUp(std::size_t bytes)
+      {
+        return (bytes + pageBytes - 1) & ~(pageBytes - 1);
+      }
+  };
+
+
+  /// Arena Resource class
+  ///
+  /// Bump allocator for short-lived temporaries: allocation is a pointer
+  /// increment inside a few large chunks, and nothing is freed until reset(),
+  /// which makes the memory reusable for the next round of temporaries (the
+  /// largest chunk is kept, so a steady workload stops allocating at all).
+  /// Freeing the most recent allocation gives its space straight back, so
+  /// temporaries that die in reverse order reuse memory without a reset.
+  /// Every buffer taken from an arena must be gone before reset() or the
+  /// arena's destruction. An arena is not thread-safe; give each thread its
+  /// own.
+  class ArenaResource : public MemoryResource
+  {
+    private:
+      struct Chunk
+      {
+        char* base;
+        std::size_t bytes;
+      };
+
+      MemoryResource& upstream;     ///< Where chunks come from
+      std::size_t chunkBytes;       ///< Size of a regular chunk
+      std::vector<Chunk> chunks;    ///< Chunks in use; the last is being filled
+      std::size_t used;             ///< Bytes used in the last chunk
+      char* last;                   ///< Most recent allocation (for LIFO frees)
+
+      void addChunk(std::size_t bytes)
+      {
+        chunks.reserve(chunks.size() + 1);
+
+        Chunk chunk;
+        chunk.bytes = std::max(bytes, chunkBytes);
+        chunk.base = static_cast<char*>(upstream.allocate(chunk.bytes, chunkAlignment));
+        chunks.push_back(chunk);
+        used = 0;
+      }
+
+    public:
+      /// Alignment of every chunk (and the largest alignment served)
+      static const std::size_t chunkAlignment = 4096;
+
+      explicit ArenaResource(std::size_t _chunkBytes = std::size_t(4) << 20,
+                             MemoryResource& _upstream = defaultResource())
+            : upstream(_upstream),
+              chunkBytes(_chunkBytes),
+              used(0),
+              last(nullptr)
+      {
+      }
+
+      ~ArenaResource()
+      {
+        for (const Chunk& chunk : chunks)
+        {
+          upstream.deallocate(chunk.base, chunk.bytes);
+        }
+      }
+
+      ArenaResource(const ArenaResource&) = delete;
+      ArenaResource& operator=(const ArenaResource&) = delete;
+
+      void* allocate(std::size_t bytes, std::size_t alignment) override
+      {
+        if ( alignment > chunkAlignment )
+        {
+          throw std::bad_alloc();
+        }
+
+        // Bump within the current chunk, or start a new one big enough:
+        std::size_t offset = chunks.empty() ? 0 : (used + alignment - 1) & ~(alignment - 1);
+        if ( chunks.empty() || (offset > chunks.back().bytes) || (chunks.back().bytes - offset < bytes) )
+        {
+          addChunk(bytes);
+          offset = 0;
+        }
+
+        last = chunks.back().base + offset;
+        used = offset + bytes;
+        return last;
+      }
+
+      void deallocate(void* ptr, std::size_t bytes) override
+      {
+        // Only the newest allocation can be handed back early:
+        if ( (ptr != nullptr) && (ptr == last) && (last + bytes == chunks.back().base + used) )
+        {
+          used = std::size_t(last - chunks.back().base);
+          last = nullptr;
+        }
+      }
+
+      /// Make all memory reusable, keeping the largest chunk
+      void reset()
+      {
+        if ( chunks.empty() )
+        {
+          return;
+        }
+
+        std::vector<Chunk>::iterator keep = std::max_element(chunks.begin(), chunks.end(),
+          [](const Chunk& a, const Chunk& b) { return a.bytes < b.bytes; });
+        const Chunk kept = *keep;
+        for (std::vector<Chunk>::iterator it=chunks.begin(); it!=chunks.end(); ++it)
+        {
+          if ( it != keep )
+          {
+            upstream.deallocate(it->base, it->bytes);
+          }
+        }
+
+        chunks.assign(1, kept);
+        used = 0;
+        last = nullptr;
+      }
+
+      /// Bytes handed out since the last reset (ignoring alignment gaps)
+      std::size_t getBytesUsed() const
+      {
+        std::size_t total = used;
+        for (std::size_t i=0; i+1<chunks.size(); ++i)
+        {
+          total += chunks[i].bytes;
+        }
+        return total;
+      }
+
+      /// Bytes held from upstream
+      std::size_t getBytesReserved() const
+      {
+        std::size_t total = 0;
+        for (const Chunk& chunk : chunks)
+        {
+          total += chunk.bytes;
+        }
+        return total;
+      }
+  };
+
+
+  /// memoryImpl namespace (per-thread resource selection)
+  namespace memoryImpl
+  {
+
+    /// The calling thread's resource (null means defaultResource())
+    inline MemoryResource*& current()
+    {
+      static thread_local MemoryResource* resource = nullptr;
+      return resource;
+    }
+
+  } // memoryImpl namespace
+
+  /// Resource new buffers on this thread allocate from
+  inline MemoryResource& getMemoryResource()
+  {
+    MemoryResource* resource = memoryImpl::current();
+    return (resource != nullptr) ? *resource : defaultResource();
+  }
+
+  /// Memory Resource Scope class
+  ///
+  /// Makes a resource the calling thread's current one for the scope's
+  /// lifetime, then restores the previous one. Scopes nest. Only the calling
+  /// thread is affected: buffers allocated inside parallel kernels keep using
+  /// the workers' own resources.
+  class MemoryResourceScope
+  {
+    private:
+      MemoryResource* previous;
+
+    public:
+      explicit MemoryResourceScope(MemoryResource& resource) : previous(memoryImpl::current())
+      {
+        memoryImpl::current() = &resource;
+      }
+
+      ~MemoryResourceScope()
+      {
+        memoryImpl::current() = previous;
+      }
+
+      MemoryResourceScope(const MemoryResourceScope&) = delete;
+      MemoryResourceScope& operator=(const MemoryResourceScope&) = delete;
+  };
+
+} // matrix namespace
+
+#endif // MEMORY_RESOURCE_H
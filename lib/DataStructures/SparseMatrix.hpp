@@ -0,0 +1,1012 @@
+////////////////////////////////////////
+//
+//  File:
+//      \file SparseMatrix.hpp
+//
+//  Description:
+//      \brief Sparse Matrix: Header & Impl (CSR/CSC storage)
+//
+//  Author:
+//      \author J. Caleb Wherry
+//
+////////////////////////////////////////
+
+// Include Guards:
+#ifndef SPARSE_MATRIX_H
+#define SPARSE_MATRIX_H
+
+// Forward Declared Dependencies:
+//
+
+// Local Include Dependencies:
+#include "Matrix.hpp"
+#include "CpuFeatures.hpp"
+#include "MatrixSimd.hpp"
+#include "ThreadPool.hpp"
+
+// Compiler Include Dependencies:
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <utility>
+
+/// matrix Namespace
+namespace matrix
+{
+
+  /// Compressed storage layout of a SparseMatrix
+  enum SparseFormat
+  {
+    sparseCsr,    ///< Compressed Sparse Row: rows stored one after another (fast A*x)
+    sparseCsc     ///< Compressed Sparse Column: columns stored one after another (fast x^T*A)
+  };
+
+  /// One (row, col, value) entry used to assemble a SparseMatrix (COO format)
+  template <typename T>
+  struct Triplet
+  {
+    uint32_t row;     ///< Row index
+    uint32_t col;     ///< Column index
+    T value;          ///< Value (duplicates are summed)
+  };
+
+
+  /// sparseImpl namespace (kernel internals)
+  namespace sparseImpl
+  {
+
+    /// sum(val[p] * x[idx[p]]) for p in [0, n)
+    template <typename T>
+    T gatherDotScalar(const T* val, const uint32_t* idx, const T* x, std::size_t n)
+    {
+      // Two chains so consecutive multiply-adds don't wait on each other:
+      T s0 = T(0), s1 = T(0);
+      std::size_t p = 0;
+      for (; p+2<=n; p+=2)
+      {
+        s0 += val[p]*x[idx[p]];
+        s1 += val[p+1]*x[idx[p+1]];
+      }
+      if ( p < n )
+      {
+        s0 += val[p]*x[idx[p]];
+      }
+      return s0 + s1;
+    }
+
+#if MATRIX_X86_DISPATCH
+
+    // Indices are widened to 64 bits before gathering, so every uint32_t
+    //  column index is valid (a 32-bit gather would treat them as signed).
+
+    __attribute__((target("avx2,fma")))
+    inline double gatherDotAvx2(const double* val, const uint32_t* idx, const double* x, std::size_t n)
+    {
+      __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+      std::size_t p = 0;
+      for (; p+8<=n; p+=8)
+      {
+        const __m256i i0 = _mm256_cvtepu32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(idx + p)));
+        const __m256i i1 = _mm256_cvtepu32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(idx + p + 4)));
+        s0 = _mm256_fmadd_pd(_mm256_loadu_pd(val + p),     _mm256_i64gather_pd(x, i0, 8), s0);
+        s1 = _mm256_fmadd_pd(_mm256_loadu_pd(val + p + 4), _mm256_i64gather_pd(x, i1, 8), s1);
+      }
+
+      alignas(32) double lanes[4];
+      _mm256_store_pd(lanes, _mm256_add_pd(s0, s1));
+      return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + gatherDotScalar(val + p, idx + p, x, n - p);
+    }
+
+    __attribute__((target("avx2,fma")))
+    inline float gatherDotAvx2(const float* val, const uint32_t* idx, const float* x, std::size_t n)
+    {
+      __m256 s0 = _mm256_setzero_ps();
+      std::size_t p = 0;
+      for (; p+8<=n; p+=8)
+      {
+        const __m256i i0 = _mm256_cvtepu32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(idx + p)));
+        const __m256i i1 = _mm256_cvtepu32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(idx + p + 4)));
+        const __m256 gathered = _mm256_set_m128(_mm256_i64gather_ps(x, i1, 4), _mm256_i64gather_ps(x, i0, 4));
+        s0 = _mm256_fmadd_ps(_mm256_loadu_ps(val + p), gathered, s0);
+      }
+
+      alignas(32) float lanes[8];
+      _mm256_store_ps(lanes, s0);
+      return ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]))
+             + gatherDotScalar(val + p, idx + p, x, n - p);
+    }
+
+#endif // MATRIX_X86_DISPATCH
+
+    //
+    // Dispatchers:
+    //
+
+    /// sum(val[p] * x[idx[p]]) for p in [0, n)
+    template <typename T>
+    T gatherDot(const T* val, const uint32_t* idx, const T* x, std::size_t n)
+    {
+      return gatherDotScalar(val, idx, x, n);
+    }
+
+#if MATRIX_X86_DISPATCH
+
+    inline double gatherDot(const double* val, const uint32_t* idx, const double* x, std::size_t n)
+    {
+      return simd::useAvx2Fma() ? gatherDotAvx2(val, idx, x, n) : gatherDotScalar(val, idx, x, n);
+    }
+
+    inline float gatherDot(const float* val, const uint32_t* idx, const float* x, std::size_t n)
+    {
+      return simd::useAvx2Fma() ? gatherDotAvx2(val, idx, x, n) : gatherDotScalar(val, idx, x, n);
+    }
+
+#endif // MATRIX_X86_DISPATCH
+
+  } // sparseImpl namespace
+
+
+  /// Sparse Matrix class
+  ///
+  /// Only non-zero elements are stored. In CSR layout, row i's elements are
+  /// values[pointers[i] .. pointers[i+1]) with their columns in indices (sorted,
+  /// no duplicates); CSC is the same with the roles of rows and columns
+  /// swapped. Pointers are 64-bit so the element count isn't limited by the
+  /// 32-bit row/column indices.
+  template <typename T>
+  class SparseMatrix
+  {
+
+    private:
+      uint32_t numRows;                     ///< Number of rows
+      uint32_t numCols;                     ///< Number of columns
+      SparseFormat format;                  ///< CSR or CSC
+      std::vector<std::size_t> pointers;    ///< Start of each row (CSR) / column (CSC), plus the end
+      std::vector<uint32_t> indices;        ///< Column (CSR) / row (CSC) of each stored element
+      std::vector<T> values;                ///< Stored elements
+
+      // Compressed dimension (rows for CSR) and the other one:
+      uint32_t majorDim() const { return (format == sparseCsr) ? numRows : numCols; };
+      uint32_t minorDim() const { return (format == sparseCsr) ? numCols : numRows; };
+
+      /// Rows (CSR) / columns (CSC) per parallel task
+      std::size_t majorGrain() const { return getParallelThreshold()/(values.size()/(std::size_t(majorDim()) + 1) + 1) + 1; };
+
+      /// This matrix in format f: itself, or a converted copy kept in temp
+      const SparseMatrix<T>& inFormat(SparseFormat f, SparseMatrix<T>& temp) const;
+
+      /// Element-wise lhs OP rhs over the union of both patterns
+      template <int Op>
+      SparseMatrix<T> combine(const SparseMatrix<T>& rhs, const char* message) const;
+
+      /// Row-by-row product (Gustavson) of compressed arrays: c = a*b, where
+      ///  a's minor indices select b's majors
+      static void multiplyCompressed(const SparseMatrix<T>& a, const SparseMatrix<T>& b, SparseMatrix<T>& c);
+
+    public:
+
+
+      //
+      // Constructors:
+      //
+
+      /// Default Constructor (0x0)
+      SparseMatrix();
+
+      /// Empty Constructor (all zeros)
+      SparseMatrix (
+        uint32_t _numRows,                  ///< Number of rows new matrix will have.
+        uint32_t _numCols,                  ///< Number of columns new matrix will have.
+        SparseFormat _format = sparseCsr    ///< Storage layout.
+      );
+
+      /// Triplet (COO) Constructor: entries in any order, duplicates summed
+      SparseMatrix (
+        uint32_t _numRows,                          ///< Number of rows new matrix will have.
+        uint32_t _numCols,                          ///< Number of columns new matrix will have.
+        const std::vector<Triplet<T>>& entries,     ///< Non-zero elements.
+        SparseFormat _format = sparseCsr            ///< Storage layout.
+      );
+
+      /// Compressed Arrays Constructor (takes the arrays, checks them)
+      SparseMatrix (
+        uint32_t _numRows,                    ///< Number of rows new matrix will have.
+        uint32_t _numCols,                    ///< Number of columns new matrix will have.
+        SparseFormat _format,                 ///< Layout of the arrays.
+        std::vector<std::size_t> _pointers,   ///< Row (CSR) / column (CSC) starts, major+1 entries.
+        std::vector<uint32_t> _indices,       ///< Minor indices, increasing within each row/column.
+        std::vector<T> _values                ///< Stored elements.
+      );
+
+      /// Dense Constructor (zeros are dropped)
+      explicit SparseMatrix (
+        const Matrix<T>& dense,               ///< Matrix to compress.
+        SparseFormat _format = sparseCsr      ///< Storage layout.
+      );
+
+
+      //
+      // Accessors:
+      //
+
+      uint32_t getNumRows() const { return numRows; };                          ///< Row accessor
+      uint32_t getNumCols() const { return numCols; };                          ///< Columns accessor
+      std::size_t getNonZeros() const { return values.size(); };                ///< Stored element count
+      SparseFormat getFormat() const { return format; };                        ///< Layout accessor
+      const std::vector<std::size_t>& getPointers() const { return pointers; }; ///< Row/column starts
+      const std::vector<uint32_t>& getIndices() const { return indices; };      ///< Minor indices
+      const std::vector<T>& getValues() const { return values; };               ///< Stored elements
+
+
+      //
+      // Operators:
+      //
+
+      /// Display (one "(row, col) value" line per stored element)
+      template <typename U>
+      friend std::ostream& operator<< (
+        std::ostream& os,                   ///< Output stream
+        const SparseMatrix<U>& rhs          ///< Matrix to output
+      );
+
+      // Sparse/Sparse
+      SparseMatrix<T> operator+(const SparseMatrix<T>& rhs) const;    ///< Sparse/Sparse Addition
+      SparseMatrix<T> operator-(const SparseMatrix<T>& rhs) const;    ///< Sparse/Sparse Subtraction
+      SparseMatrix<T> operator*(const SparseMatrix<T>& rhs) const;    ///< Sparse/Sparse Multiplication
+
+      // Sparse/Dense
+      Matrix<T> operator*(const Matrix<T>& rhs) const;                ///< Sparse/Matrix Multiplication (SpMM)
+      std::vector<T> operator*(const std::vector<T>& rhs) const;      ///< Sparse/Vector Multiplication (SpMV)
+
+      // Sparse/Scalar
+      SparseMatrix<T> operator*(const T& rhs) const;                  ///< Sparse/Scalar Multiplication
+
+      // Element Access (read only; unstored elements are zero)
+      T operator()(const uint32_t& row, const uint32_t& col) const;   ///< Sparse Element Access
+
+      // Comparison
+      bool operator==(const SparseMatrix<T>& rhs) const;              ///< Same stored elements?
+
+
+      //
+      // Operations:
+      //
+
+      /// y = A*x into caller storage (x: getNumCols() elements, y: getNumRows())
+      void multiply(const T* x, T* y) const;
+
+      SparseMatrix<T> toFormat(SparseFormat _format) const;   ///< Same matrix in another layout
+      SparseMatrix<T> transpose() const;                      ///< Transpose (same arrays, other layout)
+      Matrix<T> toDense() const;                              ///< Dense copy
+
+  }; // SparseMatrix class
+
+  /// Matrix/Sparse Multiplication
+  template <typename T>
+  Matrix<T> operator*(const Matrix<T>& lhs, const SparseMatrix<T>& rhs);
+
+
+  //
+  // Template Implementation
+  //
+
+
+  // Default constructor
+  template <typename T>
+  SparseMatrix<T>::SparseMatrix()
+        : numRows(0),
+          numCols(0),
+          format(sparseCsr),
+          pointers(1, 0)
+  {
+    // Nothing stored.
+  }
+
+  // Empty constructor
+  template <typename T>
+  SparseMatrix<T>::SparseMatrix(uint32_t _numRows, uint32_t _numCols, SparseFormat _format)
+        : numRows(_numRows),
+          numCols(_numCols),
+          format(_format),
+          pointers(std::size_t(majorDim()) + 1, 0)
+  {
+    // Nothing stored.
+  }
+
+  // Triplet constructor
+  template <typename T>
+  SparseMatrix<T>::SparseMatrix(uint32_t _numRows, uint32_t _numCols, const std::vector<Triplet<T>>& entries, SparseFormat _format)
+        : numRows(_numRows),
+          numCols(_numCols),
+          format(_format),
+          pointers(std::size_t(majorDim()) + 1, 0)
+  {
+    const bool csr = (format == sparseCsr);
+    const std::size_t major = majorDim();
+
+    // Count the entries of each row (CSR) / column (CSC):
+    for (const auto& e : entries)
+    {
+      if ( (e.row >= numRows) || (e.col >= numCols) )
+      {
+        throw std::out_of_range("SparseMatrix::SparseMatrix (triplets) - Indices out of bounds!");
+      }
+      ++pointers[(csr ? e.row : e.col) + 1];
+    }
+    for (std::size_t i=0; i<major; ++i)
+    {
+      pointers[i+1] += pointers[i];
+    }
+
+    // Bucket them (counting sort on the major index, input order kept):
+    std::vector<std::pair<uint32_t, T>> bucketed(entries.size());
+    {
+      std::vector<std::size_t> next(pointers.begin(), pointers.end() - 1);
+      for (const auto& e : entries)
+      {
+        bucketed[next[csr ? e.row : e.col]++] = std::make_pair(csr ? e.col : e.row, e.value);
+      }
+    }
+
+    // Sort each bucket by minor index and count the distinct ones:
+    const std::size_t grain = getParallelThreshold()/(entries.size()/(major + 1) + 1) + 1;
+    std::vector<std::size_t> counts(major + 1, 0);
+    parallelFor(0, major, [&](std::size_t lo, std::size_t hi) {
+      for (std::size_t i=lo; i<hi; ++i)
+      {
+        auto first = bucketed.begin() + pointers[i];
+        auto last = bucketed.begin() + pointers[i+1];
+        std::stable_sort(first, last, [](const std::pair<uint32_t, T>& x, const std::pair<uint32_t, T>& y) {
+          return x.first < y.first;
+        });
+
+        std::size_t distinct = 0;
+        for (auto it=first; it!=last; ++it)
+        {
+          if ( (it == first) || (it->first != (it - 1)->first) )
+          {
+            ++distinct;
+          }
+        }
+        counts[i+1] = distinct;
+      }
+    }, grain);
+
+    for (std::size_t i=0; i<major; ++i)
+    {
+      counts[i+1] += counts[i];
+    }
+
+    // Compact, summing duplicates in input order:
+    indices.resize(counts[major]);
+    values.resize(counts[major]);
+    parallelFor(0, major, [&](std::size_t lo, std::size_t hi) {
+      for (std::size_t i=lo; i<hi; ++i)
+      {
+        std::size_t out = counts[i];
+        for (std::size_t p=pointers[i]; p<pointers[i+1]; ++p)
+        {
+          if ( (p == pointers[i]) || (bucketed[p].first != bucketed[p-1].first) )
+          {
+            indices[out] = bucketed[p].first;
+            values[out] = bucketed[p].second;
+            ++out;
+          }
+          else
+          {
+            values[out-1] += bucketed[p].second;
+          }
+        }
+      }
+    }, grain);
+
+    pointers.swap(counts);
+  }
+
+  // Compressed arrays constructor
+  template <typename T>
+  SparseMatrix<T>::SparseMatrix(uint32_t _numRows, uint32_t _numCols, SparseFormat _format,
+                                std::vector<std::size_t> _pointers, std::vector<uint32_t> _indices, std::vector<T> _values)
+        : numRows(_numRows),
+          numCols(_numCols),
+          format(_format),
+          pointers(std::move(_pointers)),
+          indices(std::move(_indices)),
+          values(std::move(_values))
+  {
+    const std::size_t major = majorDim();
+    const std::size_t nnz = values.size();
+
+    if ( (pointers.size() != major + 1) ||
+         (pointers[0] != 0) ||
+         (pointers[major] != nnz) ||
+         (indices.size() != nnz)
+       )
+    {
+      throw std::logic_error("SparseMatrix::SparseMatrix (arrays) - Array sizes are inconsistent!");
+    }
+
+    const uint32_t minor = minorDim();
+    bool valid = parallelAll(0, major, [&](std::size_t lo, std::size_t hi) {
+      for (std::size_t i=lo; i<hi; ++i)
+      {
+        if ( (pointers[i] > pointers[i+1]) || (pointers[i+1] > nnz) )
+        {
+          return false;
+        }
+        for (std::size_t p=pointers[i]; p<pointers[i+1]; ++p)
+        {
+          if ( (indices[p] >= minor) || ((p > pointers[i]) && (indices[p-1] >= indices[p])) )
+          {
+            return false;
+          }
+        }
+      }
+      return true;
+    }, majorGrain());
+
+    if ( !valid )
+    {
+      throw std::logic_error("SparseMatrix::SparseMatrix (arrays) - Indices must be in range and increasing within each row/column!");
+    }
+  }
+
+  // Dense constructor
+  template <typename T>
+  SparseMatrix<T>::SparseMatrix(const Matrix<T>& dense, SparseFormat _format)
+        : numRows(dense.getNumRows()),
+          numCols(dense.getNumCols()),
+          format(sparseCsr),
+          pointers(std::size_t(numRows) + 1, 0)
+  {
+    const T* a = dense.data();
+    const std::size_t ld = dense.getLeadingDim();
+    const std::size_t grain = getParallelThreshold()/(std::size_t(numCols) + 1) + 1;
+
+    // Count the non-zeros of each row, then fill each row's slice:
+    parallelFor(0, numRows, [&](std::size_t lo, std::size_t hi) {
+      for (std::size_t i=lo; i<hi; ++i)
+      {
+        std::size_t count = 0;
+        for (uint32_t j=0; j<numCols; ++j)
+        {
+          count += (a[i*ld + j] != T(0)) ? 1 : 0;
+        }
+        pointers[i+1] = count;
+      }
+    }, grain);
+
+    for (uint32_t i=0; i<numRows; ++i)
+    {
+      pointers[i+1] += pointers[i];
+    }
+
+    indices.resize(pointers[numRows]);
+    values.resize(pointers[numRows]);
+    parallelFor(0, numRows, [&](std::size_t lo, std::size_t hi) {
+      for (std::size_t i=lo; i<hi; ++i)
+      {
+        std::size_t out = pointers[i];
+        for (uint32_t j=0; j<numCols; ++j)
+        {
+          if ( a[i*ld + j] != T(0) )
+          {
+            indices[out] = j;
+            values[out] = a[i*ld + j];
+            ++out;
+          }
+        }
+      }
+    }, grain);
+
+    if ( _format != sparseCsr )
+    {
+      *this = this->toFormat(_format);
+    }
+  }
+
+  // Operator <<
+  template <typename T>
+  std::ostream& operator<<(std::ostream& os, const SparseMatrix<T>& rhs)
+  {
+    const bool csr = (rhs.format == sparseCsr);
+
+    // Iterate through and print out each stored element (one flush at the end, not per line):
+    for (uint32_t i=0; i<rhs.majorDim(); ++i)
+    {
+      for (std::size_t p=rhs.pointers[i]; p<rhs.pointers[i+1]; ++p)
+      {
+        os << "(" << (csr ? i : rhs.indices[p]) << ", " << (csr ? rhs.indices[p] : i) << ") "
+           << rhs.values[p] << '\n';
+      }
+    }
+
+    return os << std::flush;
+  }
+
+  // inFormat
+  template <typename T>
+  const SparseMatrix<T>& SparseMatrix<T>::inFormat(SparseFormat f, SparseMatrix<T>& temp) const
+  {
+    if ( format == f )
+    {
+      return *this;
+    }
+
+    temp = this->toFormat(f);
+    return temp;
+  }
+
+  // combine
+  template <typename T>
+  template <int Op>
+  SparseMatrix<T> SparseMatrix<T>::combine(const SparseMatrix<T>& rhs, const char* message) const
+  {
+    // Matrices must be the same size:
+    if ( (numRows != rhs.numRows) || (numCols != rhs.numCols) )
+    {
+      throw std::logic_error(message);
+    }
+
+    SparseMatrix<T> temp;
+    const SparseMatrix<T>& b = rhs.inFormat(format, temp);
+    const std::size_t major = majorDim();
+    SparseMatrix<T> result(numRows, numCols, format);
+
+    // Merge each pair of sorted rows twice: once to size it, once to fill it:
+    auto merge = [&](std::size_t i, bool fill) {
+      std::size_t pa = pointers[i], pb = b.pointers[i], out = result.pointers[i];
+      const std::size_t ea = pointers[i+1], eb = b.pointers[i+1];
+      std::size_t count = 0;
+
+      while ( (pa < ea) || (pb < eb) )
+      {
+        uint32_t col;
+        T value;
+        if ( (pb == eb) || ((pa < ea) && (indices[pa] < b.indices[pb])) )
+        {
+          col = indices[pa];
+          value = values[pa++];
+        }
+        else if ( (pa == ea) || (b.indices[pb] < indices[pa]) )
+        {
+          col = b.indices[pb];
+          value = simd::apply<Op>(T(0), b.values[pb++]);
+        }
+        else
+        {
+          col = indices[pa];
+          value = simd::apply<Op>(values[pa++], b.values[pb++]);
+        }
+
+        if ( fill )
+        {
+          result.indices[out] = col;
+          result.values[out] = value;
+          ++out;
+        }
+        ++count;
+      }
+
+      return count;
+    };
+
+    const std::size_t grain = majorGrain();
+    parallelFor(0, major, [&](std::size_t lo, std::size_t hi) {
+      for (std::size_t i=lo; i<hi; ++i)
+      {
+        result.pointers[i+1] = merge(i, false);
+      }
+    }, grain);
+
+    for (std::size_t i=0; i<major; ++i)
+    {
+      result.pointers[i+1] += result.pointers[i];
+    }
+
+    result.indices.resize(result.pointers[major]);
+    result.values.resize(result.pointers[major]);
+    parallelFor(0, major, [&](std::size_t lo, std::size_t hi) {
+      for (std::size_t i=lo; i<hi; ++i)
+      {
+        merge(i, true);
+      }
+    }, grain);
+
+    return result;
+  }
+
+  // Operator + (Sparse/Sparse)
+  template <typename T>
+  SparseMatrix<T> SparseMatrix<T>::operator+(const SparseMatrix<T>& rhs) const
+  {
+    return this->combine<simd::opAdd>(rhs, "SparseMatrix::operator+ (Sparse/Sparse) - Matrices must be the same size!");
+  }
+
+  // Operator - (Sparse/Sparse)
+  template <typename T>
+  SparseMatrix<T> SparseMatrix<T>::operator-(const SparseMatrix<T>& rhs) const
+  {
+    return this->combine<simd::opSub>(rhs, "SparseMatrix::operator- (Sparse/Sparse) - Matrices must be the same size!");
+  }
+
+  // multiplyCompressed
+  template <typename T>
+  void SparseMatrix<T>::multiplyCompressed(const SparseMatrix<T>& a, const SparseMatrix<T>& b, SparseMatrix<T>& c)
+  {
+    const std::size_t major = a.majorDim();
+    const std::size_t minor = b.minorDim();
+    const std::size_t tasks = parallelTasks(major, a.majorGrain());
+
+    // Each task builds its band of rows in local arrays, using a dense
+    //  accumulator indexed by column plus a marker of the row that last
+    //  touched each column:
+    std::vector<std::vector<uint32_t>> bandIndices(tasks);
+    std::vector<std::vector<T>> bandValues(tasks);
+    std::vector<std::size_t> counts(major + 1, 0);
+
+    auto band = [&](std::size_t task) {
+      const std::size_t lo = major*task/tasks, hi = major*(task + 1)/tasks;
+      std::vector<std::size_t> marker(minor, std::size_t(-1));
+      std::vector<T> accumulator(minor);
+      std::vector<uint32_t>& idx = bandIndices[task];
+      std::vector<T>& val = bandValues[task];
+
+      for (std::size_t i=lo; i<hi; ++i)
+      {
+        const std::size_t rowStart = idx.size();
+
+        for (std::size_t pa=a.pointers[i]; pa<a.pointers[i+1]; ++pa)
+        {
+          const uint32_t k = a.indices[pa];
+          const T av = a.values[pa];
+          for (std::size_t pb=b.pointers[k]; pb<b.pointers[k+1]; ++pb)
+          {
+            const uint32_t j = b.indices[pb];
+            if ( marker[j] != i )
+            {
+              marker[j] = i;
+              accumulator[j] = av*b.values[pb];
+              idx.push_back(j);
+            }
+            else
+            {
+              accumulator[j] += av*b.values[pb];
+            }
+          }
+        }
+
+        std::sort(idx.begin() + rowStart, idx.end());
+        for (std::size_t p=rowStart; p<idx.size(); ++p)
+        {
+          val.push_back(accumulator[idx[p]]);
+        }
+        counts[i+1] = idx.size() - rowStart;
+      }
+    };
+
+    if ( tasks == 1 )
+    {
+      band(0);
+    }
+    else
+    {
+      threadPool().run(tasks, band);
+    }
+
+    // Stitch the bands together:
+    for (std::size_t i=0; i<major; ++i)
+    {
+      counts[i+1] += counts[i];
+    }
+    c.pointers.swap(counts);
+    c.indices.resize(c.pointers[major]);
+    c.values.resize(c.pointers[major]);
+
+    auto copyBand = [&](std::size_t task) {
+      const std::size_t offset = c.pointers[major*task/tasks];
+      std::copy(bandIndices[task].begin(), bandIndices[task].end(), c.indices.begin() + offset);
+      std::copy(bandValues[task].begin(), bandValues[task].end(), c.values.begin() + offset);
+    };
+
+    if ( tasks == 1 )
+    {
+      copyBand(0);
+    }
+    else
+    {
+      threadPool().run(tasks, copyBand);
+    }
+  }
+
+  // Operator * (Sparse/Sparse)
+  template <typename T>
+  SparseMatrix<T> SparseMatrix<T>::operator*(const SparseMatrix<T>& rhs) const
+  {
+    // If lhs col count doesn match rhs's row count, can't multiply:
+    if ( numCols != rhs.numRows )
+    {
+      throw std::logic_error("SparseMatrix::operator* (Sparse/Sparse) - Matrices' inner dimensions do not match, can not multiply them!");
+    }
+
+    SparseMatrix<T> temp;
+    const SparseMatrix<T>& b = rhs.inFormat(format, temp);
+    SparseMatrix<T> result(numRows, rhs.numCols, format);
+
+    // CSR: rows of A times B. CSC: the CSC arrays of B and A are the CSR
+    //  arrays of B^T and A^T, and C^T = B^T*A^T, so the same kernel applies:
+    if ( format == sparseCsr )
+    {
+      multiplyCompressed(*this, b, result);
+    }
+    else
+    {
+      multiplyCompressed(b, *this, result);
+    }
+
+    return result;
+  }
+
+  // Operator * (Sparse/Matrix)
+  template <typename T>
+  Matrix<T> SparseMatrix<T>::operator*(const Matrix<T>& rhs) const
+  {
+    // If lhs col count doesn match rhs's row count, can't multiply:
+    if ( numCols != rhs.getNumRows() )
+    {
+      throw std::logic_error("SparseMatrix::operator* (Sparse/Matrix) - Matrices' inner dimensions do not match, can not multiply them!");
+    }
+
+    SparseMatrix<T> temp;
+    const SparseMatrix<T>& a = this->inFormat(sparseCsr, temp);
+    Matrix<T> result(numRows, rhs.getNumCols(), T(0));
+
+    // Row i of the result is a combination of the rows of rhs picked by row i:
+    const T* b = rhs.data();
+    T* c = result.data();
+    const std::size_t ldB = rhs.getLeadingDim(), ldC = result.getLeadingDim(), n = rhs.getNumCols();
+    parallelFor(0, numRows, [&](std::size_t lo, std::size_t hi) {
+      for (std::size_t i=lo; i<hi; ++i)
+      {
+        for (std::size_t p=a.pointers[i]; p<a.pointers[i+1]; ++p)
+        {
+          simdAxpy(a.values[p], b + a.indices[p]*ldB, c + i*ldC, n);
+        }
+      }
+    }, getParallelThreshold()/((a.values.size()/(std::size_t(numRows) + 1) + 1)*(n + 1)) + 1);
+
+    return result;
+  }
+
+  // Operator * (Sparse/Vector)
+  template <typename T>
+  std::vector<T> SparseMatrix<T>::operator*(const std::vector<T>& rhs) const
+  {
+    // Vector length must match the column count:
+    if ( rhs.size() != numCols )
+    {
+      throw std::logic_error("SparseMatrix::operator* (Sparse/Vector) - Vector length does not match the number of columns!");
+    }
+
+    std::vector<T> result(numRows);
+    this->multiply(rhs.data(), result.data());
+    return result;
+  }
+
+  // multiply
+  template <typename T>
+  void SparseMatrix<T>::multiply(const T* x, T* y) const
+  {
+    if ( format == sparseCsr )
+    {
+      // One gathered dot product per row, rows in parallel:
+      parallelFor(0, numRows, [&](std::size_t lo, std::size_t hi) {
+        for (std::size_t i=lo; i<hi; ++i)
+        {
+          const std::size_t p = pointers[i];
+          y[i] = sparseImpl::gatherDot(values.data() + p, indices.data() + p, x, pointers[i+1] - p);
+        }
+      }, majorGrain());
+      return;
+    }
+
+    // CSC scatters each column into y, so it runs serially (convert to CSR
+    //  first when the same matrix is applied many times):
+    std::fill(y, y + numRows, T(0));
+    for (uint32_t j=0; j<numCols; ++j)
+    {
+      const T xj = x[j];
+      for (std::size_t p=pointers[j]; p<pointers[j+1]; ++p)
+      {
+        y[indices[p]] += values[p]*xj;
+      }
+    }
+  }
+
+  // Operator * (Sparse/Scalar)
+  template <typename T>
+  SparseMatrix<T> SparseMatrix<T>::operator*(const T& rhs) const
+  {
+    SparseMatrix<T> result = *this;
+
+    T* v = result.values.data();
+    parallelFor(0, result.values.size(), [=](std::size_t lo, std::size_t hi) {
+      simdMultiplyScalar(v + lo, rhs, v + lo, hi - lo);
+    });
+
+    return result;
+  }
+
+  // Operator ()
+  template <typename T>
+  T SparseMatrix<T>::operator()(const uint32_t& row, const uint32_t& col) const
+  {
+    // Check range:
+    if ( (row >= numRows) ||
+         (col >= numCols)
+       )
+    {
+      throw std::out_of_range("SparseMatrix::operator() - Indices out of bounds!");
+    }
+
+    // Binary search the row (CSR) / column (CSC):
+    const uint32_t major = (format == sparseCsr) ? row : col;
+    const uint32_t minor = (format == sparseCsr) ? col : row;
+    auto first = indices.begin() + pointers[major];
+    auto last = indices.begin() + pointers[major+1];
+    auto it = std::lower_bound(first, last, minor);
+
+    return ( (it != last) && (*it == minor) ) ? values[it - indices.begin()] : T(0);
+  }
+
+  // Operator ==
+  template <typename T>
+  bool SparseMatrix<T>::operator==(const SparseMatrix<T>& rhs) const
+  {
+    // If dimensions do not match, they are not equal:
+    if ( (numRows != rhs.numRows) || (numCols != rhs.numCols) )
+    {
+      return false;
+    }
+
+    SparseMatrix<T> temp;
+    const SparseMatrix<T>& b = rhs.inFormat(format, temp);
+    return (pointers == b.pointers) && (indices == b.indices) && (values == b.values);
+  }
+
+  // toFormat
+  template <typename T>
+  SparseMatrix<T> SparseMatrix<T>::toFormat(SparseFormat _format) const
+  {
+    if ( _format == format )
+    {
+      return *this;
+    }
+
+    SparseMatrix<T> result(numRows, numCols, _format);
+    const std::size_t major = majorDim(), minor = minorDim();
+
+    // Counting sort on the minor index; walking the majors in order leaves
+    //  every new row/column sorted:
+    for (std::size_t p=0; p<indices.size(); ++p)
+    {
+      ++result.pointers[indices[p] + 1];
+    }
+    for (std::size_t j=0; j<minor; ++j)
+    {
+      result.pointers[j+1] += result.pointers[j];
+    }
+
+    result.indices.resize(values.size());
+    result.values.resize(values.size());
+    std::vector<std::size_t> next(result.pointers.begin(), result.pointers.end() - 1);
+    for (std::size_t i=0; i<major; ++i)
+    {
+      for (std::size_t p=pointers[i]; p<pointers[i+1]; ++p)
+      {
+        const std::size_t out = next[indices[p]]++;
+        result.indices[out] = uint32_t(i);
+        result.values[out] = values[p];
+      }
+    }
+
+    return result;
+  }
+
+  // transpose
+  template <typename T>
+  SparseMatrix<T> SparseMatrix<T>::transpose() const
+  {
+    // The CSR arrays of A are the CSC arrays of A^T (and vice versa):
+    SparseMatrix<T> result = *this;
+    std::swap(result.numRows, result.numCols);
+    result.format = (format == sparseCsr) ? sparseCsc : sparseCsr;
+
+    return result;
+  }
+
+  // toDense
+  template <typename T>
+  Matrix<T> SparseMatrix<T>::toDense() const
+  {
+    Matrix<T> result(numRows, numCols, T(0));
+
+    T* d = result.data();
+    const std::size_t ld = result.getLeadingDim();
+    const bool csr = (format == sparseCsr);
+    parallelFor(0, majorDim(), [&](std::size_t lo, std::size_t hi) {
+      for (std::size_t i=lo; i<hi; ++i)
+      {
+        for (std::size_t p=pointers[i]; p<pointers[i+1]; ++p)
+        {
+          d[csr ? (i*ld + indices[p]) : (indices[p]*ld + i)] = values[p];
+        }
+      }
+    }, majorGrain());
+
+    return result;
+  }
+
+  // Operator * (Matrix/Sparse)
+  template <typename T>
+  Matrix<T> operator*(const Matrix<T>& lhs, const SparseMatrix<T>& rhs)
+  {
+    // If lhs col count doesn match rhs's row count, can't multiply:
+    if ( lhs.getNumCols() != rhs.getNumRows() )
+    {
+      throw std::logic_error("SparseMatrix::operator* (Matrix/Sparse) - Matrices' inner dimensions do not match, can not multiply them!");
+    }
+
+    const uint32_t m = lhs.getNumRows(), n = rhs.getNumCols();
+    Matrix<T> result(m, n, T(0));
+
+    const T* a = lhs.data();
+    T* c = result.data();
+    const std::size_t ldA = lhs.getLeadingDim(), ldC = result.getLeadingDim();
+    const std::vector<std::size_t>& ptr = rhs.getPointers();
+    const std::vector<uint32_t>& idx = rhs.getIndices();
+    const std::vector<T>& val = rhs.getValues();
+    const std::size_t work = (rhs.getNonZeros() + 1)*2;
+
+    parallelFor(0, m, [&](std::size_t lo, std::size_t hi) {
+      for (std::size_t i=lo; i<hi; ++i)
+      {
+        const T* aRow = a + i*ldA;
+        T* cRow = c + i*ldC;
+
+        if ( rhs.getFormat() == sparseCsc )
+        {
+          // c(i,j) = row i of lhs dotted with column j of rhs:
+          for (uint32_t j=0; j<n; ++j)
+          {
+            cRow[j] = sparseImpl::gatherDot(val.data() + ptr[j], idx.data() + ptr[j], aRow, ptr[j+1] - ptr[j]);
+          }
+        }
+        else
+        {
+          // Row i of c is a combination of the rows of rhs:
+          for (uint32_t k=0; k<lhs.getNumCols(); ++k)
+          {
+            const T aik = aRow[k];
+            if ( aik == T(0) )
+            {
+              continue;
+            }
+            for (std::size_t p=ptr[k]; p<ptr[k+1]; ++p)
+            {
+              cRow[idx[p]] += aik*val[p];
+            }
+          }
+        }
+      }
+    }, getParallelThreshold()/work + 1);
+
+    return result;
+  }
+
+} // matrix namespace
+
+#endif // SPARSE_MATRIX_H
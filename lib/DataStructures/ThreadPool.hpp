@@ -0,0 +1,423 @@
+////////////////////////////////////////
+//
+//  File:
+//      \file ThreadPool.hpp
+//
+//  Description:
+//      \brief Thread Pool: Persistent workers and parallel loops for Matrix
+//
+//  Author:
+//      \author J. Caleb Wherry
+//
+////////////////////////////////////////
+
+// Include Guards:
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+// Forward Declared Dependencies:
+//
+
+// Local Include Dependencies:
+//
+
+// Compiler Include Dependencies:
+#include <cstddef>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+#include <functional>
+
+/// matrix Namespace
+namespace matrix
+{
+
+  /// Thread Pool class
+  ///
+  /// Workers are started once and sleep between jobs. A job is a number of
+  /// independent tasks; the calling thread works on them too and run() returns
+  /// when all of them are finished. Jobs submitted from inside a task, or from
+  /// another thread while the pool is busy, run serially on the submitting
+  /// thread, so nested or concurrent callers can't deadlock or share a job.
+  class ThreadPool
+  {
+
+    private:
+      std::vector<std::thread> workers;                 ///< Worker threads
+      std::mutex mutex;                                 ///< Guards the job state
+      std::mutex runMutex;                              ///< Held by the thread that owns the current job
+      std::condition_variable wake;                     ///< Signals a new job (or shutdown)
+      std::condition_variable finished;                 ///< Signals job completion
+      const std::function<void(std::size_t)>* job;      ///< Current job
+      std::size_t numTasks;                             ///< Tasks in current job
+      std::atomic<std::size_t> nextTask;                ///< Next unclaimed task
+      std::size_t remainingTasks;                       ///< Tasks not yet finished
+      std::size_t activeWorkers;                        ///< Workers inside the current job
+      std::size_t generation;                           ///< Job counter
+      bool stopping;                                    ///< Shutdown flag
+      std::exception_ptr error;                         ///< First exception thrown by a task
+
+      /// Thread-local flag: is this thread executing a task?
+      static bool& inTask()
+      {
+        static thread_local bool flag = false;
+        return flag;
+      }
+
+      /// Claim and execute tasks until none are left
+      void work(const std::function<void(std::size_t)>& fn)
+      {
+        bool wasInTask = inTask();
+        inTask() = true;
+
+        std::size_t done = 0;
+        for (std::size_t task = nextTask++; task < numTasks; task = nextTask++)
+        {
+          try
+          {
+            fn(task);
+          }
+          catch (...)
+          {
+            std::lock_guard<std::mutex> lock(mutex);
+            if ( !error )
+            {
+              error = std::current_exception();
+            }
+          }
+          ++done;
+        }
+
+        inTask() = wasInTask;
+
+        if ( done > 0 )
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          remainingTasks -= done;
+          if ( remainingTasks == 0 )
+          {
+            finished.notify_all();
+          }
+        }
+      }
+
+      /// Worker thread main loop
+      void workerLoop()
+      {
+        std::size_t seen = 0;
+
+        for (;;)
+        {
+          const std::function<void(std::size_t)>* fn;
+          {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&]() { return stopping || (generation != seen && job != nullptr); });
+            if ( stopping )
+            {
+              return;
+            }
+            seen = generation;
+            fn = job;
+            ++activeWorkers;
+          }
+
+          work(*fn);
+
+          {
+            std::lock_guard<std::mutex> lock(mutex);
+            --activeWorkers;
+            if ( activeWorkers == 0 )
+            {
+              finished.notify_all();
+            }
+          }
+        }
+      }
+
+    public:
+
+      /// Constructor
+      explicit ThreadPool(
+        std::size_t numThreads    ///< Total threads, including the caller (>= 1)
+      )
+        : job(nullptr),
+          numTasks(0),
+          nextTask(0),
+          remainingTasks(0),
+          activeWorkers(0),
+          generation(0),
+          stopping(false)
+      {
+        for (std::size_t i=1; i<numThreads; ++i)
+        {
+          workers.push_back(std::thread(&ThreadPool::workerLoop, this));
+        }
+      }
+
+      /// Deconstructor
+      ~ThreadPool()
+      {
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          stopping = true;
+        }
+        wake.notify_all();
+
+        for (auto& worker : workers)
+        {
+          worker.join();
+        }
+      }
+
+      /// Total threads working on a job (workers + caller)
+      std::size_t size() const { return workers.size() + 1; };
+
+      /// Is the calling thread inside a pool task?
+      static bool insideTask() { return inTask(); };
+
+      /// Run fn(0) ... fn(tasks-1) across the pool and wait for all of them
+      void run(std::size_t tasks, const std::function<void(std::size_t)>& fn)
+      {
+        // Serial when there is nothing to share, we're already in a task, or
+        //  another thread owns the pool (there is only one job slot):
+        std::unique_lock<std::mutex> owner(runMutex, std::defer_lock);
+        if ( (tasks <= 1) || workers.empty() || inTask() || !owner.try_lock() )
+        {
+          for (std::size_t task=0; task<tasks; ++task)
+          {
+            fn(task);
+          }
+          return;
+        }
+
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          job = &fn;
+          numTasks = tasks;
+          nextTask = 0;
+          remainingTasks = tasks;
+          error = nullptr;
+          ++generation;
+        }
+        wake.notify_all();
+
+        work(fn);
+
+        // Wait for the tasks and for every worker to leave the job, so none
+        //  of them can pick up the next job's counter with this job's function:
+        std::exception_ptr failure;
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          finished.wait(lock, [&]() { return (remainingTasks == 0) && (activeWorkers == 0); });
+          job = nullptr;
+          failure = error;
+          error = nullptr;
+        }
+
+        if ( failure )
+        {
+          std::rethrow_exception(failure);
+        }
+      }
+
+  }; // ThreadPool class
+
+
+  /// parallel namespace (configuration internals)
+  namespace parallel
+  {
+
+    /// Execution settings shared by all Matrix operations
+    struct Config
+    {
+      std::size_t numThreads;             ///< Threads used by Matrix operations
+      std::size_t elementThreshold;       ///< Minimum elements per task (element-wise ops, reductions)
+      std::size_t gemmThreshold;          ///< Minimum multiply-adds (m*n*k) before GEMM goes parallel
+      std::unique_ptr<ThreadPool> pool;   ///< Pool sized to numThreads (created on first use)
+      std::mutex poolMutex;               ///< Guards lazy pool creation
+    };
+
+    /// Process-wide configuration
+    inline Config& config()
+    {
+      static Config cfg = { std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1,
+                            std::size_t(1) << 16,
+                            std::size_t(1) << 21,
+                            std::unique_ptr<ThreadPool>(),
+                            {} };
+      return cfg;
+    }
+
+  } // parallel namespace
+
+  /// Threads used by Matrix operations
+  inline std::size_t getNumThreads()
+  {
+    return parallel::config().numThreads;
+  }
+
+  /// Set the threads used by Matrix operations (1 = serial; not while an operation is running)
+  inline void setNumThreads(std::size_t numThreads)
+  {
+    parallel::Config& cfg = parallel::config();
+    std::lock_guard<std::mutex> lock(cfg.poolMutex);
+    cfg.numThreads = (numThreads == 0) ? 1 : numThreads;
+    cfg.pool.reset();
+  }
+
+  /// Minimum elements per task below which element-wise ops and reductions stay serial
+  inline std::size_t getParallelThreshold()
+  {
+    return parallel::config().elementThreshold;
+  }
+
+  /// Set the element-wise cutoff
+  inline void setParallelThreshold(std::size_t elements)
+  {
+    parallel::config().elementThreshold = (elements == 0) ? 1 : elements;
+  }
+
+  /// Minimum multiply-adds (m*n*k) below which GEMM stays serial
+  inline std::size_t getGemmParallelThreshold()
+  {
+    return parallel::config().gemmThreshold;
+  }
+
+  /// Set the GEMM cutoff
+  inline void setGemmParallelThreshold(std::size_t multiplyAdds)
+  {
+    parallel::config().gemmThreshold = multiplyAdds;
+  }
+
+  /// The shared pool (started on first use)
+  inline ThreadPool& threadPool()
+  {
+    parallel::Config& cfg = parallel::config();
+    std::lock_guard<std::mutex> lock(cfg.poolMutex);
+    if ( !cfg.pool )
+    {
+      cfg.pool.reset(new ThreadPool(cfg.numThreads));
+    }
+    return *cfg.pool;
+  }
+
+  /// Number of tasks to split n items into, given a minimum grain per task
+  inline std::size_t parallelTasks(std::size_t n, std::size_t grain)
+  {
+    if ( (getNumThreads() <= 1) || ThreadPool::insideTask() || (grain == 0) )
+    {
+      return 1;
+    }
+
+    std::size_t tasks = n / grain;
+    if ( tasks > getNumThreads() )
+    {
+      tasks = getNumThreads();
+    }
+    return (tasks == 0) ? 1 : tasks;
+  }
+
+  /// Call fn(lo, hi) over [begin, end) in contiguous chunks, in parallel above the cutoff
+  ///
+  /// Chunk boundaries depend only on the range and the thread count, so
+  /// reductions built on top are reproducible run to run.
+  template <typename Fn>
+  void parallelFor(std::size_t begin, std::size_t end, const Fn& fn,
+                   std::size_t grain = getParallelThreshold())
+  {
+    if ( end <= begin )
+    {
+      return;
+    }
+
+    const std::size_t n = end - begin;
+    const std::size_t tasks = parallelTasks(n, grain);
+    if ( tasks == 1 )
+    {
+      fn(begin, end);
+      return;
+    }
+
+    threadPool().run(tasks, [&](std::size_t task) {
+      const std::size_t lo = begin + n*task/tasks;
+      const std::size_t hi = begin + n*(task + 1)/tasks;
+      fn(lo, hi);
+    });
+  }
+
+  /// Reduce fn(lo, hi) partials over [begin, end) with combine, in chunk order
+  template <typename R, typename Fn, typename Combine>
+  R parallelReduce(std::size_t begin, std::size_t end, const R& identity,
+                   const Fn& fn, const Combine& combine,
+                   std::size_t grain = getParallelThreshold())
+  {
+    if ( end <= begin )
+    {
+      return identity;
+    }
+
+    const std::size_t n = end - begin;
+    const std::size_t tasks = parallelTasks(n, grain);
+    if ( tasks == 1 )
+    {
+      return fn(begin, end);
+    }
+
+    std::vector<R> partials(tasks, identity);
+    threadPool().run(tasks, [&](std::size_t task) {
+      const std::size_t lo = begin + n*task/tasks;
+      const std::size_t hi = begin + n*(task + 1)/tasks;
+      partials[task] = fn(lo, hi);
+    });
+
+    R result = identity;
+    for (const auto& partial : partials)
+    {
+      result = combine(result, partial);
+    }
+    return result;
+  }
+
+  /// True if pred(lo, hi) holds on every chunk of [begin, end); stops early on failure
+  template <typename Pred>
+  bool parallelAll(std::size_t begin, std::size_t end, const Pred& pred,
+                   std::size_t grain = getParallelThreshold())
+  {
+    if ( end <= begin )
+    {
+      return true;
+    }
+
+    const std::size_t n = end - begin;
+    const std::size_t tasks = parallelTasks(n, grain);
+    if ( tasks == 1 )
+    {
+      return pred(begin, end);
+    }
+
+    // Split finer than the task count so a failure can cancel the rest:
+    const std::size_t chunks = tasks*8 < n ? tasks*8 : n;
+    std::atomic<bool> ok(true);
+    threadPool().run(chunks, [&](std::size_t chunk) {
+      if ( !ok.load(std::memory_order_relaxed) )
+      {
+        return;
+      }
+      const std::size_t lo = begin + n*chunk/chunks;
+      const std::size_t hi = begin + n*(chunk + 1)/chunks;
+      if ( !pred(lo, hi) )
+      {
+        ok.store(false, std::memory_order_relaxed);
+      }
+    });
+
+    return ok.load();
+  }
+
+} // matrix namespace
+
+#endif // THREAD_POOL_H
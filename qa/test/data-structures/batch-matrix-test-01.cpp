@@ -0,0 +1,244 @@
+////////////////////////////////////////
+////////////////////////////////////////
+//
+//  File:
+//      \file batch-matrix-test-01.cpp
+//
+//  Description:
+//      \brief Matrix Batch Tests
+//
+//  Author:
+//      \author J. Caleb Wherry
+//
+////////////////////////////////////////
+////////////////////////////////////////
+
+// Local Includes:
+#include "MatrixBatch.hpp"
+
+// Compiler includes:
+#include <cmath>
+#include <complex>
+#include <vector>
+
+// Test Includes:
+#include <gtest/gtest.h>
+
+// Namespaces:
+namespace M = matrix;
+using namespace std;
+
+// Anonymous namespace:
+namespace
+{
+
+// count matrices of rows x cols with small integer entries (diagonally dominant when square):
+template <typename T>
+vector<M::Matrix<T>> makeMatrices(size_t count, uint32_t rows, uint32_t cols, int seed)
+{
+  vector<M::Matrix<T>> matrices;
+  for (size_t b=0; b<count; ++b)
+  {
+    M::Matrix<T> X(rows, cols);
+    for (uint32_t i=0; i<rows; ++i)
+      for (uint32_t j=0; j<cols; ++j)
+        X(i,j) = T(int((b*13 + i*7 + j*3 + seed) % 9) - 4) + ((i == j) ? T(4*int(cols)) : T(0));
+    matrices.push_back(X);
+  }
+  return matrices;
+}
+
+
+TEST(MatrixBatchTest, Construction)
+{
+
+  M::MatrixBatch<double> A(10, 3, 4);
+  EXPECT_EQ( A.getCount(), 10u );
+  EXPECT_EQ( A.getNumRows(), 3u );
+  EXPECT_EQ( A.getNumCols(), 4u );
+  EXPECT_EQ( A.getLayout(), M::batchInterleaved );
+  EXPECT_EQ( A.getStride(), 96u );
+  EXPECT_EQ( A.getMatrix(9), M::Matrix<double>(3, 4, 0.0) );
+
+  A(3, 2, 1) = 5;
+  EXPECT_EQ( A.at(3, 2, 1), 5.0 );
+  EXPECT_EQ( A.data()[A.offset(3, 2, 1)], 5.0 );
+  EXPECT_THROW( A.at(10, 0, 0), out_of_range );
+  EXPECT_THROW( A.at(0, 3, 0), out_of_range );
+  EXPECT_THROW( A.getMatrix(10), out_of_range );
+  EXPECT_THROW( A.setMatrix(0, M::Matrix<double>(4, 3)), logic_error );
+
+  const vector<M::Matrix<double>> matrices = makeMatrices<double>(21, 5, 3, 1);
+  for (const M::BatchLayout layout : { M::batchStrided, M::batchInterleaved })
+  {
+    const M::MatrixBatch<double> B(matrices, layout);
+    EXPECT_EQ( B.getLayout(), layout );
+    const M::MatrixBatch<double> C = B.toLayout(layout == M::batchStrided ? M::batchInterleaved : M::batchStrided);
+    for (size_t b=0; b<matrices.size(); ++b)
+    {
+      EXPECT_EQ( B.getMatrix(b), matrices[b] );
+      EXPECT_EQ( C.getMatrix(b), matrices[b] );
+    }
+  }
+
+}
+
+
+TEST(MatrixBatchTest, Multiply)
+{
+
+  // Small integers keep every product exact:
+  const uint32_t shapes[][3] = { {8, 8, 8}, {3, 5, 4}, {7, 1, 9}, {16, 16, 16}, {33, 31, 35} };
+  for (const auto& shape : shapes)
+  {
+    const vector<M::Matrix<double>> L = makeMatrices<double>(45, shape[0], shape[1], 1);
+    const vector<M::Matrix<double>> R = makeMatrices<double>(45, shape[1], shape[2], 2);
+    const vector<M::Matrix<float>> Lf = makeMatrices<float>(45, shape[0], shape[1], 1);
+    const vector<M::Matrix<float>> Rf = makeMatrices<float>(45, shape[1], shape[2], 2);
+    for (const M::BatchLayout layout : { M::batchStrided, M::batchInterleaved })
+    {
+      const M::MatrixBatch<double> P = M::batchMultiply(M::MatrixBatch<double>(L, layout), M::MatrixBatch<double>(R, layout));
+      const M::MatrixBatch<float> Pf = M::batchMultiply(M::MatrixBatch<float>(Lf, layout), M::MatrixBatch<float>(Rf, layout));
+      EXPECT_EQ( P.getNumRows(), shape[0] );
+      EXPECT_EQ( P.getNumCols(), shape[2] );
+      for (size_t b=0; b<L.size(); ++b)
+      {
+        EXPECT_EQ( P.getMatrix(b), L[b]*R[b] );
+        EXPECT_EQ( Pf.getMatrix(b), Lf[b]*Rf[b] );
+      }
+    }
+  }
+
+  // Portable kernel, reusing the result, and an operand as the result:
+  const vector<M::Matrix<complex<double>>> Z = makeMatrices<complex<double>>(9, 4, 4, 3);
+  const vector<M::Matrix<int>> I = makeMatrices<int>(9, 4, 4, 4);
+  M::MatrixBatch<complex<double>> ZB(Z), ZP;
+  M::MatrixBatch<int> IB(I), IP;
+  M::batchMultiply(ZB, ZB, ZP);
+  M::batchMultiply(IB, IB, IP);
+  const complex<double>* before = ZP.data();
+  M::batchMultiply(ZB, ZB, ZP);
+  EXPECT_EQ( ZP.data(), before );
+  M::batchMultiply(ZB, ZP, ZB);
+  for (size_t b=0; b<Z.size(); ++b)
+  {
+    EXPECT_EQ( ZP.getMatrix(b), Z[b]*Z[b] );
+    EXPECT_EQ( ZB.getMatrix(b), Z[b]*Z[b]*Z[b] );
+    EXPECT_EQ( IP.getMatrix(b), I[b]*I[b] );
+  }
+
+  // Shapes, counts and layouts must agree:
+  M::MatrixBatch<double> A(4, 3, 3), B(5, 3, 3), C(4, 2, 3), D(4, 3, 3, M::batchStrided);
+  EXPECT_THROW( M::batchMultiply(A, B), logic_error );
+  EXPECT_THROW( M::batchMultiply(A, C), logic_error );
+  EXPECT_THROW( M::batchMultiply(A, D), logic_error );
+
+}
+
+
+TEST(MatrixBatchTest, SolveAndInverse)
+{
+
+  const vector<M::Matrix<double>> A = makeMatrices<double>(37, 6, 6, 1);
+  const vector<M::Matrix<double>> B = makeMatrices<double>(37, 6, 2, 5);
+  for (const M::BatchLayout layout : { M::batchStrided, M::batchInterleaved })
+  {
+    const M::MatrixBatch<double> AB(A, layout);
+    const M::MatrixBatch<double> X = M::batchSolve(AB, M::MatrixBatch<double>(B, layout));
+    const M::MatrixBatch<double> AI = M::batchInverse(AB);
+    const M::MatrixBatch<double> AAI = M::batchMultiply(AB, AI);
+    for (size_t b=0; b<A.size(); ++b)
+    {
+      EXPECT_LT( M::Matrix<double>(X.getMatrix(b) - A[b].solve(B[b])).maxNorm(), 1e-12 );
+      EXPECT_LT( M::Matrix<double>(AAI.getMatrix(b) - A[b].identity()).maxNorm(), 1e-12 );
+    }
+  }
+
+  // Into existing results, including solving in place:
+  M::MatrixBatch<double> AB(A), X(B), AI;
+  M::batchSolve(AB, X, X);
+  M::batchInverse(AB, AI);
+  M::batchInverse(AI, AI);
+  for (size_t b=0; b<A.size(); ++b)
+  {
+    EXPECT_LT( M::Matrix<double>(X.getMatrix(b) - A[b].solve(B[b])).maxNorm(), 1e-12 );
+    EXPECT_LT( M::Matrix<double>(AI.getMatrix(b) - A[b]).maxNorm(), 1e-12 );
+  }
+
+  // Pivoting: a zero leading entry must not stop the elimination:
+  M::Matrix<double> P = { {0, 1},
+                          {1, 0}
+                        };
+  M::MatrixBatch<double> PB(vector<M::Matrix<double>>(3, P));
+  EXPECT_EQ( M::batchInverse(PB).getMatrix(2), P );
+
+  // Complex and float:
+  const vector<M::Matrix<complex<double>>> Z = makeMatrices<complex<double>>(5, 3, 3, 2);
+  const M::MatrixBatch<complex<double>> ZI = M::batchInverse(M::MatrixBatch<complex<double>>(Z, M::batchStrided));
+  EXPECT_LT( M::Matrix<complex<double>>(ZI.getMatrix(4)*Z[4] - Z[4].identity()).maxNorm(), 1e-12 );
+  const vector<M::Matrix<float>> F = makeMatrices<float>(19, 5, 5, 3);
+  const M::MatrixBatch<float> FI = M::batchInverse(M::MatrixBatch<float>(F));
+  EXPECT_LT( M::Matrix<float>(FI.getMatrix(18)*F[18] - F[18].identity()).maxNorm(), 1e-5f );
+
+  // One singular matrix fails the batch:
+  M::MatrixBatch<double> S(PB);
+  S(1, 1, 0) = 0;
+  EXPECT_THROW( M::batchInverse(S), logic_error );
+  EXPECT_THROW( M::batchInverse(S.toLayout(M::batchStrided)), logic_error );
+
+  // Numerically singular (a negligible pivot) fails the batch exactly when LU says so:
+  const vector<M::Matrix<double>> R = makeMatrices<double>(9, 3, 3, 7);
+  for (const double tiny : {1e-17, 1e-10})
+  {
+    M::Matrix<double> N = { {tiny, 2, 0},
+                            {0, 1, 0},
+                            {0, 0, 1}
+                          };
+    vector<M::Matrix<double>> mixed(R);
+    mixed[5] = N;
+    const bool singular = N.isSingular();
+    EXPECT_EQ( singular, tiny < 1e-15 );
+    for (const M::BatchLayout layout : { M::batchStrided, M::batchInterleaved })
+    {
+      const M::MatrixBatch<double> NB(mixed, layout);
+      if ( singular )
+      {
+        EXPECT_THROW( M::batchInverse(NB), logic_error );
+        EXPECT_THROW( M::batchSolve(NB, M::MatrixBatch<double>(makeMatrices<double>(9, 3, 1, 3), layout)), logic_error );
+      }
+      else
+      {
+        EXPECT_NO_THROW( M::batchInverse(NB) );
+      }
+    }
+  }
+  EXPECT_THROW( M::batchSolve(M::MatrixBatch<double>(2, 2, 3), M::MatrixBatch<double>(2, 2, 1)), logic_error );
+  EXPECT_THROW( M::batchSolve(M::MatrixBatch<double>(2, 2, 2), M::MatrixBatch<double>(2, 3, 1)), logic_error );
+
+}
+
+
+TEST(MatrixBatchTest, Transpose)
+{
+
+  const vector<M::Matrix<double>> A = makeMatrices<double>(29, 4, 7, 1);
+  for (const M::BatchLayout layout : { M::batchStrided, M::batchInterleaved })
+  {
+    const M::MatrixBatch<double> T = M::batchTranspose(M::MatrixBatch<double>(A, layout));
+    EXPECT_EQ( T.getNumRows(), 7u );
+    EXPECT_EQ( T.getNumCols(), 4u );
+    for (size_t b=0; b<A.size(); ++b)
+    {
+      EXPECT_EQ( T.getMatrix(b), A[b].transpose() );
+    }
+  }
+
+  M::MatrixBatch<double> B(A, M::batchStrided);
+  M::batchTranspose(B, B);
+  M::batchTranspose(B, B);
+  EXPECT_EQ( B.getMatrix(28), A[28] );
+
+}
+
+
+} // End anonymous namespace
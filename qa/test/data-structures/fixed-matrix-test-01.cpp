@@ -0,0 +1,193 @@
+////////////////////////////////////////
+////////////////////////////////////////
+//
+//  File:
+//      \file fixed-matrix-test-01.cpp
+//
+//  Description:
+//      \brief Fixed Matrix Tests
+//
+//  Author:
+//      \author J. Caleb Wherry
+//
+////////////////////////////////////////
+////////////////////////////////////////
+
+// Local Includes:
+#include "FixedMatrix.hpp"
+
+// Compiler includes:
+#include <complex>
+#include <type_traits>
+#include <utility>
+
+// Test Includes:
+#include <gtest/gtest.h>
+
+// Namespaces:
+namespace M = matrix;
+using namespace std;
+
+// Anonymous namespace:
+namespace
+{
+
+// Can A*B be formed?
+template <typename A, typename B, typename = void>
+struct CanMultiply : false_type {};
+
+template <typename A, typename B>
+struct CanMultiply<A, B, decltype(void(declval<A>()*declval<B>()))> : true_type {};
+
+// Evaluated by the compiler:
+constexpr M::FixedMatrix<double,2,2> rotation(0.0, -1.0,
+                                              1.0,  0.0);
+constexpr M::FixedMatrix<double,2,2> rotationSquared = rotation*rotation;
+static_assert(rotationSquared == -M::FixedMatrix<double,2,2>::identity(), "constexpr multiply");
+static_assert(rotation.determinant() == 1.0, "constexpr determinant");
+static_assert(rotation.inverse() == rotation.transpose(), "constexpr inverse");
+static_assert(M::FixedMatrix<double,4,4>(2.0).trace() == 8.0, "constexpr trace");
+static_assert(sizeof(M::FixedMatrix<double,3,3>) == 9*sizeof(double), "inline storage only");
+
+
+TEST(FixedMatrixTest, Construction)
+{
+
+  M::FixedMatrix<double,2,3> A(1, 2, 3,
+                               4, 5, 6);
+  EXPECT_EQ( A.getNumRows(), 2u );
+  EXPECT_EQ( A.getNumCols(), 3u );
+  EXPECT_EQ( A(1,0), 4.0 );
+  EXPECT_EQ( (M::FixedMatrix<double,2,3>()(1,2)), 0.0 );
+  EXPECT_EQ( (M::FixedMatrix<double,2,3>(7.0)(1,2)), 7.0 );
+  EXPECT_THROW({
+    auto temp = A(2,0);
+  }, out_of_range);
+
+  // Element count is checked at compile time:
+  EXPECT_FALSE( (is_constructible<M::FixedMatrix<double,2,2>, double, double, double>::value) );
+  EXPECT_TRUE ( (is_constructible<M::FixedMatrix<double,2,2>, double, double, double, double>::value) );
+
+}
+
+
+TEST(FixedMatrixTest, Operators)
+{
+
+  M::FixedMatrix<double,2,3> A(1, 2, 3,
+                               4, 5, 6);
+  M::FixedMatrix<double,3,2> B(1, 0,
+                               0, 1,
+                               2, -1);
+  M::FixedMatrix<double,2,2> expected(7, -1,
+                                      16, -1);
+  EXPECT_EQ( A*B, expected );
+  EXPECT_EQ( A.transpose().transpose(), A );
+  EXPECT_EQ( A + A, A*2.0 );
+  EXPECT_EQ( 2.0*A, A*2.0 );
+  EXPECT_EQ( (A*2.0)/2.0, A );
+  EXPECT_EQ( A - A, (M::FixedMatrix<double,2,3>()) );
+
+  M::FixedMatrix<double,2,3> C = A;
+  C += A;
+  C -= A;
+  C *= 3.0;
+  C /= 3.0;
+  EXPECT_EQ( C, A );
+
+  M::FixedMatrix<double,2,2> D = expected;
+  D *= M::FixedMatrix<double,2,2>::identity();
+  EXPECT_EQ( D, expected );
+
+  // Dimension mismatches don't compile:
+  EXPECT_TRUE ( (CanMultiply<M::FixedMatrix<double,2,3>, M::FixedMatrix<double,3,2>>::value) );
+  EXPECT_FALSE( (CanMultiply<M::FixedMatrix<double,2,3>, M::FixedMatrix<double,2,3>>::value) );
+
+}
+
+
+TEST(FixedMatrixTest, Operations)
+{
+
+  // Closed forms (2x2, 3x3) and elimination (4x4 and up) agree with the dynamic Matrix:
+  M::FixedMatrix<double,3,3> A3(2, -1, 0,
+                                -1, 2, -1,
+                                0, -1, 2);
+  EXPECT_NEAR( A3.determinant(), 4.0, 1e-12 );
+  M::FixedMatrix<double,3,3> I3 = A3*A3.inverse();
+  for (size_t i=0; i<3; ++i)
+  {
+    for (size_t j=0; j<3; ++j)
+    {
+      EXPECT_NEAR( I3(i,j), (i == j) ? 1.0 : 0.0, 1e-12 );
+    }
+  }
+
+  M::FixedMatrix<double,5,5> A5;
+  for (size_t i=0; i<5; ++i)
+  {
+    for (size_t j=0; j<5; ++j)
+    {
+      A5(i,j) = double((i*7 + j*3) % 5) + ((i == j) ? 4.0 : 0.0);
+    }
+  }
+  M::Matrix<double> D5 = A5.toMatrix();
+  EXPECT_NEAR( A5.determinant(), D5.determinant(), 1e-9 );
+  M::FixedMatrix<double,5,5> inv5 = A5.inverse();
+  M::Matrix<double> dinv5 = D5.inverse();
+  for (size_t i=0; i<5; ++i)
+  {
+    for (size_t j=0; j<5; ++j)
+    {
+      EXPECT_NEAR( inv5(i,j), dinv5(i,j), 1e-12 );
+    }
+  }
+
+  M::FixedMatrix<double,4,4> singular(1.0);
+  EXPECT_EQ( singular.determinant(), 0.0 );
+  EXPECT_THROW({
+    singular.inverse();
+  }, logic_error);
+
+  // Integer determinants are exact past the closed forms:
+  M::FixedMatrix<int,4,4> T4(2, 1, 0, 0,
+                             1, 2, 1, 0,
+                             0, 1, 2, 1,
+                             0, 0, 1, 2);
+  M::FixedMatrix<int,4,4> P4(0, 1, 0, 0,
+                             3, 0, 0, 0,
+                             0, 0, 0, 2,
+                             0, 0, 5, 0);
+  EXPECT_EQ( T4.determinant(), 5 );
+  EXPECT_EQ( P4.determinant(), 30 );
+
+  // Complex:
+  M::FixedMatrix<complex<double>,2,2> C(complex<double>(1,1), complex<double>(2,0),
+                                        complex<double>(0,-1), complex<double>(1,2));
+  EXPECT_EQ( C.determinant(), complex<double>(-1,5) );
+  M::FixedMatrix<complex<double>,2,2> CI = C*C.inverse();
+  EXPECT_NEAR( abs(CI(0,0) - 1.0), 0.0, 1e-12 );
+  EXPECT_NEAR( abs(CI(0,1)), 0.0, 1e-12 );
+
+}
+
+
+TEST(FixedMatrixTest, Interop)
+{
+
+  M::Matrix<double> D = { {1, 2, 3},
+                          {4, 5, 6}
+                        };
+  M::FixedMatrix<double,2,3> F(D);
+  EXPECT_EQ( F(1,2), 6.0 );
+  EXPECT_EQ( F.toMatrix(), D );
+  EXPECT_EQ( (F*F.transpose()).toMatrix(), D*D.transpose() );
+  typedef M::FixedMatrix<double,3,2> Wrong;
+  EXPECT_THROW({
+    Wrong temp(D);
+  }, logic_error);
+
+}
+
+
+} // End anonymous namespace
@@ -18,6 +18,16 @@
 
 // Compiler includes:
 //#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iterator>
+#include <numeric>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
 
 // Test Includes:
 #include <gtest/gtest.h>
@@ -201,18 +211,309 @@ TEST_F(MatrixTest, OperatorMultiply_Matrix)
   EXPECT_THROW({
     real_2 = real_2*I3;
   }, logic_error);
+
+  // Rectangular product: (3x4)*(4x2) = 3x2
+  M::Matrix<double> A = { {1, 2, 3, 4},
+                          {5, 6, 7, 8},
+                          {9, 10, 11, 12}
+                        };
+  M::Matrix<double> B = { {1, 0},
+                          {0, 1},
+                          {1, 0},
+                          {0, 1}
+                        };
+  M::Matrix<double> AB = { {4, 6},
+                           {12, 14},
+                           {20, 22}
+                         };
+  EXPECT_EQ( A*B, AB );
+
+  // Large enough to go through the packed, blocked path (odd sizes hit every edge tile):
+  const uint32_t m = 131, n = 77, k = 301;
+  M::Matrix<double> L(m, k), R(k, n);
+  for (uint32_t i=0; i<m; ++i)
+    for (uint32_t j=0; j<k; ++j)
+      L(i,j) = (i + 2*j) % 7 - 3;
+  for (uint32_t i=0; i<k; ++i)
+    for (uint32_t j=0; j<n; ++j)
+      R(i,j) = (3*i + j) % 5 - 2;
+
+  M::Matrix<double> LR = L*R;
+  ASSERT_EQ( LR.getNumRows(), m );
+  ASSERT_EQ( LR.getNumCols(), n );
+  for (uint32_t i=0; i<m; ++i)
+  {
+    for (uint32_t j=0; j<n; ++j)
+    {
+      double expected = 0;
+      for (uint32_t p=0; p<k; ++p)
+        expected += L(i,p)*R(p,j);
+      EXPECT_EQ( LR(i,j), expected );
+    }
+  }
+
+  // Unsigned elements (no std::abs overload picks their magnitude type):
+  M::Matrix<unsigned> U = { {1, 2},
+                            {3, 4}
+                          };
+  M::Matrix<unsigned> UU = { {7, 10},
+                             {15, 22}
+                           };
+  EXPECT_EQ( U*U, UU );
+  EXPECT_EQ( M::Matrix<unsigned>(U + U), U*2u );
+  EXPECT_EQ( U.transpose()(0,1), 3u );
+  EXPECT_TRUE( (is_same<M::Matrix<unsigned>::Real, unsigned>::value) );
+  EXPECT_TRUE( (is_same<M::Matrix<complex<float>>::Real, float>::value) );
+}
+
+
+TEST_F(MatrixTest, OperatorMultiply_Strassen)
+{
+
+  // Small integers keep every product exact, so recursion must match GEMM:
+  auto fill = [](uint32_t rows, uint32_t cols, int seed) {
+    M::Matrix<double> X(rows, cols);
+    for (uint32_t i=0; i<rows; ++i)
+      for (uint32_t j=0; j<cols; ++j)
+        X(i,j) = double(int((i*7 + j*3 + seed) % 11) - 5);
+    return X;
+  };
+
+  const size_t crossover = M::getStrassenCrossover(), workspace = M::getStrassenWorkspace();
+  const uint32_t shapes[][3] = { {64, 64, 64}, {67, 45, 53}, {33, 101, 17}, {96, 80, 112}, {9, 9, 9}, {40, 1, 40} };
+  for (const auto& shape : shapes)
+  {
+    const M::Matrix<double> L = fill(shape[0], shape[1], 1), R = fill(shape[1], shape[2], 4);
+    M::setStrassenCrossover(0);
+    const M::Matrix<double> reference = L*R;
+
+    M::setStrassenCrossover(4);
+    EXPECT_EQ( L*R, reference );
+
+    // Workspace for one level only:
+    M::setStrassenWorkspace(sizeof(double)*(shape[0]/2*max(shape[1]/2, shape[2]/2) + shape[1]/2*(shape[2]/2)));
+    EXPECT_EQ( L*R, reference );
+    M::setStrassenWorkspace(workspace);
+  }
+
+  // Complex, and through power():
+  M::Matrix<complex<double>> Z(37, 37);
+  for (uint32_t i=0; i<37; ++i)
+    for (uint32_t j=0; j<37; ++j)
+      Z(i,j) = complex<double>(double(int(i + j) % 3 - 1), double(int(i*j) % 3 - 1));
+  M::setStrassenCrossover(0);
+  const M::Matrix<complex<double>> Z2 = Z*Z;
+  const M::Matrix<double> S = fill(30, 30, 2), S3 = S*S*S;
+  M::setStrassenCrossover(5);
+  EXPECT_EQ( Z*Z, Z2 );
+  EXPECT_EQ( S.power(3), S3 );
+
+  // Floating point: close to GEMM, not identical:
+  M::Matrix<double> F(150, 150);
+  for (uint32_t i=0; i<150; ++i)
+    for (uint32_t j=0; j<150; ++j)
+      F(i,j) = sin(i*0.37 + j*1.13);
+  const M::Matrix<double> FF = F*F;
+  M::setStrassenCrossover(0);
+  EXPECT_LT( M::Matrix<double>(FF - F*F).maxNorm(), 1e-11 );
+
+  M::setStrassenCrossover(crossover);
+
+}
+
+
+TEST_F(MatrixTest, OperatorMultiply_Complex)
+{
+
+  // Small Gaussian integers keep every product exact, whichever method runs:
+  typedef complex<double> C;
+  auto fill = [](uint32_t rows, uint32_t cols, int seed) {
+    M::Matrix<C> X(rows, cols);
+    for (uint32_t i=0; i<rows; ++i)
+      for (uint32_t j=0; j<cols; ++j)
+        X(i,j) = C(double(int((i*7 + j*3 + seed) % 11) - 5), double(int((i*5 + j*2 + seed) % 7) - 3));
+    return X;
+  };
+  auto reference = [](const M::Matrix<C>& X, bool conjX, const M::Matrix<C>& Y, bool conjY) {
+    M::Matrix<C> R(X.getNumRows(), Y.getNumCols(), C(0));
+    for (uint32_t i=0; i<X.getNumRows(); ++i)
+      for (uint32_t j=0; j<Y.getNumCols(); ++j)
+        for (uint32_t l=0; l<X.getNumCols(); ++l)
+          R(i,j) += (conjX ? conj(X(i,l)) : X(i,l))*(conjY ? conj(Y(l,j)) : Y(l,j));
+    return R;
+  };
+
+  const M::ComplexGemm method = M::getComplexGemmMethod();
+  const uint32_t shapes[][3] = { {70, 50, 60}, {3, 4, 5}, {129, 33, 71} };
+  for (const M::ComplexGemm m : { M::complexGemm4M, M::complexGemm3M })
+  {
+    M::setComplexGemmMethod(m);
+    EXPECT_EQ( M::getComplexGemmMethod(), m );
+    for (const auto& shape : shapes)
+    {
+      const M::Matrix<C> L = fill(shape[0], shape[1], 1), R = fill(shape[1], shape[2], 4);
+      const M::Matrix<C> LH = L.conjugateTranspose(), RH = R.conjugateTranspose();
+      EXPECT_EQ( L*R, reference(L, false, R, false) );
+      EXPECT_EQ( L.conjugated()*R, reference(L, true, R, false) );
+      EXPECT_EQ( L*R.conjugated(), reference(L, false, R, true) );
+      EXPECT_EQ( L.conjugated()*R.conjugated(), reference(L, true, R, true) );
+      EXPECT_EQ( LH.adjoint()*R, L*R );
+      EXPECT_EQ( L*RH.adjoint(), L*R );
+      EXPECT_EQ( LH.adjoint()*RH.adjoint(), L*R );
+    }
+
+    // Hermitian products, below and above the block size:
+    for (const uint32_t rows : { 40u, 300u })
+    {
+      const M::Matrix<C> A = fill(rows, 45, 2), AH = A.conjugateTranspose();
+      const M::Matrix<C> G = A*A.adjoint(), H = AH.adjoint()*AH;
+      EXPECT_EQ( G, reference(A, false, AH, false) );
+      EXPECT_EQ( H, G );
+      EXPECT_TRUE( G.isHermitian() );
+      EXPECT_EQ( A.adjoint()*A, reference(AH, false, A, false) );
+    }
+  }
+  M::setComplexGemmMethod(method);
+
+  // Views materialize on demand and check dimensions:
+  const M::Matrix<C> Z = fill(4, 6, 3);
+  EXPECT_EQ( Z.adjoint().getNumRows(), 6u );
+  EXPECT_EQ( Z.adjoint().getNumCols(), 4u );
+  EXPECT_EQ( M::Matrix<C>(Z.adjoint()), Z.conjugateTranspose() );
+  EXPECT_EQ( M::Matrix<C>(Z.conjugated()), Z.complexConjugate() );
+  EXPECT_THROW( Z*Z.conjugated(), logic_error );
+  EXPECT_THROW( Z.adjoint()*Z.adjoint(), logic_error );
+
+  // Views are expression operands, read in place:
+  const M::Matrix<C> ZH = Z.conjugateTranspose(), V = fill(6, 4, 5);
+  const M::Matrix<C> sumZV = Z.adjoint() + V;
+  EXPECT_EQ( sumZV, ZH + V );
+  EXPECT_EQ( M::Matrix<C>(Z.conjugated()*C(2.0) - Z), Z.complexConjugate()*C(2.0) - Z );
+  EXPECT_TRUE( Z.adjoint() == ZH );
+  EXPECT_EQ( M::Matrix<C>(Z.adjoint().transpose()), Z.complexConjugate() );
+  EXPECT_EQ( Z.conjugated().transpose().eval(), ZH );
+  EXPECT_EQ( Z.adjoint().eval().sum(), ZH.sum() );
+  ostringstream shown, expected;
+  shown << Z.adjoint();
+  expected << ZH;
+  EXPECT_EQ( shown.str(), expected.str() );
+
+  // Assigning a view of the destination itself:
+  M::Matrix<C> Y = fill(5, 5, 7);
+  const M::Matrix<C> YH = Y.conjugateTranspose();
+  Y = Y.adjoint();
+  EXPECT_EQ( Y, YH );
+  Y += Y.adjoint();
+  EXPECT_EQ( Y, YH + YH.conjugateTranspose() );
+
+  // Integer complex (conjugated up front) and real (conjugation is a no-op):
+  M::Matrix<complex<int>> I(3, 2);
+  I(0,0) = complex<int>(1,2);  I(0,1) = complex<int>(0,-1);
+  I(1,0) = complex<int>(3,0);  I(1,1) = complex<int>(-2,1);
+  I(2,0) = complex<int>(1,1);  I(2,1) = complex<int>(4,-3);
+  const M::Matrix<complex<int>> IHI = I.adjoint()*I;
+  EXPECT_EQ( IHI, I.conjugateTranspose()*I );
+  EXPECT_EQ( IHI(0,0), complex<int>(16,0) );
+  M::Matrix<double> D(5, 3);
+  for (uint32_t i=0; i<5; ++i)
+    for (uint32_t j=0; j<3; ++j)
+      D(i,j) = double(int(i*3 + j) % 4) - 1.5;
+  EXPECT_EQ( D.adjoint()*D, D.transpose()*D );
+
+  // isReal and complexConjugate:
+  EXPECT_TRUE( D.isReal() );
+  EXPECT_FALSE( Z.isReal() );
+  M::Matrix<C> W(70, 90, C(2.5, 0));
+  EXPECT_TRUE( W.isReal() );
+  W(69,89) = C(2.5, -0.0001);
+  EXPECT_FALSE( W.isReal() );
+  const M::Matrix<C> WC = W.complexConjugate();
+  EXPECT_EQ( WC(69,89), C(2.5, 0.0001) );
+  EXPECT_EQ( WC(0,0), C(2.5, 0) );
+  EXPECT_EQ( WC.complexConjugate(), W );
+
 }
 
 
 TEST_F(MatrixTest, OperatorMultiply_Vector)
 {
-  // TODO
+
+  EXPECT_EQ( real_1*vector<double>({1, 2, 3}), vector<double>({6, 6, 6}) );
+  EXPECT_EQ( vector<double>({1, 2, 3})*real_2, vector<double>({0, 0, 0, 0}) );
+  EXPECT_EQ( I4*vector<double>({1, 2, 3, 4}), vector<double>({1, 2, 3, 4}) );
+
+  // Odd sizes (row and column tails) against GEMM, at every kernel level:
+  M::Matrix<double> A(37, 53);
+  M::Matrix<float> F(37, 53);
+  M::Matrix<double> X(53, 1), Xt(1, 37);
+  vector<double> x(53), xt(37);
+  vector<float> xf(53), xtf(37);
+  for (uint32_t i=0; i<37; ++i)
+  {
+    for (uint32_t j=0; j<53; ++j)
+    {
+      A(i,j) = (i*5 + j*3) % 7 - 3.0;
+      F(i,j) = float(A(i,j));
+    }
+    xt[i] = Xt(0,i) = i % 4 - 1.5;
+    xtf[i] = float(xt[i]);
+  }
+  for (uint32_t j=0; j<53; ++j)
+  {
+    x[j] = X(j,0) = j % 5 - 2.0;
+    xf[j] = float(x[j]);
+  }
+
+  M::Matrix<double> Ax = A*X, xA = Xt*A;
+  M::SimdLevel best = M::simdLevel();
+  for (int level=M::simdScalar; level<=best; ++level)
+  {
+    M::setSimdLevel(M::SimdLevel(level));
+
+    vector<double> y = A*x, yt = xt*A;
+    vector<float> yf = F*xf, ytf = xtf*F;
+    for (uint32_t i=0; i<37; ++i)
+    {
+      EXPECT_EQ( y[i], Ax(i,0) );
+      EXPECT_EQ( yf[i], float(Ax(i,0)) );
+    }
+    for (uint32_t j=0; j<53; ++j)
+    {
+      EXPECT_EQ( yt[j], xA(0,j) );
+      EXPECT_EQ( ytf[j], float(xA(0,j)) );
+    }
+  }
+  M::setSimdLevel(best);
+
+  // Output-parameter forms reuse the caller's buffer:
+  vector<double> y(37);
+  const double* buffer = y.data();
+  A.multiply(x, y);
+  EXPECT_EQ( y.data(), buffer );
+  EXPECT_EQ( y, A*x );
+  A.multiplyTransposed(xt.data(), x.data());
+  EXPECT_EQ( x, xt*A );
+
+  vector<complex<double>> z = complex_1*vector<complex<double>>(3, complex<double>(0,1));
+  EXPECT_EQ( z, vector<complex<double>>(3, complex<double>(-3,3)) );
+
+  EXPECT_THROW({
+    auto temp = real_2*vector<double>(3);
+  }, logic_error);
+  EXPECT_THROW({
+    auto temp = vector<double>(4)*real_2;
+  }, logic_error);
+
 }
 
 
 TEST_F(MatrixTest, OperatorMultiply_Scalar)
 {
-  // TODO
+
+  EXPECT_EQ( real_1*3.0, real_1c );
+  EXPECT_EQ( complex_3*complex<double>(3,3), M::Matrix<complex<double>>(4, 4, complex<double>(3,3)) );
+  EXPECT_EQ( (complex_1*complex<double>(0,1))(2,2), complex<double>(-1,1) );
+
 }
 
 
@@ -235,13 +536,130 @@ TEST_F(MatrixTest, OperatorPlus_Matrix)
 
 TEST_F(MatrixTest, OperatorPlus_Scalar)
 {
-  // TODO
+
+  EXPECT_EQ( real_1 + 2.0, real_1c );
+  EXPECT_EQ( real_1c - 2.0, real_1 );
+
 }
 
 
 TEST_F(MatrixTest, OperatorMinus_Matrix)
 {
-  // TODO
+
+  EXPECT_EQ( real_1c - real_1b, real_1 );
+  EXPECT_EQ( -real_1, real_1 - real_1b );
+
+  // Not same size:
+  EXPECT_THROW({
+    real_1 = real_1 - real_2;
+  }, logic_error);
+
+}
+
+
+TEST_F(MatrixTest, ElementWise_Expressions)
+{
+
+  M::Matrix<double> A(19, 23), B(19, 23), C(19, 23);
+  for (uint32_t i=0; i<19; ++i)
+  {
+    for (uint32_t j=0; j<23; ++j)
+    {
+      A(i,j) = i + j;
+      B(i,j) = 2.0*i - j;
+      C(i,j) = j % 3;
+    }
+  }
+
+  // Whole chain evaluated into the destination in one pass:
+  M::Matrix<double> D = A*2.0 + B - C;
+  for (uint32_t i=0; i<19; ++i)
+    for (uint32_t j=0; j<23; ++j)
+      EXPECT_EQ( D(i,j), 2.0*A(i,j) + B(i,j) - C(i,j) );
+
+  // Single elements of an expression, without evaluating the rest:
+  EXPECT_EQ( (A - B/2.0)(3,4), A(3,4) - B(3,4)/2.0 );
+  EXPECT_THROW({
+    auto temp = (A + B)(19,0);
+  }, out_of_range);
+
+  // Destination read by the expression:
+  M::Matrix<double> E = A;
+  E = E*2.0 + E*3.0 - -E;
+  EXPECT_EQ( E, A*6.0 );
+
+  // Assigning a different shape replaces the storage:
+  M::Matrix<double> F(2, 2, 0.0);
+  F = A + B;
+  EXPECT_EQ( F.getNumRows(), 19u );
+  EXPECT_EQ( F, B + A );
+
+  // Expressions feed the eager operations:
+  EXPECT_EQ( (A + B)*C.transpose(), M::Matrix<double>(A + B)*C.transpose() );
+
+  // Matrix members are called on the evaluated expression:
+  const M::Matrix<double> AB = A + B;
+  EXPECT_EQ( (A + B).eval(), AB );
+  EXPECT_EQ( (A + B).eval().sum(), AB.sum() );
+  EXPECT_EQ( (A - B).eval().transpose(), M::Matrix<double>(A - B).transpose() );
+  EXPECT_EQ( (A*2.0).eval().isSquare(), A.isSquare() );
+
+  // Shape checks still happen when the expression is built:
+  EXPECT_THROW({
+    D = A + real_1;
+  }, logic_error);
+
+}
+
+
+TEST_F(MatrixTest, ElementWise_SimdLevels)
+{
+
+  // Odd sizes so every kernel runs its vector body and its scalar tail:
+  M::Matrix<double> A(37, 29), B(37, 29);
+  M::Matrix<float> Af(37, 29), Bf(37, 29);
+  M::Matrix<complex<double>> Ac(37, 29), Bc(37, 29);
+  for (uint32_t i=0; i<37; ++i)
+  {
+    for (uint32_t j=0; j<29; ++j)
+    {
+      A(i,j)  = Af(i,j) = float(i) - 0.5f*j;
+      B(i,j)  = Bf(i,j) = float(j) + 0.25f*i;
+      Ac(i,j) = complex<double>(A(i,j), B(i,j));
+      Bc(i,j) = complex<double>(B(i,j), -A(i,j));
+    }
+  }
+
+  // Reference results from the portable kernels:
+  M::SimdLevel best = M::simdLevel();
+  M::setSimdLevel(M::simdScalar);
+  M::Matrix<double> sumRef = A + B, diffRef = A - B, scaleRef = A*3.0, divRef = A/4.0, negRef = -A;
+  M::Matrix<float> sumRefF = Af + Bf, divRefF = Af/4.0f;
+  M::Matrix<complex<double>> sumRefC = Ac + Bc, scaleRefC = Ac*complex<double>(2,-1);
+  double totalRef = A.sum();
+  complex<double> totalRefC = Ac.sum();
+
+  for (int level=M::simdSse2; level<=best; ++level)
+  {
+    M::setSimdLevel(M::SimdLevel(level));
+    EXPECT_EQ( A + B, sumRef );
+    EXPECT_EQ( A - B, diffRef );
+    EXPECT_EQ( A*3.0, scaleRef );
+    EXPECT_EQ( A/4.0, divRef );
+    EXPECT_EQ( -A, negRef );
+    EXPECT_EQ( Af + Bf, sumRefF );
+    EXPECT_EQ( Af/4.0f, divRefF );
+    EXPECT_EQ( Ac + Bc, sumRefC );
+    EXPECT_EQ( Ac*complex<double>(2,-1), scaleRefC );
+    EXPECT_DOUBLE_EQ( A.sum(), totalRef );
+    EXPECT_DOUBLE_EQ( Ac.sum().real(), totalRefC.real() );
+    EXPECT_DOUBLE_EQ( Ac.sum().imag(), totalRefC.imag() );
+    EXPECT_FALSE( A == B );
+    EXPECT_FALSE( Ac == Bc );
+  }
+
+  M::setSimdLevel(best);
+
 }
 
 
@@ -251,6 +669,319 @@ TEST_F(MatrixTest, OperatorMinux_Scalar)
 }
 
 
+TEST_F(MatrixTest, OperatorCompound)
+{
+
+  M::Matrix<double> A = real_1;
+  const double* buffer = A.data();
+
+  A += real_1b;
+  EXPECT_EQ( A, real_1c );
+  A -= real_1;
+  EXPECT_EQ( A, real_1b );
+  A *= 1.5;
+  EXPECT_EQ( A, real_1c );
+  A /= 3;
+  EXPECT_EQ( A, real_1 );
+  A += 2;
+  EXPECT_EQ( A, real_1c );
+  A -= 1;
+  EXPECT_EQ( A, real_1b );
+
+  // Expressions that read the destination:
+  A += A*2.0 - real_1;
+  EXPECT_EQ( A, M::Matrix<double>(3, 3, 5.0) );
+
+  // None of the above reallocated:
+  EXPECT_EQ( A.data(), buffer );
+
+  A *= I3;
+  EXPECT_EQ( A, M::Matrix<double>(3, 3, 5.0) );
+
+  M::Matrix<complex<double>> C = complex_1;
+  C *= complex<double>(0,1);
+  EXPECT_EQ( C, M::Matrix<complex<double>>(3, 3, complex<double>(-1,1)) );
+
+  EXPECT_THROW({
+    A += real_2;
+  }, logic_error);
+  EXPECT_THROW({
+    A /= 0;
+  }, logic_error);
+  EXPECT_THROW({
+    A *= real_3;
+  }, logic_error);
+
+}
+
+
+TEST_F(MatrixTest, MoveSemantics)
+{
+
+  // Move construction and assignment take the buffer and empty the source:
+  M::Matrix<double> A = real_1b;
+  const double* buffer = A.data();
+
+  M::Matrix<double> B(std::move(A));
+  EXPECT_EQ( B.data(), buffer );
+  EXPECT_EQ( A.getNumRows(), 0u );
+  EXPECT_EQ( A.getNumCols(), 0u );
+
+  A = std::move(B);
+  EXPECT_EQ( A.data(), buffer );
+  EXPECT_EQ( A, real_1b );
+  EXPECT_EQ( B.getNumRows(), 0u );
+
+  // Operators on a temporary reuse its buffer:
+  M::Matrix<double> C = std::move(A)*2.0 + real_1 - real_1b;
+  EXPECT_EQ( C.data(), buffer );
+  EXPECT_EQ( C, real_1c );
+
+  C = -std::move(C);
+  EXPECT_EQ( C.data(), buffer );
+  EXPECT_EQ( C, real_1c*(-1.0) );
+
+  // Temporary on the right:
+  M::Matrix<double> D = real_1c - real_1*I3;
+  EXPECT_EQ( D, real_1b );
+  D = real_1 + (real_1*I3)/0.5;
+  EXPECT_EQ( D, real_1c );
+
+  EXPECT_THROW({
+    D = real_2 - real_1*I3;
+  }, logic_error);
+
+}
+
+
+TEST_F(MatrixTest, OperatorPower)
+{
+
+  EXPECT_EQ( real_1^0, I3 );
+  EXPECT_EQ( real_1^1, real_1 );
+  EXPECT_EQ( real_1^2, real_1*real_1 );
+  EXPECT_EQ( I4^1000000, I4 );
+
+  // Fibonacci numbers:
+  M::Matrix<double> F = { {1, 1},
+                          {1, 0}
+                        };
+  M::Matrix<double> F10 = { {89, 55},
+                            {55, 34}
+                          };
+  EXPECT_EQ( F^10, F10 );
+
+  // Every exponent up to 12 against repeated multiplication:
+  M::Matrix<double> A(5, 5);
+  for (uint32_t i=0; i<5; ++i)
+    for (uint32_t j=0; j<5; ++j)
+      A(i,j) = (i*3 + j) % 4 - 1.0;
+  M::Matrix<double> expected = A.identity();
+  for (uint32_t p=0; p<=12; ++p)
+  {
+    EXPECT_EQ( A^p, expected );
+    expected = expected*A;
+  }
+
+  M::Matrix<complex<double>> J = { {complex<double>(0,1), 0},
+                                   {0,                    complex<double>(0,1)}
+                                 };
+  EXPECT_EQ( J^3, J*(-1.0) );
+
+  EXPECT_THROW({
+    auto temp = real_2^2;
+  }, logic_error);
+
+  // Eigendecomposition path (symmetric only, accurate to rounding):
+  M::Matrix<double> S = { { 4, 1, -2, 0.5},
+                          { 1, 3,  0, 1  },
+                          {-2, 0,  5, 1  },
+                          { 0.5, 1, 1, 2 }
+                        };
+  M::Matrix<double> exact = S^9, fast = S.power(9, M::powerEigen);
+  for (uint32_t i=0; i<4; ++i)
+    for (uint32_t j=0; j<4; ++j)
+      EXPECT_NEAR( fast(i,j), exact(i,j), 1e-9*abs(exact(i,j)) + 1e-6 );
+
+  EXPECT_THROW({
+    auto temp = A.power(3, M::powerEigen);
+  }, logic_error);
+  EXPECT_THROW({
+    auto temp = complex_1.power(3, M::powerEigen);
+  }, logic_error);
+
+}
+
+
+TEST_F(MatrixTest, Parallel)
+{
+
+  M::Matrix<double> A(157, 203), B(203, 61);
+  for (uint32_t i=0; i<A.getNumRows(); ++i)
+    for (uint32_t j=0; j<A.getNumCols(); ++j)
+      A(i,j) = (i*7 + j*3) % 11 - 5;
+  for (uint32_t i=0; i<B.getNumRows(); ++i)
+    for (uint32_t j=0; j<B.getNumCols(); ++j)
+      B(i,j) = (i + j*5) % 13 - 6;
+
+  // Serial reference:
+  size_t threads = M::getNumThreads();
+  M::setNumThreads(1);
+  M::Matrix<double> prodRef = A*B, sumRef = A + A, scaleRef = A*2.0, transRef = A.transpose();
+  double totalRef = A.sum(), traceRef = A.trace();
+  vector<double> ones(203, 1.0), twos(157, 2.0);
+  vector<double> gemvRef = A*ones, gemvTRef = twos*A;
+
+  // Force every operation through the pool, even at these sizes:
+  size_t threshold = M::getParallelThreshold(), gemmThreshold = M::getGemmParallelThreshold();
+  M::setNumThreads(4);
+  M::setParallelThreshold(16);
+  M::setGemmParallelThreshold(0);
+
+  EXPECT_EQ( M::getNumThreads(), 4u );
+  EXPECT_EQ( A*B, prodRef );
+  EXPECT_EQ( A + A, sumRef );
+  EXPECT_EQ( A*2.0, scaleRef );
+  EXPECT_EQ( A.transpose(), transRef );
+  EXPECT_EQ( A.sum(), totalRef );
+  EXPECT_EQ( A.trace(), traceRef );
+  EXPECT_EQ( A*ones, gemvRef );
+  EXPECT_EQ( twos*A, gemvTRef );
+  EXPECT_TRUE( A.isReal() );
+  EXPECT_FALSE( A == sumRef );
+
+  // Exceptions thrown by tasks reach the caller:
+  EXPECT_THROW({
+    M::threadPool().run(8, [](size_t task) { if (task == 5) throw runtime_error("task"); });
+  }, runtime_error);
+
+  // Several user threads at once (whoever finds the pool busy runs serially):
+  vector<int> agreed(6, 0);
+  vector<thread> users;
+  for (size_t t=0; t<agreed.size(); ++t)
+  {
+    users.push_back(thread([&, t]() {
+      int ok = 1;
+      for (int rep=0; rep<20; ++rep)
+      {
+        ok &= int( (A*B == prodRef) && (A + A == sumRef) && (A.sum() == totalRef) && (A*ones == gemvRef) );
+      }
+      agreed[t] = ok;
+    }));
+  }
+  for (auto& user : users)
+  {
+    user.join();
+  }
+  EXPECT_EQ( agreed, vector<int>(agreed.size(), 1) );
+
+  M::setParallelThreshold(threshold);
+  M::setGemmParallelThreshold(gemmThreshold);
+  M::setNumThreads(threads);
+
+}
+
+
+// Counts what goes through it, on top of the heap:
+class CountingResource : public M::MemoryResource
+{
+  public:
+    size_t allocations = 0, deallocations = 0, live = 0;
+
+    void* allocate(size_t bytes, size_t alignment) override
+    {
+      ++allocations;
+      live += bytes;
+      return M::defaultResource().allocate(bytes, alignment);
+    }
+
+    void deallocate(void* ptr, size_t bytes) override
+    {
+      ++deallocations;
+      live -= bytes;
+      M::defaultResource().deallocate(ptr, bytes);
+    }
+};
+
+TEST_F(MatrixTest, Storage_MemoryResource)
+{
+
+  // Buffers use the current resource and return memory to the one they came from:
+  CountingResource counting;
+  {
+    M::Matrix<double> outer(10, 10, 1.0);
+    {
+      M::MemoryResourceScope scope(counting);
+      M::Matrix<double> A(20, 30, 2.0);
+      M::Matrix<double> B = A*2.0;
+      EXPECT_EQ( counting.allocations, 2u );
+      EXPECT_EQ( counting.live, 2*600*sizeof(double) );
+      EXPECT_EQ( &M::getMemoryResource(), &counting );
+      outer = std::move(B);
+    }
+    EXPECT_EQ( &M::getMemoryResource(), &M::defaultResource() );
+    EXPECT_EQ( counting.deallocations, 1u );
+    EXPECT_EQ( outer(19,29), 4.0 );
+    M::Matrix<double> copy = outer;
+    EXPECT_EQ( counting.allocations, 2u );
+  }
+  EXPECT_EQ( counting.deallocations, 2u );
+  EXPECT_EQ( counting.live, 0u );
+
+  // Arena: bump allocation, LIFO reuse and reset:
+  M::ArenaResource arena(1 << 16);
+  {
+    M::MemoryResourceScope scope(arena);
+    M::Matrix<double> A(16, 16, 1.0);
+    EXPECT_EQ( reinterpret_cast<uintptr_t>(A.data()) % M::storageAlignment, 0u );
+    const size_t afterA = arena.getBytesUsed();
+    {
+      M::Matrix<double> T = A + A;
+      EXPECT_GT( arena.getBytesUsed(), afterA );
+      EXPECT_EQ( T(3,4), 2.0 );
+    }
+    EXPECT_EQ( arena.getBytesUsed(), afterA );
+
+    // Bigger than a chunk:
+    M::Matrix<double> big(100, 100, 3.0);
+    EXPECT_EQ( big.sum(), 30000.0 );
+    EXPECT_GT( arena.getBytesReserved(), size_t(1 << 16) );
+  }
+  arena.reset();
+  EXPECT_EQ( arena.getBytesUsed(), 0u );
+  EXPECT_EQ( arena.getBytesReserved(), 100*100*sizeof(double) );
+
+  // Huge pages: large blocks are 2 MiB aligned, small ones come from the heap:
+  M::HugePageResource huge;
+  {
+    M::MemoryResourceScope scope(huge);
+    M::Matrix<double> A(512, 1024, 1.5), small(4, 4, 1.0);
+    EXPECT_EQ( reinterpret_cast<uintptr_t>(A.data()) % M::HugePageResource::pageBytes, 0u );
+    EXPECT_EQ( reinterpret_cast<uintptr_t>(small.data()) % M::storageAlignment, 0u );
+    EXPECT_EQ( A.sum(), 1.5*512*1024 );
+    EXPECT_EQ( (A*small.getNumRows())(511,1023), 6.0 );
+  }
+  M::HugePageResource explicitPages(M::hugePagesExplicit);
+  {
+    M::MemoryResourceScope scope(explicitPages);
+    M::Matrix<float> A(1024, 1024, 2.0f);
+    EXPECT_EQ( A(1023,1023), 2.0f );
+  }
+
+  // Parallel first-touch fill:
+  size_t threads = M::getNumThreads(), threshold = M::getParallelThreshold();
+  M::setNumThreads(4);
+  M::setParallelThreshold(16);
+  M::Matrix<double> F(37, 41, 7.0);
+  M::Matrix<complex<double>> G(37, 41, complex<double>(1.0, -1.0));
+  M::setParallelThreshold(threshold);
+  M::setNumThreads(threads);
+  EXPECT_EQ( F, M::Matrix<double>(37, 41, 7.0) );
+  EXPECT_EQ( G.sum(), complex<double>(37*41, -37*41) );
+
+}
+
+
 TEST_F(MatrixTest, Accessors_Size)
 {
 
@@ -263,15 +994,669 @@ TEST_F(MatrixTest, Accessors_Size)
 }
 
 
+TEST_F(MatrixTest, Storage)
+{
+
+  // One contiguous, aligned, row-major buffer:
+  M::Matrix<double> A = { {1, 2, 3},
+                          {4, 5, 6}
+                        };
+  EXPECT_EQ( A.getLeadingDim(), 3u );
+  EXPECT_EQ( reinterpret_cast<uintptr_t>(&A(0,0)) % M::storageAlignment, 0u );
+  EXPECT_EQ( &A(1,0), &A(0,0) + A.getLeadingDim() );
+  EXPECT_EQ( A(1,2), 6 );
+
+  // Nested vector accessor still reflects the contents:
+  vector<vector<double>> nested = A.getMatrix();
+  EXPECT_EQ( nested.size(), 2u );
+  EXPECT_EQ( nested[1][0], 4 );
+
+  // Ragged rows can't share one buffer:
+  EXPECT_THROW({
+    M::Matrix<double> ragged({ {1, 2}, {3} });
+  }, logic_error);
+
+}
+
+
 TEST_F(MatrixTest, Modifiers_Size)
 {
   // TODO
 }
  
 
+TEST_F(MatrixTest, Transpose)
+{
+
+  // Shapes around the tile and register-tile edges, every kernel level:
+  const uint32_t shapes[][2] = { {1, 1}, {1, 9}, {7, 3}, {8, 8}, {33, 31}, {64, 64}, {97, 130}, {300, 45} };
+  M::SimdLevel best = M::simdLevel();
+  for (int level=M::simdScalar; level<=best; ++level)
+  {
+    M::setSimdLevel(M::SimdLevel(level));
+    for (const auto& shape : shapes)
+    {
+      const uint32_t r = shape[0], c = shape[1];
+      M::Matrix<double> A(r, c);
+      M::Matrix<float> F(r, c);
+      M::Matrix<complex<double>> Z(r, c);
+      for (uint32_t i=0; i<r; ++i)
+      {
+        for (uint32_t j=0; j<c; ++j)
+        {
+          A(i,j) = i*1000.0 + j;
+          F(i,j) = float(i*100 + j);
+          Z(i,j) = complex<double>(i, -double(j));
+        }
+      }
+
+      M::Matrix<double> At = A.transpose();
+      M::Matrix<float> Ft = F.transpose();
+      M::Matrix<complex<double>> Zh = Z.conjugateTranspose();
+      ASSERT_EQ( At.getNumRows(), c );
+      ASSERT_EQ( At.getNumCols(), r );
+      bool same = true;
+      for (uint32_t i=0; i<r; ++i)
+      {
+        for (uint32_t j=0; j<c; ++j)
+        {
+          same = same && (At(j,i) == A(i,j)) && (Ft(j,i) == F(i,j)) && (Zh(j,i) == conj(Z(i,j)));
+        }
+      }
+      EXPECT_TRUE( same ) << r << "x" << c << " at level " << level;
+
+      // In place (square swaps tiles, other shapes follow cycles):
+      M::Matrix<double> B = A;
+      EXPECT_EQ( B.transposeInPlace(), At );
+      EXPECT_EQ( B.transposeInPlace(), A );
+      M::Matrix<complex<double>> W = Z;
+      EXPECT_EQ( W.conjugateTransposeInPlace(), Zh );
+    }
+  }
+  M::setSimdLevel(best);
+
+  EXPECT_EQ( complex_2.conjugateTranspose().conjugateTranspose(), complex_2 );
+  EXPECT_EQ( real_2.transpose().getNumRows(), 4u );
+
+}
+
+
+TEST_F(MatrixTest, Decomposition_LU)
+{
+
+  // Small system with a known answer (needs pivoting: a11 = 0):
+  M::Matrix<double> A = { {0, 2, 1},
+                          {1, 1, 0},
+                          {3, 0, 1}
+                        };
+  M::Matrix<double> B = { {5, 1},
+                          {3, 0},
+                          {4, 6}
+                        };
+  M::Matrix<double> X = A.solve(B);
+  M::Matrix<double> expected = { {1, 1},
+                                 {2, -1},
+                                 {1, 3}
+                               };
+  for (uint32_t i=0; i<3; ++i)
+  {
+    for (uint32_t j=0; j<2; ++j)
+    {
+      EXPECT_NEAR( X(i,j), expected(i,j), 1e-12 );
+    }
+  }
+  EXPECT_NEAR( A.determinant(), -5.0, 1e-12 );
+  EXPECT_NEAR( I4.determinant(), 1.0, 1e-15 );
+
+  // The factors reproduce P*A:
+  M::LUDecomposition<double> lu(A);
+  M::Matrix<double> PA = A;
+  for (uint32_t i=0; i<3; ++i)
+  {
+    for (uint32_t j=0; j<3; ++j)
+    {
+      swap(PA(i,j), PA(lu.getPivots()[i],j));
+    }
+  }
+  M::Matrix<double> LU = lu.getL()*lu.getU();
+  for (uint32_t i=0; i<3; ++i)
+  {
+    for (uint32_t j=0; j<3; ++j)
+    {
+      EXPECT_NEAR( LU(i,j), PA(i,j), 1e-12 );
+    }
+  }
+
+  // Large enough to take several blocked panels:
+  const uint32_t n = 150;
+  M::Matrix<double> big(n, n), rhs(n, 3);
+  uint32_t state = 7;
+  for (uint32_t i=0; i<n; ++i)
+  {
+    for (uint32_t j=0; j<n; ++j)
+    {
+      state = state*1664525u + 1013904223u;
+      big(i,j) = double((state >> 16) % 2001)/1000.0 - 1.0;
+    }
+    for (uint32_t j=0; j<3; ++j)
+    {
+      rhs(i,j) = double(i % 5) - double(j);
+    }
+  }
+  M::Matrix<double> residual = big*big.solve(rhs) - rhs;
+  M::Matrix<double> nearI = big*big.inverse();
+  for (uint32_t i=0; i<n; ++i)
+  {
+    for (uint32_t j=0; j<3; ++j)
+    {
+      EXPECT_NEAR( residual(i,j), 0.0, 1e-9 );
+    }
+    for (uint32_t j=0; j<n; ++j)
+    {
+      EXPECT_NEAR( nearI(i,j), (i == j) ? 1.0 : 0.0, 1e-9 );
+    }
+  }
+
+  // Vector right-hand side:
+  vector<double> x = M::LUDecomposition<double>(big).solve(vector<double>(n, 1.0));
+  vector<double> bx = big*x;
+  for (uint32_t i=0; i<n; ++i)
+  {
+    EXPECT_NEAR( bx[i], 1.0, 1e-9 );
+  }
+
+  // Complex:
+  M::Matrix<complex<double>> C = { {complex<double>(1,1), complex<double>(2,0)},
+                                   {complex<double>(0,-1), complex<double>(1,2)}
+                                 };
+  EXPECT_NEAR( abs(C.determinant() - complex<double>(-1,5)), 0.0, 1e-12 );
+  M::Matrix<complex<double>> CI = C*C.inverse();
+  EXPECT_NEAR( abs(CI(0,0) - 1.0), 0.0, 1e-12 );
+  EXPECT_NEAR( abs(CI(0,1)), 0.0, 1e-12 );
+  EXPECT_NEAR( abs(CI(1,0)), 0.0, 1e-12 );
+  EXPECT_NEAR( abs(CI(1,1) - 1.0), 0.0, 1e-12 );
+
+  // Singular and non-square:
+  EXPECT_TRUE ( real_1.isSingular() );
+  EXPECT_TRUE ( real_1.isDegenerate() );
+  EXPECT_FALSE( real_1.isInvertible() );
+  EXPECT_EQ( real_1.determinant(), 0.0 );
+  EXPECT_TRUE ( A.isInvertible() );
+  EXPECT_TRUE ( real_2.isSingular() );
+  EXPECT_THROW({
+    auto temp = real_1.inverse();
+  }, logic_error);
+  EXPECT_THROW({
+    auto temp = real_2.inverse();
+  }, logic_error);
+  EXPECT_THROW({
+    auto temp = real_2.determinant();
+  }, logic_error);
+  EXPECT_THROW({
+    auto temp = A.solve(I4);
+  }, logic_error);
+
+  // Singular to working precision, with no exactly zero pivot:
+  M::Matrix<double> S3 = { {1, 2, 3},
+                           {4, 5, 6},
+                           {7, 8, 9}
+                         };
+  M::Matrix<double> S2 = { {0.1, 0.2},
+                           {0.3, 0.6}
+                         };
+  EXPECT_TRUE ( S3.isSingular() );
+  EXPECT_TRUE ( S2.isSingular() );
+  EXPECT_TRUE ( M::LUDecomposition<double>(S3).isSingular() );
+  EXPECT_EQ( S3.determinant(), 0.0 );
+  EXPECT_EQ( S2.determinant(), 0.0 );
+  EXPECT_THROW( S3.inverse(), logic_error );
+  EXPECT_THROW( S2.solve(M::Matrix<double>(2, 1, 1.0)), logic_error );
+
+  // Tiny but well conditioned is not singular:
+  M::Matrix<double> tiny = A*1e-100;
+  EXPECT_FALSE( tiny.isSingular() );
+  EXPECT_NEAR( tiny.determinant()/A.determinant(), 1e-300, 1e-310 );
+
+  // isSingular() and determinant() agree on a negligible pivot, Hermitian or not:
+  M::Matrix<double> N1 = { {1e-17, 0},
+                           {0, 1}
+                         };
+  M::Matrix<double> N2 = { {1e-17, 2},
+                           {0, 1}
+                         };
+  EXPECT_TRUE( N1.isSingular() );
+  EXPECT_EQ( N1.determinant(), 0.0 );
+  EXPECT_TRUE( N2.isSingular() );
+  EXPECT_EQ( N2.determinant(), 0.0 );
+  M::Matrix<double> N3 = { {1e-10, 2},
+                           {0, 1}
+                         };
+  EXPECT_FALSE( N3.isSingular() );
+  EXPECT_DOUBLE_EQ( N3.determinant(), 1e-10 );
+
+  // Integer determinants are exact (fraction-free elimination):
+  EXPECT_EQ( M::Matrix<int>({ {2, 3}, {4, 5} }).determinant(), -2 );
+  EXPECT_EQ( M::Matrix<int>({ {2, 1}, {1, 1} }).determinant(), 1 );
+  EXPECT_EQ( M::Matrix<int>({ {0, 1}, {1, 0} }).determinant(), -1 );
+  M::Matrix<long long> T4 = { {2, 1, 0, 0},
+                              {1, 2, 1, 0},
+                              {0, 1, 2, 1},
+                              {0, 0, 1, 2}
+                            };
+  EXPECT_EQ( T4.determinant(), 5 );
+  EXPECT_TRUE ( T4.isInvertible() );
+  EXPECT_TRUE ( M::Matrix<int>({ {1, 2, 3}, {4, 5, 6}, {7, 8, 9} }).isSingular() );
+  EXPECT_EQ( M::Matrix<int>({ {3, 7, 1}, {0, 0, 2}, {5, 1, 4} }).determinant(), 64 );
+
+}
+
+
+TEST_F(MatrixTest, Decomposition_Cholesky)
+{
+
+  // Known factor: A = L*L^T:
+  M::Matrix<double> L = { {2, 0, 0},
+                          {1, 3, 0},
+                          {-1, 2, 1}
+                        };
+  M::Matrix<double> A = L*L.transpose();
+  M::CholeskyDecomposition<double> llt(A);
+  EXPECT_TRUE( llt.isComplete() );
+  M::Matrix<double> Lf = llt.getL();
+  for (uint32_t i=0; i<3; ++i)
+  {
+    for (uint32_t j=0; j<3; ++j)
+    {
+      EXPECT_NEAR( Lf(i,j), L(i,j), 1e-12 );
+    }
+  }
+  EXPECT_NEAR( llt.determinant(), 36.0, 1e-10 );
+  EXPECT_NEAR( A.determinant(), 36.0, 1e-10 );
+  EXPECT_TRUE( A.isPositiveDefinite() );
+
+  // LDL^T: same solution, D = diag(l_ii^2):
+  M::CholeskyDecomposition<double> ldlt(A, M::choleskyLDLT);
+  EXPECT_TRUE( ldlt.isPositiveDefinite() );
+  vector<double> d = ldlt.getD();
+  EXPECT_NEAR( d[0], 4.0, 1e-12 );
+  EXPECT_NEAR( d[1], 9.0, 1e-12 );
+  EXPECT_NEAR( d[2], 1.0, 1e-12 );
+  vector<double> b = {1, 2, 3};
+  vector<double> x1 = llt.solve(b), x2 = ldlt.solve(b), x3 = M::LUDecomposition<double>(A).solve(b);
+  for (size_t i=0; i<3; ++i)
+  {
+    EXPECT_NEAR( x1[i], x3[i], 1e-12 );
+    EXPECT_NEAR( x2[i], x3[i], 1e-12 );
+  }
+
+  // Large enough to take several blocked panels (SPD: B*B^T + n*I):
+  const uint32_t n = 150;
+  M::Matrix<double> big(n, n), rhs(n, 2);
+  uint32_t state = 11;
+  for (uint32_t i=0; i<n; ++i)
+  {
+    for (uint32_t j=0; j<n; ++j)
+    {
+      state = state*1664525u + 1013904223u;
+      big(i,j) = double((state >> 16) % 2001)/1000.0 - 1.0;
+    }
+    rhs(i,0) = 1.0;
+    rhs(i,1) = double(i % 7);
+  }
+  M::Matrix<double> spd = big*big.transpose() + big.identity()*double(n);
+  for (int form=M::choleskyLLT; form<=M::choleskyLDLT; ++form)
+  {
+    M::CholeskyDecomposition<double> chol(spd, M::CholeskyForm(form));
+    EXPECT_TRUE( chol.isComplete() );
+    M::Matrix<double> residual = spd*chol.solve(rhs) - rhs;
+    for (uint32_t i=0; i<n; ++i)
+    {
+      EXPECT_NEAR( residual(i,0), 0.0, 1e-9 );
+      EXPECT_NEAR( residual(i,1), 0.0, 1e-9 );
+    }
+  }
+  M::Matrix<double> nearI = spd*spd.inverse();
+  for (uint32_t i=0; i<n; ++i)
+  {
+    for (uint32_t j=0; j<n; ++j)
+    {
+      EXPECT_NEAR( nearI(i,j), (i == j) ? 1.0 : 0.0, 1e-9 );
+    }
+  }
+
+  // Hermitian positive definite complex:
+  M::Matrix<complex<double>> H = { {complex<double>(4,0), complex<double>(1,-2)},
+                                   {complex<double>(1,2), complex<double>(6,0)}
+                                 };
+  EXPECT_TRUE( H.isPositiveDefinite() );
+  EXPECT_NEAR( abs(H.determinant() - complex<double>(19,0)), 0.0, 1e-12 );
+  M::CholeskyDecomposition<complex<double>> hc(H);
+  M::Matrix<complex<double>> HL = hc.getL();
+  M::Matrix<complex<double>> HH = HL*HL.conjugateTranspose();
+  for (uint32_t i=0; i<2; ++i)
+  {
+    for (uint32_t j=0; j<2; ++j)
+    {
+      EXPECT_NEAR( abs(HH(i,j) - H(i,j)), 0.0, 1e-12 );
+    }
+  }
+  M::CholeskyDecomposition<complex<double>> hd(H, M::choleskyLDLT);
+  vector<complex<double>> hx = hd.solve(vector<complex<double>>({complex<double>(5,-2), complex<double>(7,2)}));
+  EXPECT_NEAR( abs(hx[0] - 1.0), 0.0, 1e-12 );
+  EXPECT_NEAR( abs(hx[1] - 1.0), 0.0, 1e-12 );
+
+  // Indefinite: LL^T stops, LDL^T still factors:
+  M::Matrix<double> S = { {1, 2},
+                          {2, 1}
+                        };
+  EXPECT_FALSE( S.isPositiveDefinite() );
+  EXPECT_FALSE( M::CholeskyDecomposition<double>(S).isComplete() );
+  M::CholeskyDecomposition<double> sd(S, M::choleskyLDLT);
+  EXPECT_TRUE ( sd.isComplete() );
+  EXPECT_FALSE( sd.isPositiveDefinite() );
+  EXPECT_NEAR( sd.determinant(), -3.0, 1e-12 );
+  EXPECT_NEAR( S.determinant(), -3.0, 1e-12 );
+  EXPECT_THROW({
+    auto temp = M::CholeskyDecomposition<double>(S).solve(b);
+  }, logic_error);
+  EXPECT_THROW({
+    M::CholeskyDecomposition<double> temp(real_2);
+  }, logic_error);
+
+  // Rank deficient positive semidefinite (X*X^T, rank 3): the roundoff left
+  //  in the last pivots must not pass for positive, so nothing is inverted:
+  state = 7;
+  for (int trial=0; trial<200; ++trial)
+  {
+    M::Matrix<double> X(6, 3);
+    for (uint32_t i=0; i<6; ++i)
+    {
+      for (uint32_t j=0; j<3; ++j)
+      {
+        state = state*1664525u + 1013904223u;
+        X(i,j) = double((state >> 16) % 2001)/1000.0 - 1.0;
+      }
+    }
+    M::Matrix<double> P = X*X.transpose();
+    EXPECT_FALSE( M::CholeskyDecomposition<double>(P).isComplete() );
+    EXPECT_FALSE( P.isPositiveDefinite() );
+    EXPECT_TRUE( P.isSingular() );
+    EXPECT_THROW({
+      auto temp = P.inverse();
+    }, logic_error);
+    EXPECT_THROW({
+      auto temp = P.solve(X);
+    }, logic_error);
+  }
+
+}
+
+
+TEST_F(MatrixTest, Decomposition_QR)
+{
+
+  // Exact fit: y = 1 + 2*t through four points, plus a second right-hand side:
+  M::Matrix<double> A = { {1, 0},
+                          {1, 1},
+                          {1, 2},
+                          {1, 3}
+                        };
+  M::Matrix<double> B = { {1, 0},
+                          {3, 1},
+                          {5, 0},
+                          {7, 1}
+                        };
+  M::Matrix<double> X = A.leastSquares(B);
+  EXPECT_EQ( X.getNumRows(), 2u );
+  EXPECT_NEAR( X(0,0), 1.0, 1e-12 );
+  EXPECT_NEAR( X(1,0), 2.0, 1e-12 );
+  EXPECT_NEAR( X(0,1), 0.2, 1e-12 );
+  EXPECT_NEAR( X(1,1), 0.2, 1e-12 );
+
+  // Q has orthonormal columns and Q*R = A, over several panels:
+  const uint32_t m = 300, n = 140;
+  M::Matrix<double> tall(m, n), rhs(m, 3);
+  uint32_t state = 5;
+  for (uint32_t i=0; i<m; ++i)
+  {
+    for (uint32_t j=0; j<n; ++j)
+    {
+      state = state*1664525u + 1013904223u;
+      tall(i,j) = double((state >> 16) % 2001)/1000.0 - 1.0;
+    }
+    for (uint32_t j=0; j<3; ++j)
+    {
+      state = state*1664525u + 1013904223u;
+      rhs(i,j) = double((state >> 16) % 2001)/1000.0 - 1.0;
+    }
+  }
+  M::QRDecomposition<double> qr(tall);
+  EXPECT_TRUE( qr.isFullRank() );
+  M::Matrix<double> Q = qr.getQ(), R = qr.getR();
+  M::Matrix<double> QtQ = Q.transpose()*Q, QR = Q*R;
+  for (uint32_t i=0; i<n; ++i)
+  {
+    for (uint32_t j=0; j<n; ++j)
+    {
+      EXPECT_NEAR( QtQ(i,j), (i == j) ? 1.0 : 0.0, 1e-12 );
+      if ( j < i )
+      {
+        EXPECT_EQ( R(i,j), 0.0 );
+      }
+    }
+  }
+  for (uint32_t i=0; i<m; ++i)
+  {
+    for (uint32_t j=0; j<n; ++j)
+    {
+      EXPECT_NEAR( QR(i,j), tall(i,j), 1e-12 );
+    }
+  }
+
+  // Least squares: the residual is orthogonal to A's columns:
+  M::Matrix<double> residual = tall*qr.solve(rhs) - rhs;
+  M::Matrix<double> normal = tall.transpose()*residual;
+  for (uint32_t i=0; i<n; ++i)
+  {
+    for (uint32_t j=0; j<3; ++j)
+    {
+      EXPECT_NEAR( normal(i,j), 0.0, 1e-10 );
+    }
+  }
+
+  // Complex:
+  M::Matrix<complex<double>> C = { {complex<double>(1,1), complex<double>(0,0)},
+                                   {complex<double>(0,-1), complex<double>(2,0)},
+                                   {complex<double>(1,0), complex<double>(1,1)}
+                                 };
+  vector<complex<double>> xc = {complex<double>(1,-1), complex<double>(2,0.5)};
+  vector<complex<double>> bc = C*xc;
+  vector<complex<double>> sc = M::QRDecomposition<complex<double>>(C).solve(bc);
+  EXPECT_NEAR( abs(sc[0] - xc[0]), 0.0, 1e-12 );
+  EXPECT_NEAR( abs(sc[1] - xc[1]), 0.0, 1e-12 );
+
+  // Extreme magnitudes neither overflow nor underflow the reflectors:
+  for (double scale : {1e200, 1e-200})
+  {
+    M::Matrix<double> H = { {1*scale, 2*scale},
+                            {3*scale, 1*scale},
+                            {2*scale, 5*scale}
+                          };
+    M::QRDecomposition<double> qrH(H);
+    EXPECT_TRUE( qrH.isFullRank() );
+    M::Matrix<double> RH = qrH.getR();
+    EXPECT_NEAR( RH(0,0)/scale, -sqrt(14.0), 1e-12 );
+    EXPECT_NEAR( abs(RH(1,1))/scale, sqrt(30.0 - 225.0/14.0), 1e-12 );
+    M::Matrix<double> QRH = qrH.getQ()*RH;
+    for (uint32_t i=0; i<3; ++i)
+    {
+      for (uint32_t j=0; j<2; ++j)
+      {
+        EXPECT_NEAR( QRH(i,j)/scale, H(i,j)/scale, 1e-12 );
+      }
+    }
+  }
+
+  // Rank deficient and wide:
+  M::Matrix<double> D = { {1, 2},
+                          {2, 4},
+                          {3, 6}
+                        };
+  EXPECT_FALSE( M::QRDecomposition<double>(D).isFullRank() );
+  EXPECT_THROW({
+    auto temp = D.leastSquares(A);
+  }, logic_error);
+  EXPECT_THROW({
+    auto temp = real_2.leastSquares(real_2);
+  }, logic_error);
+
+}
+
+
 TEST_F(MatrixTest, Properties_Numerical)
 {
-  // TODO
+
+  // Norms of a small matrix with known values:
+  M::Matrix<double> A = { { 1, -2},
+                          {-3,  4}
+                        };
+  EXPECT_DOUBLE_EQ( A.sum(), 0.0 );
+  EXPECT_DOUBLE_EQ( A.mean(), 0.0 );
+  EXPECT_DOUBLE_EQ( A.p1Norm(), 6.0 );
+  EXPECT_DOUBLE_EQ( A.pInfNorm(), 7.0 );
+  EXPECT_DOUBLE_EQ( A.frobeniusNorm(), sqrt(30.0) );
+  EXPECT_DOUBLE_EQ( A.maxNorm(), 4.0 );
+  EXPECT_NEAR( A.p2Norm(), sqrt((30.0 + sqrt(884.0))/2), 1e-12 );
+  EXPECT_DOUBLE_EQ( I3.p2Norm(), 1.0 );
+  EXPECT_DOUBLE_EQ( real_2.p2Norm(), 0.0 );
+
+  // Row and column variants:
+  EXPECT_EQ( A.rowSums(), (vector<double>{ -1, 1 }) );
+  EXPECT_EQ( A.columnSums(), (vector<double>{ -2, 2 }) );
+  EXPECT_EQ( A.rowMeans(), (vector<double>{ -0.5, 0.5 }) );
+  EXPECT_EQ( A.columnMeans(M::summationKahan), (vector<double>{ -1, 1 }) );
+  EXPECT_EQ( A.rowNorms(M::vectorNorm1), (vector<double>{ 3, 7 }) );
+  EXPECT_EQ( A.columnNorms(M::vectorNormInf), (vector<double>{ 3, 4 }) );
+  EXPECT_DOUBLE_EQ( A.columnNorms()[1], sqrt(20.0) );
+
+  // Complex elements reduce through their magnitudes:
+  M::Matrix<complex<double>> Z = { {complex<double>(3,4), 0},
+                                   {0,                    1}
+                                 };
+  EXPECT_DOUBLE_EQ( Z.frobeniusNorm(), sqrt(26.0) );
+  EXPECT_DOUBLE_EQ( Z.maxNorm(), 5.0 );
+  EXPECT_DOUBLE_EQ( Z.p1Norm(), 5.0 );
+  EXPECT_NEAR( Z.p2Norm(), 5.0, 1e-12 );
+  EXPECT_EQ( Z.sum(M::summationKahan), complex<double>(4,4) );
+
+  // Squares that would overflow or underflow are rescaled:
+  M::Matrix<double> huge(2, 2, 1e200), tiny(2, 2, 1e-200);
+  EXPECT_DOUBLE_EQ( huge.frobeniusNorm(), 2e200 );
+  EXPECT_DOUBLE_EQ( tiny.frobeniusNorm(), 2e-200 );
+  EXPECT_DOUBLE_EQ( huge.columnNorms()[0], sqrt(2.0)*1e200 );
+  EXPECT_DOUBLE_EQ( tiny.rowNorms()[1], sqrt(2.0)*1e-200 );
+  EXPECT_NEAR( huge.p2Norm()/2e200, 1.0, 1e-12 );
+
+  // Spectral norm of Q*diag(d)*Q^T is the largest |d_i|:
+  const uint32_t n = 120;
+  M::Matrix<double> R(n, n), Dg(n, n, 0.0);
+  uint32_t state = 21;
+  for (uint32_t i=0; i<n; ++i)
+  {
+    for (uint32_t j=0; j<n; ++j)
+    {
+      state = state*1664525u + 1013904223u;
+      R(i,j) = double((state >> 16) % 2001)/1000.0 - 1.0;
+    }
+    Dg(i,i) = (i%2 ? -1.0 : 1.0)*(1.0 + 0.5*i);
+  }
+  M::Matrix<double> Q = M::QRDecomposition<double>(R).getQ();
+  M::Matrix<double> S = Q*Dg*Q.transpose();
+  EXPECT_NEAR( S.p2Norm(), 1.0 + 0.5*(n - 1), 1e-10 );
+  M::Matrix<complex<double>> Si(n, n);
+  for (uint32_t i=0; i<n; ++i)
+  {
+    for (uint32_t j=0; j<n; ++j)
+    {
+      Si(i,j) = complex<double>(0, S(i,j));
+    }
+  }
+  EXPECT_NEAR( Si.p2Norm(), 1.0 + 0.5*(n - 1), 1e-10 );
+
+  // Clustered top of the spectrum: more Lanczos steps than vectors kept
+  //  (tridiagonal 1, 2, 1 has eigenvalues 2 + 2cos(k*pi/(n + 1))):
+  const uint32_t nt = 400;
+  M::Matrix<double> Tri(nt, nt, 0.0);
+  for (uint32_t i=0; i<nt; ++i)
+  {
+    Tri(i,i) = 2;
+    if ( i + 1 < nt )
+    {
+      Tri(i,i+1) = Tri(i+1,i) = 1;
+    }
+  }
+  EXPECT_NEAR( Tri.p2Norm(), 2 + 2*cos(M_PI/(nt + 1)), 1e-12 );
+
+  // Integer elements (the iteration runs in double):
+  EXPECT_EQ( M::Matrix<int>({ {3, 0}, {0, 4} }).p2Norm(), 4 );
+  EXPECT_EQ( M::Matrix<int>({ {3, 0}, {0, 4} }).frobeniusNorm(), 5 );
+  EXPECT_EQ( M::Matrix<long long>({ {1, 1}, {-1, 1}, {0, 0} }).p2Norm(), 1 );
+  // sqrt(13) rounds to nearest whatever the shape:
+  EXPECT_EQ( M::Matrix<int>({ {2, 3} }).p2Norm(), 4 );
+  EXPECT_EQ( M::Matrix<int>({ {2}, {3} }).p2Norm(), 4 );
+  EXPECT_EQ( M::Matrix<int>({ {2, 3}, {0, 0} }).p2Norm(), 4 );
+
+  // A long float sum: the compensated and pairwise sums stay accurate at every level:
+  M::Matrix<float> F(1000, 1000, 0.1f);
+  M::Matrix<double> D(37, 53);
+  for (uint32_t i=0; i<37; ++i)
+  {
+    for (uint32_t j=0; j<53; ++j)
+    {
+      D(i,j) = (i%2 ? -1.0 : 1.0)*(j + 0.5*i);
+    }
+  }
+  M::SimdLevel best = M::simdLevel();
+  for (int level=M::simdScalar; level<=best; ++level)
+  {
+    M::setSimdLevel(M::SimdLevel(level));
+    EXPECT_NEAR( F.sum(M::summationKahan), 1e5f, 1.0f ) << "level " << level;
+    EXPECT_NEAR( F.sum(M::summationPairwise), 1e5f, 1.0f ) << "level " << level;
+    EXPECT_NEAR( F.columnSums(M::summationKahan)[7], 100.0f, 1e-3f ) << "level " << level;
+    EXPECT_NEAR( F.columnSums(M::summationPairwise)[999], 100.0f, 1e-3f ) << "level " << level;
+
+    double p1 = 0, pInf = 0, squares = 0, largest = 0;
+    for (uint32_t j=0; j<53; ++j)
+    {
+      double column = 0;
+      for (uint32_t i=0; i<37; ++i)
+      {
+        column += fabs(D(i,j));
+        squares += D(i,j)*D(i,j);
+        largest = max(largest, fabs(D(i,j)));
+      }
+      p1 = max(p1, column);
+    }
+    for (uint32_t i=0; i<37; ++i)
+    {
+      double row = 0;
+      for (uint32_t j=0; j<53; ++j)
+      {
+        row += fabs(D(i,j));
+      }
+      pInf = max(pInf, row);
+    }
+    EXPECT_DOUBLE_EQ( D.p1Norm(), p1 ) << "level " << level;
+    EXPECT_DOUBLE_EQ( D.pInfNorm(), pInf ) << "level " << level;
+    EXPECT_DOUBLE_EQ( D.frobeniusNorm(), sqrt(squares) ) << "level " << level;
+    EXPECT_DOUBLE_EQ( D.maxNorm(), largest ) << "level " << level;
+  }
+  M::setSimdLevel(best);
+
+  EXPECT_THROW({
+    auto temp = I0.mean();
+  }, logic_error);
+
 }
 
 
@@ -344,6 +1729,924 @@ TEST_F(MatrixTest, Properties_Boolean)
   EXPECT_FALSE( complex_3.isProjection() );
   EXPECT_TRUE ( complex_3.commutesWith(complex_3) );
 
+  // Unsigned elements (differences must not wrap around):
+  M::Matrix<unsigned> U = { {1, 2, 0},
+                            {2, 5, 3},
+                            {0, 3, 9}
+                          };
+  EXPECT_TRUE ( U.isSymmetric() );
+  EXPECT_TRUE ( U.isHermitian() );
+  EXPECT_FALSE( U.isIdentity() );
+  EXPECT_TRUE ( U.commutesWith(U) );
+  U(2,0) = 1;
+  EXPECT_FALSE( U.isSymmetric() );
+  EXPECT_TRUE ( U.isSymmetric(1) );
+  EXPECT_FALSE( U.isSymmetric(0, 0.5) );
+  M::Matrix<unsigned> UI = U.identity();
+  EXPECT_TRUE ( UI.isIdentity() );
+  UI(1,2) = 3;
+  EXPECT_FALSE( UI.isIdentity() );
+  EXPECT_TRUE ( UI.isIdentity(3) );
+
+}
+
+
+TEST_F(MatrixTest, Properties_Tolerance)
+{
+
+  // Sizes past several tiles and product bands:
+  const uint32_t n = 150;
+  M::Matrix<double> A(n, n);
+  M::Matrix<complex<double>> C(n, n);
+  uint32_t state = 11;
+  for (uint32_t i=0; i<n; ++i)
+  {
+    for (uint32_t j=0; j<n; ++j)
+    {
+      state = state*1664525u + 1013904223u;
+      A(i,j) = double((state >> 16) % 2001)/1000.0 - 1.0;
+      state = state*1664525u + 1013904223u;
+      C(i,j) = complex<double>(A(i,j), double((state >> 16) % 2001)/1000.0 - 1.0);
+    }
+  }
+
+  // Mirror checks are exact by default; a tolerance absorbs small noise:
+  M::Matrix<double> S = A + A.transpose(), K = A - A.transpose();
+  EXPECT_TRUE ( S.isSymmetric() );
+  EXPECT_FALSE( S.isSkewSymmetric() );
+  EXPECT_TRUE ( K.isSkewSymmetric() );
+  EXPECT_FALSE( K.isSymmetric() );
+  EXPECT_FALSE( A.isSymmetric() );
+  S(140,3) += 1e-9;
+  EXPECT_FALSE( S.isSymmetric() );
+  EXPECT_TRUE ( S.isSymmetric(1e-8) );
+  EXPECT_TRUE ( S.isSymmetric(0, 1e-6) );
+  EXPECT_FALSE( S.isSymmetric(1e-10, 1e-12) );
+
+  M::Matrix<complex<double>> H = C + C.conjugateTranspose(), G = C - C.conjugateTranspose();
+  EXPECT_TRUE ( H.isHermitian() );
+  EXPECT_TRUE ( H.isSelfAdjoint() );
+  EXPECT_FALSE( H.isSymmetric() );
+  EXPECT_TRUE ( G.isSkewHermitian() );
+  EXPECT_FALSE( G.isHermitian() );
+  H(77,77) += complex<double>(0, 1e-9);
+  EXPECT_FALSE( H.isHermitian() );
+  EXPECT_TRUE ( H.isHermitian(1e-8) );
+
+  // Identity:
+  M::Matrix<double> I = A.identity();
+  EXPECT_TRUE ( I.isIdentity() );
+  I(0,149) = 1e-13;
+  EXPECT_FALSE( I.isIdentity() );
+  EXPECT_TRUE ( I.isIdentity(1e-12) );
+  EXPECT_FALSE( A.isIdentity(1e-12) );
+
+  // Orthogonal and unitary factors only hold up to rounding:
+  M::Matrix<double> Q = M::QRDecomposition<double>(A).getQ();
+  M::Matrix<complex<double>> U = M::QRDecomposition<complex<double>>(C).getQ();
+  EXPECT_TRUE ( Q.isOrthogonal(1e-12) );
+  EXPECT_TRUE ( Q.isNormal(1e-12) );
+  EXPECT_FALSE( A.isOrthogonal(1e-12) );
+  EXPECT_TRUE ( U.isUnitary(1e-12) );
+  EXPECT_FALSE( U.isOrthogonal(1e-12) );
+  EXPECT_TRUE ( U.isNormal(1e-12) );
+  EXPECT_FALSE( C.isUnitary(1e-12) );
+
+  // Normal:
+  EXPECT_TRUE ( K.isNormal(1e-12, 1e-12) );
+  EXPECT_TRUE ( G.isNormal(1e-12, 1e-12) );
+  EXPECT_FALSE( A.isNormal(1e-12, 1e-12) );
+  EXPECT_FALSE( C.isNormal(1e-12, 1e-12) );
+
+  // Projection onto the span of Q's first columns:
+  M::Matrix<double> Qk(n, 40);
+  for (uint32_t i=0; i<n; ++i)
+  {
+    for (uint32_t j=0; j<40; ++j)
+    {
+      Qk(i,j) = Q(i,j);
+    }
+  }
+  M::Matrix<double> P = Qk*Qk.transpose();
+  EXPECT_TRUE ( P.isProjection(1e-12) );
+  EXPECT_FALSE( S.isProjection(1e-12) );
+
+  // Polynomials in a matrix commute with it:
+  M::Matrix<double> S2 = S*S + S*2.0;
+  EXPECT_TRUE ( S.commutesWith(S2, 1e-12, 1e-12) );
+  EXPECT_FALSE( S.commutesWith(A, 1e-12, 1e-12) );
+  EXPECT_FALSE( Qk.commutesWith(Qk.transpose()) );
+
+}
+
+// Binary file format (writer, mapped and loaded readers):
+TEST_F(MatrixTest, BinaryFile)
+{
+
+  const string dir = testing::TempDir();
+  const string pathD = dir + "matrix-test-01-d.mat";
+  const string pathF = dir + "matrix-test-01-f.mat";
+  const string pathC = dir + "matrix-test-01-c.mat";
+
+  // CRC-32C check value:
+  EXPECT_EQ( M::crc32c(0, "123456789", 9), 0xE3069283u );
+
+  const uint32_t rows = 301, cols = 17;
+  M::Matrix<double> A(rows, cols);
+  M::Matrix<float> F(rows, cols);
+  M::Matrix<complex<double>> C(rows, cols);
+  for (uint32_t i=0; i<rows; ++i)
+  {
+    for (uint32_t j=0; j<cols; ++j)
+    {
+      A(i,j) = i*1.5 - j*0.25;
+      F(i,j) = float(i) + float(j)/8.0f;
+      C(i,j) = complex<double>(i, -double(j));
+    }
+  }
+
+  // Whole matrices:
+  M::saveMatrix(A, pathD);
+  M::saveMatrix(F, pathF);
+  M::saveMatrix(C, pathC);
+  EXPECT_EQ( M::mapMatrix<double>(pathD), A );
+  EXPECT_EQ( M::loadMatrix<double>(pathD), A );
+  EXPECT_EQ( M::mapMatrix<float>(pathF, true), F );
+  EXPECT_EQ( M::loadMatrix<float>(pathF), F );
+  EXPECT_EQ( M::mapMatrix<complex<double>>(pathC, true), C );
+  EXPECT_TRUE( M::verifyMatrixFile<double>(pathD) );
+
+  // Empty matrix:
+  const string pathE = dir + "matrix-test-01-e.mat";
+  M::saveMatrix(M::Matrix<double>(), pathE);
+  EXPECT_EQ( M::loadMatrix<double>(pathE).getNumRows(), 0u );
+  EXPECT_EQ( M::mapMatrix<double>(pathE).getNumCols(), 0u );
+
+  // Streamed a few rows at a time gives the same file:
+  {
+    M::MatrixFileWriter<double> writer(pathD, rows, cols);
+    for (uint32_t i=0; i<rows; i+=50)
+    {
+      const uint32_t count = min(50u, rows - i);
+      writer.writeRows(A.data() + size_t(i)*cols, count);
+    }
+    EXPECT_EQ( writer.getRowsWritten(), rows );
+    EXPECT_THROW( writer.writeRows(A.data(), 1), logic_error );
+    writer.close();
+  }
+  EXPECT_EQ( M::mapMatrix<double>(pathD, true), A );
+
+  // Writer misuse:
+  {
+    M::MatrixFileWriter<double> writer(pathE, 2, 3);
+    EXPECT_THROW( writer.writeRows(A), logic_error );
+    EXPECT_THROW( writer.close(), logic_error );
+  }
+
+  // Mapped matrices are copy-on-write; copies are independent:
+  {
+    M::Matrix<double> mapped = M::mapMatrix<double>(pathD);
+    M::Matrix<double> copy = mapped;
+    mapped(0,0) = -7.0;
+    EXPECT_EQ( copy(0,0), A(0,0) );
+    EXPECT_EQ( mapped(0,0), -7.0 );
+  }
+  EXPECT_EQ( M::loadMatrix<double>(pathD), A );
+
+  // Wrong element type and missing files:
+  EXPECT_THROW( M::mapMatrix<float>(pathD), runtime_error );
+  EXPECT_THROW( M::loadMatrix<complex<double>>(pathD), runtime_error );
+  EXPECT_THROW( M::loadMatrix<double>(dir + "matrix-test-01-none.mat"), runtime_error );
+
+  // Corrupt one payload byte:
+  {
+    FILE* f = fopen(pathD.c_str(), "r+b");
+    ASSERT_NE( f, nullptr );
+    fseek(f, 64 + 1000, SEEK_SET);
+    const int c = fgetc(f);
+    fseek(f, 64 + 1000, SEEK_SET);
+    fputc(c ^ 0x10, f);
+    fclose(f);
+  }
+  EXPECT_THROW( M::loadMatrix<double>(pathD), runtime_error );
+  EXPECT_THROW( M::mapMatrix<double>(pathD, true), runtime_error );
+  EXPECT_FALSE( M::verifyMatrixFile<double>(pathD) );
+  EXPECT_NO_THROW( M::mapMatrix<double>(pathD) );
+
+  // Corrupt the header:
+  {
+    FILE* f = fopen(pathF.c_str(), "r+b");
+    ASSERT_NE( f, nullptr );
+    fseek(f, 16, SEEK_SET);
+    fputc(0x7F, f);
+    fclose(f);
+  }
+  EXPECT_THROW( M::mapMatrix<float>(pathF), runtime_error );
+
+  // Truncated file:
+  {
+    FILE* f = fopen(pathC.c_str(), "r+b");
+    ASSERT_NE( f, nullptr );
+    ASSERT_EQ( ftruncate(fileno(f), 64 + 100), 0 );
+    fclose(f);
+  }
+  EXPECT_THROW( M::mapMatrix<complex<double>>(pathC), runtime_error );
+
+  // Crafted header with a valid checksum: 2^31 x 2^31 doubles is 2^65 bytes,
+  //  which wraps to zero; 2^32 rows don't fit a Matrix:
+  for (const uint64_t dims : { uint64_t(1) << 31, uint64_t(1) << 32 })
+  {
+    M::saveMatrix(A, pathD);
+    M::MatrixFileHeader header;
+    FILE* f = fopen(pathD.c_str(), "r+b");
+    ASSERT_NE( f, nullptr );
+    ASSERT_EQ( fread(&header, sizeof(header), 1, f), 1u );
+    header.rows = header.cols = dims;
+    header.headerChecksum = 0;
+    header.headerChecksum = M::crc32c(0, &header, sizeof(header));
+    fseek(f, 0, SEEK_SET);
+    ASSERT_EQ( fwrite(&header, sizeof(header), 1, f), 1u );
+    fclose(f);
+    EXPECT_THROW( M::mapMatrix<double>(pathD), runtime_error );
+    EXPECT_THROW( M::loadMatrix<double>(pathD), runtime_error );
+    EXPECT_FALSE( M::verifyMatrixFile<double>(pathD) );
+  }
+  EXPECT_THROW( M::loadMatrix<complex<double>>(pathC), runtime_error );
+
+  remove(pathD.c_str());
+  remove(pathF.c_str());
+  remove(pathC.c_str());
+  remove(pathE.c_str());
+
+}
+
+// Out-of-core multiplication of matrix files:
+TEST_F(MatrixTest, Multiplication_OutOfCore)
+{
+
+  const string dir = testing::TempDir();
+  const string pathA = dir + "matrix-test-01-ooc-a.mat";
+  const string pathB = dir + "matrix-test-01-ooc-b.mat";
+  const string pathC = dir + "matrix-test-01-ooc-c.mat";
+
+  // Small integers keep every product exact, whatever order tiles add up in:
+  const uint32_t m = 157, k = 1100, n = 93;
+  M::Matrix<double> A(m, k), B(k, n);
+  for (uint32_t i=0; i<m; ++i)
+  {
+    for (uint32_t p=0; p<k; ++p)
+    {
+      A(i,p) = double(int((i*7 + p*3) % 11) - 5);
+    }
+  }
+  for (uint32_t p=0; p<k; ++p)
+  {
+    for (uint32_t j=0; j<n; ++j)
+    {
+      B(p,j) = double(int((p*5 + j) % 9) - 4);
+    }
+  }
+  const M::Matrix<double> C = A*B;
+  M::saveMatrix(A, pathA);
+  M::saveMatrix(B, pathB);
+
+  // Everything fits: one tile, full depth:
+  M::OutOfCoreStats stats = M::multiplyOutOfCore<double>(pathA, pathB, pathC);
+  EXPECT_EQ( stats.tileRows, m );
+  EXPECT_EQ( stats.tileCols, n );
+  EXPECT_EQ( stats.tileDepth, k );
+  EXPECT_EQ( M::mapMatrix<double>(pathC, true), C );
+
+  // Budgets forcing row tiles, column tiles and split depths:
+  const size_t budgets[] = { 64u << 10, 16u << 10, 6u << 10 };
+  for (size_t budget : budgets)
+  {
+    stats = M::multiplyOutOfCore<double>(pathA, pathB, pathC, budget);
+    EXPECT_LE( stats.bufferBytes, budget );
+    EXPECT_EQ( stats.bytesWritten, uint64_t(m)*n*sizeof(double) );
+    EXPECT_TRUE( M::verifyMatrixFile<double>(pathC) );
+    EXPECT_EQ( M::loadMatrix<double>(pathC), C );
+  }
+  EXPECT_LT( stats.tileCols, n );
+  EXPECT_LT( stats.tileDepth, k );
+
+  // Complex entries, column-tiled output:
+  M::Matrix<complex<double>> Z(40, 30), W(30, 50);
+  for (uint32_t i=0; i<40; ++i)
+  {
+    for (uint32_t j=0; j<30; ++j)
+    {
+      Z(i,j) = complex<double>(double(int(i) - int(j)), double((i + 2*j) % 5));
+      W(j,i) = complex<double>(double((i*j) % 7), -double(j));
+    }
+  }
+  for (uint32_t i=0; i<30; ++i)
+  {
+    for (uint32_t j=40; j<50; ++j)
+    {
+      W(i,j) = complex<double>(1.0, double(j));
+    }
+  }
+  M::saveMatrix(Z, pathA);
+  M::saveMatrix(W, pathB);
+  stats = M::multiplyOutOfCore<complex<double>>(pathA, pathB, pathC, 8u << 10);
+  EXPECT_LT( stats.tileCols, 50u );
+  EXPECT_EQ( M::mapMatrix<complex<double>>(pathC, true), Z*W );
+
+  // Misuse:
+  EXPECT_THROW( M::multiplyOutOfCore<complex<double>>(pathA, pathA, pathC), logic_error );
+  EXPECT_THROW( M::multiplyOutOfCore<complex<double>>(pathA, pathB, pathA), logic_error );
+  EXPECT_THROW( M::multiplyOutOfCore<complex<double>>(pathA, pathB, pathC, 16), logic_error );
+  EXPECT_THROW( M::multiplyOutOfCore<double>(pathA, pathB, pathC), runtime_error );
+
+  remove(pathA.c_str());
+  remove(pathB.c_str());
+  remove(pathC.c_str());
+
+}
+
+// Products accumulated in a wider type than the elements:
+TEST_F(MatrixTest, Multiplication_MixedPrecision)
+{
+
+  // Float sums lose the 1 next to 1e8; double ones keep it:
+  const M::Matrix<float> a = { { 1e8f, 1.0f, -1e8f } };
+  const M::Matrix<float> b = { { 1.0f }, { 1.0f }, { 1.0f } };
+  EXPECT_EQ( (a*b)(0,0), 0.0f );
+  EXPECT_EQ( M::multiplyAccumulate<double>(a, b)(0,0), 1.0 );
+
+  // Sizes past one block, against the same product done in double:
+  const uint32_t m = 37, k = 600, n = 29;
+  M::Matrix<float> A(m, k), B(k, n);
+  M::Matrix<double> Ad(m, k), Bd(k, n);
+  for (uint32_t i=0; i<m; ++i)
+  {
+    for (uint32_t p=0; p<k; ++p)
+    {
+      A(i,p) = float(std::sin(0.37*i + 0.011*p));
+      Ad(i,p) = A(i,p);
+    }
+  }
+  for (uint32_t p=0; p<k; ++p)
+  {
+    for (uint32_t j=0; j<n; ++j)
+    {
+      B(p,j) = float(std::cos(0.23*j - 0.017*p));
+      Bd(p,j) = B(p,j);
+    }
+  }
+  const M::Matrix<double> C = M::multiplyAccumulate<double>(A, B);
+  EXPECT_EQ( C.getNumRows(), m );
+  EXPECT_EQ( C.getNumCols(), n );
+  EXPECT_LT( M::Matrix<double>(C - Ad*Bd).maxNorm(), 1e-12 );
+
+  // Integers that overflow int sum fine in long long:
+  const M::Matrix<int> I = { { 100000, 100000 }, { 100000, -100000 } };
+  const M::Matrix<long long> J = M::multiplyAccumulate<long long>(I, I);
+  EXPECT_EQ( J(0,0), 20000000000LL );
+  EXPECT_EQ( J(0,1), 0LL );
+
+  EXPECT_THROW( M::multiplyAccumulate<double>(A, A), logic_error );
+
+}
+
+// int8/int16 quantized products with per-row and per-column scales:
+TEST_F(MatrixTest, Multiplication_Quantized)
+{
+
+  // Quantization: values within [-levels, levels], dequantized within half a step:
+  M::Matrix<float> X(5, 9);
+  for (uint32_t i=0; i<5; ++i)
+  {
+    for (uint32_t j=0; j<9; ++j)
+    {
+      X(i,j) = (i == 3) ? 0.0f : float(std::sin(1.3*i + 0.7*j))*float(i + 1);
+    }
+  }
+  const M::QuantizedMatrix<int8_t> QX(X, M::quantizeRows);
+  EXPECT_EQ( QX.getNumRows(), 5u );
+  EXPECT_EQ( QX.getNumCols(), 9u );
+  EXPECT_EQ( QX.getLevels(), 127 );
+  EXPECT_EQ( QX.getScales().size(), 5u );
+  EXPECT_EQ( QX.getScales()[3], 1.0f );
+  const M::Matrix<float> DX = QX.dequantize();
+  for (uint32_t i=0; i<5; ++i)
+  {
+    for (uint32_t j=0; j<9; ++j)
+    {
+      EXPECT_LE( abs(int(QX(i,j))), 127 );
+      EXPECT_LE( std::abs(DX(i,j) - X(i,j)), 0.5f*QX.getScales()[i]*1.0001f );
+    }
+  }
+  EXPECT_EQ( M::QuantizedMatrix<int16_t>(X, M::quantizeColumns).getScales().size(), 9u );
+  EXPECT_THROW( QX(5, 0), out_of_range );
+  EXPECT_THROW( M::QuantizedMatrix<int8_t>(X, M::quantizeRows, 0), logic_error );
+  EXPECT_THROW( M::QuantizedMatrix<int8_t>(X, M::quantizeRows, 128), logic_error );
+
+  // Products against the exact sum of scaled integer products, on every kernel:
+  auto check = [](const auto& QA, const auto& QB) {
+    const M::Matrix<float> C = M::quantizedMultiply(QA, QB);
+    ASSERT_EQ( C.getNumRows(), QA.getNumRows() );
+    ASSERT_EQ( C.getNumCols(), QB.getNumCols() );
+    for (uint32_t i=0; i<QA.getNumRows(); ++i)
+    {
+      for (uint32_t j=0; j<QB.getNumCols(); ++j)
+      {
+        double sum = 0.0, size = 0.0;
+        for (uint32_t p=0; p<QA.getNumCols(); ++p)
+        {
+          const double term = double(QA.getScales()[i])*QB.getScales()[j]*QA(i,p)*QB(p,j);
+          sum += term;
+          size += std::abs(term);
+        }
+        ASSERT_LE( std::abs(C(i,j) - sum), 1e-5*size + 1e-30 );
+      }
+    }
+  };
+
+  const M::SimdLevel detected = M::simdLevel();
+  const uint32_t shapes[][3] = { {1, 1, 1}, {6, 32, 16}, {37, 103, 45}, {13, 1300, 70} };
+  for (const M::SimdLevel level : { detected, M::simdAvx2, M::simdScalar })
+  {
+    M::setSimdLevel(level);
+    for (const auto& shape : shapes)
+    {
+      M::Matrix<double> A(shape[0], shape[1]), B(shape[1], shape[2]);
+      for (uint32_t i=0; i<shape[0]; ++i)
+      {
+        for (uint32_t p=0; p<shape[1]; ++p)
+        {
+          A(i,p) = std::sin(0.37*i + 0.011*p + 0.5) + ((p % 17 == 0) ? 2.0 : 0.0);
+        }
+      }
+      for (uint32_t p=0; p<shape[1]; ++p)
+      {
+        for (uint32_t j=0; j<shape[2]; ++j)
+        {
+          B(p,j) = std::cos(0.23*j - 0.017*p) - ((p % 13 == 0) ? 1.5 : 0.0);
+        }
+      }
+
+      check(M::QuantizedMatrix<int8_t>(A, M::quantizeRows), M::QuantizedMatrix<int8_t>(B, M::quantizeColumns));
+      check(M::QuantizedMatrix<int16_t>(A, M::quantizeRows), M::QuantizedMatrix<int16_t>(B, M::quantizeColumns));
+      check(M::QuantizedMatrix<int16_t>(A, M::quantizeRows, 32767), M::QuantizedMatrix<int16_t>(B, M::quantizeColumns, 32767));
+
+      // Close to the unquantized product:
+      const M::Matrix<float> C = M::quantizedMultiply(M::QuantizedMatrix<int8_t>(A, M::quantizeRows),
+                                                      M::QuantizedMatrix<int8_t>(B, M::quantizeColumns));
+      const M::Matrix<double> exact = A*B;
+      for (uint32_t i=0; i<shape[0]; ++i)
+      {
+        for (uint32_t j=0; j<shape[2]; ++j)
+        {
+          EXPECT_LT( std::abs(C(i,j) - exact(i,j)), 0.05*std::sqrt(double(shape[1])) );
+        }
+      }
+    }
+  }
+  M::setSimdLevel(detected);
+
+  // Misuse:
+  const M::QuantizedMatrix<int8_t> R(X, M::quantizeRows), S(X.transpose(), M::quantizeColumns);
+  EXPECT_EQ( M::quantizedMultiply(R, S).getNumRows(), 5u );
+  EXPECT_THROW( M::quantizedMultiply(S, R), logic_error );
+  EXPECT_THROW( M::quantizedMultiply(R, M::QuantizedMatrix<int8_t>(X.transpose(), M::quantizeRows)), logic_error );
+  EXPECT_THROW( M::quantizedMultiply(R, M::QuantizedMatrix<int8_t>(X, M::quantizeColumns)), logic_error );
+
+}
+
+TEST_F(MatrixTest, Views)
+{
+
+  M::Matrix<double> A(9, 7);
+  for (uint32_t i=0; i<9; ++i)
+    for (uint32_t j=0; j<7; ++j)
+      A(i,j) = 10*i + j;
+  const M::Matrix<double> original = A;
+
+  // Accessors look into the matrix:
+  const M::ConstMatrixView<double> B = original.block(2, 1, 4, 3);
+  EXPECT_EQ( B.getNumRows(), 4u );
+  EXPECT_EQ( B.getNumCols(), 3u );
+  EXPECT_EQ( B(3, 2), 53.0 );
+  EXPECT_EQ( B.data(), &original(2, 1) );
+  EXPECT_EQ( original.row(4)(0, 6), 46.0 );
+  EXPECT_EQ( original.column(5)(8, 0), 85.0 );
+  EXPECT_EQ( original.diagonal().getNumRows(), 7u );
+  EXPECT_EQ( original.diagonal()(6, 0), 66.0 );
+  EXPECT_EQ( original.slice(1, 0, 3, 4, 3, 2)(2, 3), 76.0 );
+  EXPECT_EQ( B.transpose()(2, 3), 53.0 );
+  EXPECT_EQ( B.block(1, 1, 2, 2)(1, 1), 43.0 );
+  EXPECT_EQ( M::Matrix<double>(B.transpose()), M::Matrix<double>(B).transpose() );
+  EXPECT_TRUE( original.view().isPacked() );
+  EXPECT_FALSE( B.isPacked() );
+  EXPECT_EQ( B.eval(), M::Matrix<double>(B) );
+  EXPECT_EQ( B.eval().rowSums(), M::Matrix<double>(B).rowSums() );
+  EXPECT_EQ( (B*2.0).eval().frobeniusNorm(), 2*M::Matrix<double>(B).frobeniusNorm() );
+
+  EXPECT_THROW( B(4, 0), out_of_range );
+  EXPECT_THROW( original.block(6, 0, 4, 1), out_of_range );
+  EXPECT_THROW( original.row(9), out_of_range );
+  EXPECT_THROW( original.slice(0, 0, 4, 1, 3, 1), out_of_range );
+  EXPECT_THROW( original.slice(0, 0, 2, 2, 0, 1), logic_error );
+  EXPECT_NO_THROW( original.block(9, 7, 0, 0) );
+
+  // Writes go through to the matrix:
+  A.row(0) = 1.0;
+  A.column(6) *= 2.0;
+  A.diagonal() += 100.0;
+  EXPECT_EQ( A(0, 3), 1.0 );
+  EXPECT_EQ( A(0, 6), 2.0 );
+  EXPECT_EQ( A(5, 6), 112.0 );
+  EXPECT_EQ( A(3, 3), 133.0 );
+  A.block(2, 1, 4, 3)(0, 0) = -1;
+  EXPECT_EQ( A(2, 1), -1.0 );
+
+  // Expressions mix views and matrices:
+  A = original;
+  M::Matrix<double> C = B*2.0 - B.transpose().transpose() + original.block(0, 0, 4, 3);
+  EXPECT_EQ( C, M::Matrix<double>(M::Matrix<double>(B) + original.block(0, 0, 4, 3)) );
+  A.block(0, 4, 3, 3) = original.block(6, 0, 3, 3) + original.block(0, 0, 3, 3).transpose();
+  EXPECT_EQ( A(1, 5), 71.0 + 11.0 );
+  EXPECT_THROW( A.block(0, 0, 2, 2) = original.block(0, 0, 3, 2), logic_error );
+  EXPECT_THROW( A.row(0) += original.column(0), logic_error );
+
+  // Assignments reading the view's own memory elsewhere:
+  A = original;
+  A.block(0, 0, 6, 6) = A.block(1, 1, 6, 6);
+  EXPECT_EQ( M::Matrix<double>(A.block(0, 0, 6, 6)), M::Matrix<double>(original.block(1, 1, 6, 6)) );
+  A = original;
+  A.block(1, 1, 6, 6) += A.block(0, 0, 6, 6);
+  EXPECT_EQ( A(6, 6), 66.0 + 55.0 );
+  M::Matrix<double> S = original.block(0, 0, 7, 7);
+  S = S.view().transpose();
+  EXPECT_EQ( S, M::Matrix<double>(original.block(0, 0, 7, 7)).transpose() );
+  M::Matrix<double> T = original.block(0, 0, 7, 7);
+  T.view() = T.view().transpose() + T;
+  EXPECT_EQ( T(1, 2), 12.0 + 21.0 );
+
+  // Products against copies (strided, transposed and sliced operands):
+  const M::ConstMatrixView<double> L = original.slice(0, 1, 3, 5, 2, 1), R = original.block(2, 0, 5, 7).transpose();
+  EXPECT_EQ( L*R.transpose(), M::Matrix<double>(L)*M::Matrix<double>(R.transpose()) );
+  EXPECT_EQ( L*original.block(0, 0, 5, 2), M::Matrix<double>(L)*M::Matrix<double>(original.block(0, 0, 5, 2)) );
+  EXPECT_EQ( original.block(0, 0, 2, 7)*original.block(0, 0, 7, 3), M::Matrix<double>(original.block(0, 0, 2, 7))*M::Matrix<double>(original.block(0, 0, 7, 3)) );
+  M::Matrix<double> square = original.block(0, 0, 7, 7);
+  EXPECT_EQ( square*original.block(1, 0, 7, 7), square*M::Matrix<double>(original.block(1, 0, 7, 7)) );
+  EXPECT_THROW( L*L, logic_error );
+  const vector<double> x = { 1, -2, 3, 0.5, 2 };
+  EXPECT_EQ( L*x, M::Matrix<double>(L)*x );
+  EXPECT_EQ( original.block(0, 0, 5, 3).transpose()*x, M::Matrix<double>(original.block(0, 0, 5, 3).transpose())*x );
+  EXPECT_EQ( original.slice(0, 0, 3, 5, 3, 1).transpose().slice(0, 0, 5, 3, 1, 1).transpose()*x, M::Matrix<double>(original.slice(0, 0, 3, 5, 3, 1))*x );
+
+  // Blocked updates in place:
+  M::Matrix<double> D = original;
+  D.block(0, 0, 3, 3).multiplyAdd(original.block(0, 0, 3, 4), original.block(3, 3, 4, 3), -1.0, 1.0);
+  EXPECT_EQ( M::Matrix<double>(D.block(0, 0, 3, 3)),
+             M::Matrix<double>(original.block(0, 0, 3, 3)) - M::Matrix<double>(original.block(0, 0, 3, 4))*M::Matrix<double>(original.block(3, 3, 4, 3)) );
+  D = original;
+  D.block(1, 1, 3, 3).transpose().multiplyAdd(D.block(0, 0, 3, 3), D.block(0, 0, 3, 3));
+  EXPECT_EQ( M::Matrix<double>(D.block(1, 1, 3, 3)),
+             (M::Matrix<double>(original.block(0, 0, 3, 3))*M::Matrix<double>(original.block(0, 0, 3, 3))).transpose() );
+
+  // Reductions in place match copies (packed, row runs, column runs and gathered):
+  M::Matrix<double> W(40, 37);
+  for (uint32_t i=0; i<40; ++i)
+    for (uint32_t j=0; j<37; ++j)
+      W(i,j) = std::sin(0.3*i + 0.7*j) - 0.1*j;
+  const M::ConstMatrixView<double> views[] = { W.view(), W.block(3, 2, 30, 20), W.block(3, 2, 30, 20).transpose(),
+                                               W.slice(1, 0, 12, 9, 3, 4), W.block(0, 5, 40, 3), W.row(7), W.column(30) };
+  for (const M::ConstMatrixView<double>& V : views)
+  {
+    const M::Matrix<double> copy(V);
+    EXPECT_NEAR( V.sum(), copy.sum(), 1e-12 );
+    EXPECT_NEAR( V.mean(M::summationKahan), copy.mean(M::summationKahan), 1e-14 );
+    EXPECT_NEAR( V.trace(), copy.trace(), 1e-12 );
+    EXPECT_NEAR( V.frobeniusNorm(), copy.frobeniusNorm(), 1e-12 );
+    EXPECT_EQ( V.maxNorm(), copy.maxNorm() );
+    EXPECT_NEAR( V.p1Norm(), copy.p1Norm(), 1e-12 );
+    EXPECT_NEAR( V.pInfNorm(), copy.pInfNorm(), 1e-12 );
+    const vector<double> rs = V.rowSums(), cs = V.columnSums(), rn = V.rowNorms(M::vectorNormInf), cn = V.columnNorms();
+    const vector<double> crs = copy.rowSums(), ccs = copy.columnSums(), crn = copy.rowNorms(M::vectorNormInf), ccn = copy.columnNorms();
+    for (size_t i=0; i<rs.size(); ++i)
+    {
+      EXPECT_NEAR( rs[i], crs[i], 1e-12 );
+      EXPECT_EQ( rn[i], crn[i] );
+    }
+    for (size_t j=0; j<cs.size(); ++j)
+    {
+      EXPECT_NEAR( cs[j], ccs[j], 1e-12 );
+      EXPECT_NEAR( cn[j], ccn[j], 1e-12 );
+    }
+  }
+  EXPECT_THROW( W.block(0, 0, 0, 3).mean(), logic_error );
+
+  // Factorizations take views:
+  M::Matrix<double> G(8, 8);
+  for (uint32_t i=0; i<8; ++i)
+    for (uint32_t j=0; j<8; ++j)
+      G(i,j) = double((i*5 + j*3) % 7) + ((i == j) ? 20.0 : 0.0);
+  const M::ConstMatrixView<double> Gb = G.block(1, 1, 6, 6), rhs = G.block(0, 6, 6, 2);
+  const M::Matrix<double> Gc(Gb);
+  EXPECT_LT( M::Matrix<double>(Gb.solve(rhs) - Gc.solve(M::Matrix<double>(rhs))).maxNorm(), 1e-12 );
+  EXPECT_LT( M::Matrix<double>(Gb.transpose().inverse() - Gc.transpose().inverse()).maxNorm(), 1e-12 );
+  EXPECT_NEAR( Gb.determinant(), Gc.determinant(), 1e-6*std::abs(Gc.determinant()) );
+  EXPECT_LT( M::Matrix<double>(M::LUDecomposition<double>(Gb).solve(M::Matrix<double>(rhs)) - Gc.solve(M::Matrix<double>(rhs))).maxNorm(), 1e-12 );
+
+  // Complex views:
+  M::Matrix<complex<double>> Z(3, 4);
+  for (uint32_t i=0; i<3; ++i)
+    for (uint32_t j=0; j<4; ++j)
+      Z(i,j) = complex<double>(i, j);
+  Z.column(1) += Z.column(2);
+  EXPECT_EQ( Z(2, 1), complex<double>(4, 3) );
+  EXPECT_EQ( Z.view().transpose().sum(), M::Matrix<complex<double>>(Z).sum() );
+
+}
+
+TEST_F(MatrixTest, TextFormatting)
+{
+
+  // Layout: pad, each element followed by a space, one row per line:
+  M::Matrix<double> A = { {1, 0.1},
+                          {-2.5, 1e-7}
+                        };
+  A.setPad("  ");
+  ostringstream plain;
+  plain << A;
+  EXPECT_EQ( plain.str(), "  1 0.1 \n  -2.5 1e-07 \n" );
+
+  // Fixed and scientific streams keep their precision:
+  ostringstream fixedOut, scientificOut;
+  fixedOut << fixed << setprecision(2) << A;
+  scientificOut << scientific << setprecision(1) << M::Matrix<double>(1, 1, 1234.0);
+  EXPECT_EQ( fixedOut.str(), "  1.00 0.10 \n  -2.50 0.00 \n" );
+  EXPECT_EQ( scientificOut.str(), "1.2e+03 \n" );
+
+  // Longer than the number buffer: %f of 1e300, %e at a long precision:
+  char expected[1000];
+  ostringstream hugeFixed, longScientific;
+  hugeFixed << fixed << setprecision(2) << M::Matrix<double>(1, 2, 1e300);
+  snprintf(expected, sizeof(expected), "%.2f %.2f \n", 1e300, 1e300);
+  EXPECT_EQ( hugeFixed.str(), expected );
+  longScientific << scientific << setprecision(90) << M::Matrix<double>(1, 1, 0.1);
+  snprintf(expected, sizeof(expected), "%.90e \n", 0.1);
+  EXPECT_EQ( longScientific.str(), expected );
+
+  // Integers, complex numbers, zeros and non-finite values:
+  ostringstream other;
+  other << M::Matrix<int>(1, 2, -42) << M::Matrix<complex<double>>(1, 1, complex<double>(1.5, -2))
+        << M::Matrix<double>({ { -0.0, 1e300, numeric_limits<double>::infinity(), 123456789012.0 } });
+  EXPECT_EQ( other.str(), "-42 -42 \n(1.5,-2) \n-0 1e+300 inf 123456789012 \n" );
+
+  // Shortest forms that read back exactly:
+  M::Matrix<double> D(1, 2000);
+  M::Matrix<float> F(1, 2000);
+  for (uint32_t j=0; j<2000; ++j)
+  {
+    D(0, j) = std::sin(j*0.7 + 0.1)*std::pow(10.0, int(j % 41) - 20);
+    F(0, j) = float(D(0, j));
+  }
+  D(0, 0) = 0.1;
+  D(0, 1) = 5e-324;
+  D(0, 2) = numeric_limits<double>::max();
+  ostringstream dText, fText;
+  dText << D;
+  fText << F;
+  EXPECT_EQ( dText.str().substr(0, 8), "0.1 5e-3" );
+  istringstream dIn(dText.str()), fIn(fText.str());
+  string token;
+  for (uint32_t j=0; j<2000; ++j)
+  {
+    dIn >> token;
+    EXPECT_EQ( std::strtod(token.c_str(), nullptr), D(0, j) );
+    EXPECT_LE( token.size(), 24u );
+    fIn >> token;
+    EXPECT_EQ( std::strtof(token.c_str(), nullptr), F(0, j) );
+    EXPECT_LE( token.size(), 15u );
+  }
+
+  // Normal values print exactly as the first of %.15g, %.16g, %.17g that reads back
+  //  (near-ties between two neighbours that both read back included):
+  const auto printfShortest = [](double x) {
+    char text[64];
+    for (int digits=15; digits<=17; ++digits)
+    {
+      snprintf(text, sizeof(text), "%.*g", digits, x);
+      if ( std::strtod(text, nullptr) == x )
+      {
+        break;
+      }
+    }
+    return string(text);
+  };
+  M::Matrix<double> R(1, 20000);
+  uint64_t bits = 42;
+  for (uint32_t j=0; j<R.getNumCols(); ++j)
+  {
+    do
+    {
+      bits = bits*6364136223846793005ull + 1442695040888963407ull;
+      std::memcpy(&R(0, j), &bits, sizeof(double));
+    } while ( std::fpclassify(R(0, j)) != FP_NORMAL );
+  }
+  R(0, 0) = 0.07196275350033148;
+  R(0, 1) = 107915819972370.0;
+  R(0, 2) = 1524.7649198310773;
+  ostringstream rText;
+  rText << R;
+  istringstream rIn(rText.str());
+  for (uint32_t j=0; j<R.getNumCols(); ++j)
+  {
+    rIn >> token;
+    EXPECT_EQ( token, printfShortest(R(0, j)) );
+  }
+
+}
+
+
+TEST_F(MatrixTest, TextFiles)
+{
+
+  const string dir = testing::TempDir();
+  const string path = dir + "matrix-test-01.txt";
+  const auto writeText = [&](const string& text) {
+    FILE* f = fopen(path.c_str(), "wb");
+    ASSERT_NE( f, nullptr );
+    fwrite(text.data(), 1, text.size(), f);
+    fclose(f);
+  };
+
+  // Round trips large enough to be parsed in several chunks:
+  const uint32_t rows = 513, cols = 301;
+  M::Matrix<double> A(rows, cols);
+  M::Matrix<float> F(rows, cols);
+  M::Matrix<int64_t> I(rows, cols);
+  M::Matrix<complex<double>> Z(67, 45);
+  for (uint32_t i=0; i<rows; ++i)
+  {
+    for (uint32_t j=0; j<cols; ++j)
+    {
+      A(i,j) = std::sin(0.37*i + 1.1*j)*std::pow(10.0, int((i + j) % 13) - 6);
+      F(i,j) = float(std::cos(0.1*i - 0.3*j));
+      I(i,j) = (int64_t(i) - 200)*int64_t(j)*1000003;
+      if ( (i < 67) && (j < 45) )
+      {
+        Z(i,j) = complex<double>(A(i,j), -1.0/(1.0 + j));
+      }
+    }
+  }
+  I(0, 0) = numeric_limits<int64_t>::min();
+
+  M::saveMatrixMarket(A, path);
+  EXPECT_EQ( M::loadMatrixMarket<double>(path), A );
+  M::saveCsv(A, path);
+  EXPECT_EQ( M::loadCsv<double>(path), A );
+  M::saveMatrixMarket(F, path);
+  EXPECT_EQ( M::loadMatrixMarket<float>(path), F );
+  M::saveCsv(F, path, ';');
+  EXPECT_EQ( M::loadCsv<float>(path, ';'), F );
+  M::saveMatrixMarket(I, path);
+  EXPECT_EQ( M::loadMatrixMarket<int64_t>(path), I );
+  M::saveCsv(I, path, '\t');
+  EXPECT_EQ( M::loadCsv<int64_t>(path, '\t'), I );
+  M::saveMatrixMarket(Z, path);
+  EXPECT_EQ( M::loadMatrixMarket<complex<double>>(path), Z );
+  M::saveMatrixMarket(A.block(1, 2, 30, 7).transpose()*M::Matrix<double>(30, 3, 1.0), path);
+  EXPECT_EQ( M::loadMatrixMarket<double>(path).getNumRows(), 7u );
+  M::saveCsv(M::Matrix<double>(), path);
+  EXPECT_EQ( M::loadCsv<double>(path).getNumRows(), 0u );
+
+  // Hand-written Matrix Market files:
+  writeText("%%MatrixMarket matrix coordinate real general\n% comment\n\n3 4 3\n1 1 2.5\n3 4 -1e2\n  2 1 7\n");
+  EXPECT_EQ( M::loadMatrixMarket<double>(path), M::Matrix<double>({ {2.5, 0, 0, 0}, {7, 0, 0, 0}, {0, 0, 0, -100} }) );
+  writeText("%%MatrixMarket matrix coordinate integer symmetric\n3 3 2\n2 1 4\n3 3 -6\n");
+  EXPECT_EQ( M::loadMatrixMarket<int>(path), M::Matrix<int>({ {0, 4, 0}, {4, 0, 0}, {0, 0, -6} }) );
+  writeText("%%MatrixMarket matrix coordinate pattern general\n2 2 2\n1 2\n2 1\n");
+  EXPECT_EQ( M::loadMatrixMarket<double>(path), M::Matrix<double>({ {0, 1}, {1, 0} }) );
+  writeText("%%MatrixMarket matrix coordinate complex hermitian\r\n2 2 2\r\n1 1 3 0\r\n2 1 1 2\r\n");
+  EXPECT_EQ( M::loadMatrixMarket<complex<double>>(path),
+             M::Matrix<complex<double>>({ {3.0, complex<double>(1, -2)}, {complex<double>(1, 2), 0.0} }) );
+  writeText("%%MatrixMarket matrix array real skew-symmetric\n3 3\n1\n2\n3\n");
+  EXPECT_EQ( M::loadMatrixMarket<double>(path), M::Matrix<double>({ {0, -1, -2}, {1, 0, -3}, {2, 3, 0} }) );
+  writeText("%%MatrixMarket matrix array real symmetric\n2 2\n1 2\n3\n");
+  EXPECT_EQ( M::loadMatrixMarket<float>(path), M::Matrix<float>({ {1, 2}, {2, 3} }) );
+  writeText("%%MATRIXMARKET MATRIX ARRAY REAL GENERAL\n2 3\n1 2 3 4 5 6\n");
+  EXPECT_EQ( M::loadMatrixMarket<double>(path), M::Matrix<double>({ {1, 3, 5}, {2, 4, 6} }) );
+  writeText("%%MatrixMarket matrix array real general\n1 3\n0.30000000000000004 1e400 -inf\n");
+  const M::Matrix<double> B = M::loadMatrixMarket<double>(path);
+  EXPECT_EQ( B(0, 0), 0.30000000000000004 );
+  EXPECT_EQ( B(0, 1), numeric_limits<double>::infinity() );
+  EXPECT_EQ( B(0, 2), -numeric_limits<double>::infinity() );
+
+  // Hand-written CSV (BOM, spaces, blank lines, CRLF):
+  writeText("\xEF\xBB\xBF" "1, 2 ,3\r\n\n 4,5e-1,  -6 \r\n\n");
+  EXPECT_EQ( M::loadCsv<double>(path), M::Matrix<double>({ {1, 2, 3}, {4, 0.5, -6} }) );
+
+  // Malformed files:
+  const char* badMarket[] = {
+    "%%MatrixMarket matrix array real general\n2 2\n1 2 3\n",                // too few entries
+    "%%MatrixMarket matrix array real general\n1 2\n1 x\n",                  // not a number
+    "%%MatrixMarket matrix coordinate real general\n2 2 1\n3 1 1\n",         // out of range
+    "%%MatrixMarket matrix coordinate real general\n2 2 2\n1 1 1\n",         // missing entries
+    "%%MatrixMarket matrix coordinate real symmetric\n2 2 1\n1 2 1\n",       // upper triangle
+    "%%MatrixMarket matrix array real symmetric\n2 3\n1 2 3\n",              // not square
+    "%%MatrixMarket matrix array complex general\n1 1\n1 2\n",               // complex into real
+    "%%MatrixMarket vector array real general\n1 1\n1\n",                    // not a matrix
+    "%%MatrixMarket matrix array real general\n1\n1\n"                       // bad size line
+  };
+  for (const char* text : badMarket)
+  {
+    writeText(text);
+    EXPECT_THROW( M::loadMatrixMarket<double>(path), runtime_error ) << text;
+  }
+  writeText("%%MatrixMarket matrix array real general\n1 1\n1.5\n");
+  EXPECT_THROW( M::loadMatrixMarket<int>(path), runtime_error );
+  writeText("%%MatrixMarket matrix array integer general\n1 1\n3000000000\n");
+  EXPECT_THROW( M::loadMatrixMarket<int>(path), runtime_error );
+  writeText("1,2,3\n4,5\n");
+  EXPECT_THROW( M::loadCsv<double>(path), runtime_error );
+  writeText("1,2\n4,5,6\n");
+  EXPECT_THROW( M::loadCsv<double>(path), runtime_error );
+  writeText("1,2\n4,five\n");
+  EXPECT_THROW( M::loadCsv<double>(path), runtime_error );
+  EXPECT_THROW( M::loadCsv<double>(dir + "matrix-test-01-missing.csv"), runtime_error );
+
+  remove(path.c_str());
+
+}
+
+TEST_F(MatrixTest, IteratorsAndRows)
+{
+
+  // Element iterators (row-major) with <algorithm>/<numeric>:
+  M::Matrix<double> A(3, 4);
+  iota(A.begin(), A.end(), 0.0);
+  EXPECT_EQ( A.end() - A.begin(), 12 );
+  EXPECT_EQ( A(2, 1), 9.0 );
+  EXPECT_EQ( accumulate(A.cbegin(), A.cend(), 0.0), 66.0 );
+  sort(A.begin(), A.end(), greater<double>());
+  EXPECT_EQ( A(0, 0), 11.0 );
+  EXPECT_EQ( A(2, 3), 0.0 );
+  transform(A.begin(), A.end(), A.begin(), [](double x) { return 2*x; });
+  EXPECT_EQ( *max_element(A.begin(), A.end()), 22.0 );
+
+  // Unchecked row pointers and spans:
+  const M::Matrix<double>& C = A;
+  EXPECT_EQ( A.rowPtr(1), A.data() + A.getLeadingDim() );
+  EXPECT_EQ( C.rowPtr(2)[0], 6.0 );
+  A.rowPtr(2)[3] = -1;
+  EXPECT_EQ( A(2, 3), -1.0 );
+  M::RowSpan<double> r = A.rowSpan(1);
+  M::RowSpan<const double> cr = r;
+  EXPECT_EQ( r.size(), 4u );
+  EXPECT_EQ( cr[0], 14.0 );
+  EXPECT_EQ( accumulate(cr.begin(), cr.end(), 0.0), 14.0 + 12 + 10 + 8 );
+  fill(r.begin(), r.end(), 5.0);
+  EXPECT_EQ( C.rowSpan(1).at(3), 5.0 );
+  EXPECT_THROW( r.at(4), out_of_range );
+  EXPECT_TRUE( M::RowSpan<double>().empty() );
+
+  // Checked access:
+  EXPECT_EQ( A.at(1, 2), 5.0 );
+  EXPECT_EQ( C.at(0, 0), 22.0 );
+  EXPECT_THROW( A.at(3, 0), out_of_range );
+  EXPECT_THROW( C.at(0, 4), out_of_range );
+
+  // Row iterators are random access:
+  static_assert( is_same<iterator_traits<M::RowIterator<double>>::iterator_category, random_access_iterator_tag>::value,
+                 "RowIterator must be random access" );
+  M::RowRange<double> rows = A.rows();
+  EXPECT_EQ( rows.size(), 3u );
+  EXPECT_EQ( rows.end() - rows.begin(), 3 );
+  EXPECT_EQ( distance(C.rows().begin(), C.rows().end()), 3 );
+  M::RowIterator<double> it = rows.begin();
+  EXPECT_EQ( (*(it + 2)).size(), 4u );
+  EXPECT_EQ( it[2][0], 6.0 );
+  EXPECT_EQ( (2 + it)[0].data(), A.rowPtr(2) );
+  EXPECT_EQ( (rows.end() - 1)[0][3], -1.0 );
+  EXPECT_TRUE( (it < rows.end()) && (rows.end() > it) && (it <= it) && (it >= it) );
+  M::RowIterator<const double> cit = it;
+  EXPECT_EQ( (*++cit)[0], 5.0 );
+
+  for (M::RowSpan<double> row : A.rows())
+  {
+    transform(row.begin(), row.end(), row.begin(), [](double x) { return x + 1; });
+  }
+  for_each(A.rows().begin(), A.rows().end(), [](M::RowSpan<double> row) { row[0] = accumulate(row.begin(), row.end(), 0.0); });
+  EXPECT_EQ( A(0, 0), 23.0 + 21 + 19 + 17 );
+  EXPECT_EQ( A(1, 0), 24.0 );
+  EXPECT_EQ( A(2, 0), 7.0 + 5 + 3 + 0 );
+  const auto found = find_if(C.rows().begin(), C.rows().end(), [](M::RowSpan<const double> row) { return row[1] == 6.0; });
+  EXPECT_EQ( found - C.rows().begin(), 1 );
+
+  // Empty matrices and complex elements:
+  M::Matrix<double> E;
+  EXPECT_EQ( E.begin(), E.end() );
+  EXPECT_TRUE( E.rows().empty() );
+  M::Matrix<complex<double>> Z(2, 2, complex<double>(1, 2));
+  transform(Z.begin(), Z.end(), Z.begin(), [](const complex<double>& z) { return conj(z); });
+  EXPECT_EQ( Z, M::Matrix<complex<double>>(2, 2, complex<double>(1, -2)) );
+
 }
 
 } // anon namepace 
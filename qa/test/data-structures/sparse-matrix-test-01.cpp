@@ -0,0 +1,302 @@
+////////////////////////////////////////
+////////////////////////////////////////
+//
+//  File:
+//      \file sparse-matrix-test-01.cpp
+//
+//  Description:
+//      \brief Sparse Matrix Tests
+//
+//  Author:
+//      \author J. Caleb Wherry
+//
+////////////////////////////////////////
+////////////////////////////////////////
+
+// Local Includes:
+#include "SparseMatrix.hpp"
+
+// Compiler includes:
+#include <vector>
+#include <sstream>
+
+// Test Includes:
+#include <gtest/gtest.h>
+
+// Namespaces:
+namespace M = matrix;
+using namespace std;
+
+// Anonymous namespace:
+namespace
+{
+
+// Sparse matrix class test fixture:
+class SparseMatrixTest : public ::testing::Test
+{
+  protected:
+
+    // Test Objects:
+    M::Matrix<double> dense, denseB, denseC;
+    M::SparseMatrix<double> sparse, sparseB, sparseC;
+
+    // Dense matrix with roughly one element in `every` set to a small integer
+    //  (sums of products stay exact, whatever the order):
+    static M::Matrix<double> pattern(uint32_t rows, uint32_t cols, uint32_t seed, uint32_t every)
+    {
+      M::Matrix<double> result(rows, cols, 0.0);
+      uint32_t state = seed;
+      for (uint32_t i=0; i<rows; ++i)
+      {
+        for (uint32_t j=0; j<cols; ++j)
+        {
+          state = state*1664525u + 1013904223u;
+          if ( (state >> 8) % every == 0 )
+          {
+            result(i,j) = double(int((state >> 16) % 9) - 4);
+          }
+        }
+      }
+      return result;
+    }
+
+    // Called before every test group:
+    virtual void SetUp()
+    {
+      dense  = pattern(67, 45, 1, 5);
+      denseB = pattern(45, 38, 2, 4);
+      denseC = pattern(67, 45, 3, 6);
+      sparse  = M::SparseMatrix<double>(dense);
+      sparseB = M::SparseMatrix<double>(denseB);
+      sparseC = M::SparseMatrix<double>(denseC, M::sparseCsc);
+    }
+
+    // Called after every test group:
+    virtual void TearDown()
+    {
+    }
+
+};
+
+
+TEST_F(SparseMatrixTest, Assembly)
+{
+
+  // Unordered entries, with duplicates summed:
+  vector<M::Triplet<double>> entries = { {2, 1, 5.0}, {0, 3, 1.0}, {2, 0, 2.0}, {0, 3, 4.0}, {1, 2, -1.0} };
+  M::SparseMatrix<double> A(3, 4, entries);
+  M::Matrix<double> expected = { {0, 0,  0, 5},
+                                 {0, 0, -1, 0},
+                                 {2, 5,  0, 0}
+                               };
+
+  EXPECT_EQ( A.getNonZeros(), 4u );
+  EXPECT_EQ( A.getPointers(), vector<size_t>({0, 1, 2, 4}) );
+  EXPECT_EQ( A.getIndices(), vector<uint32_t>({3, 2, 0, 1}) );
+  EXPECT_EQ( A.toDense(), expected );
+  EXPECT_EQ( A(0,3), 5.0 );
+  EXPECT_EQ( A(1,1), 0.0 );
+
+  M::SparseMatrix<double> B(3, 4, entries, M::sparseCsc);
+  EXPECT_EQ( B.getFormat(), M::sparseCsc );
+  EXPECT_EQ( B.toDense(), expected );
+  EXPECT_EQ( B, A );
+
+  EXPECT_THROW({
+    M::SparseMatrix<double> temp(3, 3, entries);
+  }, out_of_range);
+  EXPECT_THROW({
+    auto temp = A(3,0);
+  }, out_of_range);
+
+  // Raw arrays are checked:
+  M::SparseMatrix<double> C(2, 3, M::sparseCsr, {0, 1, 3}, {2, 0, 1}, {1.0, 2.0, 3.0});
+  EXPECT_EQ( C(1,1), 3.0 );
+  EXPECT_THROW({
+    M::SparseMatrix<double> temp(2, 3, M::sparseCsr, {0, 1, 3}, {2, 1, 0}, {1.0, 2.0, 3.0});
+  }, logic_error);
+  EXPECT_THROW({
+    M::SparseMatrix<double> temp(2, 3, M::sparseCsr, {0, 1}, {2}, {1.0});
+  }, logic_error);
+
+}
+
+
+TEST_F(SparseMatrixTest, Conversion)
+{
+
+  EXPECT_EQ( sparse.toDense(), dense );
+  EXPECT_EQ( sparseC.toDense(), denseC );
+  EXPECT_EQ( sparse.toFormat(M::sparseCsc).toDense(), dense );
+  EXPECT_EQ( sparse.toFormat(M::sparseCsc).toFormat(M::sparseCsr), sparse );
+
+  M::SparseMatrix<double> T = sparse.transpose();
+  EXPECT_EQ( T.getNumRows(), dense.getNumCols() );
+  EXPECT_EQ( T.toDense(), dense.transpose() );
+  EXPECT_EQ( T.transpose(), sparse );
+
+  EXPECT_EQ( M::SparseMatrix<double>(5, 7).toDense(), M::Matrix<double>(5, 7, 0.0) );
+
+}
+
+
+TEST_F(SparseMatrixTest, OperatorDisplay)
+{
+
+  // Stream buffer that counts flushes:
+  struct CountingBuf : public stringbuf
+  {
+    int syncs = 0;
+    int sync() { ++syncs; return stringbuf::sync(); }
+  };
+
+  M::Matrix<double> D = { {0, 2, 0},
+                          {1, 0, 3}
+                        };
+  CountingBuf buf;
+  ostream os(&buf);
+  os << M::SparseMatrix<double>(D);
+  EXPECT_EQ( buf.str(), "(0, 1) 2\n(1, 0) 1\n(1, 2) 3\n" );
+  EXPECT_EQ( buf.syncs, 1 );
+
+  // Column-major storage prints the same coordinates:
+  ostringstream csc;
+  csc << M::SparseMatrix<double>(D, M::sparseCsc);
+  EXPECT_EQ( csc.str(), "(1, 0) 1\n(0, 1) 2\n(1, 2) 3\n" );
+
+}
+
+
+TEST_F(SparseMatrixTest, OperatorMultiply_Vector)
+{
+
+  vector<double> x(dense.getNumCols());
+  for (size_t j=0; j<x.size(); ++j)
+  {
+    x[j] = double(j % 7) - 3;
+  }
+
+  M::Matrix<double> X(dense.getNumCols(), 1);
+  for (uint32_t j=0; j<X.getNumRows(); ++j)
+  {
+    X(j,0) = x[j];
+  }
+  M::Matrix<double> expected = dense*X;
+
+  // Every kernel level, both layouts:
+  M::SimdLevel best = M::simdLevel();
+  for (int level=M::simdScalar; level<=best; ++level)
+  {
+    M::setSimdLevel(M::SimdLevel(level));
+
+    vector<double> y = sparse*x, yc = sparse.toFormat(M::sparseCsc)*x;
+    for (uint32_t i=0; i<dense.getNumRows(); ++i)
+    {
+      EXPECT_EQ( y[i], expected(i,0) );
+      EXPECT_EQ( yc[i], expected(i,0) );
+    }
+  }
+  M::setSimdLevel(best);
+
+  // float takes its own kernel:
+  M::SparseMatrix<float> F(3, 20, { {0, 19, 2.0f}, {0, 3, 1.0f}, {2, 5, -1.0f}, {2, 6, 1.0f}, {2, 7, 1.0f},
+                                    {2, 8, 1.0f}, {2, 9, 1.0f}, {2, 10, 1.0f}, {2, 11, 1.0f}, {2, 12, 1.0f} });
+  vector<float> f = F*vector<float>(20, 1.5f);
+  EXPECT_EQ( f, vector<float>({4.5f, 0.0f, 9.0f}) );
+
+  EXPECT_THROW({
+    auto temp = sparse*vector<double>(3);
+  }, logic_error);
+
+}
+
+
+TEST_F(SparseMatrixTest, OperatorMultiply_Matrix)
+{
+
+  // Sparse/Dense in both layouts:
+  EXPECT_EQ( sparse*denseB, dense*denseB );
+  EXPECT_EQ( sparse.toFormat(M::sparseCsc)*denseB, dense*denseB );
+
+  // Dense/Sparse in both layouts:
+  EXPECT_EQ( dense*sparseB, dense*denseB );
+  EXPECT_EQ( dense*sparseB.toFormat(M::sparseCsc), dense*denseB );
+
+  // Sparse/Sparse:
+  M::SparseMatrix<double> P = sparse*sparseB;
+  EXPECT_EQ( P.toDense(), dense*denseB );
+  EXPECT_EQ( P.getFormat(), M::sparseCsr );
+  M::SparseMatrix<double> Pc = sparse.toFormat(M::sparseCsc)*sparseB;
+  EXPECT_EQ( Pc.getFormat(), M::sparseCsc );
+  EXPECT_EQ( Pc.toDense(), dense*denseB );
+
+  // Scalar:
+  EXPECT_EQ( (sparse*2.0).toDense(), dense*2.0 );
+
+  EXPECT_THROW({
+    auto temp = sparse*sparse;
+  }, logic_error);
+  EXPECT_THROW({
+    auto temp = sparse*dense;
+  }, logic_error);
+  EXPECT_THROW({
+    auto temp = denseB*sparse;
+  }, logic_error);
+
+}
+
+
+TEST_F(SparseMatrixTest, OperatorPlusMinus)
+{
+
+  EXPECT_EQ( (sparse + sparseC).toDense(), dense + denseC );
+  EXPECT_EQ( (sparse - sparseC).toDense(), dense - denseC );
+  EXPECT_EQ( (sparseC - sparse).getFormat(), M::sparseCsc );
+  EXPECT_EQ( (sparseC - sparse).toDense(), denseC - dense );
+
+  // Cancelled elements stay stored as zeros:
+  M::SparseMatrix<double> Z = sparse - sparse;
+  EXPECT_EQ( Z.getNonZeros(), sparse.getNonZeros() );
+  EXPECT_EQ( Z.toDense(), M::Matrix<double>(67, 45, 0.0) );
+
+  EXPECT_THROW({
+    auto temp = sparse + sparseB;
+  }, logic_error);
+
+}
+
+
+TEST_F(SparseMatrixTest, Parallel)
+{
+
+  M::Matrix<double> big = pattern(301, 257, 4, 7), bigB = pattern(257, 190, 5, 9);
+  M::SparseMatrix<double> A(big), B(bigB);
+  vector<double> x(257, 1.0);
+
+  // Serial reference:
+  size_t threads = M::getNumThreads();
+  M::setNumThreads(1);
+  M::SparseMatrix<double> prodRef = A*B, sumRef = A + A;
+  M::Matrix<double> spmmRef = A*bigB;
+  vector<double> spmvRef = A*x;
+
+  // Force every operation through the pool:
+  size_t threshold = M::getParallelThreshold();
+  M::setNumThreads(4);
+  M::setParallelThreshold(16);
+
+  EXPECT_EQ( A*B, prodRef );
+  EXPECT_EQ( A + A, sumRef );
+  EXPECT_EQ( A*bigB, spmmRef );
+  EXPECT_EQ( big*B, big*bigB );
+  EXPECT_EQ( A*x, spmvRef );
+  EXPECT_EQ( M::SparseMatrix<double>(big), A );
+  EXPECT_EQ( A.toDense(), big );
+
+  M::setParallelThreshold(threshold);
+  M::setNumThreads(threads);
+
+}
+
+
+} // End anonymous namespace